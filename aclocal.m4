@@ -1761,6 +1761,7 @@ m4_include([auxdir/slurmrestd.m4])
 m4_include([auxdir/x_ac_affinity.m4])
 m4_include([auxdir/x_ac_c99.m4])
 m4_include([auxdir/x_ac_cgroup.m4])
+m4_include([auxdir/x_ac_cpu_dispatch.m4])
 m4_include([auxdir/x_ac_curl.m4])
 m4_include([auxdir/x_ac_databases.m4])
 m4_include([auxdir/x_ac_debug.m4])
@@ -1770,6 +1771,7 @@ m4_include([auxdir/x_ac_freeipmi.m4])
 m4_include([auxdir/x_ac_hpe_slingshot.m4])
 m4_include([auxdir/x_ac_http_parser.m4])
 m4_include([auxdir/x_ac_hwloc.m4])
+m4_include([auxdir/x_ac_io_uring.m4])
 m4_include([auxdir/x_ac_json.m4])
 m4_include([auxdir/x_ac_jwt.m4])
 m4_include([auxdir/x_ac_lua.m4])
@@ -0,0 +1,49 @@
+##*****************************************************************************
+#  SYNOPSIS:
+#    X_AC_CPU_DISPATCH
+#
+#  DESCRIPTION:
+#    Test whether the compiler can build functions for a specific x86-64
+#    instruction set with __attribute__((target)) and select between them at
+#    run time with __builtin_cpu_supports(). Used by the bitstring kernels.
+##*****************************************************************************
+
+AC_DEFUN([X_AC_CPU_DISPATCH], [
+  AC_MSG_CHECKING([for x86-64 run time CPU dispatch support])
+  AC_LINK_IFELSE([AC_LANG_PROGRAM([
+	#if !defined(__x86_64__)
+	#error not x86-64
+	#endif
+	#include <immintrin.h>
+	__attribute__((target("avx2")))
+	static int f_avx2(void) {
+		__m256i a = _mm256_setzero_si256();
+		return _mm256_testz_si256(a, a);
+	}
+	__attribute__((target("avx512f,avx512vpopcntdq")))
+	static long long f_avx512(void) {
+		__m512i a = _mm512_setzero_si512();
+		return _mm512_reduce_add_epi64(_mm512_popcnt_epi64(a));
+	}
+	__attribute__((target("popcnt")))
+	static int f_popcnt(unsigned long long x) {
+		return __builtin_popcountll(x);
+	}],
+	[[
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512vpopcntdq"))
+		return f_avx512();
+	if (__builtin_cpu_supports("avx2"))
+		return f_avx2();
+	if (__builtin_cpu_supports("popcnt"))
+		return f_popcnt(0);
+	return 0; ]])],
+    x_ac_cpu_dispatch=yes,
+    x_ac_cpu_dispatch=no)
+
+  AC_MSG_RESULT([$x_ac_cpu_dispatch])
+  if test "$x_ac_cpu_dispatch" = "yes"; then
+    AC_DEFINE(HAVE_X86_CPU_DISPATCH, 1,
+	      [Define to 1 if x86-64 CPU specific functions can be selected at run time])
+  fi
+])
@@ -0,0 +1,37 @@
+##*****************************************************************************
+#  SYNOPSIS:
+#    X_AC_IO_URING
+#
+#  DESCRIPTION:
+#    Test whether the kernel headers provide io_uring(7) with multishot poll
+#    requests. No library is needed as the ring is driven directly through
+#    the io_uring_setup(2) and io_uring_enter(2) system calls. Used by the
+#    conmgr io_uring polling backend.
+##*****************************************************************************
+
+AC_DEFUN([X_AC_IO_URING], [
+  AC_MSG_CHECKING([for io_uring multishot poll support])
+  AC_COMPILE_IFELSE([AC_LANG_PROGRAM([
+	#include <linux/io_uring.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>],
+	[[
+	struct io_uring_params p = { 0 };
+	struct io_uring_sqe sqe = {
+		.opcode = IORING_OP_POLL_ADD,
+		.len = IORING_POLL_ADD_MULTI,
+	};
+	struct io_uring_cqe cqe = { .flags = IORING_CQE_F_MORE };
+	return syscall(__NR_io_uring_setup, 1, &p) +
+	       syscall(__NR_io_uring_enter, 0, 0, 0, IORING_ENTER_GETEVENTS,
+		       NULL, 0) + sqe.len + cqe.flags; ]])],
+    x_ac_io_uring=yes,
+    x_ac_io_uring=no)
+
+  AC_MSG_RESULT([$x_ac_io_uring])
+  if test "$x_ac_io_uring" = "yes"; then
+    AC_DEFINE(HAVE_IO_URING, 1,
+	      [Define to 1 if we have io_uring(7) multishot poll support])
+  fi
+  AM_CONDITIONAL(HAVE_IO_URING, [test "$x_ac_io_uring" = "yes"])
+])
@@ -1034,7 +1034,8 @@ enum node_states {
  * Values can be ORed */
 #define SHOW_ALL SLURM_BIT(0) /* Show info for "hidden" partitions */
 #define SHOW_DETAIL SLURM_BIT(1) /* Show detailed resource information */
-/*	SLURM_BIT(2) empty */
+#define SHOW_DELTA SLURM_BIT(2) /* Only show jobs changed since update_time,
+				 * plus IDs of purged jobs */
 #define SHOW_MIXED SLURM_BIT(3)	/* Automatically set node MIXED state */
 #define SHOW_LOCAL SLURM_BIT(4)	/* Show only local information, even on
 				 * federated cluster */
@@ -1972,6 +1973,11 @@ typedef struct job_info_msg {
 	time_t last_update;	/* time of latest info */
 	uint32_t record_count;	/* number of records */
 	slurm_job_info_t *job_array;	/* the job records */
+	bool delta;		/* true if job_array only holds jobs changed
+				 * since the requested update_time */
+	uint32_t purged_count;	/* number of purged_job_ids */
+	uint32_t *purged_job_ids; /* jobs purged since the requested
+				   * update_time, only set if delta */
 } job_info_msg_t;
 
 typedef struct {
@@ -4129,6 +4135,10 @@ extern int slurm_load_job_user(job_info_msg_t **job_info_msg_pptr,
  * IN show_flags - job filtering options
  * RET 0 or -1 on error
  * NOTE: free the response using slurm_free_job_info_msg
+ * NOTE: with SHOW_DELTA only jobs changed since update_time are returned, along
+ *	with the IDs of jobs purged since then. If the response's delta field is
+ *	false, the controller could not satisfy the request incrementally and
+ *	returned every job instead.
  */
 extern int slurm_load_jobs(time_t update_time,
 			   job_info_msg_t **job_info_msg_pptr,
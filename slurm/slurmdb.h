@@ -941,6 +941,8 @@ typedef struct {
 				 * (DON'T PACK for state file) */
 	list_t *acct_limit_list; /* slurmdb_used_limits_t's (DON'T PACK
 			          * for state file) */
+	struct xhash_st *acct_limit_hash; /* index of acct_limit_list by
+					   * account name (DON'T PACK) */
 	list_t *job_list; /* list of job pointers to submitted/running
 			     jobs (DON'T PACK) */
 	bitstr_t *grp_node_bitmap;	/* Bitmap of allocated nodes
@@ -966,6 +968,8 @@ typedef struct {
 	long double *usage_tres_raw; /* measure of each TRES usage */
 	list_t *user_limit_list; /* slurmdb_used_limits_t's (DON'T PACK
 				  * for state file) */
+	struct xhash_st *user_limit_hash; /* index of user_limit_list by uid
+					   * (DON'T PACK) */
 } slurmdb_qos_usage_t;
 
 typedef struct {
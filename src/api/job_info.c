@@ -397,6 +397,7 @@ static int _load_fed_jobs(slurm_msg_t *req_msg,
 				orig_msg->record_count = new_rec_cnt;
 			}
 			xfree(new_msg->job_array);
+			xfree(new_msg->purged_job_ids);
 			xfree(new_msg);
 		}
 		xfree(job_resp);
@@ -533,7 +534,7 @@ slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 	    cluster_in_federation(ptr, cluster_name)) {
 		/* In federation. Need full info from all clusters */
 		update_time = (time_t) 0;
-		show_flags &= (~SHOW_LOCAL);
+		show_flags &= (~(SHOW_LOCAL | SHOW_DELTA));
 	} else {
 		/* Report local cluster info only */
 		show_flags |= SHOW_LOCAL;
@@ -53,8 +53,12 @@
 
 #include "src/slurmdbd/read_config.h"
 
+/*
+ * Minimum number of buckets in the association hash tables. The tables are
+ * grown as associations are added to keep chains short, see _add_assoc_hash().
+ */
 #define ASSOC_HASH_SIZE 1000
-#define ASSOC_HASH_ID_INX(_assoc_id)	(_assoc_id % ASSOC_HASH_SIZE)
+#define ASSOC_HASH_ID_INX(_assoc_id)	(_assoc_id % assoc_hash_size)
 
 typedef struct {
 	char *req;
@@ -92,6 +96,8 @@ static pthread_mutex_t assoc_lock_init = PTHREAD_MUTEX_INITIALIZER;
 static assoc_init_args_t init_setup;
 static slurmdb_assoc_rec_t **assoc_hash_id = NULL;
 static slurmdb_assoc_rec_t **assoc_hash = NULL;
+static uint32_t assoc_hash_size = 0; /* buckets in each assoc hash table */
+static uint32_t assoc_hash_cnt = 0; /* records in each assoc hash table */
 static int *assoc_mgr_tres_old_pos = NULL;
 
 static bool _running_cache(void)
@@ -103,59 +109,51 @@ static bool _running_cache(void)
 	return false;
 }
 
-static int _get_str_inx(char *name)
+static uint32_t _get_str_inx(char *name)
 {
-	int j, index = 0;
+	uint32_t index = 0;
 
 	if (!name)
 		return 0;
 
-	for (j = 1; *name; name++, j++)
-		index += (int)tolower(*name) * j;
+	for (; *name; name++)
+		index = (index * 31) + (uint32_t) tolower(*name);
 
 	return index;
 }
 
-static int _assoc_hash_index(slurmdb_assoc_rec_t *assoc)
+static uint32_t _assoc_hash_index(slurmdb_assoc_rec_t *assoc)
 {
-	int index;
+	uint32_t index;
 
 	xassert(assoc);
+	xassert(assoc_hash_size);
 
-	/* Multiply each character by its numerical position in the
-	 * name string to add a bit of entropy.
+	/*
+	 * Mix each component with a multiplicative hash so that different
+	 * uid/account/partition combinations spread over the whole table
+	 * instead of clustering around the sum of their values.
 	 */
-
-	index = assoc->uid;
+	index = assoc->uid * 0x9e3779b1;
 
 	/* only set on the slurmdbd */
 	if (slurmdbd_conf && assoc->cluster)
-		index += _get_str_inx(assoc->cluster);
+		index = (index ^ _get_str_inx(assoc->cluster)) * 0x9e3779b1;
 
 	if (assoc->acct)
-		index += _get_str_inx(assoc->acct);
+		index = (index ^ _get_str_inx(assoc->acct)) * 0x9e3779b1;
 
 	if (assoc->partition)
-		index += _get_str_inx(assoc->partition);
-
-	index %= ASSOC_HASH_SIZE;
-	if (index < 0)
-		index += ASSOC_HASH_SIZE;
+		index = (index ^ _get_str_inx(assoc->partition)) * 0x9e3779b1;
 
-	return index;
+	index ^= index >> 16;
 
+	return index % assoc_hash_size;
 }
 
-static void _add_assoc_hash(slurmdb_assoc_rec_t *assoc)
+static void _link_assoc_hash(slurmdb_assoc_rec_t *assoc)
 {
-	int inx = ASSOC_HASH_ID_INX(assoc->id);
-
-	if (!assoc_hash_id)
-		assoc_hash_id = xcalloc(ASSOC_HASH_SIZE,
-					sizeof(slurmdb_assoc_rec_t *));
-	if (!assoc_hash)
-		assoc_hash = xcalloc(ASSOC_HASH_SIZE,
-				     sizeof(slurmdb_assoc_rec_t *));
+	uint32_t inx = ASSOC_HASH_ID_INX(assoc->id);
 
 	assoc->assoc_next_id = assoc_hash_id[inx];
 	assoc_hash_id[inx] = assoc;
@@ -165,6 +163,58 @@ static void _add_assoc_hash(slurmdb_assoc_rec_t *assoc)
 	assoc_hash[inx] = assoc;
 }
 
+/*
+ * Allocate the assoc hash tables with room for at least cnt records,
+ * rehashing any records already in them.
+ */
+static void _resize_assoc_hash(uint32_t cnt)
+{
+	slurmdb_assoc_rec_t **old_hash_id = assoc_hash_id;
+	uint32_t old_size = assoc_hash_size;
+
+	assoc_hash_size = MAX(cnt, ASSOC_HASH_SIZE);
+	assoc_hash_id = xcalloc(assoc_hash_size, sizeof(*assoc_hash_id));
+	xfree(assoc_hash);
+	assoc_hash = xcalloc(assoc_hash_size, sizeof(*assoc_hash));
+
+	/* Every record is on exactly one chain of the id table */
+	for (uint32_t i = 0; i < old_size; i++) {
+		slurmdb_assoc_rec_t *assoc = old_hash_id[i];
+
+		while (assoc) {
+			slurmdb_assoc_rec_t *next = assoc->assoc_next_id;
+			_link_assoc_hash(assoc);
+			assoc = next;
+		}
+	}
+
+	xfree(old_hash_id);
+
+	if (old_size)
+		debug2("%s: resized from %u to %u buckets for %u associations",
+		       __func__, old_size, assoc_hash_size, assoc_hash_cnt);
+}
+
+static void _free_assoc_hash(void)
+{
+	xfree(assoc_hash_id);
+	xfree(assoc_hash);
+	assoc_hash_size = 0;
+	assoc_hash_cnt = 0;
+}
+
+static void _add_assoc_hash(slurmdb_assoc_rec_t *assoc)
+{
+	/* Double the tables once the load factor exceeds 1 */
+	if (!assoc_hash_id)
+		_resize_assoc_hash(ASSOC_HASH_SIZE);
+	else if (assoc_hash_cnt >= assoc_hash_size)
+		_resize_assoc_hash(assoc_hash_size * 2);
+
+	_link_assoc_hash(assoc);
+	assoc_hash_cnt++;
+}
+
 static slurmdb_assoc_rec_t *_find_assoc_rec_id(uint32_t assoc_id,
 					       char *cluster_name)
 {
@@ -216,7 +266,7 @@ static slurmdb_assoc_rec_t *_find_assoc_rec(
 	slurmdb_assoc_rec_t *assoc)
 {
 	slurmdb_assoc_rec_t *assoc_ptr;
-	int inx;
+	uint32_t inx;
 
 	/* We can only use _find_assoc_rec_id if we are not on the slurmdbd */
 	if (assoc->id)
@@ -333,6 +383,9 @@ static void _delete_assoc_hash(slurmdb_assoc_rec_t *assoc)
 		return;	/* Fix CLANG false positive error */
 	} else
 		*assoc_pptr = assoc_ptr->assoc_next;
+
+	xassert(assoc_hash_cnt);
+	assoc_hash_cnt--;
 }
 
 
@@ -1108,8 +1161,8 @@ static int _post_assoc_list(void)
 	if (!assoc_mgr_assoc_list)
 		return SLURM_ERROR;
 
-	xfree(assoc_hash_id);
-	xfree(assoc_hash);
+	_free_assoc_hash();
+	_resize_assoc_hash(list_count(assoc_mgr_assoc_list));
 
 	itr = list_iterator_create(assoc_mgr_assoc_list);
 
@@ -2185,8 +2238,7 @@ extern int assoc_mgr_fini(bool save_state)
 	if (_running_cache())
 		*init_setup.running_cache = RUNNING_CACHE_STATE_NOTRUNNING;
 
-	xfree(assoc_hash_id);
-	xfree(assoc_hash);
+	_free_assoc_hash();
 
 	assoc_mgr_unlock(&locks);
 
@@ -42,10 +42,15 @@
 #include "config.h"
 
 #include <ctype.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef HAVE_X86_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
 #include "src/common/bitstring.h"
 #include "src/common/log.h"
 #include "src/common/macros.h"
@@ -704,31 +709,414 @@ bit_fill_gaps(bitstr_t *b)
 	return;
 }
 
+#ifdef HAVE___BUILTIN_POPCOUNTLL
+#define hweight __builtin_popcountll
+#else
+/*
+ * Returns the hamming weight (i.e. the number of bits set) in a word.
+ * NOTE: This routine borrowed from Linux 4.9 <tools/lib/hweight.c>.
+ */
+static uint64_t
+hweight(uint64_t w)
+{
+        w -= (w >> 1) & 0x5555555555555555ul;
+        w =  (w & 0x3333333333333333ul) + ((w >> 2) & 0x3333333333333333ul);
+        w =  (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0ful;
+        return (w * 0x0101010101010101ul) >> 56;
+}
+#endif
+
+/*
+ * Word kernels used by the bitmap operations below. They only process whole
+ * words, the callers handle the partial last word of a bitmap.
+ *
+ * Where supported the kernels are built for several x86-64 instruction sets
+ * and the best one for the CPU is selected at startup. Bitmaps shorter than
+ * BIT_KERNEL_MIN_WORDS always use the scalar loops, which the compiler can
+ * inline, as vectorizing a word or two does not pay for the indirect call.
+ */
+#define BIT_KERNEL_MIN_WORDS 8
+
+static inline void _and_words(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	for (bitoff_t i = 0; i < words; i++)
+		w1[i] &= w2[i];
+}
+
+static inline void _and_not_words(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	for (bitoff_t i = 0; i < words; i++)
+		w1[i] &= ~w2[i];
+}
+
+static inline void _or_words(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	for (bitoff_t i = 0; i < words; i++)
+		w1[i] |= w2[i];
+}
+
+static inline int32_t _count_words(bitstr_t *w, bitoff_t words)
+{
+	int32_t count = 0;
+
+	for (bitoff_t i = 0; i < words; i++)
+		count += hweight(w[i]);
+
+	return count;
+}
+
+static inline int32_t _overlap_words(bitstr_t *w1, bitstr_t *w2,
+				     bitoff_t words)
+{
+	int32_t count = 0;
+
+	for (bitoff_t i = 0; i < words; i++)
+		count += hweight(w1[i] & w2[i]);
+
+	return count;
+}
+
+static inline bool _overlap_any_words(bitstr_t *w1, bitstr_t *w2,
+				      bitoff_t words)
+{
+	for (bitoff_t i = 0; i < words; i++)
+		if (w1[i] & w2[i])
+			return true;
+
+	return false;
+}
+
+static inline bool _super_set_words(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	for (bitoff_t i = 0; i < words; i++)
+		if (w1[i] & ~w2[i])
+			return false;
+
+	return true;
+}
+
+#ifdef HAVE_X86_CPU_DISPATCH
+__attribute__((target("popcnt")))
+static int32_t _count_words_popcnt(bitstr_t *w, bitoff_t words)
+{
+	int32_t count = 0;
+
+	for (bitoff_t i = 0; i < words; i++)
+		count += __builtin_popcountll(w[i]);
+
+	return count;
+}
+
+__attribute__((target("popcnt")))
+static int32_t _overlap_words_popcnt(bitstr_t *w1, bitstr_t *w2,
+				     bitoff_t words)
+{
+	int32_t count = 0;
+
+	for (bitoff_t i = 0; i < words; i++)
+		count += __builtin_popcountll(w1[i] & w2[i]);
+
+	return count;
+}
+
+__attribute__((target("avx2")))
+static void _and_words_avx2(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	bitoff_t i;
+
+	for (i = 0; (i + 4) <= words; i += 4) {
+		__m256i v1 = _mm256_loadu_si256((__m256i *) &w1[i]);
+		__m256i v2 = _mm256_loadu_si256((__m256i *) &w2[i]);
+		_mm256_storeu_si256((__m256i *) &w1[i],
+				    _mm256_and_si256(v1, v2));
+	}
+	_and_words(&w1[i], &w2[i], words - i);
+}
+
+__attribute__((target("avx2")))
+static void _and_not_words_avx2(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	bitoff_t i;
+
+	for (i = 0; (i + 4) <= words; i += 4) {
+		__m256i v1 = _mm256_loadu_si256((__m256i *) &w1[i]);
+		__m256i v2 = _mm256_loadu_si256((__m256i *) &w2[i]);
+		/* _mm256_andnot_si256(a, b) is (~a & b) */
+		_mm256_storeu_si256((__m256i *) &w1[i],
+				    _mm256_andnot_si256(v2, v1));
+	}
+	_and_not_words(&w1[i], &w2[i], words - i);
+}
+
+__attribute__((target("avx2")))
+static void _or_words_avx2(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	bitoff_t i;
+
+	for (i = 0; (i + 4) <= words; i += 4) {
+		__m256i v1 = _mm256_loadu_si256((__m256i *) &w1[i]);
+		__m256i v2 = _mm256_loadu_si256((__m256i *) &w2[i]);
+		_mm256_storeu_si256((__m256i *) &w1[i],
+				    _mm256_or_si256(v1, v2));
+	}
+	_or_words(&w1[i], &w2[i], words - i);
+}
+
+__attribute__((target("avx2")))
+static bool _overlap_any_words_avx2(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	bitoff_t i;
+
+	for (i = 0; (i + 4) <= words; i += 4) {
+		__m256i v1 = _mm256_loadu_si256((__m256i *) &w1[i]);
+		__m256i v2 = _mm256_loadu_si256((__m256i *) &w2[i]);
+		if (!_mm256_testz_si256(v1, v2))
+			return true;
+	}
+
+	return _overlap_any_words(&w1[i], &w2[i], words - i);
+}
+
+__attribute__((target("avx2")))
+static bool _super_set_words_avx2(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	bitoff_t i;
+
+	for (i = 0; (i + 4) <= words; i += 4) {
+		__m256i v1 = _mm256_loadu_si256((__m256i *) &w1[i]);
+		__m256i v2 = _mm256_loadu_si256((__m256i *) &w2[i]);
+		/* _mm256_testc_si256(a, b) is true if (~a & b) == 0 */
+		if (!_mm256_testc_si256(v2, v1))
+			return false;
+	}
+
+	return _super_set_words(&w1[i], &w2[i], words - i);
+}
+
+__attribute__((target("avx512f")))
+static void _and_words_avx512(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	bitoff_t i;
+
+	for (i = 0; (i + 8) <= words; i += 8) {
+		__m512i v1 = _mm512_loadu_si512(&w1[i]);
+		__m512i v2 = _mm512_loadu_si512(&w2[i]);
+		_mm512_storeu_si512(&w1[i], _mm512_and_si512(v1, v2));
+	}
+	_and_words(&w1[i], &w2[i], words - i);
+}
+
+__attribute__((target("avx512f")))
+static void _and_not_words_avx512(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	bitoff_t i;
+
+	for (i = 0; (i + 8) <= words; i += 8) {
+		__m512i v1 = _mm512_loadu_si512(&w1[i]);
+		__m512i v2 = _mm512_loadu_si512(&w2[i]);
+		/* _mm512_andnot_si512(a, b) is (~a & b) */
+		_mm512_storeu_si512(&w1[i], _mm512_andnot_si512(v2, v1));
+	}
+	_and_not_words(&w1[i], &w2[i], words - i);
+}
+
+__attribute__((target("avx512f")))
+static void _or_words_avx512(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	bitoff_t i;
+
+	for (i = 0; (i + 8) <= words; i += 8) {
+		__m512i v1 = _mm512_loadu_si512(&w1[i]);
+		__m512i v2 = _mm512_loadu_si512(&w2[i]);
+		_mm512_storeu_si512(&w1[i], _mm512_or_si512(v1, v2));
+	}
+	_or_words(&w1[i], &w2[i], words - i);
+}
+
+__attribute__((target("avx512f")))
+static bool _overlap_any_words_avx512(bitstr_t *w1, bitstr_t *w2,
+				      bitoff_t words)
+{
+	bitoff_t i;
+
+	for (i = 0; (i + 8) <= words; i += 8) {
+		__m512i v1 = _mm512_loadu_si512(&w1[i]);
+		__m512i v2 = _mm512_loadu_si512(&w2[i]);
+		if (_mm512_test_epi64_mask(v1, v2))
+			return true;
+	}
+
+	return _overlap_any_words(&w1[i], &w2[i], words - i);
+}
+
+__attribute__((target("avx512f")))
+static bool _super_set_words_avx512(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	bitoff_t i;
+
+	for (i = 0; (i + 8) <= words; i += 8) {
+		__m512i v1 = _mm512_loadu_si512(&w1[i]);
+		__m512i v2 = _mm512_loadu_si512(&w2[i]);
+		__m512i extra = _mm512_andnot_si512(v2, v1);
+		if (_mm512_test_epi64_mask(extra, extra))
+			return false;
+	}
+
+	return _super_set_words(&w1[i], &w2[i], words - i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static int32_t _count_words_avx512(bitstr_t *w, bitoff_t words)
+{
+	__m512i sum = _mm512_setzero_si512();
+	bitoff_t i;
+
+	for (i = 0; (i + 8) <= words; i += 8) {
+		__m512i v = _mm512_loadu_si512(&w[i]);
+		sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(v));
+	}
+
+	return _mm512_reduce_add_epi64(sum) + _count_words(&w[i], words - i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static int32_t _overlap_words_avx512(bitstr_t *w1, bitstr_t *w2,
+				     bitoff_t words)
+{
+	__m512i sum = _mm512_setzero_si512();
+	bitoff_t i;
+
+	for (i = 0; (i + 8) <= words; i += 8) {
+		__m512i v1 = _mm512_loadu_si512(&w1[i]);
+		__m512i v2 = _mm512_loadu_si512(&w2[i]);
+		sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(
+						    _mm512_and_si512(v1, v2)));
+	}
+
+	return _mm512_reduce_add_epi64(sum) +
+	       _overlap_words(&w1[i], &w2[i], words - i);
+}
+#endif
+
+static void _and_words_scalar(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	_and_words(w1, w2, words);
+}
+
+static void _and_not_words_scalar(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	_and_not_words(w1, w2, words);
+}
+
+static void _or_words_scalar(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	_or_words(w1, w2, words);
+}
+
+static int32_t _count_words_scalar(bitstr_t *w, bitoff_t words)
+{
+	return _count_words(w, words);
+}
+
+static int32_t _overlap_words_scalar(bitstr_t *w1, bitstr_t *w2,
+				     bitoff_t words)
+{
+	return _overlap_words(w1, w2, words);
+}
+
+static bool _overlap_any_words_scalar(bitstr_t *w1, bitstr_t *w2,
+				      bitoff_t words)
+{
+	return _overlap_any_words(w1, w2, words);
+}
+
+static bool _super_set_words_scalar(bitstr_t *w1, bitstr_t *w2, bitoff_t words)
+{
+	return _super_set_words(w1, w2, words);
+}
+
+static struct {
+	void (*and_words)(bitstr_t *w1, bitstr_t *w2, bitoff_t words);
+	void (*and_not_words)(bitstr_t *w1, bitstr_t *w2, bitoff_t words);
+	void (*or_words)(bitstr_t *w1, bitstr_t *w2, bitoff_t words);
+	int32_t (*count_words)(bitstr_t *w, bitoff_t words);
+	int32_t (*overlap_words)(bitstr_t *w1, bitstr_t *w2, bitoff_t words);
+	bool (*overlap_any_words)(bitstr_t *w1, bitstr_t *w2, bitoff_t words);
+	bool (*super_set_words)(bitstr_t *w1, bitstr_t *w2, bitoff_t words);
+} kernels = {
+	.and_words = _and_words_scalar,
+	.and_not_words = _and_not_words_scalar,
+	.or_words = _or_words_scalar,
+	.count_words = _count_words_scalar,
+	.overlap_words = _overlap_words_scalar,
+	.overlap_any_words = _overlap_any_words_scalar,
+	.super_set_words = _super_set_words_scalar,
+};
+
+#ifdef HAVE_X86_CPU_DISPATCH
+/*
+ * Select the kernels for this CPU before any bitmap can be used, so the table
+ * is never modified while other threads read it.
+ */
+__attribute__((constructor))
+static void _select_kernels(void)
+{
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("popcnt")) {
+		kernels.count_words = _count_words_popcnt;
+		kernels.overlap_words = _overlap_words_popcnt;
+	}
+
+	if (__builtin_cpu_supports("avx512f")) {
+		kernels.and_words = _and_words_avx512;
+		kernels.and_not_words = _and_not_words_avx512;
+		kernels.or_words = _or_words_avx512;
+		kernels.overlap_any_words = _overlap_any_words_avx512;
+		kernels.super_set_words = _super_set_words_avx512;
+	} else if (__builtin_cpu_supports("avx2")) {
+		kernels.and_words = _and_words_avx2;
+		kernels.and_not_words = _and_not_words_avx2;
+		kernels.or_words = _or_words_avx2;
+		kernels.overlap_any_words = _overlap_any_words_avx2;
+		kernels.super_set_words = _super_set_words_avx2;
+	}
+
+	if (__builtin_cpu_supports("avx512vpopcntdq")) {
+		kernels.count_words = _count_words_avx512;
+		kernels.overlap_words = _overlap_words_avx512;
+	}
+}
+#endif
+
+/* Run a word kernel, using the inlined scalar loop for short bitmaps */
+#define _run_kernel(name, words, ...)			\
+	(((words) < BIT_KERNEL_MIN_WORDS) ?		\
+	 _##name(__VA_ARGS__, (words)) :		\
+	 kernels.name(__VA_ARGS__, (words)))
+
 /*
  * return 1 if all bits set in b1 are also set in b2, 0 otherwise
  */
 int
 bit_super_set(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t bit_cnt, words;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	xassert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += BITSTR_WORD_SIZE) {
-		if (b1[_bit_word(bit)] != (b1[_bit_word(bit)] &
-		                           b2[_bit_word(bit)])) {
-			bitstr_t mask;
-			if ((bit + BITSTR_WORD_SIZE) <= _bitstr_bits(b1))
-				return 0;
-			mask = _bit_nmask(_bitstr_bits(b1));
-			if ((b1[_bit_word(bit)] & mask) != (b1[_bit_word(bit)] &
-							    b2[_bit_word(bit)] &
-							    mask))
-				return 0;
-		}
+	bit_cnt = _bitstr_bits(b1);
+	words = bit_cnt >> BITSTR_SHIFT;
+	if (!_run_kernel(super_set_words, words, &b1[BITSTR_OVERHEAD],
+			 &b2[BITSTR_OVERHEAD]))
+		return 0;
 
+	if (bit_cnt & BITSTR_MAXPOS) {
+		bitstr_t mask = _bit_nmask(bit_cnt);
+		if (b1[_bit_word(bit_cnt)] & ~b2[_bit_word(bit_cnt)] & mask)
+			return 0;
 	}
 
 	return 1;
@@ -764,6 +1152,36 @@ bit_equal(bitstr_t *b1, bitstr_t *b2)
 	return 1;
 }
 
+/*
+ * return a hash of the size and contents of b, identical bitstrings (see
+ * bit_equal()) always return the same hash
+ */
+extern uint64_t
+bit_hash(bitstr_t *b)
+{
+	bitoff_t bit, bit_cnt;
+	uint64_t hash;
+
+	_assert_bitstr_valid(b);
+
+	bit_cnt = _bitstr_bits(b);
+	hash = 0xcbf29ce484222325ULL ^ bit_cnt;
+
+	for (bit = 0; (bit + BITSTR_WORD_SIZE) <= bit_cnt;
+	     bit += BITSTR_WORD_SIZE) {
+		hash ^= b[_bit_word(bit)];
+		hash *= 0x100000001b3ULL;
+		hash ^= hash >> 32;
+	}
+	if (bit < bit_cnt) {
+		hash ^= b[_bit_word(bit)] & _bit_nmask(bit_cnt);
+		hash *= 0x100000001b3ULL;
+		hash ^= hash >> 32;
+	}
+
+	return hash;
+}
+
 
 
 /*
@@ -774,19 +1192,18 @@ bit_equal(bitstr_t *b1, bitstr_t *b2)
 void
 bit_and(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit, bit_cnt;
+	bitoff_t bit_cnt, words;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 
 	bit_cnt = MIN(_bitstr_bits(b1), _bitstr_bits(b2));
-	for (bit = 0; (bit + BITSTR_WORD_SIZE) <= bit_cnt;
-	     bit += BITSTR_WORD_SIZE)
-		b1[_bit_word(bit)] &= b2[_bit_word(bit)];
+	words = bit_cnt >> BITSTR_SHIFT;
+	_run_kernel(and_words, words, &b1[BITSTR_OVERHEAD], &b2[BITSTR_OVERHEAD]);
 
-	if (bit < bit_cnt) {
+	if (bit_cnt & BITSTR_MAXPOS) {
 		uint64_t mask = ~(_bit_nmask(bit_cnt));
-		b1[_bit_word(bit)] &= (b2[_bit_word(bit)] | mask);
+		b1[_bit_word(bit_cnt)] &= (b2[_bit_word(bit_cnt)] | mask);
 	}
 }
 
@@ -797,19 +1214,18 @@ bit_and(bitstr_t *b1, bitstr_t *b2)
  */
 void bit_and_not(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit, bit_cnt;
+	bitoff_t bit_cnt, words;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 
 	bit_cnt = MIN(_bitstr_bits(b1), _bitstr_bits(b2));
-	for (bit = 0; (bit + BITSTR_WORD_SIZE) <= bit_cnt;
-	     bit += BITSTR_WORD_SIZE)
-		b1[_bit_word(bit)] &= ~b2[_bit_word(bit)];
+	words = bit_cnt >> BITSTR_SHIFT;
+	_run_kernel(and_not_words, words, &b1[BITSTR_OVERHEAD], &b2[BITSTR_OVERHEAD]);
 
-	if (bit < bit_cnt) {
+	if (bit_cnt & BITSTR_MAXPOS) {
 		uint64_t mask = _bit_nmask(bit_cnt);
-		b1[_bit_word(bit)] &= ~(b2[_bit_word(bit)] & mask);
+		b1[_bit_word(bit_cnt)] &= ~(b2[_bit_word(bit_cnt)] & mask);
 	}
 }
 
@@ -836,19 +1252,18 @@ bit_not(bitstr_t *b)
 void
 bit_or(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit, bit_cnt;
+	bitoff_t bit_cnt, words;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 
 	bit_cnt = MIN(_bitstr_bits(b1), _bitstr_bits(b2));
-	for (bit = 0; (bit + BITSTR_WORD_SIZE) <= bit_cnt;
-	     bit += BITSTR_WORD_SIZE)
-		b1[_bit_word(bit)] |= b2[_bit_word(bit)];
+	words = bit_cnt >> BITSTR_SHIFT;
+	_run_kernel(or_words, words, &b1[BITSTR_OVERHEAD], &b2[BITSTR_OVERHEAD]);
 
-	if (bit < bit_cnt) {
+	if (bit_cnt & BITSTR_MAXPOS) {
 		uint64_t mask = _bit_nmask(bit_cnt);
-		b1[_bit_word(bit)] |= (b2[_bit_word(bit)] & mask);
+		b1[_bit_word(bit_cnt)] |= (b2[_bit_word(bit_cnt)] & mask);
 	}
 }
 
@@ -908,23 +1323,6 @@ bit_copybits(bitstr_t *dest, bitstr_t *src)
 	memcpy(&dest[BITSTR_OVERHEAD], &src[BITSTR_OVERHEAD], len);
 }
 
-#ifdef HAVE___BUILTIN_POPCOUNTLL
-#define hweight __builtin_popcountll
-#else
-/*
- * Returns the hamming weight (i.e. the number of bits set) in a word.
- * NOTE: This routine borrowed from Linux 4.9 <tools/lib/hweight.c>.
- */
-static uint64_t
-hweight(uint64_t w)
-{
-        w -= (w >> 1) & 0x5555555555555555ul;
-        w =  (w & 0x3333333333333333ul) + ((w >> 2) & 0x3333333333333333ul);
-        w =  (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0ful;
-        return (w * 0x0101010101010101ul) >> 56;
-}
-#endif
-
 /*
  * Count the number of bits set in bitstring.
  *   b (IN)		bitstring to check
@@ -933,19 +1331,17 @@ hweight(uint64_t w)
 int32_t
 bit_set_count(bitstr_t *b)
 {
-	int32_t count = 0;
-	bitoff_t bit, bit_cnt;
+	int32_t count;
+	bitoff_t bit_cnt, words;
 
 	_assert_bitstr_valid(b);
 
 	bit_cnt = _bitstr_bits(b);
-	for (bit = 0; (bit + BITSTR_WORD_SIZE) <= bit_cnt;
-	     bit += BITSTR_WORD_SIZE) {
-		count += hweight(b[_bit_word(bit)]);
-	}
-	if (bit < bit_cnt) {
+	words = bit_cnt >> BITSTR_SHIFT;
+	count = _run_kernel(count_words, words, &b[BITSTR_OVERHEAD]);
+	if (bit_cnt & BITSTR_MAXPOS) {
 		uint64_t mask = _bit_nmask(bit_cnt);
-		count += hweight(b[_bit_word(bit)] & mask);
+		count += hweight(b[_bit_word(bit_cnt)] & mask);
 	}
 	return count;
 }
@@ -996,26 +1392,24 @@ static int32_t _bit_overlap_internal(bitstr_t *b1, bitstr_t *b2, bool count_it)
 {
 	int32_t count = 0;
 	int64_t anded;
-	bitoff_t bit, bit_cnt;
+	bitoff_t bit_cnt, words;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	xassert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
 	bit_cnt = _bitstr_bits(b1);
-	for (bit = 0; bit < bit_cnt; bit += BITSTR_WORD_SIZE) {
-		if ((bit + BITSTR_WORD_SIZE - 1) >= bit_cnt)
-			break;
-		anded = b1[_bit_word(bit)] & b2[_bit_word(bit)];
-		if (count_it)
-			count += hweight(anded);
-		else if (anded)
-			return 1;
-	}
-
-	if (bit < bit_cnt) {
+	words = bit_cnt >> BITSTR_SHIFT;
+	if (count_it)
+		count = _run_kernel(overlap_words, words, &b1[BITSTR_OVERHEAD],
+				    &b2[BITSTR_OVERHEAD]);
+	else if (_run_kernel(overlap_any_words, words, &b1[BITSTR_OVERHEAD],
+			     &b2[BITSTR_OVERHEAD]))
+		return 1;
+
+	if (bit_cnt & BITSTR_MAXPOS) {
 		uint64_t mask = _bit_nmask(bit_cnt);
-		anded = b1[_bit_word(bit)] & b2[_bit_word(bit)] & mask;
+		anded = b1[_bit_word(bit_cnt)] & b2[_bit_word(bit_cnt)] & mask;
 		if (count_it)
 			count += hweight(anded);
 		else if (anded)
@@ -50,6 +50,8 @@
 #define DATA_MAGIC 0x1992189F
 #define DATA_LIST_MAGIC 0x1992F89F
 #define DATA_LIST_NODE_MAGIC 0x1921F89F
+/* Build key index once a dictionary grows past this many entries */
+#define DATA_DICT_INDEX_MIN_COUNT 16
 
 typedef struct data_list_s data_list_t;
 typedef struct data_list_node_s data_list_node_t;
@@ -89,19 +91,30 @@ static const struct {
 
 typedef struct data_list_node_s {
 	int magic;
+	uint32_t hash; /* hash of key for dictionary (only) */
 	data_list_node_t *next;
+	data_list_node_t *prev;
+	data_list_node_t *hash_next; /* next node in same index bucket */
 
 	data_t *data;
 	char *key; /* key for dictionary (only) */
 } data_list_node_t;
 
-/* Single linked list for list_u and dict_u */
+/*
+ * Double linked list for list_u and dict_u
+ *
+ * Dictionaries keep insertion order in the list and lazily build a chained
+ * hash index of the keys once they grow past DATA_DICT_INDEX_MIN_COUNT.
+ */
 typedef struct data_list_s {
 	int magic;
 	size_t count;
 
 	data_list_node_t *begin;
 	data_list_node_t *end;
+
+	data_list_node_t **index; /* key index buckets or NULL */
+	size_t index_size; /* number of buckets (power of 2) */
 } data_list_t;
 
 /*
@@ -184,6 +197,7 @@ static void _check_data_list_magic(const data_list_t *dl)
 		while (i) {
 			c++;
 			_check_data_list_node_magic(i);
+			xassert(i->prev == end);
 			end = i;
 			i = i->next;
 		}
@@ -192,6 +206,7 @@ static void _check_data_list_magic(const data_list_t *dl)
 	}
 
 	xassert(end == dl->end);
+	xassert(!dl->index == !dl->index_size);
 #endif /* !NDEBUG */
 }
 
@@ -212,47 +227,140 @@ static void _check_data_list_node_parent(const data_list_t *dl,
 #endif /* !NDEBUG */
 }
 
+/* FNV-1a hash of dictionary key */
+static uint32_t _hash_key(const char *key)
+{
+	uint32_t hash = 2166136261U;
+
+	for (const unsigned char *p = (const unsigned char *) key; *p; p++) {
+		hash ^= *p;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static void _index_insert(data_list_t *dl, data_list_node_t *dn)
+{
+	data_list_node_t **bucket = &dl->index[dn->hash & (dl->index_size - 1)];
+
+	dn->hash_next = *bucket;
+	*bucket = dn;
+}
+
+/* (Re)build dictionary key index with at least 2 buckets per entry */
+static void _index_rebuild(data_list_t *dl)
+{
+	size_t size = DATA_DICT_INDEX_MIN_COUNT * 2;
+
+	while (size < (dl->count * 2))
+		size *= 2;
+
+	log_flag(DATA, "%s: index data-list(0x%"PRIxPTR")[%zu] with %zu buckets",
+		 __func__, (uintptr_t) dl, dl->count, size);
+
+	xfree(dl->index);
+	dl->index = xcalloc(size, sizeof(*dl->index));
+	dl->index_size = size;
+
+	for (data_list_node_t *i = dl->begin; i; i = i->next) {
+		xassert(i->key);
+		_index_insert(dl, i);
+	}
+}
+
+/* Add new dictionary node to index (building index as needed) */
+static void _index_add(data_list_t *dl, data_list_node_t *dn)
+{
+	if (!dn->key)
+		return;
+
+	if (dl->index && (dl->count <= dl->index_size))
+		_index_insert(dl, dn);
+	else if (dl->count > DATA_DICT_INDEX_MIN_COUNT)
+		_index_rebuild(dl);
+}
+
+static void _index_remove(data_list_t *dl, data_list_node_t *dn)
+{
+	data_list_node_t **i;
+
+	if (!dl->index || !dn->key)
+		return;
+
+	for (i = &dl->index[dn->hash & (dl->index_size - 1)]; *i;
+	     i = &(*i)->hash_next) {
+		if (*i == dn) {
+			*i = dn->hash_next;
+			dn->hash_next = NULL;
+			return;
+		}
+	}
+
+	fatal_abort("%s: node missing from index", __func__);
+}
+
+/* Find dictionary node by key via index or walking the list */
+static data_list_node_t *_dict_find_node(const data_list_t *dl,
+					 const char *key)
+{
+	data_list_node_t *i;
+
+	_check_data_list_magic(dl);
+
+	if (dl->index) {
+		uint32_t hash = _hash_key(key);
+
+		for (i = dl->index[hash & (dl->index_size - 1)]; i;
+		     i = i->hash_next) {
+			_check_data_list_node_magic(i);
+
+			if ((i->hash == hash) && !xstrcmp(key, i->key))
+				return i;
+		}
+
+		return NULL;
+	}
+
+	for (i = dl->begin; i; i = i->next) {
+		_check_data_list_node_magic(i);
+
+		if (!xstrcmp(key, i->key))
+			return i;
+	}
+
+	return NULL;
+}
+
 static void _release_data_list_node(data_list_t *dl, data_list_node_t *dn)
 {
 	_check_data_list_magic(dl);
 	_check_data_list_node_magic(dn);
 	_check_data_list_node_parent(dl, dn);
-	data_list_node_t *prev;
 
 	log_flag(DATA, "%s: free data-list(0x%"PRIxPTR")[%zu]",
 		 __func__, (uintptr_t) dl, dl->count);
 
-	/* walk list to find new previous */
-	for (prev = dl->begin; prev && prev->next != dn; ) {
-		_check_data_list_node_magic(prev);
-		prev = prev->next;
-		if (prev)
-			_check_data_list_node_magic(prev);
-	}
+	_index_remove(dl, dn);
 
-	if (dn == dl->begin) {
+	if (dn->prev) {
+		xassert(dl->begin != dn);
+		xassert(dn->prev->next == dn);
+		dn->prev->next = dn->next;
+	} else {
 		/* at the beginning */
-		xassert(!prev);
+		xassert(dl->begin == dn);
 		dl->begin = dn->next;
+	}
 
-		if (dl->end == dn) {
-			dl->end = NULL;
-			xassert(!dn->next);
-		}
-	} else if (dn == dl->end) {
-		/* at the end */
-		xassert(!dn->next);
-		xassert(prev);
-		dl->end = prev;
-		prev->next = NULL;
-	} else {
-		/* somewhere in middle */
-		xassert(prev);
-		xassert(prev != dn);
-		xassert(prev->next == dn);
-		xassert(dl->begin != dn);
+	if (dn->next) {
 		xassert(dl->end != dn);
-		prev->next = dn->next;
+		xassert(dn->next->prev == dn);
+		dn->next->prev = dn->prev;
+	} else {
+		/* at the end */
+		xassert(dl->end == dn);
+		dl->end = dn->prev;
 	}
 
 	dl->count--;
@@ -281,6 +389,10 @@ static void _release_data_list(data_list_t *dl)
 
 	xassert(dl->end);
 
+	/* every node is going away so skip unlinking them from index */
+	xfree(dl->index);
+	dl->index_size = 0;
+
 	while((i = n)) {
 		n = i->next;
 		_release_data_list_node(dl, i);
@@ -315,6 +427,7 @@ static data_list_node_t *_new_data_list_node(data_t *d, const char *key)
 	dn->data = d;
 	if (key) {
 		dn->key = xstrdup(key);
+		dn->hash = _hash_key(key);
 
 		log_flag(DATA, "%s: new dictionary entry data-list-node(0x%"PRIxPTR")[%s]=%pD",
 			 __func__, (uintptr_t) dn, dn->key, dn->data);
@@ -337,6 +450,7 @@ static void _data_list_append(data_list_t *dl, data_t *d, const char *key)
 		_check_data_list_node_magic(dl->end);
 		_check_data_list_node_magic(dl->begin);
 
+		n->prev = dl->end;
 		dl->end->next = n;
 		dl->end = n;
 	} else {
@@ -346,6 +460,7 @@ static void _data_list_append(data_list_t *dl, data_t *d, const char *key)
 	}
 
 	dl->count++;
+	_index_add(dl, n);
 
 	if (n->key)
 		log_flag(DATA, "%s: append dictionary entry data-list-node(0x%"PRIxPTR")[%s]=%pD",
@@ -364,6 +479,7 @@ static void _data_list_prepend(data_list_t *dl, data_t *d, const char *key)
 	if (dl->begin) {
 		_check_data_list_node_magic(dl->begin);
 		n->next = dl->begin;
+		dl->begin->prev = n;
 		dl->begin = n;
 	} else {
 		xassert(!dl->count);
@@ -372,6 +488,7 @@ static void _data_list_prepend(data_list_t *dl, data_t *d, const char *key)
 	}
 
 	dl->count++;
+	_index_add(dl, n);
 
 	log_flag(DATA, "%s: prepend %pD[%s]->data-list-node(0x%"PRIxPTR")[%s]=%pD",
 		 __func__, d, key, (uintptr_t) n, n->key, n->data);
@@ -761,32 +878,15 @@ extern const data_t *data_key_get_const(const data_t *data, const char *key)
 	if (!data->data.dict_u->count)
 		return NULL;
 
-	_check_data_list_magic(data->data.dict_u);
-	i = data->data.dict_u->begin;
-	while (i) {
-		_check_data_list_node_magic(i);
-
-		if (!xstrcmp(key, i->key))
-			break;
-
-		i = i->next;
-	}
-
-	if (i)
+	if ((i = _dict_find_node(data->data.dict_u, key)))
 		return i->data;
 	else
 		return NULL;
 }
 
-static bool _match_string(const char *key, data_t *data, void *needle_ptr)
-{
-	const char *needle = needle_ptr;
-	return !xstrcmp(key, needle);
-}
-
 extern data_t *data_key_get(data_t *data, const char *key)
 {
-	return data_dict_find_first(data, _match_string, (void *) key);
+	return (data_t *) data_key_get_const(data, key);
 }
 
 extern data_t *data_key_get_int(data_t *data, int64_t key)
@@ -921,18 +1021,7 @@ extern bool data_key_unset(data_t *data, const char *key)
 	if (!key || data->type != TYPE_DICT)
 		return NULL;
 
-	_check_data_list_magic(data->data.dict_u);
-	i = data->data.dict_u->begin;
-	while (i) {
-		_check_data_list_node_magic(i);
-
-		if (!xstrcmp(key, i->key))
-			break;
-
-		i = i->next;
-	}
-
-	if (!i) {
+	if (!(i = _dict_find_node(data->data.dict_u, key))) {
 		log_flag(DATA, "%s: remove non-existent key in %pD[%s]",
 			 __func__, data, key);
 		return false;
@@ -183,8 +183,39 @@ struct hostlist {
 	/* list of iterators */
 	struct hostlist_iterator *ilist;
 
+	/*
+	 * Lookup index for hostlist_find(). Built lazily once an unchanged
+	 * hostlist is searched more than once. See _hostlist_index().
+	 */
+	struct {
+		/* hostlist_find() calls since last change */
+		int finds;
+		/* ranges sorted by prefix and lo (nranges entries) */
+		struct hostlist_index_entry *entries;
+		/* ranges overlap or use legacy prefix matching */
+		bool linear;
+	} index;
+
+	/* cached output of hostlist_ranged_string_xmalloc_dims() */
+	struct {
+		char *str;
+		int dims;
+		int brackets;
+	} ranged;
+
+	/* incremented every time the hostlist is modified */
+	uint64_t changes;
 };
 
+typedef struct hostlist_index_entry {
+	hostrange_t *hr;
+	/* position of first host of range in hostlist */
+	int offset;
+} hostlist_index_entry_t;
+
+/* minimum number of ranges before building lookup index */
+#define HOSTLIST_INDEX_MIN 8
+
 
 /* a hostset is a wrapper around a hostlist */
 struct hostset {
@@ -280,7 +311,8 @@ static int hostname_suffix_width(hostname_t *);
 
 static hostrange_t *hostrange_new(void);
 static hostrange_t *hostrange_create_single(const char *);
-static hostrange_t *hostrange_create(char *, unsigned long, unsigned long, int);
+static hostrange_t *hostrange_create(const char *, unsigned long,
+				     unsigned long, int);
 static unsigned long hostrange_count(hostrange_t *);
 static hostrange_t *hostrange_copy(hostrange_t *);
 static void hostrange_destroy(hostrange_t *);
@@ -590,7 +622,7 @@ static hostrange_t *hostrange_create_single(const char *prefix)
 
 /* Create a hostrange object with a prefix, hi, lo, and format width
  */
-static hostrange_t *hostrange_create(char *prefix, unsigned long lo,
+static hostrange_t *hostrange_create(const char *prefix, unsigned long lo,
 				     unsigned long hi, int width)
 {
 	hostrange_t *new;
@@ -982,8 +1014,10 @@ static int hostrange_hn_within(hostrange_t *hr, hostname_t *hn, int dims)
 			/* Tack on ldiff of the hostname's suffix to
 			 * that of it's prefix */
 			xstrncat(hn->prefix, hn->suffix, ldiff);
-		} else if (ldiff < 0) {
-			/* strip off the ldiff here */
+		} else if ((ldiff < 0) &&
+			   ((int) strspn(hn->prefix + len2 + ldiff,
+					 "0123456789") == -ldiff)) {
+			/* strip off the ldiff (digits) here */
 			hn->prefix[len2+ldiff] = '\0';
 		} else
 			return 0;
@@ -1177,6 +1211,21 @@ static void hostlist_expand(hostlist_t *hl)
 	hostlist_resize(hl, hl->size + HOSTLIST_CHUNK);
 }
 
+/* Drop lookup index and cached strings after hostlist hl is modified
+ * Assumes that hostlist hl is locked by caller
+ */
+static void _hostlist_changed(hostlist_t *hl)
+{
+	hl->changes++;
+	hl->index.finds = 0;
+	hl->index.linear = false;
+
+	if (hl->index.entries)
+		xfree(hl->index.entries);
+	if (hl->ranged.str)
+		xfree(hl->ranged.str);
+}
+
 /* Push a hostrange object onto hostlist hl
  * Returns the number of hosts successfully pushed onto hl
  */
@@ -1204,6 +1253,7 @@ static int hostlist_push_range(hostlist_t *hl, hostrange_t *hr)
 	}
 
 	retval = hl->nhosts += hostrange_count(hr);
+	_hostlist_changed(hl);
 
 	UNLOCK_HOSTLIST(hl);
 
@@ -1276,6 +1326,7 @@ static int hostlist_insert_range(hostlist_t *hl, hostrange_t *hr, int n)
 		tmp = last;
 	}
 	hl->nranges++;
+	_hostlist_changed(hl);
 
 	/* adjust hostlist iterators if needed */
 	for (hli = hl->ilist; hli; hli = hli->next) {
@@ -1304,6 +1355,7 @@ static void hostlist_delete_range(hostlist_t *hl, int n)
 	hl->nranges--;
 	hl->hr[hl->nranges] = NULL;
 	hostlist_shift_iterators(hl, n, 0, 1);
+	_hostlist_changed(hl);
 
 	/* XXX caller responsible for adjusting nhosts */
 	/* hl->nhosts -= hostrange_count(old) */
@@ -1852,6 +1904,8 @@ void hostlist_destroy(hostlist_t *hl)
 	for (i = 0; i < hl->nranges; i++)
 		hostrange_destroy(hl->hr[i]);
 	xfree(hl->hr);
+	xfree(hl->index.entries);
+	xfree(hl->ranged.str);
 	UNLOCK_HOSTLIST(hl);
 	slurm_mutex_destroy(&hl->mutex);
 	xfree(hl);
@@ -1905,6 +1959,21 @@ int hostlist_push_host(hostlist_t *hl, const char *str)
 	return hostlist_push_host_dims(hl, str, dims);
 }
 
+int hostlist_push_host_range(hostlist_t *hl, const char *prefix,
+			     unsigned long lo, unsigned long hi, int width)
+{
+	hostrange_t *hr;
+
+	if (!hl || !prefix || (hi < lo))
+		return 0;
+
+	hr = hostrange_create(prefix, lo, hi, width);
+	hostlist_push_range(hl, hr);
+	hostrange_destroy(hr);
+
+	return (hi - lo + 1);
+}
+
 int hostlist_push_list(hostlist_t *h1, hostlist_t *h2)
 {
 	int i, n = 0;
@@ -1939,6 +2008,7 @@ char *hostlist_pop(hostlist_t *hl)
 			hostrange_destroy(hl->hr[--hl->nranges]);
 			hl->hr[hl->nranges] = NULL;
 		}
+		_hostlist_changed(hl);
 	}
 	UNLOCK_HOSTLIST(hl);
 	return host;
@@ -1987,6 +2057,7 @@ char *hostlist_shift_dims(hostlist_t *hl, int dims)
 
 		host = hostrange_shift(hr, dims);
 		hl->nhosts--;
+		_hostlist_changed(hl);
 
 		if (hostrange_empty(hr)) {
 			hostlist_delete_range(hl, 0);
@@ -2134,8 +2205,9 @@ int hostlist_delete_nth(hostlist_t *hl, int n)
 	}
 
 done:
-	UNLOCK_HOSTLIST(hl);
 	hl->nhosts--;
+	_hostlist_changed(hl);
+	UNLOCK_HOSTLIST(hl);
 	return 1;
 }
 
@@ -2151,34 +2223,161 @@ int hostlist_count(hostlist_t *hl)
 	return retval;
 }
 
-int hostlist_find_dims(hostlist_t *hl, const char *hostname, int dims)
+/*
+ * Compare hostrange hr against lookup key (prefix, singlehost, num).
+ * Ranges sort by prefix, then single hosts before numbered ranges, then lo.
+ */
+static int _index_key_cmp(hostrange_t *hr, const char *prefix, bool single,
+			  unsigned long num)
 {
-	int i, count, ret = -1;
-	hostname_t *hn;
+	int rc;
 
-	if (!hostname || !hl)
-		return -1;
+	if ((rc = strcmp(hr->prefix, prefix)))
+		return rc;
+	if (hr->singlehost != single)
+		return hr->singlehost ? -1 : 1;
+	if (single || (hr->lo == num))
+		return 0;
+	return (hr->lo < num) ? -1 : 1;
+}
 
-	if (!dims)
-		dims = slurmdb_setup_cluster_dims();
+static int _index_cmp(const void *x, const void *y)
+{
+	const hostlist_index_entry_t *e1 = x;
+	const hostlist_index_entry_t *e2 = y;
 
-	hn = hostname_create_dims(hostname, dims);
+	return _index_key_cmp(e1->hr, e2->hr->prefix, e2->hr->singlehost,
+			      e2->hr->lo);
+}
 
-	LOCK_HOSTLIST(hl);
+/* Returns true if prefix ends with a digit */
+static bool _prefix_has_digit(const char *prefix)
+{
+	size_t len = strlen(prefix);
+
+	return (len && isdigit((unsigned char) prefix[len - 1]));
+}
+
+/*
+ * Build lookup index of hostlist hl to allow binary searching for hosts
+ * instead of walking every range.
+ *
+ * The index is only built once an unchanged hostlist has been searched more
+ * than once to avoid the cost for callers that modify after every lookup. It
+ * is not used if ranges overlap or if a prefix ends with a digit, as
+ * hostrange_hn_within() may then match ranges with a different prefix.
+ *
+ * Assumes that hostlist hl is locked by caller
+ * RET true if index is usable
+ */
+static bool _hostlist_index(hostlist_t *hl)
+{
+	hostlist_index_entry_t *entries;
+	int offset = 0;
+
+	if (hl->index.entries)
+		return true;
+	if (hl->index.linear || (hl->nranges < HOSTLIST_INDEX_MIN) ||
+	    (++hl->index.finds < 2))
+		return false;
+
+	entries = xcalloc(hl->nranges, sizeof(*entries));
+
+	for (int i = 0; i < hl->nranges; i++) {
+		if (_prefix_has_digit(hl->hr[i]->prefix))
+			goto linear;
+
+		entries[i].hr = hl->hr[i];
+		entries[i].offset = offset;
+		offset += hostrange_count(hl->hr[i]);
+	}
+
+	qsort(entries, hl->nranges, sizeof(*entries), _index_cmp);
+
+	for (int i = 1; i < hl->nranges; i++) {
+		hostrange_t *prev = entries[i - 1].hr;
+		hostrange_t *hr = entries[i].hr;
+
+		if (!strcmp(prev->prefix, hr->prefix) &&
+		    (prev->singlehost == hr->singlehost) &&
+		    (hr->singlehost || (prev->hi >= hr->lo)))
+			goto linear;
+	}
+
+	hl->index.entries = entries;
+	return true;
+
+linear:
+	hl->index.linear = true;
+	xfree(entries);
+	return false;
+}
+
+/*
+ * Find position of hostname hn in hostlist hl
+ * Assumes that hostlist hl is locked by caller
+ * RET position or -1 if not found
+ */
+static int _hostlist_find_hn(hostlist_t *hl, hostname_t *hn, int dims)
+{
+	int i, count;
+
+	if (_hostlist_index(hl)) {
+		hostlist_index_entry_t *entry = NULL;
+		bool single = !hostname_suffix_is_valid(hn);
+		const char *prefix = single ? hn->hostname : hn->prefix;
+		int lo = 0, hi = hl->nranges - 1;
+
+		/* find last range starting at or before hn */
+		while (lo <= hi) {
+			int mid = (lo + hi) / 2;
+
+			if (_index_key_cmp(hl->index.entries[mid].hr, prefix,
+					   single, hn->num) <= 0) {
+				entry = &hl->index.entries[mid];
+				lo = mid + 1;
+			} else {
+				hi = mid - 1;
+			}
+		}
+
+		if (!entry || !hostrange_hn_within(entry->hr, hn, dims))
+			return -1;
+		if (single)
+			return entry->offset;
+		return entry->offset + hn->num - entry->hr->lo;
+	}
 
 	for (i = 0, count = 0; i < hl->nranges; i++) {
 		if (hostrange_hn_within(hl->hr[i], hn, dims)) {
 			if (hostname_suffix_is_valid(hn))
-				ret = count + hn->num - hl->hr[i]->lo;
+				return count + hn->num - hl->hr[i]->lo;
 			else
-				ret = count;
-			goto done;
+				return count;
 		} else
 			count += hostrange_count(hl->hr[i]);
 	}
 
-done:
+	return -1;
+}
+
+int hostlist_find_dims(hostlist_t *hl, const char *hostname, int dims)
+{
+	int ret;
+	hostname_t *hn;
+
+	if (!hostname || !hl)
+		return -1;
+
+	if (!dims)
+		dims = slurmdb_setup_cluster_dims();
+
+	hn = hostname_create_dims(hostname, dims);
+
+	LOCK_HOSTLIST(hl);
+	ret = _hostlist_find_hn(hl, hn, dims);
 	UNLOCK_HOSTLIST(hl);
+
 	hostname_destroy(hn);
 	return ret;
 }
@@ -2211,6 +2410,7 @@ void hostlist_sort(hostlist_t *hl)
 	}
 
 	qsort(hl->hr, hl->nranges, sizeof(hostrange_t *), &_cmp);
+	_hostlist_changed(hl);
 
 	/* reset all iterators */
 	for (i = hl->ilist; i; i = i->next)
@@ -2264,6 +2464,8 @@ static void hostlist_coalesce(hostlist_t *hl)
 			hostrange_t *hnext = hl->hr[i];
 			j = i;
 
+			_hostlist_changed(hl);
+
 			if (new->hi < hprev->hi)
 				hnext->hi = hprev->hi;
 
@@ -2327,6 +2529,7 @@ void hostlist_uniq(hostlist_t *hl)
 		return;
 	}
 	qsort(hl->hr, hl->nranges, sizeof(hostrange_t *), &_cmp);
+	_hostlist_changed(hl);
 
 	while (i < hl->nranges) {
 		if (_attempt_range_join(hl, i) < 0) /* No range join occurred */
@@ -2850,12 +3053,36 @@ char *hostlist_ranged_string_xmalloc_dims(hostlist_t *hl, int dims,
 					  int brackets)
 {
 	int buf_size = 8192;
-	char *buf = xmalloc_nz(buf_size);
+	char *buf;
+	uint64_t changes;
+
+	/* reuse string of unchanged hostlist */
+	LOCK_HOSTLIST(hl);
+	if (hl->ranged.str && (hl->ranged.dims == dims) &&
+	    (hl->ranged.brackets == brackets)) {
+		buf = xstrdup(hl->ranged.str);
+		UNLOCK_HOSTLIST(hl);
+		return buf;
+	}
+	changes = hl->changes;
+	UNLOCK_HOSTLIST(hl);
+
+	buf = xmalloc_nz(buf_size);
 	while (hostlist_ranged_string_dims(
 		       hl, buf_size, buf, dims, brackets) < 0) {
 		buf_size *= 2;
 		xrealloc_nz(buf, buf_size);
 	}
+
+	LOCK_HOSTLIST(hl);
+	if (hl->changes == changes) {
+		xfree(hl->ranged.str);
+		hl->ranged.str = xstrdup(buf);
+		hl->ranged.dims = dims;
+		hl->ranged.brackets = brackets;
+	}
+	UNLOCK_HOSTLIST(hl);
+
 	return buf;
 }
 
@@ -3160,6 +3387,7 @@ int hostlist_remove(hostlist_iterator_t *i)
 		i->depth--;
 
 	i->hl->nhosts--;
+	_hostlist_changed(i->hl);
 	UNLOCK_HOSTLIST(i->hl);
 
 	return 1;
@@ -3195,7 +3423,7 @@ void hostset_destroy(hostset_t *set)
 static int hostset_insert_range(hostset_t *set, hostrange_t *hr)
 {
 	int i = 0;
-	int inserted = 0;
+	int lo, hi;
 	int nhosts = 0;
 	int ndups = 0;
 	hostlist_t *hl;
@@ -3207,35 +3435,42 @@ static int hostset_insert_range(hostset_t *set, hostrange_t *hr)
 
 	nhosts = hostrange_count(hr);
 
-	for (i = 0; i < hl->nranges; i++) {
-		if (hostrange_cmp(hr, hl->hr[i]) <= 0) {
+	/* binary search for first range sorting at or after hr */
+	lo = 0;
+	hi = hl->nranges;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
 
-			if ((ndups = hostrange_join(hr, hl->hr[i])) >= 0)
-				hostlist_delete_range(hl, i);
-			else if (ndups < 0)
-				ndups = 0;
+		if (hostrange_cmp(hr, hl->hr[mid]) <= 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	i = lo;
 
-			hostlist_insert_range(hl, hr, i);
+	if (i < hl->nranges) {
+		if ((ndups = hostrange_join(hr, hl->hr[i])) >= 0)
+			hostlist_delete_range(hl, i);
+		else if (ndups < 0)
+			ndups = 0;
 
-			/* now attempt to join hr[i] and hr[i-1] */
-			if (i > 0) {
-				int m;
-				if ((m = _attempt_range_join(hl, i)) > 0)
-					ndups += m;
-			}
-			hl->nhosts += nhosts - ndups;
-			inserted = 1;
-			break;
-		}
-	}
+		hostlist_insert_range(hl, hr, i);
 
-	if (inserted == 0) {
+		/* now attempt to join hr[i] and hr[i-1] */
+		if (i > 0) {
+			int m;
+			if ((m = _attempt_range_join(hl, i)) > 0)
+				ndups += m;
+		}
+		hl->nhosts += nhosts - ndups;
+	} else {
 		hl->hr[hl->nranges++] = hostrange_copy(hr);
 		hl->nhosts += nhosts;
 		if (hl->nranges > 1) {
 			if ((ndups = _attempt_range_join(hl, hl->nranges - 1)) <= 0)
 				ndups = 0;
 		}
+		_hostlist_changed(hl);
 	}
 
 	/*
@@ -3261,27 +3496,21 @@ int hostset_insert(hostset_t *set, const char *hosts)
 }
 
 
-/* linear search through N ranges for hostname "host"
+/* search for hostname "host" in hostset set
  * */
 static int hostset_find_host(hostset_t *set, const char *host)
 {
-	int i;
 	int retval = 0;
 	hostname_t *hn;
 	LOCK_HOSTLIST(set->hl);
 	hn = hostname_create(host);
-	for (i = 0; i < set->hl->nranges; i++) {
-		/*
-		 * FIXME: THIS WILL NOT ALWAYS WORK CORRECTLY IF CALLED FROM A
-		 * LOCATION THAT COULD HAVE DIFFERENT DIMENSIONS
-		 * (i.e. slurmdbd).
-		 */
-		if (hostrange_hn_within(set->hl->hr[i], hn, 0)) {
-			retval = 1;
-			goto done;
-		}
-	}
-done:
+	/*
+	 * FIXME: THIS WILL NOT ALWAYS WORK CORRECTLY IF CALLED FROM A
+	 * LOCATION THAT COULD HAVE DIFFERENT DIMENSIONS
+	 * (i.e. slurmdbd).
+	 */
+	if (_hostlist_find_hn(set->hl, hn, 0) >= 0)
+		retval = 1;
 	UNLOCK_HOSTLIST(set->hl);
 	hostname_destroy(hn);
 	return retval;
@@ -180,6 +180,19 @@ int hostlist_push_host_dims(hostlist_t *hl, const char *str, int dims);
 int hostlist_push_host(hostlist_t *hl, const char *host);
 
 
+/* hostlist_push_host_range():
+ *
+ * Push hosts prefix<lo> through prefix<hi> onto the hostlist hl, with the
+ * numeric suffix zero padded to width. This is equivalent to calling
+ * hostlist_push_host() for each host of a single dimension cluster, without
+ * parsing every hostname.
+ *
+ * Returns the number of hosts pushed, or 0 on failure.
+ */
+int hostlist_push_host_range(hostlist_t *hl, const char *prefix,
+			     unsigned long lo, unsigned long hi, int width);
+
+
 /* hostlist_push_list():
  *
  * Push a hostlist (hl2) onto another list (hl1)
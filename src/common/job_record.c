@@ -263,6 +263,7 @@ extern void job_record_delete(void *job_entry)
 	xfree(job_ptr->nodes_completing);
 	xfree(job_ptr->nodes_pr);
 	xfree(job_ptr->origin_cluster);
+	job_record_free_pack_cache(job_ptr);
 	if (job_ptr->het_details && job_ptr->het_job_id) {
 		/* xfree struct if hetjob leader and NULL ptr otherwise. */
 		if (job_ptr->het_job_offset == 0)
@@ -337,6 +338,16 @@ extern void job_record_free_fed_details(job_fed_details_t **fed_details_pptr)
 	}
 }
 
+extern void job_record_free_pack_cache(job_record_t *job_ptr)
+{
+	if (!job_ptr->pack_cache)
+		return;
+
+	for (int i = 0; i < JOB_PACK_CACHE_SLOTS; i++)
+		FREE_NULL_BUFFER(job_ptr->pack_cache[i].buffer);
+	xfree(job_ptr->pack_cache);
+}
+
 /* Pack the data for a specific job step record */
 extern int pack_ctld_job_step_info(void *x, void *arg)
 {
@@ -228,6 +228,16 @@ typedef struct {
 	uint32_t priority;		/* whole hetjob calculated priority */
 } het_job_details_t;
 
+#define JOB_PACK_CACHE_SLOTS 4	/* cached pack_job() results per job */
+
+typedef struct {
+	buf_t *buffer;			/* pack_job() output */
+	time_t expire;			/* time output becomes stale */
+	time_t pack_time;		/* time output was packed */
+	uint16_t protocol_version;	/* protocol_version packed for */
+	uint16_t show_flags;		/* show_flags packed with */
+} job_pack_cache_t;
+
 typedef struct {
 	time_t last_update;
 	uint32_t *priority_array;
@@ -335,6 +345,8 @@ struct job_record {
 	uint32_t job_state;		/* state of the job */
 	uint16_t kill_on_node_fail;	/* 1 if job should be killed on
 					 * node failure */
+	time_t last_update;		/* time of last change to the job
+					 * record, see SHOW_DELTA */
 	time_t last_sched_eval;		/* last time job was evaluated for scheduling */
 	char *licenses;			/* licenses required by the job */
 	list_t *license_list;		/* structure with license info */
@@ -376,6 +388,9 @@ struct job_record {
 	char *origin_cluster;		/* cluster name that the job was
 					 * submitted from */
 	uint16_t other_port;		/* port for client communications */
+	job_pack_cache_t *pack_cache;	/* JOB_PACK_CACHE_SLOTS entries of
+					 * cached RESPONSE_JOB_INFO records
+					 * (Internal use only, don't save) */
 	char *partition;		/* name of job partition(s) */
 	list_t *part_ptr_list;		/* list of pointers to partition recs */
 	bool part_nodes_missing;	/* set if job's nodes removed from this
@@ -434,6 +449,13 @@ struct job_record {
 	time_t start_time;		/* time execution begins,
 					 * actual or expected */
 	char *state_desc;		/* optional details for state_reason */
+	slurm_hash_t state_hash;	/* hash of the record last written to
+					 * the job state journal
+					 * (Internal use only, don't save) */
+	uint64_t state_db_index;	/* db_index when state_hash was set
+					 * (Internal use only, don't save) */
+	time_t state_update;		/* last_update when state_hash was set
+					 * (Internal use only, don't save) */
 	uint32_t state_reason;		/* reason job still pending or failed
 					 * see slurm.h:enum job_state_reason */
 	uint32_t state_reason_prev_db;	/* Previous state_reason that isn't
@@ -664,6 +686,11 @@ extern void job_record_free_null_array_recs(job_record_t *array_recs);
  */
 extern void job_record_free_fed_details(job_fed_details_t **fed_details_pptr);
 
+/*
+ * Free a job's cached pack_job() output and set job_ptr->pack_cache to NULL.
+ */
+extern void job_record_free_pack_cache(job_record_t *job_ptr);
+
 extern int pack_ctld_job_step_info(void *x, void *arg);
 
 /*
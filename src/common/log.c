@@ -149,6 +149,47 @@ static bool syslog_open = false;
 static volatile log_level_t highest_log_level = LOG_LEVEL_END;
 static volatile log_level_t highest_sched_log_level = LOG_LEVEL_QUIET;
 
+/*
+ * Asynchronous logfile writer. Messages are queued into async_buf while
+ * holding log_lock and written out in batches by a single writer thread
+ * which only holds log_lock while copying data out of the queue. The writer
+ * is only woken when the queue goes from empty to not empty, when a full
+ * batch is queued or when someone waits for the queue to drain. Otherwise it
+ * collects messages for up to LOG_ASYNC_DELAY_MSEC before writing them.
+ */
+#define LOG_ASYNC_BUF_SIZE	(4 * 1024 * 1024)
+#define LOG_ASYNC_WRITE_SIZE	(64 * 1024)
+#define LOG_ASYNC_DELAY_MSEC	100
+static pthread_t async_tid = 0;
+static pthread_cond_t async_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t async_space_cond = PTHREAD_COND_INITIALIZER;
+static cbuf_t *async_buf = NULL;
+static bool async_shutdown = false;
+static bool async_waiting = false;
+static bool async_writing = false;
+static int async_flush_cnt = 0;
+static uint64_t async_dropped = 0;
+
+/*
+ * Messages which only go to the logfile are formatted into a thread local
+ * line buffer before taking log_lock, which is then only held to queue the
+ * line. Formatting needs a copy of the log settings in async_tls. async_gen
+ * changes (with log_lock held) whenever those settings change and is 0 while
+ * this path can't be used. A thread with an out of date copy takes the
+ * regular path, which refreshes its copy.
+ */
+#define LOG_ASYNC_LINE_SIZE	4096
+#define LOG_ASYNC_PREFIX_SIZE	64
+static volatile uint32_t async_gen = 0;
+static __thread struct {
+	uint32_t gen;
+	log_level_t direct_level;	/* max level also sent elsewhere */
+	log_level_t logfile_level;
+	bool prefix_level;
+	char prefix[LOG_ASYNC_PREFIX_SIZE];
+} async_tls;
+static __thread char async_line[LOG_ASYNC_LINE_SIZE];
+
 #define LOG_INITIALIZED ((log != NULL) && (log->initialized))
 #define SCHED_LOG_INITIALIZED ((sched_log != NULL) && (sched_log->initialized))
 /* define a default argv0 */
@@ -162,12 +203,31 @@ extern char * program_invocation_name;
 #endif
 
 
+static void _log_async_drain(void);
+
 /*
  * pthread_atfork handlers:
+ *
+ * Queued async log data is drained before the fork so neither the parent
+ * nor the child (which does not inherit the writer thread) loses or
+ * duplicates it.
  */
-static void _atfork_prep()   { slurm_mutex_lock(&log_lock);   }
+static void _atfork_prep()
+{
+	slurm_mutex_lock(&log_lock);
+	_log_async_drain();
+}
 static void _atfork_parent() { slurm_mutex_unlock(&log_lock); }
-static void _atfork_child()  { slurm_mutex_unlock(&log_lock); }
+static void _atfork_child()
+{
+	async_tid = 0;
+	async_waiting = false;
+	async_writing = false;
+	async_flush_cnt = 0;
+	pthread_cond_init(&async_cond, NULL);
+	pthread_cond_init(&async_space_cond, NULL);
+	slurm_mutex_unlock(&log_lock);
+}
 static bool at_forked = false;
 #define atfork_install_handlers()					\
 	while (!at_forked) {						\
@@ -176,6 +236,7 @@ static bool at_forked = false;
 	}
 
 static void _log_flush(log_t *log);
+static void xlogfmtcat(char **dst, const char *fmt, ...);
 
 static log_level_t _highest_level(log_level_t a, log_level_t b, log_level_t c)
 {
@@ -287,6 +348,246 @@ static int _fd_writeable(int fd)
 	return 1;
 }
 
+/*
+ * NOTE: The async functions below use pthread_cond_*() directly since the
+ * slurm_cond_*() wrappers log on failure which would recurse into log_lock.
+ */
+
+static void _log_async_write(int fd, char *buf, int len)
+{
+	while (len > 0) {
+		ssize_t wrote = write(fd, buf, len);
+
+		if (wrote < 0) {
+			if ((errno == EINTR) || (errno == EAGAIN))
+				continue;
+			return;
+		}
+		buf += wrote;
+		len -= wrote;
+	}
+}
+
+static void *_log_async_writer(void *arg)
+{
+	char *wbuf = xmalloc(LOG_ASYNC_WRITE_SIZE);
+
+#if HAVE_SYS_PRCTL_H
+	(void) prctl(PR_SET_NAME, "log_writer", NULL, NULL, NULL);
+#endif
+
+	slurm_mutex_lock(&log_lock);
+	while (true) {
+		int len, fd = -1;
+
+		if (!cbuf_used(async_buf)) {
+			if (async_shutdown)
+				break;
+			async_waiting = true;
+			pthread_cond_wait(&async_cond, &log_lock);
+			async_waiting = false;
+
+			/* Give other messages a chance to join this batch */
+			if (!async_shutdown && !async_flush_cnt &&
+			    (cbuf_used(async_buf) < LOG_ASYNC_WRITE_SIZE)) {
+				struct timespec ts;
+
+				clock_gettime(CLOCK_REALTIME, &ts);
+				ts.tv_nsec += LOG_ASYNC_DELAY_MSEC * NSEC_IN_MSEC;
+				if (ts.tv_nsec >= NSEC_IN_SEC) {
+					ts.tv_sec++;
+					ts.tv_nsec -= NSEC_IN_SEC;
+				}
+				async_waiting = true;
+				pthread_cond_timedwait(&async_cond, &log_lock,
+						       &ts);
+				async_waiting = false;
+			}
+			continue;
+		}
+
+		len = cbuf_read(async_buf, wbuf, LOG_ASYNC_WRITE_SIZE);
+		if (log && log->logfp)
+			fd = fileno(log->logfp);
+		async_writing = true;
+		slurm_mutex_unlock(&log_lock);
+
+		if ((len > 0) && (fd >= 0))
+			_log_async_write(fd, wbuf, len);
+
+		slurm_mutex_lock(&log_lock);
+		async_writing = false;
+		pthread_cond_broadcast(&async_space_cond);
+	}
+	slurm_mutex_unlock(&log_lock);
+
+	xfree(wbuf);
+	return NULL;
+}
+
+/* Write out queued messages on exit() paths which skip log_fini() */
+static void _log_async_atexit(void)
+{
+	slurm_mutex_lock(&log_lock);
+	_log_async_drain();
+	slurm_mutex_unlock(&log_lock);
+}
+
+/* Start writer thread if needed. Call with log_lock held. */
+static bool _log_async_start(void)
+{
+	static bool atexit_set = false;
+
+	if (async_tid)
+		return true;
+
+	if (!async_buf) {
+		async_buf = cbuf_create(LOG_ASYNC_BUF_SIZE, LOG_ASYNC_BUF_SIZE);
+		cbuf_opt_set(async_buf, CBUF_OPT_OVERWRITE, CBUF_NO_DROP);
+	}
+	if (!atexit_set) {
+		(void) atexit(_log_async_atexit);
+		atexit_set = true;
+	}
+
+	async_shutdown = false;
+	if (pthread_create(&async_tid, NULL, _log_async_writer, NULL)) {
+		async_tid = 0;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Wait until the writer thread has written out everything queued so far.
+ * Call with log_lock held.
+ */
+static void _log_async_drain(void)
+{
+	if (!async_tid)
+		return;
+
+	async_flush_cnt++;
+	while (cbuf_used(async_buf) || async_writing) {
+		pthread_cond_signal(&async_cond);
+		pthread_cond_wait(&async_space_cond, &log_lock);
+	}
+	async_flush_cnt--;
+}
+
+/* Drain and stop the writer thread. Call with log_lock held. */
+static void _log_async_stop(void)
+{
+	pthread_t tid = async_tid;
+
+	if (!tid)
+		return;
+
+	_log_async_drain();
+	async_shutdown = true;
+	pthread_cond_signal(&async_cond);
+	slurm_mutex_unlock(&log_lock);
+	pthread_join(tid, NULL);
+	slurm_mutex_lock(&log_lock);
+	async_tid = 0;
+	async_shutdown = false;
+}
+
+/*
+ * Queue a complete logfile line for the writer thread. Call with log_lock
+ * held.
+ * RET false if the line could not be queued and must be written directly
+ */
+static bool _log_async_queue(log_t *log, const char *line)
+{
+	char *notice = NULL;
+	int len = strlen(line), notice_len = 0;
+	bool was_empty;
+
+	if (!_log_async_start())
+		return false;
+
+	if (async_dropped) {
+		xlogfmtcat(&notice,
+			   "[%M] %serror: %"PRIu64" log messages dropped, async log buffer full\n",
+			   log->prefix, async_dropped);
+		notice_len = strlen(notice);
+	}
+
+	if ((len + notice_len) > LOG_ASYNC_BUF_SIZE) {
+		/* Never fits, keep ordering and write it directly */
+		xfree(notice);
+		_log_async_drain();
+		return false;
+	}
+
+	if (log->opt.async == LOG_ASYNC_BLOCK) {
+		async_flush_cnt++;
+		while (cbuf_free(async_buf) < (len + notice_len)) {
+			pthread_cond_signal(&async_cond);
+			pthread_cond_wait(&async_space_cond, &log_lock);
+		}
+		async_flush_cnt--;
+	} else if (cbuf_free(async_buf) < (len + notice_len)) {
+		async_dropped++;
+		xfree(notice);
+		pthread_cond_signal(&async_cond);
+		return true;
+	}
+
+	was_empty = !cbuf_used(async_buf);
+	if (notice) {
+		cbuf_write(async_buf, notice, notice_len, NULL);
+		async_dropped = 0;
+		xfree(notice);
+	}
+	cbuf_write(async_buf, (void *) line, len, NULL);
+
+	if (async_waiting &&
+	    (was_empty || (cbuf_used(async_buf) >= LOG_ASYNC_WRITE_SIZE)))
+		pthread_cond_signal(&async_cond);
+
+	return true;
+}
+
+/* Invalidate every thread's copy of the log settings. Call with log_lock held */
+static void _log_async_update(void)
+{
+	static uint32_t gen = 0;
+
+	if (LOG_INITIALIZED && log->opt.async && !log->opt.buffered &&
+	    log->logfp && (log->opt.logfile_fmt == LOG_FILE_FMT_TIMESTAMP)) {
+		if (!++gen)
+			gen++;
+		async_gen = gen;
+	} else {
+		async_gen = 0;
+	}
+}
+
+/* Refresh this thread's copy of the log settings. Call with log_lock held */
+static void _log_async_tls_set(void)
+{
+	uint32_t gen = async_gen;
+	size_t len;
+
+	if (!gen || (async_tls.gen == gen))
+		return;
+
+	len = strlen(log->prefix);
+	if (len >= sizeof(async_tls.prefix)) {
+		async_tls.gen = 0;
+		return;
+	}
+	memcpy(async_tls.prefix, log->prefix, len + 1);
+	async_tls.direct_level = MAX(log->opt.stderr_level,
+				     log->opt.syslog_level);
+	async_tls.logfile_level = log->opt.logfile_level;
+	async_tls.prefix_level = log->opt.prefix_level;
+	async_tls.gen = gen;
+}
+
 /*
  * Initialize log with
  * prog = program name to tag error messages with
@@ -300,6 +601,12 @@ _log_init(char *prog, log_options_t opt, log_facility_t fac, char *logfile )
 {
 	int rc = 0;
 
+	/* Queued data must reach the current logfile before it is replaced */
+	if (opt.async == LOG_ASYNC_NONE)
+		_log_async_stop();
+	else
+		_log_async_drain();
+
 	if (!log)  {
 		log = xmalloc(sizeof(log_t));
 		log->logfp = NULL;
@@ -392,6 +699,7 @@ _log_init(char *prog, log_options_t opt, log_facility_t fac, char *logfile )
 
 	log->initialized = 1;
  out:
+	_log_async_update();
 	return rc;
 }
 
@@ -527,6 +835,11 @@ void log_fini(void)
 		return;
 
 	slurm_mutex_lock(&log_lock);
+	_log_async_stop();
+	if (async_buf) {
+		cbuf_destroy(async_buf);
+		async_buf = NULL;
+	}
 	_log_flush(log);
 	xfree(log->argv0);
 	xfree(log->prefix);
@@ -542,6 +855,7 @@ void log_fini(void)
 	}
 	xfree(log);
 	xfree(slurm_prog_name);
+	_log_async_update();
 	slurm_mutex_unlock(&log_lock);
 }
 
@@ -579,6 +893,7 @@ void log_set_prefix(char **prefix)
 		log->prefix = *prefix;
 		*prefix = NULL;
 	}
+	_log_async_update();
 	slurm_mutex_unlock(&log_lock);
 }
 
@@ -624,6 +939,7 @@ int log_alter_with_fp(log_options_t opt, log_facility_t fac, FILE *fp_in)
 		/* don't close fd on out since this fd was made
 		 * outside of the logger */
 	}
+	_log_async_update();
 	slurm_mutex_unlock(&log_lock);
 	return rc;
 }
@@ -1289,6 +1605,105 @@ static void _log_printf(log_t *log, cbuf_t *cb, FILE *stream,
 
 }
 
+/* Return the level prefix (e.g. "debug: ") and syslog priority of a message */
+static char *_log_level_pfx(log_level_t level, bool sched, bool spank,
+			    bool warn, int *priority)
+{
+	char *pfx;
+
+	switch (level) {
+	case LOG_LEVEL_FATAL:
+		*priority = LOG_CRIT;
+		pfx = "fatal: ";
+		break;
+
+	case LOG_LEVEL_ERROR:
+		*priority = LOG_ERR;
+		pfx = sched ? "error: sched: " : "error: ";
+		pfx = spank ? "" : pfx;
+		break;
+
+	case LOG_LEVEL_INFO:
+	case LOG_LEVEL_VERBOSE:
+		*priority = warn ? LOG_WARNING : LOG_INFO;
+		pfx = sched ? "sched: " : "";
+		pfx = warn ? "warning: " : pfx;
+		break;
+
+	case LOG_LEVEL_DEBUG:
+		*priority = LOG_DEBUG;
+		pfx = sched ? "debug:  sched: " : "debug:  ";
+		break;
+
+	case LOG_LEVEL_DEBUG2:
+		*priority = LOG_DEBUG;
+		pfx = sched ? "debug2: sched: " : "debug2: ";
+		break;
+
+	case LOG_LEVEL_DEBUG3:
+		*priority = LOG_DEBUG;
+		pfx = sched ? "debug3: sched: " : "debug3: ";
+		break;
+
+	case LOG_LEVEL_DEBUG4:
+		*priority = LOG_DEBUG;
+		pfx = "debug4: ";
+		break;
+
+	case LOG_LEVEL_DEBUG5:
+		*priority = LOG_DEBUG;
+		pfx = "debug5: ";
+		break;
+
+	default:
+		*priority = LOG_ERR;
+		pfx = "internal error: ";
+		break;
+	}
+
+	return pfx;
+}
+
+/*
+ * Format a message which only goes to the logfile into this thread's line
+ * buffer and queue it for the async writer, holding log_lock only to queue it.
+ * RET false if the message must go through the regular path
+ */
+static bool _log_async_msg(log_level_t level, bool spank, bool warn,
+			   const char *buf)
+{
+	uint32_t gen = async_tls.gen;
+	char *pfx = "", *stamp = NULL;
+	int len, priority;
+
+	if (!gen || (gen != async_gen) ||
+	    (level <= async_tls.direct_level) ||
+	    (level > async_tls.logfile_level))
+		return false;
+
+	if (async_tls.prefix_level)
+		pfx = _log_level_pfx(level, false, spank, warn, &priority);
+
+	xlogfmtcat(&stamp, "%M");
+	len = snprintf(async_line, sizeof(async_line), "[%s] %s%s%s\n",
+		       stamp, async_tls.prefix, pfx, buf);
+	xfree(stamp);
+	if ((len < 0) || (len >= sizeof(async_line)))
+		return false;
+
+	slurm_mutex_lock(&log_lock);
+	if (gen != async_gen) {
+		/* Settings changed while formatting */
+		slurm_mutex_unlock(&log_lock);
+		return false;
+	}
+	if (!_log_async_queue(log, async_line))
+		_log_printf(log, NULL, log->logfp, "%s", async_line);
+	slurm_mutex_unlock(&log_lock);
+
+	return true;
+}
+
 /*
  * log a message at the specified level to facilities that have been
  * configured to receive messages at that level
@@ -1309,6 +1724,11 @@ static void _log_msg(log_level_t level, bool sched, bool spank, bool warn,
 	 */
 	buf = vxstrfmt(fmt, args);
 
+	if (!sched && _log_async_msg(level, spank, warn, buf)) {
+		xfree(buf);
+		return;
+	}
+
 	slurm_mutex_lock(&log_lock);
 
 	if (!LOG_INITIALIZED) {
@@ -1334,58 +1754,8 @@ static void _log_msg(log_level_t level, bool sched, bool spank, bool warn,
 		return;
 	}
 
-	if (log->opt.prefix_level || (log->opt.syslog_level > level)) {
-		switch (level) {
-		case LOG_LEVEL_FATAL:
-			priority = LOG_CRIT;
-			pfx = "fatal: ";
-			break;
-
-		case LOG_LEVEL_ERROR:
-			priority = LOG_ERR;
-			pfx = sched? "error: sched: " : "error: ";
-			pfx = spank ? "" : pfx;
-			break;
-
-		case LOG_LEVEL_INFO:
-		case LOG_LEVEL_VERBOSE:
-			priority = warn ? LOG_WARNING : LOG_INFO;
-			pfx = sched ? "sched: " : "";
-			pfx = warn ? "warning: " : pfx;
-			break;
-
-		case LOG_LEVEL_DEBUG:
-			priority = LOG_DEBUG;
-			pfx = sched ? "debug:  sched: " : "debug:  ";
-			break;
-
-		case LOG_LEVEL_DEBUG2:
-			priority = LOG_DEBUG;
-			pfx = sched ? "debug2: sched: " : "debug2: ";
-			break;
-
-		case LOG_LEVEL_DEBUG3:
-			priority = LOG_DEBUG;
-			pfx = sched ? "debug3: sched: " : "debug3: ";
-			break;
-
-		case LOG_LEVEL_DEBUG4:
-			priority = LOG_DEBUG;
-			pfx = "debug4: ";
-			break;
-
-		case LOG_LEVEL_DEBUG5:
-			priority = LOG_DEBUG;
-			pfx = "debug5: ";
-			break;
-
-		default:
-			priority = LOG_ERR;
-			pfx = "internal error: ";
-			break;
-		}
-
-	}
+	if (log->opt.prefix_level || (log->opt.syslog_level > level))
+		pfx = _log_level_pfx(level, sched, spank, warn, &priority);
 
 	if (level <= log->opt.stderr_level) {
 
@@ -1442,16 +1812,31 @@ static void _log_msg(log_level_t level, bool sched, bool spank, bool warn,
 					   SER_FLAGS_COMPACT);
 		FREE_NULL_DATA(out);
 
-		if (json)
+		if (json && log->opt.async && !log->opt.buffered) {
+			xstrcat(json, "\n");
+			if (!_log_async_queue(log, json))
+				_log_printf(log, NULL, log->logfp, "%s", json);
+		} else if (json) {
 			_log_printf(log, log->fbuf, log->logfp, "%s\n", json);
+		}
 
 		xfree(json);
 		fflush(log->logfp);
 		xfree(msgbuf);
 	} else {
 		xassert(log->opt.logfile_fmt == LOG_FILE_FMT_TIMESTAMP);
-		xlogfmtcat(&msgbuf, "[%M] %s%s", log->prefix, pfx);
-		_log_printf(log, log->fbuf, log->logfp, "%s%s\n", msgbuf, buf);
+		if (log->opt.async && !log->opt.buffered) {
+			_log_async_tls_set();
+			xlogfmtcat(&msgbuf, "[%M] %s%s%s\n",
+				   log->prefix, pfx, buf);
+			if (!_log_async_queue(log, msgbuf))
+				_log_printf(log, NULL, log->logfp, "%s",
+					    msgbuf);
+		} else {
+			xlogfmtcat(&msgbuf, "[%M] %s%s", log->prefix, pfx);
+			_log_printf(log, log->fbuf, log->logfp, "%s%s\n",
+				    msgbuf, buf);
+		}
 		fflush(log->logfp);
 
 		xfree(msgbuf);
@@ -1487,6 +1872,8 @@ log_has_data()
 static void
 _log_flush(log_t *log)
 {
+	_log_async_drain();
+
 	if (!log->opt.buffered)
 		return;
 
@@ -95,6 +95,12 @@ typedef enum {
 	LOG_FILE_FMT_JSON,
 } log_file_fmt_t;
 
+typedef enum {
+	LOG_ASYNC_NONE = 0,	/* write logfile from the calling thread */
+	LOG_ASYNC_DROP,		/* queue for writer thread, drop when full */
+	LOG_ASYNC_BLOCK,	/* queue for writer thread, wait when full */
+} log_async_t;
+
 /*
  * log options: Each of stderr, syslog, and logfile can have a different level
  */
@@ -106,6 +112,7 @@ typedef struct {
 	bool buffered;              /* use internal buffer to never block    */
 	bool raw;                   /* output is to a raw terminal           */
 	log_file_fmt_t logfile_fmt; /* format of logfile output */
+	log_async_t async;          /* logfile written by a separate thread */
 } 	log_options_t;
 
 extern char *slurm_prog_name;
@@ -227,7 +234,8 @@ bool log_has_data(void);
 
 /*
  * log_flush() attempts to flush all data in the internal
- * log buffer to the appropriate output stream.
+ * log buffer to the appropriate output stream. With async logging it
+ * also waits for the writer thread to drain the queued logfile data.
  */
 void log_flush(void);
 
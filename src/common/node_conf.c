@@ -62,6 +62,7 @@
 #include "src/common/pack.h"
 #include "src/common/parse_time.h"
 #include "src/common/read_config.h"
+#include "src/common/working_cluster.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
@@ -97,6 +98,21 @@ uint16_t *cr_node_num_cores = NULL;
 uint32_t *cr_node_cores_offset = NULL;
 bool spec_cores_first = false;
 
+/* Recent bitmap2node_name_sortable() results, see _name_cache_get() */
+#define NAME_CACHE_SIZE 64
+typedef struct {
+	bitstr_t *bitmap;
+	uint64_t hash;
+	uint64_t last_used;
+	char *names;
+	bool sort;
+} name_cache_t;
+
+static name_cache_t name_cache[NAME_CACHE_SIZE];
+static uint64_t name_cache_clock = 0;
+static uint64_t name_cache_gen = 0;
+static pthread_mutex_t name_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /* Local function definitions */
 static void _delete_config_record(void);
 static void _delete_node_config_ptr(node_record_t *node_ptr);
@@ -181,6 +197,56 @@ static void _node_record_hash_identity(void *item, const char **key,
 	*key_len = strlen(node_ptr->name);
 }
 
+/* Split node name into prefix and numeric suffix for bitmap2hostlist() */
+static void _set_node_name_tokens(node_record_t *node_ptr)
+{
+	const char *name = node_ptr->name;
+	size_t len = strlen(name), prefix_len = len;
+
+	while (prefix_len && isdigit((int) name[prefix_len - 1]))
+		prefix_len--;
+
+	node_ptr->name_prefix_len = 0;
+	node_ptr->name_suffix = 0;
+	node_ptr->name_suffix_width = 0;
+
+	/* Leave names that might overflow to hostlist_push_host() */
+	if ((prefix_len == len) || (len > UINT16_MAX) ||
+	    ((len - prefix_len) > 9))
+		return;
+
+	node_ptr->name_prefix_len = prefix_len;
+	node_ptr->name_suffix = strtoul(name + prefix_len, NULL, 10);
+	node_ptr->name_suffix_width = len - prefix_len;
+}
+
+/* Return true if node_ptr is the host after prev in a hostlist range */
+static bool _node_name_follows(node_record_t *prev, node_record_t *node_ptr)
+{
+	return (node_ptr->name_suffix_width &&
+		(node_ptr->name_suffix_width == prev->name_suffix_width) &&
+		(node_ptr->name_suffix == (prev->name_suffix + 1)) &&
+		(node_ptr->name_prefix_len == prev->name_prefix_len) &&
+		!strncmp(node_ptr->name, prev->name, prev->name_prefix_len));
+}
+
+/* Push names of first through last, which follow each other, onto hl */
+static void _push_node_names(hostlist_t *hl, node_record_t *first,
+			     node_record_t *last)
+{
+	char *prefix;
+
+	if (!first->name_suffix_width) {
+		hostlist_push_host(hl, first->name);
+		return;
+	}
+
+	prefix = xstrndup(first->name, first->name_prefix_len);
+	hostlist_push_host_range(hl, prefix, first->name_suffix,
+				 last->name_suffix, first->name_suffix_width);
+	xfree(prefix);
+}
+
 /*
  * bitmap2hostlist - given a bitmap, build a hostlist
  * IN bitmap - bitmap pointer
@@ -191,17 +257,107 @@ static void _node_record_hash_identity(void *item, const char **key,
 extern hostlist_t *bitmap2hostlist(bitstr_t *bitmap)
 {
 	hostlist_t *hl;
-	node_record_t *node_ptr;
+	node_record_t *node_ptr, *first = NULL, *last = NULL;
 
 	if (bitmap == NULL)
 		return NULL;
 
 	hl = hostlist_create(NULL);
+
+	if (slurmdb_setup_cluster_dims() > 1) {
+		for (int i = 0; (node_ptr = next_node_bitmap(bitmap, &i)); i++)
+			hostlist_push_host(hl, node_ptr->name);
+		return hl;
+	}
+
+	/*
+	 * Push each run of consecutively numbered nodes as one range instead
+	 * of parsing every node name.
+	 */
 	for (int i = 0; (node_ptr = next_node_bitmap(bitmap, &i)); i++) {
-		hostlist_push_host(hl, node_ptr->name);
+		if (last && _node_name_follows(last, node_ptr)) {
+			last = node_ptr;
+			continue;
+		}
+		if (first)
+			_push_node_names(hl, first, last);
+		first = last = node_ptr;
 	}
+	if (first)
+		_push_node_names(hl, first, last);
+
 	return hl;
+}
+
+extern void node_conf_name_cache_clear(void)
+{
+	slurm_mutex_lock(&name_cache_mutex);
+	name_cache_gen++;
+	for (int i = 0; i < NAME_CACHE_SIZE; i++) {
+		FREE_NULL_BITMAP(name_cache[i].bitmap);
+		xfree(name_cache[i].names);
+	}
+	slurm_mutex_unlock(&name_cache_mutex);
+}
+
+/*
+ * Look up node names of bitmap in the cache
+ * OUT gen - cache generation to pass to _name_cache_add()
+ * RET copy of node names or NULL if not cached
+ */
+static char *_name_cache_get(bitstr_t *bitmap, bool sort, uint64_t hash,
+			     uint64_t *gen)
+{
+	char *names = NULL;
+
+	slurm_mutex_lock(&name_cache_mutex);
+	*gen = name_cache_gen;
+	for (int i = 0; i < NAME_CACHE_SIZE; i++) {
+		name_cache_t *entry = &name_cache[i];
+
+		if (!entry->bitmap || (entry->hash != hash) ||
+		    (entry->sort != sort) || !bit_equal(entry->bitmap, bitmap))
+			continue;
+
+		entry->last_used = ++name_cache_clock;
+		names = xstrdup(entry->names);
+		break;
+	}
+	slurm_mutex_unlock(&name_cache_mutex);
+
+	return names;
+}
 
+/* Cache node names of bitmap, replacing the least recently used entry */
+static void _name_cache_add(bitstr_t *bitmap, bool sort, uint64_t hash,
+			    uint64_t gen, char *names)
+{
+	name_cache_t *entry = &name_cache[0];
+
+	slurm_mutex_lock(&name_cache_mutex);
+	/* node table changed since names were built */
+	if (gen != name_cache_gen) {
+		slurm_mutex_unlock(&name_cache_mutex);
+		return;
+	}
+
+	for (int i = 0; i < NAME_CACHE_SIZE; i++) {
+		if (!name_cache[i].bitmap) {
+			entry = &name_cache[i];
+			break;
+		}
+		if (name_cache[i].last_used < entry->last_used)
+			entry = &name_cache[i];
+	}
+
+	FREE_NULL_BITMAP(entry->bitmap);
+	xfree(entry->names);
+	entry->bitmap = bit_copy(bitmap);
+	entry->hash = hash;
+	entry->last_used = ++name_cache_clock;
+	entry->names = xstrdup(names);
+	entry->sort = sort;
+	slurm_mutex_unlock(&name_cache_mutex);
 }
 
 /*
@@ -218,14 +374,22 @@ extern char *bitmap2node_name_sortable(bitstr_t *bitmap, bool sort)
 {
 	hostlist_t *hl;
 	char *buf;
+	uint64_t hash, gen;
 
-	hl = bitmap2hostlist (bitmap);
-	if (hl == NULL)
+	if (bitmap == NULL)
 		return xstrdup("");
+
+	hash = bit_hash(bitmap);
+	if ((buf = _name_cache_get(bitmap, sort, hash, &gen)))
+		return buf;
+
+	hl = bitmap2hostlist (bitmap);
 	if (sort)
 		hostlist_sort(hl);
 	buf = hostlist_ranged_string_xmalloc(hl);
 	hostlist_destroy(hl);
+
+	_name_cache_add(bitmap, sort, hash, gen, buf);
 	return buf;
 }
 
@@ -877,8 +1041,10 @@ extern node_record_t *create_node_record_at(int index, char *node_name,
 	node_ptr = node_record_table_ptr[index] = xmalloc(sizeof(*node_ptr));
 	node_ptr->index = index;
 	node_ptr->name = xstrdup(node_name);
+	_set_node_name_tokens(node_ptr);
 	xhash_add(node_hash_table, node_ptr);
 	active_node_record_count++;
+	node_conf_name_cache_clear();
 
 	_init_node_record(node_ptr, config_ptr);
 
@@ -963,8 +1129,10 @@ extern void insert_node_record_at(node_record_t *node_ptr, int index)
 	bit_clear(node_ptr->config_ptr->node_bitmap, node_ptr->index);
 	node_ptr->index = index;
 	bit_set(node_ptr->config_ptr->node_bitmap, node_ptr->index);
+	_set_node_name_tokens(node_ptr);
 	xhash_add(node_hash_table, node_ptr);
 	active_node_record_count++;
+	node_conf_name_cache_clear();
 
 	/* add node to conf node hash tables */
 	slurm_conf_remove_node(node_ptr->name);
@@ -989,6 +1157,7 @@ extern void delete_node_record(node_record_t *node_ptr)
 			last_node_index = -1;
 	}
 	active_node_record_count--;
+	node_conf_name_cache_clear();
 
 	_delete_node_config_ptr(node_ptr);
 
@@ -1322,6 +1491,7 @@ extern void rehash_node(void)
 
 	xhash_free (node_hash_table);
 	node_hash_table = xhash_init(_node_record_hash_identity, NULL);
+	node_conf_name_cache_clear();
 	for (i = 0; (node_ptr = next_node(&i)); i++) {
 		if ((node_ptr->name == NULL) ||
 		    (node_ptr->name[0] == '\0'))
@@ -135,6 +135,11 @@ struct node_record {
 	char *mcs_label;		/* mcs_label if mcs plugin in use */
 	uint64_t mem_spec_limit;	/* MB memory limit for specialization */
 	char *name;			/* name of the node. NULL==defunct */
+	uint16_t name_prefix_len;	/* length of name before numeric
+					 * suffix, no need to save/restore */
+	unsigned long name_suffix;	/* numeric suffix of name */
+	uint16_t name_suffix_width;	/* digits in numeric suffix of name,
+					 * 0 if name has no usable suffix */
 	uint32_t next_state;		/* state after reboot */
 	uint16_t no_share_job_cnt;	/* count of jobs running that will
 					 * not share nodes */
@@ -242,6 +247,13 @@ char * bitmap2node_name (bitstr_t *bitmap);
  */
 hostlist_t *bitmap2hostlist(bitstr_t *bitmap);
 
+/*
+ * node_conf_name_cache_clear - forget bitmap2node_name() results cached for
+ *	the current node table. Must be called when node records are added,
+ *	removed or reordered.
+ */
+extern void node_conf_name_cache_clear(void);
+
 /*
  * build_all_nodeline_info - get a array of slurm_conf_node_t structures
  *	from the slurm.conf reader, build table, and set values
@@ -4118,6 +4118,7 @@ extern void slurm_free_job_info_msg(job_info_msg_t * job_buffer_ptr)
 			_free_all_job_info(job_buffer_ptr);
 			xfree(job_buffer_ptr->job_array);
 		}
+		xfree(job_buffer_ptr->purged_job_ids);
 		xfree(job_buffer_ptr);
 	}
 }
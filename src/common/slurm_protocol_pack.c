@@ -3285,6 +3285,13 @@ static int _unpack_job_info_msg(slurm_msg_t *smsg, buf_t *buffer)
 			job_ptr->bitflags |= BACKFILL_LAST;
 	}
 
+	/* load trailer (delta information) */
+	if (smsg->protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		safe_unpackbool(&msg->delta, buffer);
+		safe_unpack32_array(&msg->purged_job_ids, &msg->purged_count,
+				    buffer);
+	}
+
 	return SLURM_SUCCESS;
 
 unpack_error:
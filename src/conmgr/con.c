@@ -105,6 +105,7 @@ static const struct {
 	T(FLAG_WATCH_WRITE_TIMEOUT),
 	T(FLAG_WATCH_READ_TIMEOUT),
 	T(FLAG_WATCH_CONNECT_TIMEOUT),
+	T(FLAG_IS_OUTBOUND),
 };
 #undef T
 
@@ -515,6 +516,11 @@ extern int add_connection(conmgr_con_type_t type,
 		.work = list_create(NULL),
 		.write_complete_work = list_create(NULL),
 		.new_arg = arg,
+		/*
+		 * Outbound connections may timeout or fail before
+		 * on_connection() is ever called
+		 */
+		.arg = ((flags & FLAG_IS_OUTBOUND) ? arg : NULL),
 		.type = type,
 		.polling_input_fd = PCTL_TYPE_NONE,
 		.polling_output_fd = PCTL_TYPE_NONE,
@@ -629,6 +635,11 @@ extern void wrap_on_connection(conmgr_callback_args_t conmgr_args, void *arg)
 	if (!arg) {
 		error("%s: [%s] closing connection due to NULL return from on_connection",
 		      __func__, con->name);
+
+		slurm_mutex_lock(&mgr.mutex);
+		con->arg = NULL;
+		slurm_mutex_unlock(&mgr.mutex);
+
 		close_con(false, con);
 		return;
 	}
@@ -1061,7 +1072,7 @@ extern int conmgr_create_listen_sockets(conmgr_con_type_t type,
 extern int conmgr_create_connect_socket(conmgr_con_type_t type,
 					slurm_addr_t *addr, socklen_t addrlen,
 					const conmgr_events_t *events,
-					void *arg)
+					conmgr_con_flags_t flags, void *arg)
 {
 	int fd = -1, rc = SLURM_ERROR;
 	//socklen_t bindlen = 0;
@@ -1107,7 +1118,8 @@ again:
 				log_flag(CONMGR, "%s: [%pA(fd:%d)] connect() interrupted during shutdown. Closing connection.",
 					 __func__, addr, fd);
 				fd_close(&fd);
-				return SLURM_SUCCESS;
+				/* No connection so caller must cleanup arg */
+				return rc;
 			}
 
 			log_flag(CONMGR, "%s: [%pA(fd:%d)] connect() interrupted. Retrying.",
@@ -1126,8 +1138,9 @@ again:
 		/* delayed connect() completion is expected */
 	}
 
-	return add_connection(type, NULL, fd, fd, events, CON_FLAG_NONE, addr,
-			      addrlen, false, NULL, arg);
+	return add_connection(type, NULL, fd, fd, events,
+			      (flags | FLAG_IS_OUTBOUND), addr, addrlen, false,
+			      NULL, arg);
 }
 
 extern int conmgr_get_fd_auth_creds(conmgr_fd_t *con,
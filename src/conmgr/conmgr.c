@@ -134,7 +134,6 @@ extern void conmgr_init(int thread_count, int max_connections,
 	mgr.listen_conns = list_create(NULL);
 	mgr.complete_conns = list_create(NULL);
 	mgr.callbacks = callbacks;
-	mgr.work = list_create(NULL);
 	mgr.quiesced_work = list_create(NULL);
 	init_delayed_work();
 
@@ -191,10 +190,6 @@ extern void conmgr_fini(void)
 	xassert(list_is_empty(mgr.quiesced_work));
 	FREE_NULL_LIST(mgr.quiesced_work);
 
-	/* work should have been cleared by workers_fini() */
-	xassert(list_is_empty(mgr.work));
-	FREE_NULL_LIST(mgr.work);
-
 	pollctl_fini();
 
 	/*
@@ -343,6 +338,9 @@ extern int conmgr_set_params(const char *params)
 		} else if (!xstrcasecmp(tok, CONMGR_PARAM_POLL_ONLY)) {
 			log_flag(CONMGR, "%s: %s activated", __func__, tok);
 			pollctl_set_mode(POLL_MODE_POLL);
+		} else if (!xstrcasecmp(tok, CONMGR_PARAM_IO_URING)) {
+			log_flag(CONMGR, "%s: %s activated", __func__, tok);
+			pollctl_set_mode(POLL_MODE_URING);
 		} else if (!xstrcasecmp(tok, CONMGR_PARAM_WAIT_WRITE_DELAY)) {
 			const unsigned long count = slurm_atoul(tok +
 				strlen(CONMGR_PARAM_WAIT_WRITE_DELAY));
@@ -424,6 +424,17 @@ extern int conmgr_queue_send_fd(conmgr_fd_t *con, int fd);
 extern int conmgr_queue_write_data(conmgr_fd_t *con, const void *buffer,
 				   const size_t bytes);
 
+/*
+ * Write contents of buffer to connection without copying (from callback).
+ * NOTE: shadow and mmap()ed buffers do not own their data and are copied
+ * NOTE: type=CON_TYPE_RAW only
+ * IN con connection manager connection struct
+ * IN buffer_ptr - ptr to buffer with data to send up to get_buf_offset().
+ *	Ownership of buffer is always taken and *buffer_ptr is set to NULL.
+ * RET SLURM_SUCCESS or error
+ */
+extern int conmgr_queue_write_buffer(conmgr_fd_t *con, buf_t **buffer_ptr);
+
 /*
  * Write packed msg to connection (from callback).
  * NOTE: type=CON_TYPE_RPC only
@@ -486,13 +497,16 @@ extern int conmgr_create_listen_sockets(conmgr_con_type_t type,
  * IN addr - destination address to connect() socket
  * IN addrlen - sizeof(*addr)
  * IN events - ptr to function callback on events
- * IN arg - arbitrary ptr handed to on_connection callback
- * RET SLURM_SUCCESS or error
+ * IN flags - bit-or'ed flags to apply to connection
+ * IN arg - arbitrary ptr handed to on_connection callback. Also handed to
+ *	on_connect_timeout() and on_finish() if the connection is never
+ *	established.
+ * RET SLURM_SUCCESS or error. No callbacks are ever called for arg on error.
  */
 extern int conmgr_create_connect_socket(conmgr_con_type_t type,
 					slurm_addr_t *addr, socklen_t addrlen,
 					const conmgr_events_t *events,
-					void *arg);
+					conmgr_con_flags_t flags, void *arg);
 
 /*
  * Run connection manager main loop for until shutdown
@@ -808,6 +822,7 @@ extern int conmgr_queue_extract_con_fd(conmgr_fd_t *con,
 				       void *func_arg);
 
 #define CONMGR_PARAM_POLL_ONLY "CONMGR_USE_POLL"
+#define CONMGR_PARAM_IO_URING "CONMGR_USE_IO_URING"
 #define CONMGR_PARAM_THREADS "CONMGR_THREADS="
 #define CONMGR_PARAM_MAX_CONN "CONMGR_MAX_CONNECTIONS="
 #define CONMGR_PARAM_WAIT_WRITE_DELAY "CONMGR_WAIT_WRITE_DELAY="
@@ -402,6 +402,24 @@ extern void wrap_on_data(conmgr_callback_args_t conmgr_args, void *arg)
 	con->in->size = size;
 }
 
+static void _queue_write(conmgr_fd_t *con, buf_t *buf)
+{
+	log_flag(NET, "%s: [%s] write of %u bytes queued",
+		 __func__, con->name, remaining_buf(buf));
+
+	log_flag_hex(NET_RAW, get_buf_data(buf), size_buf(buf),
+		     "%s: queuing up write", __func__);
+
+	list_append(con->out, buf);
+
+	if (con_flag(con, FLAG_WATCH_WRITE_TIMEOUT))
+		con->last_write = timespec_now();
+
+	slurm_mutex_lock(&mgr.mutex);
+	EVENT_SIGNAL(&mgr.watch_sleep);
+	slurm_mutex_unlock(&mgr.mutex);
+}
+
 extern int conmgr_queue_write_data(conmgr_fd_t *con, const void *buffer,
 				   const size_t bytes)
 {
@@ -410,25 +428,41 @@ extern int conmgr_queue_write_data(conmgr_fd_t *con, const void *buffer,
 	xassert(con->magic == MAGIC_CON_MGR_FD);
 
 	buf = init_buf(bytes);
-
-	/* TODO: would be nice to avoid this copy */
 	memmove(get_buf_data(buf), buffer, bytes);
 
-	log_flag(NET, "%s: [%s] write of %zu bytes queued",
-		 __func__, con->name, bytes);
+	_queue_write(con, buf);
+	return SLURM_SUCCESS;
+}
+
+extern int conmgr_queue_write_buffer(conmgr_fd_t *con, buf_t **buffer_ptr)
+{
+	buf_t *buf = *buffer_ptr;
+	int rc = SLURM_SUCCESS;
 
-	log_flag_hex(NET_RAW, get_buf_data(buf), get_buf_offset(buf),
-		     "%s: queuing up write", __func__);
+	xassert(con->magic == MAGIC_CON_MGR_FD);
+	xassert(buf->magic == BUF_MAGIC);
 
-	list_append(con->out, buf);
+	*buffer_ptr = NULL;
 
-	if (con_flag(con, FLAG_WATCH_WRITE_TIMEOUT))
-		con->last_write = timespec_now();
+	if (!get_buf_offset(buf)) {
+		FREE_NULL_BUFFER(buf);
+	} else if (buf->shadow || buf->mmaped) {
+		/*
+		 * shadow buffer does not own its data and mmap()ed buffer
+		 * must keep its size to be munmap()ed, so both are copied
+		 */
+		rc = conmgr_queue_write_data(con, get_buf_data(buf),
+					     get_buf_offset(buf));
+		FREE_NULL_BUFFER(buf);
+	} else {
+		/* writev() sends from offset to size */
+		buf->size = get_buf_offset(buf);
+		set_buf_offset(buf, 0);
 
-	slurm_mutex_lock(&mgr.mutex);
-	EVENT_SIGNAL(&mgr.watch_sleep);
-	slurm_mutex_unlock(&mgr.mutex);
-	return SLURM_SUCCESS;
+		_queue_write(con, buf);
+	}
+
+	return rc;
 }
 
 extern void conmgr_fd_get_in_buffer(const conmgr_fd_t *con,
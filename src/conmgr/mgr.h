@@ -51,6 +51,7 @@
 #include "slurm/slurm.h"
 
 #include "src/common/pack.h"
+#include "src/common/slurm_time.h"
 
 #include "src/conmgr/conmgr.h"
 #include "src/conmgr/events.h"
@@ -76,6 +77,8 @@ typedef struct {
 	conmgr_fd_t *con;
 	conmgr_callback_t callback;
 	conmgr_work_control_t control;
+	/* when work was queued to run by a worker */
+	timespec_t queued;
 } work_t;
 
 /*
@@ -135,6 +138,11 @@ typedef enum {
 	FLAG_WATCH_READ_TIMEOUT = CON_FLAG_WATCH_READ_TIMEOUT,
 	/* @see CON_FLAG_WATCH_CONNECT_TIMEOUT */
 	FLAG_WATCH_CONNECT_TIMEOUT = CON_FLAG_WATCH_CONNECT_TIMEOUT,
+	/*
+	 * connection was created by conmgr_create_connect_socket():
+	 * caller's arg is handed to callbacks before on_connection()
+	 */
+	FLAG_IS_OUTBOUND = SLURM_BIT(18),
 } con_flags_t;
 
 /* Mask over flags that track connection state */
@@ -229,6 +237,19 @@ struct conmgr_fd_s {
 	bitstr_t *refs;
 };
 
+typedef struct {
+	/* callback function name (never xfree()ed) */
+	const char *func_name;
+	/* number of times callback was run */
+	uint64_t count;
+	/* total microseconds spent queued before running */
+	uint64_t wait_usec;
+	/* total microseconds spent running */
+	uint64_t run_usec;
+	/* longest run in microseconds */
+	uint64_t max_run_usec;
+} worker_callback_stats_t;
+
 typedef struct {
 #define MAGIC_WORKER 0xD2342412
 	int magic; /* MAGIC_WORKER */
@@ -236,6 +257,38 @@ typedef struct {
 	pthread_t tid;
 	/* unique id for tracking */
 	int id;
+
+	/*
+	 * Work queued for this worker. Other workers steal from the front
+	 * when their own queue is empty. All members are protected by mutex.
+	 */
+	struct {
+		pthread_mutex_t mutex;
+		/* ring buffer of work_t* */
+		work_t **work;
+		/* index of front of ring buffer */
+		int head;
+		/* number of work in ring buffer */
+		int count;
+		/* number of elements allocated in ring buffer */
+		int size;
+		/* highest count observed */
+		int max_count;
+	} queue;
+
+	/* Stats only touched by worker thread until it exits */
+	struct {
+		/* last time stats were logged */
+		timespec_t last_log;
+		/* number of work run */
+		uint64_t completed;
+		/* number of work taken from another worker's queue */
+		uint64_t stolen;
+		/* array of callback stats */
+		worker_callback_stats_t *callbacks;
+		/* number of elements in callbacks */
+		int callbacks_count;
+	} stats;
 } worker_t;
 
 /*
@@ -305,11 +358,15 @@ typedef struct {
 	/*
 	 * Is mgr currently quiesced?
 	 * Defers all new work to while true
+	 * Workers read without mgr.mutex (atomic)
 	 */
 	bool quiesced;
 	/* will inspect connections (not listeners */
 	bool inspecting;
-	/* True if watch() is only waiting on work to complete */
+	/*
+	 * True if watch() is only waiting on work to complete
+	 * Workers read without mgr.mutex (atomic)
+	 */
 	bool waiting_on_work;
 
 	/* Caller requests finish on error */
@@ -318,8 +375,6 @@ typedef struct {
 	int error;
 	/* list of work_t */
 	list_t *delayed_work;
-	/* list of work_t* */
-	list_t *work;
 
 	/* functions to handle host/port parsing */
 	conmgr_callbacks_t callbacks;
@@ -332,9 +387,28 @@ typedef struct {
 
 		/* list of worker_t */
 		list_t *workers;
+		/*
+		 * Array of worker_t* (same as workers) to find queues to
+		 * steal work from. Workers are only released by
+		 * workers_fini().
+		 */
+		worker_t **array;
+		/* number of workers in array (atomic) */
+		int count;
+		/* next worker queue to get work from outside of workers (atomic) */
+		int next;
+
+		/*
+		 * Number of work queued across all worker queues (atomic).
+		 * Workers only take mgr.mutex to sleep when this is zero.
+		 */
+		int pending;
+		/* number of workers waiting on worker_sleep (atomic) */
+		int sleeping;
 
-		/* track simple stats for logging */
+		/* number of workers looking for or running work (atomic) */
 		int active;
+		/* number of worker threads running */
 		int total;
 
 		/*
@@ -538,6 +612,22 @@ extern void wrap_work(work_t *work);
  */
 extern void wait_for_workers_idle(const char *caller);
 
+/*
+ * Queue work to be run by a worker
+ * Work is queued to the calling worker's own queue or spread across the
+ * workers when called from outside of a worker. mgr.mutex is only needed to
+ * wake up a sleeping worker.
+ * IN locked - true if caller already holds mgr.mutex
+ * IN work - work to run. Takes ownership.
+ */
+extern void workers_queue_work(bool locked, work_t *work);
+
+/* Get number of work queued across all workers */
+extern int workers_queued_count(void);
+
+/* Get number of workers looking for or running work */
+extern int workers_active(void);
+
 /*
  * Notify all worker thread to shutdown.
  * Wait until all work and workers have completed their work (and exited).
@@ -47,6 +47,10 @@ extern const poll_funcs_t epoll_funcs;
 #define DEFAULT_POLLING_MODE POLL_MODE_POLL
 #endif /* HAVE_EPOLL */
 
+#ifdef HAVE_IO_URING
+extern const poll_funcs_t uring_funcs;
+#endif /* HAVE_IO_URING */
+
 #define T(mode) { mode, XSTRINGIFY(mode) }
 static const struct {
 	poll_mode_t mode;
@@ -55,6 +59,7 @@ static const struct {
 	T(POLL_MODE_INVALID),
 	T(POLL_MODE_EPOLL),
 	T(POLL_MODE_POLL),
+	T(POLL_MODE_URING),
 	T(POLL_MODE_INVALID_MAX),
 };
 
@@ -65,6 +70,9 @@ static const poll_funcs_t *polling_funcs[] = {
 #ifdef HAVE_EPOLL
 	&epoll_funcs,
 #endif /* HAVE_EPOLL */
+#ifdef HAVE_IO_URING
+	&uring_funcs,
+#endif /* HAVE_IO_URING */
 	&poll_funcs,
 };
 
@@ -77,13 +85,23 @@ static const char *_mode_string(poll_mode_t find_mode)
 	fatal_abort("should never happen");
 }
 
-static const poll_funcs_t *_get_funcs(void)
+static const poll_funcs_t *_find_funcs(poll_mode_t find_mode)
 {
 	for (int i = 0; i < ARRAY_SIZE(polling_funcs); i++)
-		if (polling_funcs[i]->mode == mode)
+		if (polling_funcs[i]->mode == find_mode)
 			return polling_funcs[i];
 
-	fatal_abort("should never happen");
+	return NULL;
+}
+
+static const poll_funcs_t *_get_funcs(void)
+{
+	const poll_funcs_t *funcs = _find_funcs(mode);
+
+	if (!funcs)
+		fatal_abort("should never happen");
+
+	return funcs;
 }
 
 extern const char *pollctl_type_to_string(pollctl_fd_type_t type)
@@ -93,8 +111,23 @@ extern const char *pollctl_type_to_string(pollctl_fd_type_t type)
 
 extern void pollctl_init(const int max_connections)
 {
+	const poll_funcs_t *funcs = NULL;
+
 	if (mode == POLL_MODE_INVALID)
 		mode = DEFAULT_POLLING_MODE;
+
+	if (!(funcs = _find_funcs(mode))) {
+		warning("%s: [%s] polling mode not supported by this build. Falling back to %s.",
+			__func__, _mode_string(mode),
+			_mode_string(DEFAULT_POLLING_MODE));
+		mode = DEFAULT_POLLING_MODE;
+	} else if (funcs->probe && !funcs->probe()) {
+		warning("%s: [%s] polling mode not available on this host. Falling back to %s.",
+			__func__, _mode_string(mode),
+			_mode_string(DEFAULT_POLLING_MODE));
+		mode = DEFAULT_POLLING_MODE;
+	}
+
 	log_flag(CONMGR, "%s: [%s] Initializing with connection count %d",
 		 __func__, _mode_string(mode), max_connections);
 	_get_funcs()->init(max_connections);
@@ -46,6 +46,7 @@ typedef enum {
 	POLL_MODE_INVALID = 0,
 	POLL_MODE_EPOLL,
 	POLL_MODE_POLL,
+	POLL_MODE_URING,
 	POLL_MODE_INVALID_MAX,
 } poll_mode_t;
 
@@ -174,6 +175,8 @@ extern void pollctl_set_mode(poll_mode_t mode);
 
 typedef struct {
 	poll_mode_t mode;
+	/* Check if mode is usable on this host (NULL if always usable) */
+	bool (*probe)(void);
 	bool (*events_can_read)(pollctl_events_t events);
 	bool (*events_can_write)(pollctl_events_t events);
 	bool (*events_has_error)(pollctl_events_t events);
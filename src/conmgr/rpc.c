@@ -174,22 +174,18 @@ extern int conmgr_queue_write_msg(conmgr_fd_t *con, slurm_msg_t *msg)
 	/* switch to network order */
 	msglen = htonl(msglen);
 
-	//TODO: handing over the buffers would be better than copying
-
 	if ((rc = conmgr_queue_write_data(con, &msglen, sizeof(msglen))))
 		goto cleanup;
 
-	if ((rc = conmgr_queue_write_data(con, get_buf_data(buffers.header),
-					  get_buf_offset(buffers.header))))
+	/* Hand over packed buffers to avoid copying them */
+	if ((rc = conmgr_queue_write_buffer(con, &buffers.header)))
 		goto cleanup;
 
 	if (buffers.auth &&
-	    (rc = conmgr_queue_write_data(con, get_buf_data(buffers.auth),
-					  get_buf_offset(buffers.auth))))
+	    (rc = conmgr_queue_write_buffer(con, &buffers.auth)))
 		goto cleanup;
 
-	rc = conmgr_queue_write_data(con, get_buf_data(buffers.body),
-				     get_buf_offset(buffers.body));
+	rc = conmgr_queue_write_buffer(con, &buffers.body);
 cleanup:
 	if (!rc) {
 		log_flag(PROTOCOL, "%s: [%s] sending RPC %s",
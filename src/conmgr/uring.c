@@ -0,0 +1,1066 @@
+/*****************************************************************************\
+ *  uring.c - Definitions for io_uring(7) poll handlers
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include <endian.h>
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "slurm/slurm.h"
+#include "slurm/slurm_errno.h"
+
+#include "src/common/fd.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/read_config.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/conmgr/polling.h"
+#include "src/conmgr/events.h"
+
+/*
+ * Size event count for 1 input and 1 output per connection. Allocated once to
+ * avoid calling xrecalloc() every time poll() is called.
+ */
+#define MAX_POLL_EVENTS(max_connections) ((max_connections * 2) + 1)
+
+/*
+ * Cap on the submission queue size. Requests are only queued between polls
+ * and the queue is flushed early when full, so there is no need to size the
+ * ring for every connection.
+ */
+#define MAX_SQ_ENTRIES 4096
+
+/* string used for interrupt name in logging to match style of others fds */
+#define INTERRUPT_CON_NAME "interrupt"
+
+/*
+ * Every poll request is tagged with the file descriptor and a per file
+ * descriptor generation. The generation is bumped every time the request is
+ * replaced to allow ignoring completions from the prior request which can
+ * still be in flight in the completion queue.
+ */
+#define USER_DATA(fd, gen) ((((uint64_t) (gen)) << 32) | ((uint32_t) (fd)))
+#define USER_DATA_FD(data) ((int) ((data) & 0xffffffff))
+#define USER_DATA_GEN(data) ((uint32_t) ((data) >> 32))
+/* Tags for requests not tied to a file descriptor */
+#define USER_DATA_INTERRUPT UINT64_MAX
+#define USER_DATA_REMOVE (UINT64_MAX - 1)
+
+/* Get pointer to offset into mmap()ed ring */
+#define RING_PTR(base, offset) ((void *) (((char *) (base)) + (offset)))
+
+/*
+ * Flags to be used for each type of fd.
+ * Multishot poll requests are edge triggered unless IORING_POLL_ADD_LEVEL is
+ * requested which matches EPOLLET used by the epoll mode.
+ */
+#define T(type, events) { type, XSTRINGIFY(type), events, XSTRINGIFY(events) }
+static const struct {
+	pollctl_fd_type_t type;
+	const char *type_string;
+	uint32_t events;
+	const char *events_string;
+} fd_types[] = {
+	T(PCTL_TYPE_INVALID, 0),
+	T(PCTL_TYPE_UNSUPPORTED, 0),
+	T(PCTL_TYPE_NONE, 0),
+	T(PCTL_TYPE_CONNECTED, (EPOLLHUP | EPOLLERR)),
+	T(PCTL_TYPE_READ_ONLY, (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)),
+	T(PCTL_TYPE_READ_WRITE,
+	  (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLHUP | EPOLLERR)),
+	T(PCTL_TYPE_WRITE_ONLY, (EPOLLOUT | EPOLLHUP | EPOLLERR)),
+	T(PCTL_TYPE_LISTEN, (EPOLLIN | EPOLLHUP | EPOLLERR)),
+	T(PCTL_TYPE_INVALID_MAX, 0),
+};
+#undef T
+
+#define T(flag) { flag, XSTRINGIFY(flag) }
+static const struct {
+	uint32_t flag;
+	const char *string;
+} poll_events[] = {
+	T(EPOLLIN),
+	T(EPOLLOUT),
+	T(EPOLLPRI),
+	T(EPOLLERR),
+	T(EPOLLHUP),
+	T(EPOLLRDHUP),
+};
+#undef T
+
+typedef struct {
+	/* type of polling requested or PCTL_TYPE_NONE if not linked */
+	pollctl_fd_type_t type;
+	/* generation of the active poll request */
+	uint32_t gen;
+	/* pctl.batch when fd was last added to pctl.events */
+	uint32_t batch;
+	/* index into pctl.events[] when batch matches */
+	int event;
+	/* poll request is waiting for room in the submission queue */
+	bool add_deferred;
+} fd_state_t;
+
+typedef struct {
+	int fd;
+	pollctl_events_t events;
+} uring_event_t;
+
+#define PCTL_INITIALIZER \
+{ \
+	.mutex = PTHREAD_MUTEX_INITIALIZER, \
+	.poll_return = EVENT_INITIALIZER("POLL_RETURN"), \
+	.ring = -1, \
+}
+
+static struct pctl_s {
+	pthread_mutex_t mutex;
+
+	/* Is currently initialized */
+	bool initialized;
+
+	/* event to wait on pollctl_for_each_event() to return */
+	event_signal_t poll_return;
+
+	/* True if actively polling() */
+	bool polling;
+	/* True while blocked in io_uring_enter() waiting for completions */
+	bool waiting;
+	/* file descriptor for io_uring */
+	int ring;
+
+	struct {
+		void *ptr;
+		size_t bytes;
+		uint32_t *head;
+		uint32_t *tail;
+		uint32_t *array;
+		uint32_t mask;
+		uint32_t entries;
+		struct io_uring_sqe *sqes;
+		size_t sqes_bytes;
+		/* next tail to publish. Only touched with mutex locked. */
+		uint32_t next;
+	} sq;
+
+	struct {
+		void *ptr;
+		size_t bytes;
+		uint32_t *head;
+		uint32_t *tail;
+		uint32_t mask;
+		struct io_uring_cqe *cqes;
+	} cq;
+
+	/* state for each file descriptor indexed by file descriptor */
+	fd_state_t *fds;
+	/* number of elements in fds array */
+	int fds_count;
+
+	/* array holding results of last poll */
+	uring_event_t *events;
+	/* number of elements in events array */
+	int events_count;
+	/*
+	 * Number of elements triggred in last poll.
+	 * Only set when polling=true.
+	 */
+	int events_triggered;
+	/* counter to detect duplicate completions in a single poll */
+	uint32_t batch;
+	/* number of file descriptors currently registered */
+	int fd_count;
+
+	/*
+	 * Requests that did not fit in a full submission queue. They are
+	 * queued again before the next io_uring_enter() in _poll().
+	 */
+	struct {
+		/* number of fds with add_deferred set */
+		int adds;
+		/* user_data of poll requests to remove */
+		uint64_t *removes;
+		int removes_count;
+		int removes_size;
+	} deferred;
+
+	struct {
+		/* number of times interrupt requested */
+		int requested;
+	} interrupt;
+} pctl = PCTL_INITIALIZER;
+
+static int _sys_io_uring_setup(unsigned int entries,
+			       struct io_uring_params *params)
+{
+	return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int _sys_io_uring_enter(int ring, unsigned int to_submit,
+			       unsigned int min_complete, unsigned int flags)
+{
+	return syscall(__NR_io_uring_enter, ring, to_submit, min_complete,
+		       flags, NULL, 0);
+}
+
+static const char *_type_to_string(pollctl_fd_type_t type)
+{
+	for (int i = 0; i < ARRAY_SIZE(fd_types); i++)
+		if (fd_types[i].type == type)
+			return fd_types[i].type_string;
+
+	fatal_abort("should never execute");
+}
+
+static char *_poll_events_to_string(uint32_t events)
+{
+	char *str = NULL, *at = NULL;
+	uint32_t matched = 0;
+
+	if (!events)
+		return xstrdup_printf("0");
+
+	for (int i = 0; i < ARRAY_SIZE(poll_events); i++) {
+		if ((poll_events[i].flag & events) == poll_events[i].flag) {
+			xstrfmtcatat(str, &at, "%s%s", (str ? "|" : ""),
+				     poll_events[i].string);
+			matched |= poll_events[i].flag;
+		}
+	}
+
+	if (events ^ matched)
+		xstrfmtcatat(str, &at, "%s0x%08"PRIx32, (str ? "|" : ""),
+			     (events ^ matched));
+
+	return str;
+}
+
+static uint32_t _fd_type_to_events(pollctl_fd_type_t type)
+{
+	for (int i = 0; i < ARRAY_SIZE(fd_types); i++)
+		if (fd_types[i].type == type)
+			return fd_types[i].events;
+
+	fatal_abort("should never happen");
+}
+
+static const char *_fd_type_to_events_string(pollctl_fd_type_t type)
+{
+	for (int i = 0; i < ARRAY_SIZE(fd_types); i++)
+		if (fd_types[i].type == type)
+			return fd_types[i].events_string;
+
+	fatal_abort("should never happen");
+}
+
+static bool _is_linked(int fd)
+{
+	return ((fd >= 0) && (fd < pctl.fds_count) &&
+		(pctl.fds[fd].type > PCTL_TYPE_NONE));
+}
+
+static void _check_pctl_magic(void)
+{
+#ifndef NDEBUG
+	xassert(pctl.initialized);
+	xassert(pctl.ring >= 0);
+	xassert(pctl.sq.ptr && (pctl.sq.ptr != MAP_FAILED));
+	xassert(pctl.cq.ptr && (pctl.cq.ptr != MAP_FAILED));
+	xassert(pctl.sq.sqes && (pctl.sq.sqes != MAP_FAILED));
+	xassert((pctl.sq.next - *pctl.sq.head) <= pctl.sq.entries);
+	xassert(pctl.fd_count >= 0);
+	xassert(pctl.fds_count >= 0);
+
+	xassert(pctl.interrupt.requested >= 0);
+#endif /* !NDEBUG */
+}
+
+static void _atfork_child(void)
+{
+	/*
+	 * Force pctl to return to default state before it was initialized at
+	 * forking as all of the prior state is completely unusable.
+	 */
+	pctl = (struct pctl_s) PCTL_INITIALIZER;
+}
+
+static bool _probe(void)
+{
+	struct io_uring_params params = { 0 };
+	int ring;
+
+	if ((ring = _sys_io_uring_setup(1, &params)) < 0) {
+		log_flag(CONMGR, "%s: [URING] io_uring_setup() failed: %m",
+			 __func__);
+		return false;
+	}
+
+	fd_close(&ring);
+
+	/*
+	 * Multishot poll requests arrived in the same kernel release (5.13)
+	 * as resource tags which are advertised as a feature. Completions
+	 * must also never be dropped on overflow.
+	 */
+	if (!(params.features & IORING_FEAT_NODROP) ||
+	    !(params.features & IORING_FEAT_RSRC_TAGS)) {
+		log_flag(CONMGR, "%s: [URING] kernel lacks multishot poll support: features=0x%"PRIx32,
+			 __func__, params.features);
+		return false;
+	}
+
+	return true;
+}
+
+static void *_map_ring(size_t bytes, off_t offset)
+{
+	void *ptr = mmap(NULL, bytes, (PROT_READ | PROT_WRITE),
+			 (MAP_SHARED | MAP_POPULATE), pctl.ring, offset);
+
+	if (ptr == MAP_FAILED)
+		fatal("%s: [URING] mmap(%zu) of ring failed: %m",
+		      __func__, bytes);
+
+	return ptr;
+}
+
+static void _init(const int max_connections)
+{
+	struct io_uring_params params = {
+		.flags = IORING_SETUP_CLAMP,
+	};
+	int rc;
+
+	slurm_mutex_lock(&pctl.mutex);
+
+	if (pctl.initialized) {
+		log_flag(CONMGR, "%s: Skipping. Already initialized", __func__);
+		slurm_mutex_unlock(&pctl.mutex);
+		return;
+	}
+
+	pctl.events_count = MAX_POLL_EVENTS(max_connections);
+
+	if ((rc = pthread_atfork(NULL, NULL, _atfork_child)))
+		fatal_abort("%s: pthread_atfork() failed: %s",
+			    __func__, slurm_strerror(rc));
+
+	if ((pctl.ring = _sys_io_uring_setup(MIN(pctl.events_count,
+						 MAX_SQ_ENTRIES),
+					     &params)) < 0)
+		fatal("%s: [URING] io_uring_setup() failed: %m", __func__);
+
+	pctl.sq.bytes = params.sq_off.array +
+		(params.sq_entries * sizeof(uint32_t));
+	pctl.sq.ptr = _map_ring(pctl.sq.bytes, IORING_OFF_SQ_RING);
+	pctl.sq.head = RING_PTR(pctl.sq.ptr, params.sq_off.head);
+	pctl.sq.tail = RING_PTR(pctl.sq.ptr, params.sq_off.tail);
+	pctl.sq.array = RING_PTR(pctl.sq.ptr, params.sq_off.array);
+	pctl.sq.mask = *(uint32_t *) RING_PTR(pctl.sq.ptr,
+					      params.sq_off.ring_mask);
+	pctl.sq.entries = *(uint32_t *) RING_PTR(pctl.sq.ptr,
+						 params.sq_off.ring_entries);
+	pctl.sq.next = *pctl.sq.tail;
+
+	pctl.sq.sqes_bytes = params.sq_entries * sizeof(*pctl.sq.sqes);
+	pctl.sq.sqes = _map_ring(pctl.sq.sqes_bytes, IORING_OFF_SQES);
+
+	pctl.cq.bytes = params.cq_off.cqes +
+		(params.cq_entries * sizeof(struct io_uring_cqe));
+	pctl.cq.ptr = _map_ring(pctl.cq.bytes, IORING_OFF_CQ_RING);
+	pctl.cq.head = RING_PTR(pctl.cq.ptr, params.cq_off.head);
+	pctl.cq.tail = RING_PTR(pctl.cq.ptr, params.cq_off.tail);
+	pctl.cq.mask = *(uint32_t *) RING_PTR(pctl.cq.ptr,
+					      params.cq_off.ring_mask);
+	pctl.cq.cqes = RING_PTR(pctl.cq.ptr, params.cq_off.cqes);
+
+	pctl.events = xcalloc(pctl.events_count, sizeof(*pctl.events));
+	pctl.initialized = true;
+
+	log_flag(CONMGR, "%s: [URING] initialized ring with %u submission and %u completion entries",
+		 __func__, params.sq_entries, params.cq_entries);
+
+	_check_pctl_magic();
+	slurm_mutex_unlock(&pctl.mutex);
+}
+
+static void _fini(void)
+{
+	slurm_mutex_lock(&pctl.mutex);
+
+	if (!pctl.initialized) {
+		slurm_mutex_unlock(&pctl.mutex);
+		return;
+	}
+
+	_check_pctl_magic();
+
+	while (pctl.polling)
+		EVENT_WAIT(&pctl.poll_return, &pctl.mutex);
+
+#ifdef MEMORY_LEAK_DEBUG
+	(void) munmap(pctl.sq.sqes, pctl.sq.sqes_bytes);
+	(void) munmap(pctl.sq.ptr, pctl.sq.bytes);
+	(void) munmap(pctl.cq.ptr, pctl.cq.bytes);
+	fd_close(&pctl.ring);
+
+	xfree(pctl.events);
+	xfree(pctl.fds);
+	pctl.fds_count = 0;
+	xfree(pctl.deferred.removes);
+	pctl.deferred.removes_count = 0;
+	pctl.deferred.removes_size = 0;
+	EVENT_FREE_MEMBERS(&pctl.poll_return);
+
+	pctl.initialized = false;
+#endif /* MEMORY_LEAK_DEBUG */
+
+	slurm_mutex_unlock(&pctl.mutex);
+
+	/*
+	 * lock is never destroyed
+	 * slurm_mutex_destroy(&pctl.mutex);
+	 */
+}
+
+/*
+ * Submit all queued requests to the kernel without waiting
+ * Caller must hold pctl.mutex lock
+ */
+static void _submit(const char *caller)
+{
+	uint32_t pending;
+	int rc;
+
+	while ((pending = (pctl.sq.next -
+			   __atomic_load_n(pctl.sq.head, __ATOMIC_ACQUIRE)))) {
+		if ((rc = _sys_io_uring_enter(pctl.ring, pending, 0, 0)) >= 0) {
+			log_flag(CONMGR, "%s->%s: [URING] submitted %d/%u requests",
+				 caller, __func__, rc, pending);
+
+			if (!rc)
+				break;
+		} else if (errno == EINTR) {
+			continue;
+		} else if ((errno == EAGAIN) || (errno == EBUSY)) {
+			/* Kernel is backed up. Try again at next poll. */
+			log_flag(CONMGR, "%s->%s: [URING] deferring %u requests: %m",
+				 caller, __func__, pending);
+			break;
+		} else {
+			fatal_abort("%s->%s: [URING] io_uring_enter(%u) failed: %m",
+				    caller, __func__, pending);
+		}
+	}
+}
+
+/*
+ * Get next free submission queue entry
+ * Caller must hold pctl.mutex lock
+ * RET sqe or NULL if the queue is still full after submitting it. The kernel
+ *	refuses new requests (EBUSY) until the completion queue is reaped by
+ *	_poll() so the caller must defer the request instead.
+ */
+static struct io_uring_sqe *_get_sqe(const char *caller)
+{
+	struct io_uring_sqe *sqe;
+
+	if ((pctl.sq.next - __atomic_load_n(pctl.sq.head, __ATOMIC_ACQUIRE)) >=
+	    pctl.sq.entries) {
+		/* Queue is full: flush it early */
+		_submit(caller);
+
+		if ((pctl.sq.next -
+		     __atomic_load_n(pctl.sq.head, __ATOMIC_ACQUIRE)) >=
+		    pctl.sq.entries) {
+			log_flag(CONMGR, "%s->%s: [URING] submission queue full",
+				 caller, __func__);
+			return NULL;
+		}
+	}
+
+	sqe = &pctl.sq.sqes[pctl.sq.next & pctl.sq.mask];
+	memset(sqe, 0, sizeof(*sqe));
+	return sqe;
+}
+
+/*
+ * Publish sqe from _get_sqe() to the kernel
+ * Caller must hold pctl.mutex lock
+ */
+static void _push_sqe(void)
+{
+	const uint32_t index = pctl.sq.next & pctl.sq.mask;
+
+	pctl.sq.array[index] = index;
+	pctl.sq.next++;
+	__atomic_store_n(pctl.sq.tail, pctl.sq.next, __ATOMIC_RELEASE);
+}
+
+/* Caller must hold pctl.mutex lock */
+static void _queue_poll_add(int fd)
+{
+	struct io_uring_sqe *sqe = _get_sqe(__func__);
+	fd_state_t *state = &pctl.fds[fd];
+	uint32_t events = _fd_type_to_events(state->type);
+
+	if (!sqe) {
+		/* Request the current type and gen of fd once there is room */
+		if (!state->add_deferred) {
+			state->add_deferred = true;
+			pctl.deferred.adds++;
+		}
+		return;
+	}
+
+	if (state->add_deferred) {
+		state->add_deferred = false;
+		pctl.deferred.adds--;
+	}
+
+#if __BYTE_ORDER == __BIG_ENDIAN
+	/* kernel expects the 16 bit halves swapped on big endian */
+	events = ((events << 16) | (events >> 16));
+#endif
+
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->len = IORING_POLL_ADD_MULTI;
+	sqe->poll32_events = events;
+	sqe->user_data = USER_DATA(fd, state->gen);
+
+	_push_sqe();
+}
+
+/*
+ * Queue removal of poll request tagged with user_data
+ * Caller must hold pctl.mutex lock
+ * RET true if queued or false if the submission queue is full
+ */
+static bool _queue_remove(uint64_t user_data)
+{
+	struct io_uring_sqe *sqe = _get_sqe(__func__);
+
+	if (!sqe)
+		return false;
+
+	sqe->opcode = IORING_OP_POLL_REMOVE;
+	sqe->fd = -1;
+	sqe->addr = user_data;
+	sqe->user_data = USER_DATA_REMOVE;
+
+	_push_sqe();
+	return true;
+}
+
+/* Caller must hold pctl.mutex lock */
+static void _queue_poll_remove(int fd)
+{
+	const uint64_t user_data = USER_DATA(fd, pctl.fds[fd].gen);
+
+	if (pctl.fds[fd].add_deferred) {
+		/* Request was never submitted */
+		pctl.fds[fd].add_deferred = false;
+		pctl.deferred.adds--;
+		return;
+	}
+
+	if (_queue_remove(user_data))
+		return;
+
+	if (pctl.deferred.removes_count >= pctl.deferred.removes_size) {
+		pctl.deferred.removes_size =
+			MAX(16, (pctl.deferred.removes_size * 2));
+		xrecalloc(pctl.deferred.removes, pctl.deferred.removes_size,
+			  sizeof(*pctl.deferred.removes));
+	}
+
+	pctl.deferred.removes[pctl.deferred.removes_count++] = user_data;
+}
+
+/*
+ * Queue requests deferred while the submission queue was full
+ * Caller must hold pctl.mutex lock
+ */
+static void _queue_deferred(const char *caller)
+{
+	if (!pctl.deferred.removes_count && !pctl.deferred.adds)
+		return;
+
+	log_flag(CONMGR, "%s->%s: [URING] queuing %d deferred removals and %d deferred poll requests",
+		 caller, __func__, pctl.deferred.removes_count,
+		 pctl.deferred.adds);
+
+	while (pctl.deferred.removes_count) {
+		if (!_queue_remove(pctl.deferred.removes[
+				pctl.deferred.removes_count - 1]))
+			return;
+		pctl.deferred.removes_count--;
+	}
+
+	for (int fd = 0; pctl.deferred.adds && (fd < pctl.fds_count); fd++) {
+		if (!pctl.fds[fd].add_deferred)
+			continue;
+
+		_queue_poll_add(fd);
+
+		if (pctl.fds[fd].add_deferred)
+			return;
+	}
+}
+
+/*
+ * Requests are normally only queued here and submitted together by the next
+ * io_uring_enter() in _poll(). A poll that is already blocked will not see
+ * them, and a removed poll request holds a reference on the file which
+ * would keep a close()ed socket open, so those are submitted right away.
+ *
+ * Caller must hold pctl.mutex lock
+ */
+static void _flush(bool removed, const char *caller)
+{
+	if (pctl.waiting || (removed && !pctl.polling))
+		_submit(caller);
+}
+
+static int _link_fd(int fd, pollctl_fd_type_t type, const char *con_name,
+		    const char *caller)
+{
+	struct stat statbuf;
+
+	xassert(fd >= 0);
+	xassert(type > PCTL_TYPE_NONE);
+	xassert(type < PCTL_TYPE_INVALID_MAX);
+
+	/* Match epoll_ctl() rejecting files that can never block */
+	if (!fstat(fd, &statbuf) &&
+	    (S_ISREG(statbuf.st_mode) || S_ISDIR(statbuf.st_mode))) {
+		log_flag(CONMGR, "%s->%s: [URING:%s] unable to poll fd:%d: %s",
+			 caller, __func__, con_name, fd,
+			 slurm_strerror(EPERM));
+		return EPERM;
+	}
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	if (fd >= pctl.fds_count) {
+		int count = MAX((fd + 1), (pctl.fds_count * 2));
+
+		xrecalloc(pctl.fds, count, sizeof(*pctl.fds));
+		pctl.fds_count = count;
+	}
+
+	xassert(!_is_linked(fd));
+	pctl.fds[fd].type = type;
+	pctl.fds[fd].gen++;
+	_queue_poll_add(fd);
+	pctl.fd_count++;
+
+	log_flag(CONMGR, "%s->%s: [URING:%s] registered fd[%s]:%d for %s events",
+		 caller, __func__, con_name, _type_to_string(type), fd,
+		 _fd_type_to_events_string(type));
+
+	_flush(false, caller);
+	slurm_mutex_unlock(&pctl.mutex);
+
+	return SLURM_SUCCESS;
+}
+
+static void _relink_fd(int fd, pollctl_fd_type_t type, const char *con_name,
+		       const char *caller)
+{
+	xassert(type > PCTL_TYPE_NONE);
+	xassert(type < PCTL_TYPE_INVALID_MAX);
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	if (!_is_linked(fd))
+		fatal_abort("%s->%s: [URING:%s] unable to modify unregistered fd:%d",
+			    caller, __func__, con_name, fd);
+
+	_queue_poll_remove(fd);
+	pctl.fds[fd].type = type;
+	pctl.fds[fd].gen++;
+	_queue_poll_add(fd);
+
+	log_flag(CONMGR, "%s->%s: [URING:%s] Modified fd[%s]:%d for %s events",
+		 caller, __func__, con_name, _type_to_string(type), fd,
+		 _fd_type_to_events_string(type));
+
+	_flush(false, caller);
+	slurm_mutex_unlock(&pctl.mutex);
+}
+
+static void _unlink_fd(int fd, const char *con_name, const char *caller)
+{
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	if (!_is_linked(fd))
+		fatal_abort("%s->%s: [URING:%s] unable to deregister unregistered fd:%d",
+			    caller, __func__, con_name, fd);
+
+	_queue_poll_remove(fd);
+	pctl.fds[fd].type = PCTL_TYPE_NONE;
+	pctl.fds[fd].gen++;
+	pctl.fd_count--;
+
+	log_flag(CONMGR, "%s->%s: [URING:%s] deregistered fd:%d events",
+		 caller, __func__, con_name, fd);
+
+	_flush(true, caller);
+	slurm_mutex_unlock(&pctl.mutex);
+}
+
+/*
+ * Convert completion into event for pollctl_for_each_event()
+ * Caller must hold pctl.mutex lock
+ * RET true if event was added to pctl.events
+ */
+static bool _reap_cqe(const struct io_uring_cqe *cqe, const char *caller)
+{
+	const int fd = USER_DATA_FD(cqe->user_data);
+	pollctl_events_t events;
+	fd_state_t *state;
+
+	if (cqe->user_data == USER_DATA_INTERRUPT) {
+		log_flag(CONMGR, "%s->%s: [URING:%s] received interrupt representing %d pending requests",
+			 caller, __func__, INTERRUPT_CON_NAME,
+			 pctl.interrupt.requested);
+
+		/* reset counter */
+		pctl.interrupt.requested = 0;
+		return false;
+	}
+
+	if (cqe->user_data == USER_DATA_REMOVE) {
+		/* Poll request may have already completed */
+		if ((cqe->res < 0) && (cqe->res != -ENOENT) &&
+		    (cqe->res != -EALREADY))
+			log_flag(CONMGR, "%s->%s: [URING] poll remove failed: %s",
+				 caller, __func__, slurm_strerror(-cqe->res));
+		return false;
+	}
+
+	if (!_is_linked(fd) ||
+	    (pctl.fds[fd].gen != USER_DATA_GEN(cqe->user_data))) {
+		log_flag(CONMGR, "%s->%s: [URING] ignoring stale completion for fd:%d",
+			 caller, __func__, fd);
+		return false;
+	}
+
+	state = &pctl.fds[fd];
+
+	if (cqe->res < 0) {
+		/*
+		 * Poll request failed and will not trigger again. Report as an
+		 * error to get the connection closed.
+		 */
+		log_flag(CONMGR, "%s->%s: [URING] poll of fd:%d failed: %s",
+			 caller, __func__, fd, slurm_strerror(-cqe->res));
+		events = EPOLLERR;
+	} else {
+		if (!(cqe->flags & IORING_CQE_F_MORE)) {
+			/*
+			 * Kernel terminated the multishot request (such as
+			 * when the completion queue overflowed). Queue a new
+			 * request which will be submitted at the next poll.
+			 */
+			state->gen++;
+			_queue_poll_add(fd);
+		}
+
+		if (!(events = cqe->res))
+			return false;
+	}
+
+	if (state->batch == pctl.batch) {
+		/* Merge with event already reported in this poll */
+		pctl.events[state->event].events |= events;
+		return false;
+	}
+
+	state->batch = pctl.batch;
+	state->event = pctl.events_triggered;
+	pctl.events[state->event].fd = fd;
+	pctl.events[state->event].events = events;
+	return true;
+}
+
+/*
+ * Walk the completion queue and fill pctl.events
+ * Caller must hold pctl.mutex lock
+ */
+static void _reap_cqes(const char *caller)
+{
+	uint32_t head = *pctl.cq.head;
+	const uint32_t tail = __atomic_load_n(pctl.cq.tail, __ATOMIC_ACQUIRE);
+
+	pctl.batch++;
+
+	/*
+	 * Stop when the events array is full. The remaining completions stay
+	 * in the ring and will cause the next poll to return immediately.
+	 */
+	while ((head != tail) && (pctl.events_triggered < pctl.events_count)) {
+		if (_reap_cqe(&pctl.cq.cqes[head & pctl.cq.mask], caller))
+			pctl.events_triggered++;
+		head++;
+	}
+
+	__atomic_store_n(pctl.cq.head, head, __ATOMIC_RELEASE);
+}
+
+static int _poll(const char *caller)
+{
+	int rc = SLURM_SUCCESS, ring = -1, fd_count = 0, nfds = 0;
+	uint32_t pending = 0;
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	/*
+	 * Using pctl.polling as way to avoid touching pctl.events while not
+	 * holding the mutex so poll can be done without the lock.
+	 */
+	xassert(!pctl.polling);
+	xassert(!pctl.waiting);
+	xassert(!pctl.events_triggered);
+	pctl.polling = true;
+	ring = pctl.ring;
+	fd_count = pctl.fd_count;
+	_queue_deferred(caller);
+	pending = (pctl.sq.next -
+		   __atomic_load_n(pctl.sq.head, __ATOMIC_ACQUIRE));
+
+	log_flag(CONMGR, "%s->%s: [URING] BEGIN: io_uring_enter() with %d file descriptors and %u queued requests",
+		 caller, __func__, fd_count, pending);
+
+	if (fd_count < 1) {
+		/*
+		 * No point in waiting when there are no file descriptors but
+		 * still submit any queued removals.
+		 */
+		log_flag(CONMGR, "%s->%s: [URING] skipping wait with %d file descriptors",
+			 caller, __func__, fd_count);
+		_submit(caller);
+	} else {
+		pctl.waiting = true;
+		slurm_mutex_unlock(&pctl.mutex);
+
+		/*
+		 * Submit every queued poll change and wait for completions in
+		 * a single system call.
+		 */
+		if (_sys_io_uring_enter(ring, pending, 1,
+					IORING_ENTER_GETEVENTS) < 0)
+			rc = errno;
+
+		slurm_mutex_lock(&pctl.mutex);
+		pctl.waiting = false;
+	}
+
+	if (rc == EINTR) {
+		/* Treat EINTR as no events detected */
+		rc = SLURM_SUCCESS;
+
+		log_flag(CONMGR, "%s->%s: [URING] END: io_uring_enter() interrupted by signal",
+			 caller, __func__);
+	} else if ((rc == EAGAIN) || (rc == EBUSY)) {
+		/* Completion queue backed up: reap below and try again */
+		rc = SLURM_SUCCESS;
+	} else if (rc) {
+		fatal_abort("%s->%s: [URING] END: io_uring_enter() failed: %s",
+			    caller, __func__, slurm_strerror(rc));
+	}
+
+	_reap_cqes(caller);
+	nfds = pctl.events_triggered;
+
+	log_flag(CONMGR, "%s->%s: [URING] END: io_uring_enter() with events for %d/%d file descriptors",
+		 caller, __func__, nfds, pctl.fd_count);
+
+	/* pctl.polling is set to false by pollctl_for_each_event() */
+	xassert(pctl.polling);
+	slurm_mutex_unlock(&pctl.mutex);
+
+	return rc;
+}
+
+static int _for_each_event(pollctl_event_func_t func, void *arg,
+			   const char *func_name, const char *caller)
+{
+	int nfds = -1, rc = SLURM_SUCCESS;
+	uring_event_t *events = NULL;
+	event_signal_t *poll_return = NULL;
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	xassert(pctl.polling);
+
+	events = pctl.events;
+	nfds = pctl.events_triggered;
+	slurm_mutex_unlock(&pctl.mutex);
+
+	for (int i = 0; !rc && (i < nfds); ++i) {
+		char *events_str = NULL;
+
+		if (slurm_conf.debug_flags & DEBUG_FLAG_CONMGR)
+			events_str = _poll_events_to_string(events[i].events);
+
+		log_flag(CONMGR, "%s->%s: [URING] BEGIN: calling %s(fd:%d, (%s), 0x%"PRIxPTR")",
+			 caller, __func__, func_name, events[i].fd,
+			 events_str, (uintptr_t) arg);
+
+		rc = func(events[i].fd, events[i].events, arg);
+
+		log_flag(CONMGR, "%s->%s: [URING] END: called %s(fd:%d, (%s), 0x%"PRIxPTR")=%s",
+			 caller, __func__, func_name, events[i].fd,
+			 events_str, (uintptr_t) arg, slurm_strerror(rc));
+
+		xfree(events_str);
+	}
+
+	slurm_mutex_lock(&pctl.mutex);
+
+	xassert(pctl.polling);
+	pctl.polling = false;
+	pctl.events_triggered = 0;
+	poll_return = &pctl.poll_return;
+
+	EVENT_BROADCAST(poll_return);
+	slurm_mutex_unlock(&pctl.mutex);
+
+	return rc;
+}
+
+static void _interrupt(const char *caller)
+{
+	struct io_uring_sqe *sqe;
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	if (!pctl.polling) {
+		log_flag(CONMGR, "%s->%s: [URING] skipping sending interrupt when not actively poll()ing",
+			 caller, __func__);
+	} else if (pctl.interrupt.requested++) {
+		log_flag(CONMGR, "%s->%s: [URING] skipping sending another interrupt requests=%d",
+			 caller, __func__, pctl.interrupt.requested);
+	} else if (!(sqe = _get_sqe(__func__))) {
+		/*
+		 * Kernel is refusing requests until the backed up completions
+		 * are reaped which will already wake up the poll. Allow the
+		 * next request to try again.
+		 */
+		pctl.interrupt.requested = 0;
+		log_flag(CONMGR, "%s->%s: [URING] unable to queue interrupt with full submission queue",
+			 caller, __func__);
+	} else {
+		/*
+		 * Completion of a no-op request wakes up io_uring_enter()
+		 * without needing a pipe.
+		 */
+		sqe->opcode = IORING_OP_NOP;
+		sqe->user_data = USER_DATA_INTERRUPT;
+		_push_sqe();
+
+		_submit(caller);
+
+		log_flag(CONMGR, "%s->%s: [URING] interrupt sent requests=%d waiting=%c",
+			 caller, __func__, pctl.interrupt.requested,
+			 BOOL_CHARIFY(pctl.waiting));
+	}
+
+	slurm_mutex_unlock(&pctl.mutex);
+}
+
+static bool _events_can_read(pollctl_events_t events)
+{
+	/*
+	 * Allow read()/write() to catch EPOLLRDHUP AND EPOLLHUP as there may
+	 * still be more bytes the fd's buffers and we don't want to close() the
+	 * connection yet either to drop those buffers on the floor.
+	 */
+	return (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP));
+}
+
+static bool _events_can_write(pollctl_events_t events)
+{
+	return (events & (EPOLLOUT | EPOLLRDHUP | EPOLLHUP));
+}
+
+static bool _events_has_error(pollctl_events_t events)
+{
+	return (events & EPOLLERR);
+}
+
+static bool _events_has_hangup(pollctl_events_t events)
+{
+	return (events & (EPOLLRDHUP | EPOLLHUP));
+}
+
+const poll_funcs_t uring_funcs = {
+	.mode = POLL_MODE_URING,
+	.probe = _probe,
+	.init = _init,
+	.fini = _fini,
+	.type_to_string = _type_to_string,
+	.link_fd = _link_fd,
+	.relink_fd = _relink_fd,
+	.unlink_fd = _unlink_fd,
+	.poll = _poll,
+	.for_each_event = _for_each_event,
+	.interrupt = _interrupt,
+	.events_can_read = _events_can_read,
+	.events_can_write = _events_can_write,
+	.events_has_error = _events_has_error,
+	.events_has_hangup = _events_has_hangup,
+};
@@ -534,6 +534,14 @@ static int _handle_connection(conmgr_fd_t *con, handle_connection_args_t *args)
 			 * needs to be done
 			 */
 		}
+	} else if (con_flag(con, FLAG_READ_EOF)) {
+		/*
+		 * connect() failed or timed out and input was already closed.
+		 * Continue on to close the connection since it will never be
+		 * established.
+		 */
+		log_flag(CONMGR, "%s: [%s] connection failed to establish",
+			 __func__, con->name);
 	} else {
 		xassert(!con_flag(con, FLAG_CAN_READ) &&
 			!con_flag(con, FLAG_CAN_WRITE));
@@ -554,13 +562,17 @@ static int _handle_connection(conmgr_fd_t *con, handle_connection_args_t *args)
 		if (con_flag(con, FLAG_WATCH_CONNECT_TIMEOUT) && args &&
 		    _handle_time_limit(args, con->last_read,
 				       mgr.conf_connect_timeout)) {
+			/*
+			 * Continue on to run the timeout work now as work is
+			 * otherwise never run before the connection is
+			 * established.
+			 */
 			_on_connect_timeout(args, con);
+		} else {
+			log_flag(CONMGR, "%s: [%s] waiting for connection to establish",
+				 __func__, con->name);
 			return 0;
 		}
-
-		log_flag(CONMGR, "%s: [%s] waiting for connection to establish",
-			 __func__, con->name);
-		return 0;
 	}
 
 	/* always do work first once connected */
@@ -1073,7 +1085,7 @@ static int _handle_poll_event(int fd, pollctl_events_t events, void *arg)
 static bool _is_poll_interrupt(void)
 {
 	return (mgr.quiesced || mgr.shutdown_requested ||
-		(mgr.waiting_on_work && (mgr.workers.active == 1)));
+		(mgr.waiting_on_work && (workers_active() == 1)));
 }
 
 /* Poll all connections */
@@ -1212,24 +1224,34 @@ static bool _watch_loop(void)
 	}
 
 	if (!mgr.quiesced && !list_is_empty(mgr.quiesced_work)) {
-		mgr.quiesced = true;
+		/*
+		 * Workers check quiesced without mgr.mutex after counting
+		 * themselves as active. Set it before checking for active
+		 * workers so that no new work can start.
+		 */
+		__atomic_store_n(&mgr.quiesced, true, __ATOMIC_SEQ_CST);
 		log_flag(CONMGR, "%s: BEGIN: quiesced state", __func__);
 	}
 
 	if (mgr.quiesced) {
+		int active;
+
 		xassert(!list_is_empty(mgr.quiesced_work));
 
-		if (mgr.workers.active) {
+		if ((active = workers_active())) {
 			log_flag(CONMGR, "%s: quiesced state waiting on workers:%d quiesced_work:%u",
-				 __func__, mgr.workers.active,
+				 __func__, active,
 				 list_count(mgr.quiesced_work));
 			mgr.waiting_on_work = true;
 			return true;
 		}
 
 		run_quiesced_work();
-		mgr.quiesced = false;
+		__atomic_store_n(&mgr.quiesced, false, __ATOMIC_SEQ_CST);
 		log_flag(CONMGR, "%s: END: quiesced state", __func__);
+
+		/* Wake up workers for any work queued while quiesced */
+		EVENT_BROADCAST(&mgr.worker_sleep);
 		return true;
 	}
 
@@ -1243,16 +1265,24 @@ static bool _watch_loop(void)
 	 * any queued work.
 	 */
 
-	if (mgr.workers.active || !list_is_empty(mgr.work) ||
+	/*
+	 * Workers check waiting_on_work without mgr.mutex once they are done.
+	 * Set it before checking for them. Check queued work before active
+	 * workers as workers count themselves active before taking work.
+	 */
+	__atomic_store_n(&mgr.waiting_on_work, true, __ATOMIC_SEQ_CST);
+
+	if (workers_queued_count() || workers_active() ||
 	    !list_is_empty(mgr.delayed_work)) {
 		/* Need to wait for all work/workers to complete */
 		log_flag(CONMGR, "%s: waiting on workers:%d work:%d delayed_work:%d",
-			 __func__, mgr.workers.active,
-			 list_count(mgr.delayed_work), list_count(mgr.work));
-		mgr.waiting_on_work = true;
+			 __func__, workers_active(),
+			 workers_queued_count(), list_count(mgr.delayed_work));
 		return true;
 	}
 
+	mgr.waiting_on_work = false;
+
 	log_flag(CONMGR, "%s: cleaning up", __func__);
 
 	xassert(!mgr.poll_active);
@@ -1283,8 +1313,8 @@ extern void *watch(void *arg)
 		}
 
 		log_flag(CONMGR, "%s: waiting for new events: workers:%d/%d work:%d delayed_work:%d connections:%d listeners:%d complete:%d polling:%c inspecting:%c shutdown_requested:%c quiesced:%c[%u] waiting_on_work:%c",
-				 __func__, mgr.workers.active,
-				 mgr.workers.total, list_count(mgr.work),
+				 __func__, workers_active(),
+				 mgr.workers.total, workers_queued_count(),
 				 list_count(mgr.delayed_work),
 				 list_count(mgr.connections),
 				 list_count(mgr.listen_conns),
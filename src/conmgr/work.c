@@ -200,27 +200,23 @@ extern void wrap_work(work_t *work)
 }
 
 /*
- * Add work to mgr.work
+ * Queue work to run on a worker
  * Single point to enqueue internal function callbacks
- * NOTE: _handle_work_run() can add new entries to mgr.work
  *
+ * IN locked - true if caller holds mgr.mutex
  * IN work - pointer to work to run
  * NOTE: never add a thread that will never return or conmgr_fini() will never
  *	return either.
- * NOTE: conmgr mutex must be held by caller
  */
-static void _handle_work_run(work_t *work)
+static void _handle_work_run(bool locked, work_t *work)
 {
 	xassert(work->magic == MAGIC_WORK);
 
 	_log_work(work, __func__, "Enqueueing work. work:%u",
-		  list_count(mgr.work));
+		  workers_queued_count());
 
-	/* add to work list and signal a thread if watch is active */
-	list_append(mgr.work, work);
-
-	if (!mgr.quiesced)
-		EVENT_SIGNAL(&mgr.worker_sleep);
+	/* add to worker queue and signal a sleeping worker if needed */
+	workers_queue_work(locked, work);
 }
 
 /*
@@ -302,6 +298,15 @@ static void _handle_work_pending(work_t *work)
 
 extern void handle_work(bool locked, work_t *work)
 {
+	/* Work without any dependency can be queued without mgr.mutex */
+	if (!locked && !work->con &&
+	    (work->status == CONMGR_WORK_STATUS_PENDING) &&
+	    (work->control.depend_type == CONMGR_WORK_DEP_NONE)) {
+		work->status = CONMGR_WORK_STATUS_RUN;
+		_handle_work_run(false, work);
+		return;
+	}
+
 	if (!locked)
 		slurm_mutex_lock(&mgr.mutex);
 
@@ -312,7 +317,7 @@ extern void handle_work(bool locked, work_t *work)
 	case CONMGR_WORK_STATUS_CANCELLED:
 		/* fall through as cancelled work runs immediately */
 	case CONMGR_WORK_STATUS_RUN:
-		_handle_work_run(work);
+		_handle_work_run(true, work);
 		break;
 	case CONMGR_WORK_STATUS_MAX:
 	case CONMGR_WORK_STATUS_INVALID:
@@ -37,19 +37,32 @@
 
 #include "src/common/macros.h"
 #include "src/common/read_config.h"
+#include "src/common/slurm_time.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
 
 #include "src/conmgr/conmgr.h"
 #include "src/conmgr/events.h"
 #include "src/conmgr/mgr.h"
 
+/* Starting number of elements in each worker queue */
+#define QUEUE_START_SIZE 16
+/* Seconds between each worker logging its stats with DebugFlags=CONMGR */
+#define STATS_LOG_INTERVAL 60
+
+/* Worker running in the current thread or NULL if not a worker */
+static __thread worker_t *current_worker = NULL;
+
 static void *_worker(void *arg);
 
 static void _check_magic_workers(void)
 {
 	xassert(mgr.workers.workers);
-	xassert(mgr.workers.active >= 0);
+	xassert(mgr.workers.array);
+	xassert(__atomic_load_n(&mgr.workers.active, __ATOMIC_RELAXED) >= 0);
+	xassert(mgr.workers.count >= 0);
+	xassert(mgr.workers.count <= CONMGR_THREAD_COUNT_MAX);
 }
 
 static void _check_magic_worker(worker_t *worker)
@@ -59,10 +72,17 @@ static void _check_magic_worker(worker_t *worker)
 	xassert(worker->id > 0);
 }
 
-static int _find_worker(void *x, void *arg)
+/* caller must hold worker->queue.mutex */
+static void _check_queue(worker_t *worker)
 {
-	return (x == arg);
+	_check_magic_worker(worker);
+	xassert(worker->queue.work);
+	xassert(worker->queue.count >= 0);
+	xassert(worker->queue.count <= worker->queue.size);
+	xassert(worker->queue.head >= 0);
+	xassert(worker->queue.head < worker->queue.size);
 }
+
 static void _worker_free(void *x)
 {
 	worker_t *worker = x;
@@ -74,20 +94,25 @@ static void _worker_free(void *x)
 
 	log_flag(CONMGR, "%s: [%u] free worker", __func__, worker->id);
 
+	xassert(!worker->queue.count);
+	xfree(worker->queue.work);
+	slurm_mutex_destroy(&worker->queue.mutex);
+	xfree(worker->stats.callbacks);
+
 	worker->magic = ~MAGIC_WORKER;
 	xfree(worker);
 }
 
-/* caller must own mgr.mutex lock */
-static void _worker_delete(void *x)
+/*
+ * Stop tracking worker as running.
+ * Worker is not released until workers_fini() as other workers may still be
+ * looking in its queue.
+ * caller must own mgr.mutex lock
+ */
+static void _worker_delete(worker_t *worker)
 {
-	worker_t *worker = x;
-
-	if (!worker)
-		return;
+	_check_magic_worker(worker);
 
-	/* list_delete_first calls _worker_free() */
-	list_delete_first(mgr.workers.workers, _find_worker, worker);
 	mgr.workers.total--;
 }
 
@@ -96,13 +121,301 @@ static void _increase_thread_count(int count)
 	for (int i = 0; i < count; i++) {
 		worker_t *worker = xmalloc(sizeof(*worker));
 		worker->magic = MAGIC_WORKER;
-		worker->id = i + 1;
+		worker->id = mgr.workers.count + 1;
+		slurm_mutex_init(&worker->queue.mutex);
+		worker->queue.size = QUEUE_START_SIZE;
+		worker->queue.work = xcalloc(worker->queue.size,
+					     sizeof(*worker->queue.work));
+
+		xassert(mgr.workers.count < CONMGR_THREAD_COUNT_MAX);
+		mgr.workers.array[mgr.workers.count] = worker;
+		/* Workers read count without mgr.mutex to find queues */
+		__atomic_store_n(&mgr.workers.count, (mgr.workers.count + 1),
+				 __ATOMIC_RELEASE);
+		list_append(mgr.workers.workers, worker);
+		_check_magic_worker(worker);
 
 		slurm_thread_create(&worker->tid, _worker, worker);
-		_check_magic_worker(worker);
+	}
+}
 
-		list_append(mgr.workers.workers, worker);
+/* Add work to back of worker's queue */
+static void _queue_push(worker_t *worker, work_t *work)
+{
+	slurm_mutex_lock(&worker->queue.mutex);
+	_check_queue(worker);
+
+	if (worker->queue.count == worker->queue.size) {
+		int size = worker->queue.size * 2;
+		work_t **queue = xcalloc(size, sizeof(*queue));
+
+		/* Copy ring buffer in order to start of new buffer */
+		for (int i = 0; i < worker->queue.count; i++)
+			queue[i] = worker->queue.work[((worker->queue.head + i) %
+						       worker->queue.size)];
+
+		xfree(worker->queue.work);
+		worker->queue.work = queue;
+		worker->queue.size = size;
+		worker->queue.head = 0;
+	}
+
+	worker->queue.work[((worker->queue.head + worker->queue.count) %
+			    worker->queue.size)] = work;
+	worker->queue.count++;
+
+	if (worker->queue.count > worker->queue.max_count)
+		worker->queue.max_count = worker->queue.count;
+
+	slurm_mutex_unlock(&worker->queue.mutex);
+}
+
+/* Pop work from front of worker's queue or NULL if empty */
+static work_t *_queue_pop(worker_t *worker)
+{
+	work_t *work = NULL;
+
+	slurm_mutex_lock(&worker->queue.mutex);
+	_check_queue(worker);
+
+	if (worker->queue.count) {
+		work = worker->queue.work[worker->queue.head];
+		worker->queue.work[worker->queue.head] = NULL;
+		worker->queue.head = ((worker->queue.head + 1) %
+				      worker->queue.size);
+		worker->queue.count--;
+	}
+
+	slurm_mutex_unlock(&worker->queue.mutex);
+
+	if (work)
+		__atomic_sub_fetch(&mgr.workers.pending, 1, __ATOMIC_SEQ_CST);
+
+	return work;
+}
+
+/*
+ * Get next work from the worker's own queue or steal the oldest work from
+ * another worker's queue.
+ * IN worker - worker looking for work
+ * IN count - number of workers in mgr.workers.array
+ * RET work or NULL if all queues are empty
+ */
+static work_t *_get_work(worker_t *worker, int count)
+{
+	work_t *work;
+
+	if ((work = _queue_pop(worker)))
+		return work;
+
+	/* Start after worker to avoid all workers stealing from the same one */
+	for (int i = 1; i < count; i++) {
+		worker_t *victim = mgr.workers.array[((worker->id - 1 + i) %
+						      count)];
+
+		if (victim == worker)
+			continue;
+
+		if ((work = _queue_pop(victim))) {
+			worker->stats.stolen++;
+			log_flag(CONMGR, "%s: [%u] stole %s() from worker %u",
+				 __func__, worker->id,
+				 work->callback.func_name, victim->id);
+			return work;
+		}
+	}
+
+	return NULL;
+}
+
+static uint64_t _usec_between(timespec_t start, timespec_t end)
+{
+	timespec_diff_ns_t diff = timespec_diff_ns(end, start);
+
+	if (!diff.after)
+		return 0;
+
+	return ((diff.diff.tv_sec * USEC_IN_SEC) +
+		(diff.diff.tv_nsec / NSEC_IN_USEC));
+}
+
+/* Record latency of callback run by worker */
+static void _record_callback(worker_t *worker, const char *func_name,
+			     uint64_t wait_usec, uint64_t run_usec)
+{
+	worker_callback_stats_t *stats = NULL;
+
+	worker->stats.completed++;
+
+	/* Function names are normally the same string literal */
+	for (int i = 0; i < worker->stats.callbacks_count; i++) {
+		worker_callback_stats_t *cb = &worker->stats.callbacks[i];
+
+		if ((cb->func_name == func_name) ||
+		    !xstrcmp(cb->func_name, func_name)) {
+			stats = cb;
+			break;
+		}
+	}
+
+	if (!stats) {
+		xrecalloc(worker->stats.callbacks,
+			  (worker->stats.callbacks_count + 1),
+			  sizeof(*worker->stats.callbacks));
+		stats = &worker->stats.callbacks[worker->stats.callbacks_count];
+		worker->stats.callbacks_count++;
+		stats->func_name = func_name;
+	}
+
+	stats->count++;
+	stats->wait_usec += wait_usec;
+	stats->run_usec += run_usec;
+	if (run_usec > stats->max_run_usec)
+		stats->max_run_usec = run_usec;
+}
+
+static void _log_callback_stats(const char *caller, int id,
+				worker_callback_stats_t *cb)
+{
+	log_flag(CONMGR, "%s: [%u] %s() count=%"PRIu64" avg_wait=%"PRIu64"usec avg_run=%"PRIu64"usec max_run=%"PRIu64"usec",
+		 caller, id, cb->func_name, cb->count,
+		 (cb->wait_usec / cb->count), (cb->run_usec / cb->count),
+		 cb->max_run_usec);
+}
+
+/*
+ * Log stats of worker every STATS_LOG_INTERVAL seconds while it is running.
+ * Only called by the worker itself which avoids locking the stats.
+ */
+static void _log_worker_stats(worker_t *worker, timespec_t now)
+{
+	int queued, max_queued;
+
+	if (!(slurm_conf.debug_flags & DEBUG_FLAG_CONMGR))
+		return;
+
+	if (!timespec_is_after(now, timespec_add(worker->stats.last_log,
+				 (timespec_t) { .tv_sec = STATS_LOG_INTERVAL })))
+		return;
+
+	worker->stats.last_log = now;
+
+	slurm_mutex_lock(&worker->queue.mutex);
+	queued = worker->queue.count;
+	max_queued = worker->queue.max_count;
+	slurm_mutex_unlock(&worker->queue.mutex);
+
+	log_flag(CONMGR, "%s: [%u] completed=%"PRIu64" stolen=%"PRIu64" queued=%d max_queued=%d",
+		 __func__, worker->id, worker->stats.completed,
+		 worker->stats.stolen, queued, max_queued);
+
+	for (int i = 0; i < worker->stats.callbacks_count; i++)
+		_log_callback_stats(__func__, worker->id,
+				    &worker->stats.callbacks[i]);
+}
+
+/* Log stats of all workers. Only call once all workers have exited. */
+static void _log_stats(void)
+{
+	worker_callback_stats_t *callbacks = NULL;
+	int callbacks_count = 0;
+
+	if (!(slurm_conf.debug_flags & DEBUG_FLAG_CONMGR))
+		return;
+
+	for (int i = 0; i < mgr.workers.count; i++) {
+		worker_t *worker = mgr.workers.array[i];
+
+		log_flag(CONMGR, "%s: [%u] completed=%"PRIu64" stolen=%"PRIu64" max_queued=%d",
+			 __func__, worker->id, worker->stats.completed,
+			 worker->stats.stolen, worker->queue.max_count);
+
+		/* Merge callback stats across workers */
+		for (int j = 0; j < worker->stats.callbacks_count; j++) {
+			worker_callback_stats_t *wcb =
+				&worker->stats.callbacks[j];
+			worker_callback_stats_t *cb = NULL;
+
+			for (int k = 0; k < callbacks_count; k++) {
+				if (!xstrcmp(callbacks[k].func_name,
+					     wcb->func_name)) {
+					cb = &callbacks[k];
+					break;
+				}
+			}
+
+			if (!cb) {
+				xrecalloc(callbacks, (callbacks_count + 1),
+					  sizeof(*callbacks));
+				cb = &callbacks[callbacks_count++];
+				cb->func_name = wcb->func_name;
+			}
+
+			cb->count += wcb->count;
+			cb->wait_usec += wcb->wait_usec;
+			cb->run_usec += wcb->run_usec;
+			cb->max_run_usec = MAX(cb->max_run_usec,
+					       wcb->max_run_usec);
+		}
 	}
+
+	/* id 0 is all workers */
+	for (int i = 0; i < callbacks_count; i++)
+		_log_callback_stats(__func__, 0, &callbacks[i]);
+
+	xfree(callbacks);
+}
+
+extern void workers_queue_work(bool locked, work_t *work)
+{
+	worker_t *worker = current_worker;
+
+	xassert(work->magic == MAGIC_WORK);
+	xassert(mgr.workers.array);
+
+	/*
+	 * Keep work queued by a worker on its own queue as the worker is
+	 * likely to be the next to run it with warm caches. Idle workers will
+	 * steal it if this worker is still busy.
+	 */
+	if (!worker) {
+		int count = __atomic_load_n(&mgr.workers.count,
+					    __ATOMIC_ACQUIRE);
+		unsigned int next = __atomic_fetch_add(&mgr.workers.next, 1,
+						       __ATOMIC_RELAXED);
+
+		xassert(count > 0);
+		worker = mgr.workers.array[next % count];
+	}
+
+	work->queued = timespec_now();
+	_queue_push(worker, work);
+
+	/*
+	 * Pairs with _sleep(): either the worker sees pending work before it
+	 * waits or it is counted as sleeping here and gets woken up.
+	 */
+	__atomic_add_fetch(&mgr.workers.pending, 1, __ATOMIC_SEQ_CST);
+
+	if (!__atomic_load_n(&mgr.workers.sleeping, __ATOMIC_SEQ_CST) ||
+	    __atomic_load_n(&mgr.quiesced, __ATOMIC_RELAXED))
+		return;
+
+	if (!locked)
+		slurm_mutex_lock(&mgr.mutex);
+	EVENT_SIGNAL(&mgr.worker_sleep);
+	if (!locked)
+		slurm_mutex_unlock(&mgr.mutex);
+}
+
+extern int workers_queued_count(void)
+{
+	return __atomic_load_n(&mgr.workers.pending, __ATOMIC_SEQ_CST);
+}
+
+extern int workers_active(void)
+{
+	return __atomic_load_n(&mgr.workers.active, __ATOMIC_SEQ_CST);
 }
 
 extern void workers_init(int count)
@@ -139,6 +452,10 @@ extern void workers_init(int count)
 	log_flag(CONMGR, "%s: Initializing with %d workers", __func__, count);
 	xassert(!mgr.workers.workers);
 	mgr.workers.workers = list_create(_worker_free);
+	mgr.workers.array = xcalloc(CONMGR_THREAD_COUNT_MAX,
+				    sizeof(*mgr.workers.array));
+	mgr.workers.count = 0;
+	mgr.workers.next = 0;
 	mgr.workers.threads = count;
 
 	_check_magic_workers();
@@ -151,96 +468,162 @@ extern void workers_fini(void)
 	/* all workers should have already exited by now */
 
 	xassert(mgr.workers.shutdown_requested);
-	xassert(!mgr.workers.active);
+	xassert(!workers_active());
 	xassert(!mgr.workers.total);
+	xassert(!workers_queued_count());
+
+	_log_stats();
 
 	FREE_NULL_LIST(mgr.workers.workers);
+	xfree(mgr.workers.array);
+	mgr.workers.count = 0;
+	mgr.workers.next = 0;
 
 	mgr.workers.threads = 0;
 }
 
+/*
+ * Stop counting worker as active and wake up watch() if it is waiting for
+ * workers to finish.
+ */
+static void _worker_idle(void)
+{
+	/*
+	 * watch() sets quiesced or waiting_on_work before checking for active
+	 * workers. Either it sees this worker as still active or this worker
+	 * sees that it needs to signal watch().
+	 */
+	__atomic_sub_fetch(&mgr.workers.active, 1, __ATOMIC_SEQ_CST);
+
+	if (!__atomic_load_n(&mgr.shutdown_requested, __ATOMIC_SEQ_CST) &&
+	    !__atomic_load_n(&mgr.waiting_on_work, __ATOMIC_SEQ_CST) &&
+	    !__atomic_load_n(&mgr.quiesced, __ATOMIC_SEQ_CST))
+		return;
+
+	slurm_mutex_lock(&mgr.mutex);
+	/* wake up watch for all ending work on shutdown */
+	EVENT_SIGNAL(&mgr.watch_sleep);
+	slurm_mutex_unlock(&mgr.mutex);
+}
+
+/*
+ * Wait for work to be queued
+ * IN worker - worker going to sleep
+ * RET false if worker should exit
+ */
+static bool _sleep(worker_t *worker)
+{
+	bool run = true;
+
+	slurm_mutex_lock(&mgr.mutex);
+
+	/* Pairs with workers_queue_work() */
+	__atomic_add_fetch(&mgr.workers.sleeping, 1, __ATOMIC_SEQ_CST);
+
+	while (mgr.quiesced || !workers_queued_count()) {
+		if (mgr.workers.shutdown_requested) {
+			log_flag(CONMGR, "%s: [%u] shutting down completed=%"PRIu64" stolen=%"PRIu64,
+				 __func__, worker->id,
+				 worker->stats.completed,
+				 worker->stats.stolen);
+			_worker_delete(worker);
+			EVENT_SIGNAL(&mgr.worker_return);
+			run = false;
+			break;
+		}
+
+		log_flag(CONMGR, "%s: [%u] waiting for work. Current active workers %u/%u",
+			 __func__, worker->id, workers_active(),
+			 mgr.workers.total);
+		EVENT_WAIT(&mgr.worker_sleep, &mgr.mutex);
+	}
+
+	__atomic_sub_fetch(&mgr.workers.sleeping, 1, __ATOMIC_SEQ_CST);
+
+	slurm_mutex_unlock(&mgr.mutex);
+
+	return run;
+}
+
 static void *_worker(void *arg)
 {
 	worker_t *worker = arg;
 	_check_magic_worker(worker);
 
+	current_worker = worker;
+	worker->stats.last_log = timespec_now();
+
 	slurm_mutex_lock(&mgr.mutex);
 	mgr.workers.total++;
+	slurm_mutex_unlock(&mgr.mutex);
+
 	/*
-	 * mgr.mutex should be locked at the beginning of this loop. It should
-	 * also be locked when exiting the loop. It may be unlocked and
-	 * relocked during the loop.
+	 * mgr.mutex is only locked to sleep when there is no queued work, or
+	 * to signal watch() when it is waiting on workers.
 	 */
-	while (true) {
+	do {
 		work_t *work = NULL;
 
-		if (!mgr.quiesced)
-			work = list_pop(mgr.work);
-
-		/* wait for work if nothing to do */
-		if (!work) {
-			if (mgr.workers.shutdown_requested) {
-				log_flag(CONMGR, "%s: [%u] shutting down",
-					 __func__, worker->id);
-				_worker_delete(worker);
-				break;
+		/*
+		 * Count worker as active before checking quiesced. watch()
+		 * sets quiesced before waiting for all active workers which
+		 * avoids work starting after quiesce or shutdown has begun.
+		 */
+		__atomic_add_fetch(&mgr.workers.active, 1, __ATOMIC_SEQ_CST);
+
+		if (!__atomic_load_n(&mgr.quiesced, __ATOMIC_SEQ_CST))
+			work = _get_work(worker,
+					 __atomic_load_n(&mgr.workers.count,
+							 __ATOMIC_ACQUIRE));
+
+		if (work) {
+			const char *func_name = work->callback.func_name;
+			const timespec_t queued = work->queued;
+			timespec_t start, end;
+
+			xassert(work->magic == MAGIC_WORK);
+
+			if (__atomic_load_n(&mgr.shutdown_requested,
+					    __ATOMIC_RELAXED)) {
+				log_flag(CONMGR, "%s: [%u->%s] setting work status as cancelled after shutdown requested",
+					 __func__, worker->id, func_name);
+				work->status = CONMGR_WORK_STATUS_CANCELLED;
 			}
 
-			log_flag(CONMGR, "%s: [%u] waiting for work. Current active workers %u/%u",
-				 __func__, worker->id, mgr.workers.active,
-				 mgr.workers.total);
-			EVENT_WAIT(&mgr.worker_sleep, &mgr.mutex);
-			continue;
-		}
+			log_flag(CONMGR, "%s: [%u] %s() running",
+				 __func__, worker->id, func_name);
 
-		xassert(work->magic == MAGIC_WORK);
+			start = timespec_now();
 
-		if (mgr.shutdown_requested) {
-			log_flag(CONMGR, "%s: [%u->%s] setting work status as cancelled after shutdown requested",
-				 __func__, worker->id,
-				 work->callback.func_name);
-			work->status = CONMGR_WORK_STATUS_CANCELLED;
-		}
+			/* run work via wrap_work() which will xfree(work) */
+			wrap_work(work);
 
-		/* got work, run it! */
-		mgr.workers.active++;
+			end = timespec_now();
 
-		log_flag(CONMGR, "%s: [%u] %s() running active_workers=%u/%u queue=%u",
-			 __func__, worker->id, work->callback.func_name,
-			 mgr.workers.active, mgr.workers.total,
-			 list_count(mgr.work));
+			_record_callback(worker, func_name,
+					 _usec_between(queued, start),
+					 _usec_between(start, end));
 
-		/* Unlock mutex before running work */
-		slurm_mutex_unlock(&mgr.mutex);
+			log_flag(CONMGR, "%s: [%u] %s() finished",
+				 __func__, worker->id, func_name);
 
-		/* run work via wrap_work() which will xfree(work) */
-		wrap_work(work);
-		work = NULL;
-
-		/* Lock mutex after running work */
-		slurm_mutex_lock(&mgr.mutex);
-
-		mgr.workers.active--;
+			_log_worker_stats(worker, end);
+		}
 
-		log_flag(CONMGR, "%s: [%u] finished active_workers=%u/%u queue=%u",
-			 __func__, worker->id, mgr.workers.active,
-			 mgr.workers.total, list_count(mgr.work));
+		_worker_idle();
 
-		/* wake up watch for all ending work on shutdown */
-		if (mgr.shutdown_requested || mgr.waiting_on_work)
-			EVENT_SIGNAL(&mgr.watch_sleep);
-	}
+		/* Only sleep once all queues are empty or while quiesced */
+	} while ((!__atomic_load_n(&mgr.quiesced, __ATOMIC_SEQ_CST) &&
+		  workers_queued_count()) || _sleep(worker));
 
-	EVENT_SIGNAL(&mgr.worker_return);
-	slurm_mutex_unlock(&mgr.mutex);
 	return NULL;
 }
 
 extern void wait_for_workers_idle(const char *caller)
 {
-	while (mgr.workers.active > 0) {
+	while (workers_active() > 0) {
 		log_flag(CONMGR, "%s->%s: waiting for workers=%u/%u",
-			 caller, __func__, mgr.workers.active,
+			 caller, __func__, workers_active(),
 			 mgr.workers.total);
 
 		EVENT_WAIT(&mgr.worker_return, &mgr.mutex);
@@ -253,7 +636,7 @@ extern void workers_shutdown(void)
 
 	do {
 		log_flag(CONMGR, "%s: waiting for work=%u workers=%u/%u",
-			 __func__, list_count(mgr.work), mgr.workers.active,
+			 __func__, workers_queued_count(), workers_active(),
 			 mgr.workers.total);
 
 		if (mgr.workers.total > 0) {
@@ -144,8 +144,9 @@ static MYSQL_RES *_get_last_result(MYSQL *db_conn)
 }
 
 /* NOTE: Ensure that mysql_conn->lock is set on function entry */
-static int _mysql_query_internal(MYSQL *db_conn, char *query)
+static int _mysql_query_internal(mysql_conn_t *mysql_conn, char *query)
 {
+	MYSQL *db_conn = mysql_conn->db_conn;
 	int rc = SLURM_SUCCESS;
 	int deadlock_attempt = 0;
 
@@ -171,6 +172,12 @@ try_again:
 			 * a few times since this is mainly a race condition
 			 */
 			deadlock_attempt++;
+			/*
+			 * InnoDB rolled back the whole transaction, not just
+			 * this statement.  Let callers batching many requests
+			 * into one transaction notice that.
+			 */
+			mysql_conn->trans_lost++;
 
 			if (deadlock_attempt < MAX_DEADLOCK_ATTEMPTS) {
 				error("%s: deadlock detected attempt %u/%u: %d %s",
@@ -940,7 +947,7 @@ extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 		storage_init = true;
 		if (mysql_conn->flags & DB_CONN_FLAG_ROLLBACK)
 			mysql_autocommit(mysql_conn->db_conn, 0);
-		rc = _mysql_query_internal(mysql_conn->db_conn,
+		rc = _mysql_query_internal(mysql_conn,
 					   "SET session sql_mode='ANSI_QUOTES,"
 					   "NO_ENGINE_SUBSTITUTION';");
 	}
@@ -957,6 +964,8 @@ extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn)
 			mysql_thread_end();
 		mysql_close(mysql_conn->db_conn);
 		mysql_conn->db_conn = NULL;
+		/* Any open transaction is gone with the connection */
+		mysql_conn->trans_lost++;
 	}
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return SLURM_SUCCESS;
@@ -984,7 +993,7 @@ extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query)
 		return 0;	/* For CLANG false positive */
 	}
 	slurm_mutex_lock(&mysql_conn->lock);
-	rc = _mysql_query_internal(mysql_conn->db_conn, query);
+	rc = _mysql_query_internal(mysql_conn, query);
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return rc;
 }
@@ -1002,7 +1011,7 @@ extern int mysql_db_delete_affected_rows(mysql_conn_t *mysql_conn, char *query)
 		return 0;	/* For CLANG false positive */
 	}
 	slurm_mutex_lock(&mysql_conn->lock);
-	if (!(rc = _mysql_query_internal(mysql_conn->db_conn, query)))
+	if (!(rc = _mysql_query_internal(mysql_conn, query)))
 		rc = mysql_affected_rows(mysql_conn->db_conn);
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return rc;
@@ -1044,6 +1053,7 @@ extern int mysql_db_commit(mysql_conn_t *mysql_conn)
 		      mysql_errno(mysql_conn->db_conn),
 		      mysql_error(mysql_conn->db_conn));
 		errno = mysql_errno(mysql_conn->db_conn);
+		mysql_conn->trans_lost++;
 		rc = SLURM_ERROR;
 	}
 	slurm_mutex_unlock(&mysql_conn->lock);
@@ -1084,7 +1094,7 @@ extern MYSQL_RES *mysql_db_query_ret(mysql_conn_t *mysql_conn,
 	MYSQL_RES *result = NULL;
 
 	slurm_mutex_lock(&mysql_conn->lock);
-	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
+	if (_mysql_query_internal(mysql_conn, query) != SLURM_ERROR)  {
 		if (mysql_errno(mysql_conn->db_conn) == ER_NO_SUCH_TABLE)
 			goto fini;
 		else if (last)
@@ -1113,8 +1123,7 @@ extern int mysql_db_query_check_after(mysql_conn_t *mysql_conn, char *query)
 	int rc = SLURM_SUCCESS;
 
 	slurm_mutex_lock(&mysql_conn->lock);
-	if ((rc = _mysql_query_internal(
-		     mysql_conn->db_conn, query)) != SLURM_ERROR)
+	if ((rc = _mysql_query_internal(mysql_conn, query)) != SLURM_ERROR)
 		rc = _clear_results(mysql_conn->db_conn);
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return rc;
@@ -1125,7 +1134,7 @@ extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query)
 	uint64_t new_id = 0;
 
 	slurm_mutex_lock(&mysql_conn->lock);
-	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
+	if (_mysql_query_internal(mysql_conn, query) != SLURM_ERROR)  {
 		new_id = mysql_insert_id(mysql_conn->db_conn);
 		if (!new_id) {
 			/* should have new id */
@@ -1315,7 +1324,7 @@ extern void mysql_db_enable_streaming_replication(mysql_conn_t *mysql_conn)
 	 * being a specific value.
 	 */
 	query = xstrdup("SET @@SESSION.wsrep_trx_fragment_unit=\'bytes\';");
-	rc = _mysql_query_internal(mysql_conn->db_conn, query);
+	rc = _mysql_query_internal(mysql_conn, query);
 	xfree(query);
 	if (rc) {
 		error("Unable to set wsrep_trx_fragment_unit.");
@@ -1330,7 +1339,7 @@ extern void mysql_db_enable_streaming_replication(mysql_conn_t *mysql_conn)
 	fragment_size = MIN(wsrep_max_ws_size, 134217700);
 	query = xstrdup_printf("SET @@SESSION.wsrep_trx_fragment_size=%"PRIu64";",
 			       fragment_size);
-	rc = _mysql_query_internal(mysql_conn->db_conn, query);
+	rc = _mysql_query_internal(mysql_conn, query);
 	xfree(query);
 	if (rc)
 		error("Failed to set wsrep_trx_fragment_size");
@@ -1360,7 +1369,7 @@ extern void mysql_db_restore_streaming_replication(mysql_conn_t *mysql_conn)
 		query = xstrdup_printf(
 				"SET @@SESSION.wsrep_trx_fragment_unit=\'%s\';",
 				mysql_conn->wsrep_trx_fragment_unit_orig);
-		rc = _mysql_query_internal(mysql_conn->db_conn, query);
+		rc = _mysql_query_internal(mysql_conn, query);
 		xfree(query);
 		if (rc) {
 			error("Unable to restore wsrep_trx_fragment_unit.");
@@ -1374,7 +1383,7 @@ extern void mysql_db_restore_streaming_replication(mysql_conn_t *mysql_conn)
 		query = xstrdup_printf(
 				"SET @@SESSION.wsrep_trx_fragment_size=%"PRIu64";",
 				mysql_conn->wsrep_trx_fragment_size_orig);
-		rc = _mysql_query_internal(mysql_conn->db_conn, query);
+		rc = _mysql_query_internal(mysql_conn, query);
 		xfree(query);
 		if (rc) {
 			error("Unable to restore wsrep_trx_fragment_size.");
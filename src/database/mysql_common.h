@@ -67,6 +67,7 @@ typedef struct {
 	char *pre_commit_query;
 	list_t *update_list;
 	int conn;
+	uint32_t trans_lost; /* transactions lost to deadlock or reconnect */
 	uint64_t wsrep_trx_fragment_size_orig;
 	char *wsrep_trx_fragment_unit_orig;
 } mysql_conn_t;
@@ -52,7 +52,8 @@
 
 typedef enum {
 	ACCT_STORAGE_INFO_CONN_ACTIVE,
-	ACCT_STORAGE_INFO_AGENT_COUNT
+	ACCT_STORAGE_INFO_AGENT_COUNT,
+	ACCT_STORAGE_INFO_TRANS_LOST
 } acct_storage_info_t;
 
 extern uid_t db_api_uid;
@@ -49,6 +49,7 @@
 
 typedef struct {
 	int (*reconfig)(void);
+	int (*run_cycle)(void);
 } slurm_sched_ops_t;
 
 /*
@@ -56,6 +57,7 @@ typedef struct {
  */
 static const char *syms[] = {
 	"sched_p_reconfig",
+	"sched_p_run_cycle",
 };
 
 static slurm_sched_ops_t ops;
@@ -112,3 +114,10 @@ extern int sched_g_reconfig(void)
 
 	return (*(ops.reconfig))();
 }
+
+extern int sched_g_run_cycle(void)
+{
+	xassert(g_context);
+
+	return (*(ops.run_cycle))();
+}
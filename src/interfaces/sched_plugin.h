@@ -68,4 +68,11 @@ extern int sched_g_fini(void);
  */
 extern int sched_g_reconfig(void);
 
+/*
+ * Run one scheduling cycle in the calling thread. Used by "slurmctld --replay"
+ * which loads the plugin with scheduling_disabled set, so no plugin thread is
+ * running.
+ */
+extern int sched_g_run_cycle(void);
+
 #endif
@@ -3086,6 +3086,7 @@ extern int _add_feds_to_update_list(mysql_conn_t *mysql_conn,
 extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 {
 	int rc = check_connection(mysql_conn);
+	int commit_rc = SLURM_SUCCESS;
 	list_t *update_list = NULL;
 
 	/* always reset this here */
@@ -3127,8 +3128,9 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 			if (rc != SLURM_SUCCESS) {
 				if (mysql_db_rollback(mysql_conn))
 					error("rollback failed");
+				commit_rc = rc;
 			} else {
-				if (mysql_db_commit(mysql_conn))
+				if ((commit_rc = mysql_db_commit(mysql_conn)))
 					error("commit failed");
 				else if (mysql_conn->flags &
 					 DB_CONN_FLAG_FEDUPDATE)
@@ -3139,7 +3141,8 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 		}
 	}
 
-	if (commit && list_count(update_list)) {
+	/* Nothing was stored if the commit failed, so send no updates */
+	if (commit && !commit_rc && list_count(update_list)) {
 		list_itr_t *itr = NULL;
 		slurmdb_update_object_t *object = NULL;
 
@@ -3185,7 +3188,7 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 	xfree(mysql_conn->pre_commit_query);
 	FREE_NULL_LIST(update_list);
 
-	return SLURM_SUCCESS;
+	return commit_rc;
 }
 
 extern int acct_storage_p_add_users(mysql_conn_t *mysql_conn, uint32_t uid,
@@ -3823,6 +3826,19 @@ extern int acct_storage_p_clear_stats(void *db_conn, bool dbd)
 extern int acct_storage_p_get_data(void *db_conn, acct_storage_info_t dinfo,
 				   void *data)
 {
+	mysql_conn_t *mysql_conn = db_conn;
+	int *int_data = (int *) data;
+
+	switch (dinfo) {
+	case ACCT_STORAGE_INFO_TRANS_LOST:
+		if (!mysql_conn)
+			return SLURM_ERROR;
+		*int_data = mysql_conn->trans_lost;
+		break;
+	default:
+		break;
+	}
+
 	return SLURM_SUCCESS;
 }
 
@@ -1714,41 +1714,41 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 	   and extern steps.  Don't change it to a %u.
 	*/
 	xstrfmtcat(query,
-		   " where job_db_inx=%"PRIu64" and id_step=%d and step_het_comp=%u",
+		   " where job_db_inx=%"PRIu64" and id_step=%d and step_het_comp=%u;",
 		   step_ptr->job_ptr->db_index, step_ptr->step_id.step_id,
 		   step_ptr->step_id.step_het_comp);
-	DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
-	xfree(query);
+
+	/*
+	 * Send the job update in the same round trip as the step update,
+	 * mysql_db_query_check_after() catches a failure in either.
+	 */
 
 	/* set the energy for the entire job. */
 	if (step_ptr->job_ptr->tres_alloc_str) {
 		char *derived_ec_str = _get_derived_ec_update_str(exit_code);
-		query = xstrdup_printf(
-			"update \"%s_%s\" set tres_alloc='%s', derived_ec=%s where "
-			"job_db_inx=%"PRIu64,
-			mysql_conn->cluster_name, job_table,
-			step_ptr->job_ptr->tres_alloc_str, derived_ec_str,
-			step_ptr->job_ptr->db_index);
-		DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
-		rc = mysql_db_query(mysql_conn, query);
-		xfree(query);
+		xstrfmtcat(query,
+			   "update \"%s_%s\" set tres_alloc='%s', derived_ec=%s where "
+			   "job_db_inx=%"PRIu64";",
+			   mysql_conn->cluster_name, job_table,
+			   step_ptr->job_ptr->tres_alloc_str, derived_ec_str,
+			   step_ptr->job_ptr->db_index);
 		xfree(derived_ec_str);
 	} else if (exit_code &&
 		   (step_ptr->step_id.step_id != SLURM_BATCH_SCRIPT) &&
 		   (step_ptr->step_id.step_id != SLURM_EXTERN_CONT)) {
 		char *derived_ec_str = _get_derived_ec_update_str(exit_code);
-		query = xstrdup_printf(
-			"update \"%s_%s\" set derived_ec=%s where "
-			"job_db_inx=%"PRIu64,
-			mysql_conn->cluster_name, job_table, derived_ec_str,
-			step_ptr->job_ptr->db_index);
-		DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
-		rc = mysql_db_query(mysql_conn, query);
-		xfree(query);
+		xstrfmtcat(query,
+			   "update \"%s_%s\" set derived_ec=%s where "
+			   "job_db_inx=%"PRIu64";",
+			   mysql_conn->cluster_name, job_table, derived_ec_str,
+			   step_ptr->job_ptr->db_index);
 		xfree(derived_ec_str);
 	}
 
+	DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
+	rc = mysql_db_query_check_after(mysql_conn, query);
+	xfree(query);
+
 	return rc;
 }
 
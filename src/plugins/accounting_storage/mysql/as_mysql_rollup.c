@@ -42,6 +42,7 @@
 #include "as_mysql_archive.h"
 #include "src/common/parse_time.h"
 #include "src/common/slurm_time.h"
+#include "src/common/xhash.h"
 
 enum {
 	TIME_ALLOC,
@@ -91,9 +92,29 @@ typedef struct {
 	list_t *loc_tres;
 	time_t orig_start;
 	time_t start;
-	double unused_wall;
+	double unused_wall; /* unused wall this hour, added to the stored one
+			     * unless unused_reset is set */
+	bool unused_reset; /* first hour of the reservation */
 } local_resv_usage_t;
 
+typedef struct {
+	char *cluster_name;
+	uint32_t hours_done;
+	uint32_t hours_total;
+	pthread_mutex_t lock;
+} hour_progress_t;
+
+typedef struct {
+	char *cluster_name;
+	int conn;
+	int dims;
+	time_t end;
+	hour_progress_t *progress;
+	int rc;
+	char *resv_query;
+	time_t start;
+} hour_chunk_t;
+
 static void _destroy_local_tres_usage(void *object)
 {
 	local_tres_usage_t *a_usage = (local_tres_usage_t *)object;
@@ -141,16 +162,6 @@ static int _find_loc_tres(void *x, void *key)
 	return 0;
 }
 
-static int _find_id_usage(void *x, void *key)
-{
-	local_id_usage_t *loc = (local_id_usage_t *)x;
-	uint32_t id = *(uint32_t *)key;
-
-	if (loc->id == id)
-		return 1;
-	return 0;
-}
-
 static int _find_id_alt_usage(void *x, void *key)
 {
 	local_id_usage_t *loc = x;
@@ -162,6 +173,29 @@ static int _find_id_alt_usage(void *x, void *key)
 	return 0;
 }
 
+static void _id_usage_hash_id(void *item, const char **key, uint32_t *key_len)
+{
+	local_id_usage_t *loc = item;
+
+	*key = (const char *) &loc->id;
+	*key_len = sizeof(loc->id);
+}
+
+/* id and id_alt are adjacent ints, hash them together */
+static void _id_alt_usage_hash_id(void *item, const char **key,
+				  uint32_t *key_len)
+{
+	local_id_usage_t *loc = item;
+
+	*key = (const char *) &loc->id;
+	*key_len = sizeof(loc->id) + sizeof(loc->id_alt);
+}
+
+static local_id_usage_t *_find_id_usage_hash(xhash_t *usage_hash, int id)
+{
+	return xhash_get(usage_hash, (const char *) &id, sizeof(id));
+}
+
 static void _remove_job_tres_time_from_cluster(list_t *c_tres, list_t *j_tres,
 					       int seconds)
 {
@@ -294,14 +328,18 @@ static int _update_unused_wall(local_resv_usage_t *r_usage, list_t *job_tres,
 	 */
 	r_usage->unused_wall -=	(double)job_seconds * tres_ratio;
 
-	if (r_usage->unused_wall < 0) {
+	/*
+	 * The stored unused wall is floored at zero when it is updated, see
+	 * _hourly_rollup(). Only the first hour of a reservation knows the
+	 * final value here.
+	 */
+	if (r_usage->unused_reset && (r_usage->unused_wall < 0)) {
 		/*
 		 * With a Flex reservation you can easily have more time than is
 		 * possible.  Just print this debug3 warning if it happens.
 		 */
 		debug3("Unused wall is less than zero; this should never happen outside a Flex reservation. Setting it to zero for resv id = %d, start = %ld.",
 		       r_usage->id, r_usage->orig_start);
-		r_usage->unused_wall = 0;
 	}
 	return SLURM_SUCCESS;
 }
@@ -1126,8 +1164,7 @@ static int _setup_resv_usage(mysql_conn_t *mysql_conn,
 		"nodelist",
 		"tres",
 		"time_start",
-		"time_end",
-		"unused_wall"
+		"time_end"
 	};
 	enum {
 		RESV_REQ_ID,
@@ -1137,7 +1174,6 @@ static int _setup_resv_usage(mysql_conn_t *mysql_conn,
 		RESV_REQ_TRES,
 		RESV_REQ_START,
 		RESV_REQ_END,
-		RESV_REQ_UNUSED,
 		RESV_REQ_COUNT
 	};
 
@@ -1185,20 +1221,17 @@ static int _setup_resv_usage(mysql_conn_t *mysql_conn,
 	while ((row = mysql_fetch_row(result))) {
 		time_t row_start = slurm_atoul(row[RESV_REQ_START]);
 		time_t row_end = slurm_atoul(row[RESV_REQ_END]);
-		int unused;
 		int resv_seconds;
 		time_t orig_start = row_start;
-
-		if (row_start >= curr_start) {
-			/*
-			 * This is the first time we are seeing this
-			 * reservation, so set our unused to be 0.
-			 * This is mostly helpful when
-			 * rerolling set it back to 0.
-			 */
-			unused = 0;
-		} else
-			unused = slurm_atoul(row[RESV_REQ_UNUSED]);
+		/*
+		 * If this is the first time we are seeing this reservation
+		 * replace the stored unused wall instead of adding to it.
+		 * This is mostly helpful when rerolling set it back to 0.
+		 * Otherwise this hour is added to what the previous hours
+		 * stored, which lets hours be rolled up by different threads
+		 * as long as the updates are applied in order.
+		 */
+		bool unused_reset = (row_start >= curr_start);
 
 		if (row_start <= curr_start)
 			row_start = curr_start;
@@ -1232,7 +1265,8 @@ static int _setup_resv_usage(mysql_conn_t *mysql_conn,
 		r_usage->orig_start = orig_start;
 		r_usage->start = row_start;
 		r_usage->end = row_end;
-		r_usage->unused_wall = unused + resv_seconds;
+		r_usage->unused_wall = resv_seconds;
+		r_usage->unused_reset = unused_reset;
 		r_usage->hl = hostlist_create_dims(row[RESV_REQ_NODES], dims);
 		list_append(resv_usage_list, r_usage);
 	}
@@ -1271,23 +1305,28 @@ static void _add_planned_time(local_cluster_usage_t *c_usage, time_t job_start,
 }
 
 static local_id_usage_t *_check_q_usage(list_t *qos_usage_list,
+					xhash_t *qos_usage_hash,
 					local_id_usage_t *curr_q_usage,
 					local_id_usage_t *id_usage)
 {
+	const char *key;
+	uint32_t key_len;
+
 	xassert(qos_usage_list);
+	xassert(qos_usage_hash);
 	xassert(id_usage);
 
 	if (curr_q_usage && _find_id_alt_usage(curr_q_usage, id_usage))
 		return curr_q_usage;
 
-	curr_q_usage = list_find_first(qos_usage_list,
-				       _find_id_alt_usage,
-				       id_usage);
+	_id_alt_usage_hash_id(id_usage, &key, &key_len);
+	curr_q_usage = xhash_get(qos_usage_hash, key, key_len);
 	if (!curr_q_usage) {
 		curr_q_usage = xmalloc(sizeof(*curr_q_usage));
 		curr_q_usage->id = id_usage->id;
 		curr_q_usage->id_alt = id_usage->id_alt;
 		list_append(qos_usage_list, curr_q_usage);
+		xhash_add(qos_usage_hash, curr_q_usage);
 		curr_q_usage->loc_tres = list_create(
 			_destroy_local_tres_usage);
 	}
@@ -1295,14 +1334,28 @@ static local_id_usage_t *_check_q_usage(list_t *qos_usage_list,
 	return curr_q_usage;
 }
 
-extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
-				  char *cluster_name,
-				  time_t start, time_t end,
-				  uint16_t archive_data)
+static void _hour_progress(hour_progress_t *progress, time_t curr_start)
+{
+	slurm_mutex_lock(&progress->lock);
+	progress->hours_done++;
+	log_flag(DB_USAGE, "cluster %s rolled up hour %ld, %u of %u hours done",
+		 progress->cluster_name, curr_start, progress->hours_done,
+		 progress->hours_total);
+	slurm_mutex_unlock(&progress->lock);
+}
+
+/*
+ * Roll up the hours in [start, end). The reservation unused_wall updates are
+ * appended to resv_query instead of being run since they depend on the
+ * previous hour, the caller runs them in order once all hours are done.
+ */
+static int _hourly_rollup(mysql_conn_t *mysql_conn, char *cluster_name,
+			  int dims, time_t start, time_t end,
+			  char **resv_query, hour_progress_t *progress)
 {
 	int rc = SLURM_SUCCESS;
 	int add_sec = 3600;
-	int i=0, dims;
+	int i=0;
 	time_t now = time(NULL);
 	time_t curr_start = start;
 	time_t curr_end = curr_start + add_sec;
@@ -1319,6 +1372,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	list_t *qos_usage_list = list_create(_destroy_local_id_usage);
 	list_t *wckey_usage_list = list_create(_destroy_local_id_usage);
 	list_t *resv_usage_list = list_create(_destroy_local_resv_usage);
+	xhash_t *assoc_usage_hash = xhash_init(_id_usage_hash_id, NULL);
+	xhash_t *qos_usage_hash = xhash_init(_id_alt_usage_hash_id, NULL);
+	xhash_t *wckey_usage_hash = xhash_init(_id_usage_hash_id, NULL);
 	uint16_t track_wckey = slurm_get_track_wckey();
 	local_cluster_usage_t *loc_c_usage = NULL;
 	local_cluster_usage_t *c_usage = NULL;
@@ -1384,30 +1440,6 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		xstrfmtcat(suspend_str, ", %s", suspend_req_inx[i]);
 	}
 
-	/* We need to figure out the dimensions of this cluster */
-	query = xstrdup_printf("select dimensions from %s where name='%s'",
-			       cluster_table, cluster_name);
-	DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s", query);
-	result = mysql_db_query_ret(mysql_conn, query, 0);
-	xfree(query);
-
-	if (!result) {
-		error("%s: error querying cluster_table", __func__);
-		rc = SLURM_ERROR;
-		goto end_it;
-	}
-	row = mysql_fetch_row(result);
-
-	if (!row) {
-		error("%s: no cluster by name %s known",
-		      __func__, cluster_name);
-		rc = SLURM_ERROR;
-		goto end_it;
-	}
-
-	dims = atoi(row[0]);
-	mysql_free_result(result);
-
 /* 	info("begin start %s", slurm_ctime2(&curr_start)); */
 /* 	info("begin end %s", slurm_ctime2(&curr_end)); */
 	a_itr = list_iterator_create(assoc_usage_list);
@@ -1546,13 +1578,14 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			 * Do the qos calculation check the assoc_id now since
 			 * it will change in the next if
 			 */
-			q_usage = _check_q_usage(qos_usage_list, q_usage,
-						 &id_usage);
+			q_usage = _check_q_usage(qos_usage_list, qos_usage_hash,
+						 q_usage, &id_usage);
 
 			if (last_id != assoc_id) {
 				a_usage = xmalloc(sizeof(local_id_usage_t));
 				a_usage->id = assoc_id;
 				list_append(assoc_usage_list, a_usage);
+				xhash_add(assoc_usage_hash, a_usage);
 				last_id = assoc_id;
 				/* a_usage->loc_tres is made later,
 				   don't do it here.
@@ -1565,10 +1598,8 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 
 			/* do the wckey calculation */
 			if (last_wckeyid != wckey_id) {
-				list_iterator_reset(w_itr);
-				while ((w_usage = list_next(w_itr)))
-					if (w_usage->id == wckey_id)
-						break;
+				w_usage = _find_id_usage_hash(wckey_usage_hash,
+							      wckey_id);
 
 				if (!w_usage) {
 					w_usage = xmalloc(
@@ -1576,6 +1607,7 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 					w_usage->id = wckey_id;
 					list_append(wckey_usage_list,
 						    w_usage);
+					xhash_add(wckey_usage_hash, w_usage);
 					w_usage->loc_tres = list_create(
 						_destroy_local_tres_usage);
 				}
@@ -1751,14 +1783,15 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		/* now figure out how much more to add to the
 		   associations that could had run in the reservation
 		*/
-		query = NULL;
 		list_iterator_reset(r_itr);
 		while ((r_usage = list_next(r_itr))) {
 			list_itr_t *t_itr;
 			local_tres_usage_t *loc_tres;
 
-			xstrfmtcat(query, "update \"%s_%s\" set unused_wall=%f where id_resv=%u and time_start=%ld;",
+			xstrfmtcat(*resv_query, "update \"%s_%s\" set unused_wall=greatest(%s%f, 0) where id_resv=%u and time_start=%ld;",
 				   cluster_name, resv_table,
+				   r_usage->unused_reset ?
+				   "" : "unused_wall + ",
 				   r_usage->unused_wall, r_usage->id,
 				   r_usage->orig_start);
 
@@ -1822,8 +1855,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 
 					if (id_usage.id_alt) {
 						q_usage = _check_q_usage(
-							qos_usage_list, q_usage,
-							&id_usage);
+							qos_usage_list,
+							qos_usage_hash,
+							q_usage, &id_usage);
 
 						_add_time_tres(
 							q_usage->loc_tres,
@@ -1834,15 +1868,16 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 					}
 
 					if ((last_id != associd) &&
-					    !(a_usage = list_find_first(
-						      assoc_usage_list,
-						      _find_id_usage,
-						      &associd))) {
+					    !(a_usage = _find_id_usage_hash(
+						      assoc_usage_hash,
+						      associd))) {
 						a_usage = xmalloc(
 							sizeof(local_id_usage_t));
 						a_usage->id = associd;
 						list_append(assoc_usage_list,
 							    a_usage);
+						xhash_add(assoc_usage_hash,
+							  a_usage);
 						a_usage->loc_tres = list_create(
 							_destroy_local_tres_usage);
 					}
@@ -1857,17 +1892,6 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			list_iterator_destroy(t_itr);
 		}
 
-		if (query) {
-			DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s",
-			         query);
-			rc = mysql_db_query(mysql_conn, query);
-			xfree(query);
-			if (rc != SLURM_SUCCESS) {
-				error("couldn't update reservations with unused time");
-				goto end_it;
-			}
-		}
-
 		/* now apply the down time from the slurmctld disconnects */
 		if (c_usage) {
 			list_iterator_reset(c_itr);
@@ -1945,6 +1969,7 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 
 	end_loop:
 		_destroy_local_cluster_usage(c_usage);
+		_hour_progress(progress, curr_start);
 
 		c_usage     = NULL;
 		r_usage     = NULL;
@@ -1952,6 +1977,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		q_usage     = NULL;
 		w_usage     = NULL;
 
+		xhash_clear(assoc_usage_hash);
+		xhash_clear(qos_usage_hash);
+		xhash_clear(wckey_usage_hash);
 		list_flush(assoc_usage_list);
 		list_flush(cluster_down_list);
 		list_flush(qos_usage_list);
@@ -1982,19 +2010,172 @@ end_it:
 	FREE_NULL_LIST(qos_usage_list);
 	FREE_NULL_LIST(wckey_usage_list);
 	FREE_NULL_LIST(resv_usage_list);
+	xhash_free(assoc_usage_hash);
+	xhash_free(qos_usage_hash);
+	xhash_free(wckey_usage_hash);
 
 /* 	info("stop start %s", slurm_ctime2(&curr_start)); */
 /* 	info("stop end %s", slurm_ctime2(&curr_end)); */
 
+	return rc;
+}
+
+static void *_hourly_rollup_chunk(void *arg)
+{
+	hour_chunk_t *chunk = arg;
+	mysql_conn_t mysql_conn = {
+		.conn = chunk->conn,
+		.flags = DB_CONN_FLAG_ROLLBACK,
+	};
+
+	slurm_mutex_init(&mysql_conn.lock);
+
+	/* Each thread needs its own connection */
+	if ((chunk->rc = check_connection(&mysql_conn)) == SLURM_SUCCESS)
+		chunk->rc = _hourly_rollup(&mysql_conn, chunk->cluster_name,
+					   chunk->dims, chunk->start,
+					   chunk->end, &chunk->resv_query,
+					   chunk->progress);
+
+	if (chunk->rc != SLURM_SUCCESS) {
+		if (mysql_db_rollback(&mysql_conn))
+			error("rollback failed");
+	} else if (mysql_db_commit(&mysql_conn)) {
+		char start[25], end[25];
+		error("Couldn't commit cluster (%s) hour rollup for %s - %s",
+		      chunk->cluster_name,
+		      slurm_ctime2_r(&chunk->start, start),
+		      slurm_ctime2_r(&chunk->end, end));
+		chunk->rc = SLURM_ERROR;
+	}
+
+	mysql_db_close_db_connection(&mysql_conn);
+	slurm_mutex_destroy(&mysql_conn.lock);
+
+	return NULL;
+}
+
+/*
+ * Split the hours between threads, each committing its own hours on its own
+ * connection. The reservation updates are returned in hour order in
+ * resv_query.
+ */
+static int _hourly_rollup_threads(mysql_conn_t *mysql_conn,
+				  char *cluster_name, int dims,
+				  time_t start, time_t end, int threads,
+				  char **resv_query, hour_progress_t *progress)
+{
+	int rc = SLURM_SUCCESS;
+	uint32_t hours = progress->hours_total;
+	time_t curr_start = start;
+	hour_chunk_t *chunks = xcalloc(threads, sizeof(*chunks));
+	pthread_t *tids = xcalloc(threads, sizeof(*tids));
+
+	for (int i = 0; i < threads; i++) {
+		uint32_t chunk_hours = (hours / threads) +
+			((i < (hours % threads)) ? 1 : 0);
+
+		chunks[i].cluster_name = cluster_name;
+		chunks[i].conn = mysql_conn->conn;
+		chunks[i].dims = dims;
+		chunks[i].progress = progress;
+		chunks[i].start = curr_start;
+		if (i == (threads - 1))
+			chunks[i].end = end;
+		else
+			chunks[i].end = curr_start + (chunk_hours * 3600);
+		curr_start = chunks[i].end;
+
+		slurm_thread_create(&tids[i], _hourly_rollup_chunk, &chunks[i]);
+	}
+
+	for (int i = 0; i < threads; i++) {
+		slurm_thread_join(tids[i]);
+		if ((chunks[i].rc != SLURM_SUCCESS) && (rc == SLURM_SUCCESS))
+			rc = chunks[i].rc;
+		if (rc == SLURM_SUCCESS)
+			xstrcat(*resv_query, chunks[i].resv_query);
+		xfree(chunks[i].resv_query);
+	}
+
+	xfree(chunks);
+	xfree(tids);
+
+	return rc;
+}
+
+extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
+				  char *cluster_name,
+				  time_t start, time_t end,
+				  uint16_t archive_data)
+{
+	int rc = SLURM_SUCCESS;
+	int dims, threads = 1;
+	char *query = NULL, *resv_query = NULL;
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	hour_progress_t progress = {
+		.cluster_name = cluster_name,
+		.hours_total = (end - start + 3599) / 3600,
+	};
+
+	/* We need to figure out the dimensions of this cluster */
+	query = xstrdup_printf("select dimensions from %s where name='%s'",
+			       cluster_table, cluster_name);
+	DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s", query);
+	result = mysql_db_query_ret(mysql_conn, query, 0);
+	xfree(query);
+
+	if (!result) {
+		error("%s: error querying cluster_table", __func__);
+		return SLURM_ERROR;
+	}
+	row = mysql_fetch_row(result);
+
+	if (!row) {
+		error("%s: no cluster by name %s known",
+		      __func__, cluster_name);
+		mysql_free_result(result);
+		return SLURM_ERROR;
+	}
+
+	dims = atoi(row[0]);
+	mysql_free_result(result);
+
+	if (slurmdbd_conf && (slurmdbd_conf->rollup_threads > 1))
+		threads = MIN(slurmdbd_conf->rollup_threads,
+			      progress.hours_total);
+
+	slurm_mutex_init(&progress.lock);
+	if (threads > 1) {
+		debug("%s: rolling up %u hours of cluster %s with %d threads",
+		      __func__, progress.hours_total, cluster_name, threads);
+		rc = _hourly_rollup_threads(mysql_conn, cluster_name, dims,
+					    start, end, threads, &resv_query,
+					    &progress);
+	} else {
+		rc = _hourly_rollup(mysql_conn, cluster_name, dims, start, end,
+				    &resv_query, &progress);
+	}
+	slurm_mutex_destroy(&progress.lock);
+
+	if ((rc == SLURM_SUCCESS) && resv_query) {
+		DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s", resv_query);
+		if ((rc = mysql_db_query(mysql_conn, resv_query)) !=
+		    SLURM_SUCCESS)
+			error("couldn't update reservations with unused time");
+	}
+	xfree(resv_query);
+
 	/* go check to see if we archive and purge */
 
 	if (rc == SLURM_SUCCESS) {
 		if (mysql_db_commit(mysql_conn)) {
-			char start[25], end[25];
+			char start_char[25], end_char[25];
 			error("Couldn't commit cluster (%s) "
 			      "hour rollup for %s - %s",
-			      cluster_name, slurm_ctime2_r(&curr_start, start),
-			      slurm_ctime2_r(&curr_end, end));
+			      cluster_name, slurm_ctime2_r(&start, start_char),
+			      slurm_ctime2_r(&end, end_char));
 			rc = SLURM_ERROR;
 		} else
 			rc = _process_purge(mysql_conn, cluster_name,
@@ -2062,20 +2243,20 @@ extern int as_mysql_nonhour_rollup(mysql_conn_t *mysql_conn,
 			run_month ? assoc_day_table : assoc_hour_table,
 			curr_end, curr_start, now);
 
-		query = xstrdup_printf(
-			"insert into \"%s_%s\" (creation_time, mod_time, id, "
-			"id_tres, time_start, alloc_secs) "
-			"select %ld, %ld, id, id_tres, "
-			"%ld, @ASUM:=SUM(alloc_secs) from \"%s_%s\" where "
-			"(time_start < %ld && time_start >= %ld) "
-			"group by id, id_tres on duplicate key update "
-			"mod_time=%ld, alloc_secs=@ASUM;",
-			cluster_name,
-			run_month ? qos_month_table : qos_day_table,
-			now, now, curr_start,
-			cluster_name,
-			run_month ? qos_day_table : qos_hour_table,
-			curr_end, curr_start, now);
+		xstrfmtcat(query,
+			   "insert into \"%s_%s\" (creation_time, mod_time, id, "
+			   "id_alt, id_tres, time_start, alloc_secs) "
+			   "select %ld, %ld, id, id_alt, id_tres, "
+			   "%ld, @ASUM:=SUM(alloc_secs) from \"%s_%s\" where "
+			   "(time_start < %ld && time_start >= %ld) "
+			   "group by id, id_alt, id_tres on duplicate key update "
+			   "mod_time=%ld, alloc_secs=@ASUM;",
+			   cluster_name,
+			   run_month ? qos_month_table : qos_day_table,
+			   now, now, curr_start,
+			   cluster_name,
+			   run_month ? qos_day_table : qos_hour_table,
+			   curr_end, curr_start, now);
 
 		/* We group on deleted here so if there are no entries
 		   we don't get an error, just nothing is returned.
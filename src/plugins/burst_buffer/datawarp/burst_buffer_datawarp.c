@@ -701,6 +701,7 @@ static bb_job_t *_get_bb_job(job_record_t *job_ptr)
 			   "%s: Invalid burst buffer spec (%s)",
 			   plugin_type, job_ptr->burst_buffer);
 		job_ptr->priority = 0;
+		job_set_last_update(job_ptr, time(NULL));
 		info("Invalid burst buffer spec for %pJ (%s)",
 		     job_ptr, job_ptr->burst_buffer);
 		bb_job_del(&bb_state, job_ptr->job_id);
@@ -1571,6 +1572,7 @@ static void *_start_stage_in(void *x)
 		xstrfmtcat(job_ptr->state_desc, "%s: %s: %s",
 			   plugin_type, op, resp_msg);
 		job_ptr->priority = 0;	/* Hold job */
+		job_set_last_update(job_ptr, time(NULL));
 		bb_alloc = bb_find_alloc_rec(&bb_state, job_ptr);
 		if (bb_alloc) {
 			bb_alloc->state_time = time(NULL);
@@ -3643,7 +3645,7 @@ fini:
 /* Kill job from CONFIGURING state */
 static void _kill_job(job_record_t *job_ptr, bool hold_job)
 {
-	last_job_update = time(NULL);
+	job_set_last_update(job_ptr, time(NULL));
 	job_ptr->end_time = last_job_update;
 	if (hold_job)
 		job_ptr->priority = 0;
@@ -4038,6 +4040,7 @@ static int _create_bufs(job_record_t *job_ptr, bb_job_t *bb_job,
 				      job_ptr, job_ptr->user_id,
 				      buf_ptr->name, bb_alloc->user_id);
 				job_ptr->priority = 0;
+				job_set_last_update(job_ptr, time(NULL));
 				job_ptr->state_reason = FAIL_BURST_BUFFER_OP;
 				xfree(job_ptr->state_desc);
 				job_ptr->state_desc = xstrdup(
@@ -4107,6 +4110,7 @@ static int _create_bufs(job_record_t *job_ptr, bb_job_t *bb_job,
 					   "denied",
 					   plugin_type, buf_ptr->name);
 				job_ptr->priority = 0;  /* Hold job */
+				job_set_last_update(job_ptr, time(NULL));
 				continue;
 			}
 
@@ -4337,6 +4341,7 @@ static void *_create_persistent(void *x)
 		} else {
 			job_ptr->state_reason = FAIL_BAD_CONSTRAINTS;
 			job_ptr->priority = 0;
+			job_set_last_update(job_ptr, time(NULL));
 			xfree(job_ptr->state_desc);
 			xstrfmtcat(job_ptr->state_desc, "%s",
 				   resp_msg);
@@ -1587,6 +1587,7 @@ static void _fail_stage(stage_args_t *stage_args, const char *op,
 	xstrfmtcat(job_ptr->state_desc, "%s: %s: %s",
 		   plugin_type, op, resp_msg);
 	job_ptr->priority = 0; /* Hold job */
+	job_set_last_update(job_ptr, time(NULL));
 	if (bb_state.bb_config.flags & BB_FLAG_TEARDOWN_FAILURE) {
 		bb_job = bb_job_find(&bb_state, job_ptr->job_id);
 		if (bb_job)
@@ -2110,6 +2111,7 @@ static bb_job_t *_get_bb_job(job_record_t *job_ptr)
 			   "%s: Invalid burst buffer spec (%s)",
 			   plugin_type, job_ptr->burst_buffer);
 		job_ptr->priority = 0;
+		job_set_last_update(job_ptr, time(NULL));
 		info("Invalid burst buffer spec for %pJ (%s)",
 		     job_ptr, job_ptr->burst_buffer);
 		bb_job_del(&bb_state, job_ptr->job_id);
@@ -3623,7 +3625,7 @@ fini:	xfree(data_buf);
 /* Kill job from CONFIGURING state */
 static void _kill_job(job_record_t *job_ptr, bool hold_job)
 {
-	last_job_update = time(NULL);
+	job_set_last_update(job_ptr, time(NULL));
 	job_ptr->end_time = last_job_update;
 	if (hold_job)
 		job_ptr->priority = 0;
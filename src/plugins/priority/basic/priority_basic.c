@@ -216,10 +216,10 @@ extern void priority_p_job_end(job_record_t *job_ptr)
 		slurmdb_used_limits_t *used_limits_u = NULL;
 
 		used_limits_a = acct_policy_get_acct_used_limits(
-			&qos_ptr->usage->acct_limit_list,
+			qos_ptr->usage,
 			job_ptr->assoc_ptr->acct);
 		used_limits_u = acct_policy_get_user_used_limits(
-			&qos_ptr->usage->user_limit_list,
+			qos_ptr->usage,
 			job_ptr->user_id);
 
 		for (i=0; i<slurmctld_tres_cnt; i++) {
@@ -68,7 +68,7 @@ extern void fair_tree_decay(list_t *jobs, time_t start)
 
 	/* assign job priorities */
 	lock_slurmctld(job_write_lock);
-	list_for_each(jobs, (ListForF) decay_apply_weighted_factors, &start);
+	decay_apply_weighted_factors_list(jobs, &start);
 	unlock_slurmctld(job_write_lock);
 }
 
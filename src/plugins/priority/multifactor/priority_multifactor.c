@@ -76,6 +76,8 @@
 #define SECS_PER_DAY	(24 * 60 * 60)
 #define SECS_PER_WEEK	(7 * SECS_PER_DAY)
 
+#define MAX_DECAY_THREADS 64
+
 /* These are defined here so when we link with something other than
  * the slurmctld we will have these symbols defined.  They will get
  * overwritten when linking with the slurmctld.
@@ -150,6 +152,22 @@ static uint32_t flags;       /* Priority Flags */
 static time_t g_last_ran = 0; /* when the last poll ran */
 static time_t g_last_reset = 0; /* when the last reset was done */
 static double decay_factor = 1; /* The decay factor when decaying time. */
+static int decay_threads = 1; /* threads recalculating job priorities */
+
+typedef struct {
+	job_record_t **jobs;
+	int job_cnt;
+	int job_size;
+	time_t start_time;
+} decay_jobs_t;
+
+typedef struct {
+	bool changed; /* a job priority changed */
+	int job_cnt;
+	job_record_t **jobs;
+	time_t start_time;
+	pthread_t tid;
+} decay_shard_t;
 
 /* variables defined in priority_multifactor.h */
 
@@ -531,6 +549,7 @@ static double _get_tres_prio_weighted(double *tres_factors)
 }
 
 typedef struct {
+	bool changed;
 	int *counter;
 	job_record_t *job_ptr;
 	char *multi_part_str;
@@ -584,11 +603,14 @@ static int _priority_each_partition(void *object, void *arg)
 		tmp_64 = 0xffffffff;
 		priority_part = (double) tmp_64;
 	}
-	if (((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
-	    (job_ptr->part_prio->priority_array[*counter] <
+	if ((((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
+	     (job_ptr->part_prio->priority_array[*counter] <
+	      (uint32_t) priority_part)) &&
+	    (job_ptr->part_prio->priority_array[*counter] !=
 	     (uint32_t) priority_part)) {
 		job_ptr->part_prio->priority_array[*counter] =
 			(uint32_t) priority_part;
+		args->changed = true;
 	}
 	if (slurm_conf.debug_flags & DEBUG_FLAG_PRIO) {
 		xstrfmtcat(multi_part_str, multi_part_str ?
@@ -600,9 +622,14 @@ static int _priority_each_partition(void *object, void *arg)
 }
 
 
-/* Returns the priority after applying the weight factors */
+/*
+ * Returns the priority after applying the weight factors
+ * OUT part_changed - set to true if any per partition priority changed,
+ *	may be NULL
+ */
 static uint32_t _get_priority_internal(time_t start_time,
-				       job_record_t *job_ptr)
+				       job_record_t *job_ptr,
+				       bool *part_changed)
 {
 	double priority	= 0.0;
 	priority_factors_t pre_factors;
@@ -718,11 +745,14 @@ static uint32_t _get_priority_internal(time_t start_time,
 		}
 
 		i = 0;
+		arg.changed = false;
 		arg.job_ptr = job_ptr,
 		arg.multi_part_str = multi_part_str,
 		arg.counter = &i,
 		list_for_each(job_ptr->part_ptr_list, _priority_each_partition,
 			      &arg);
+		if (part_changed && arg.changed)
+			*part_changed = true;
 
 		log_flag(PRIO, "%pJ multi-partition priorities: %s",
 			 job_ptr, multi_part_str);
@@ -792,6 +822,34 @@ static uint32_t _get_priority_internal(time_t start_time,
 }
 
 
+/*
+ * Recalculate the priority of one job.
+ * Only touches job_ptr, so it may run for different jobs in parallel.
+ * RET true if the priority of the job (or any of its partitions) changed
+ */
+static bool _apply_weighted_factors(job_record_t *job_ptr, time_t start_time)
+{
+	uint32_t new_prio;
+	bool changed = false;
+
+	new_prio = _get_priority_internal(start_time, job_ptr, &changed);
+	if ((((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
+	     (job_ptr->priority < new_prio)) &&
+	    (job_ptr->priority != new_prio)) {
+		job_ptr->priority = new_prio;
+		changed = true;
+	}
+
+	/* Don't invalidate cached job info if nothing changed */
+	if (changed)
+		job_ptr->last_update = time(NULL);
+
+	debug2("priority for job %u is now %u",
+	       job_ptr->job_id, job_ptr->priority);
+
+	return changed;
+}
+
 /* based upon the last reset time, compute when the next reset should be */
 static time_t _next_reset(uint16_t reset_period, time_t last_reset)
 {
@@ -866,9 +924,9 @@ static void _handle_qos_tres_run_secs(long double *tres_run_decay,
 		return;
 
 	used_limits_a = acct_policy_get_acct_used_limits(
-		&qos->usage->acct_limit_list, job_ptr->assoc_ptr->acct);
+		qos->usage, job_ptr->assoc_ptr->acct);
 	used_limits_u = acct_policy_get_user_used_limits(
-		&qos->usage->user_limit_list, job_ptr->user_id);
+		qos->usage, job_ptr->user_id);
 
 	for (i=0; i<slurmctld_tres_cnt; i++) {
 		if (i == TRES_ARRAY_ENERGY)
@@ -1298,6 +1356,143 @@ static int _decay_apply_new_usage_and_weighted_factors(job_record_t *job_ptr,
 	return SLURM_SUCCESS;
 }
 
+/* Return true if decay_apply_weighted_factors() would recalculate the job */
+static bool _need_weighted_factors(job_record_t *job_ptr)
+{
+	/*
+	 * Priority 0 is reserved for held jobs. Also skip priority
+	 * re_calculation for non-pending jobs.
+	 */
+	if ((job_ptr->priority == 0) ||
+	    IS_JOB_POWER_UP_NODE(job_ptr) ||
+	    (!IS_JOB_PENDING(job_ptr) &&
+	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING)))
+		return false;
+
+	return true;
+}
+
+static void _add_decay_job(decay_jobs_t *djobs, job_record_t *job_ptr)
+{
+	if (!_need_weighted_factors(job_ptr))
+		return;
+
+	if (djobs->job_cnt >= djobs->job_size) {
+		djobs->job_size = MAX(1024, (djobs->job_size * 2));
+		xrecalloc(djobs->jobs, djobs->job_size, sizeof(*djobs->jobs));
+	}
+
+	djobs->jobs[djobs->job_cnt++] = job_ptr;
+}
+
+static int _decay_apply_new_usage_and_add(void *x, void *arg)
+{
+	job_record_t *job_ptr = x;
+	decay_jobs_t *djobs = arg;
+
+	if (decay_apply_new_usage(job_ptr, &djobs->start_time))
+		_add_decay_job(djobs, job_ptr);
+
+	return SLURM_SUCCESS;
+}
+
+static int _add_decay_job_foreach(void *x, void *arg)
+{
+	_add_decay_job(arg, x);
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Calculate the usage_efctv that _get_fairshare_priority() would otherwise
+ * fill in on demand under a read lock, so the shard threads only read the
+ * association tree.
+ */
+static void _set_decay_jobs_usage_efctv(decay_jobs_t *djobs)
+{
+	assoc_mgr_lock_t locks = { .assoc = WRITE_LOCK };
+
+	if (!calc_fairshare || !weight_fs)
+		return;
+
+	assoc_mgr_lock(&locks);
+	for (int i = 0; i < djobs->job_cnt; i++) {
+		slurmdb_assoc_rec_t *fs_assoc = djobs->jobs[i]->assoc_ptr;
+
+		if (!fs_assoc)
+			continue;
+		if (fs_assoc->shares_raw == SLURMDB_FS_USE_PARENT)
+			fs_assoc = fs_assoc->usage->fs_assoc_ptr;
+		if (fuzzy_equal(fs_assoc->usage->usage_efctv, NO_VAL))
+			priority_p_set_assoc_usage(fs_assoc);
+	}
+	assoc_mgr_unlock(&locks);
+}
+
+static void *_decay_shard_thread(void *arg)
+{
+	decay_shard_t *shard = arg;
+
+	for (int i = 0; i < shard->job_cnt; i++)
+		if (_apply_weighted_factors(shard->jobs[i], shard->start_time))
+			shard->changed = true;
+
+	return NULL;
+}
+
+/*
+ * Recalculate the priority of every job collected in djobs, splitting them
+ * over decay_threads threads. Only jobs whose priority changed get a new
+ * last_update, and last_job_update is only moved once all shards are done.
+ * NOTE: Caller must hold the job write lock and part read lock.
+ */
+static void _apply_weighted_factors_jobs(decay_jobs_t *djobs)
+{
+	int shard_cnt = MIN(decay_threads, djobs->job_cnt);
+	decay_shard_t shards[MAX_DECAY_THREADS] = {{ 0 }};
+	int per_shard;
+	bool changed = false;
+	DEF_TIMERS;
+
+	if (!djobs->job_cnt)
+		return;
+
+	START_TIMER;
+	if (shard_cnt <= 1) {
+		shards[0].jobs = djobs->jobs;
+		shards[0].job_cnt = djobs->job_cnt;
+		shards[0].start_time = djobs->start_time;
+		_decay_shard_thread(&shards[0]);
+		changed = shards[0].changed;
+		goto done;
+	}
+
+	_set_decay_jobs_usage_efctv(djobs);
+
+	per_shard = (djobs->job_cnt + shard_cnt - 1) / shard_cnt;
+	for (int i = 0; i < shard_cnt; i++) {
+		int offset = i * per_shard;
+
+		shards[i].jobs = &djobs->jobs[offset];
+		shards[i].job_cnt = MIN(per_shard, (djobs->job_cnt - offset));
+		shards[i].start_time = djobs->start_time;
+		slurm_thread_create(&shards[i].tid, _decay_shard_thread,
+				    &shards[i]);
+	}
+
+	for (int i = 0; i < shard_cnt; i++) {
+		slurm_thread_join(shards[i].tid);
+		changed |= shards[i].changed;
+	}
+
+done:
+	if (changed)
+		last_job_update = time(NULL);
+	END_TIMER;
+	log_flag(PRIO, "recalculated priority of %d jobs with %d threads in %s",
+		 djobs->job_cnt, MAX(shard_cnt, 1), TIME_STR);
+}
+
 
 static void *_decay_thread(void *no_data)
 {
@@ -1427,11 +1622,16 @@ static void *_decay_thread(void *no_data)
 		site_factor_g_update();
 
 		if (!(flags & PRIORITY_FLAGS_FAIR_TREE)) {
-			list_for_each(
-				job_list,
-				(ListForF) _decay_apply_new_usage_and_weighted_factors,
-				&start_time
-				);
+			decay_jobs_t djobs = { .start_time = start_time };
+
+			/*
+			 * Apply all new usage before recalculating any job
+			 * priority so every job sees the same usage.
+			 */
+			list_for_each(job_list, _decay_apply_new_usage_and_add,
+				      &djobs);
+			_apply_weighted_factors_jobs(&djobs);
+			xfree(djobs.jobs);
 		}
 
 		unlock_slurmctld(job_write_lock);
@@ -1503,6 +1703,8 @@ static priority_factors_object_t *_create_prio_factors_obj(
 
 static void _internal_setup(void)
 {
+	char *tmp_ptr;
+
 	damp_factor = (long double) slurm_conf.fs_dampening_factor;
 	max_age = slurm_conf.priority_max_age;
 	weight_age = slurm_conf.priority_weight_age;
@@ -1516,6 +1718,17 @@ static void _internal_setup(void)
 		slurm_conf.priority_weight_tres, slurmctld_tres_cnt, true);
 	flags = slurm_conf.priority_flags;
 
+	decay_threads = 1;
+	if ((tmp_ptr = xstrcasestr(slurm_conf.priority_params,
+				   "decay_threads="))) {
+		decay_threads = atoi(tmp_ptr + strlen("decay_threads="));
+		if ((decay_threads < 1) ||
+		    (decay_threads > MAX_DECAY_THREADS)) {
+			error("Invalid PriorityParameters decay_threads, using 1");
+			decay_threads = 1;
+		}
+	}
+
 	log_flag(PRIO, "priority: Damp Factor is %u", damp_factor);
 	log_flag(PRIO, "priority: AccountingStorageEnforce is %u",
 		 slurm_conf.accounting_storage_enforce);
@@ -1527,6 +1740,7 @@ static void _internal_setup(void)
 	log_flag(PRIO, "priority: Weight Part is %u", weight_part);
 	log_flag(PRIO, "priority: Weight QOS is %u", weight_qos);
 	log_flag(PRIO, "priority: Flags is %u", flags);
+	log_flag(PRIO, "priority: Decay threads is %d", decay_threads);
 }
 
 
@@ -1807,7 +2021,7 @@ extern uint32_t priority_p_set(uint32_t last_prio, job_record_t *job_ptr)
 	 */
 	site_factor_g_set(job_ptr);
 
-	priority = _get_priority_internal(time(NULL), job_ptr);
+	priority = _get_priority_internal(time(NULL), job_ptr, NULL);
 
 	debug2("initial priority for job %u is %u", job_ptr->job_id, priority);
 
@@ -2022,34 +2236,28 @@ extern bool decay_apply_new_usage(job_record_t *job_ptr,
 extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 					time_t *start_time_ptr)
 {
-	uint32_t new_prio;
-
 	/* Always return SUCCESS so that list_for_each will
 	 * continue processing list of jobs. */
 
-	/*
-	 * Priority 0 is reserved for held jobs. Also skip priority
-	 * re_calculation for non-pending jobs.
-	 */
-	if ((job_ptr->priority == 0) ||
-	    IS_JOB_POWER_UP_NODE(job_ptr) ||
-	    (!IS_JOB_PENDING(job_ptr) &&
-	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING)))
+	if (!_need_weighted_factors(job_ptr))
 		return SLURM_SUCCESS;
 
-	new_prio = _get_priority_internal(*start_time_ptr, job_ptr);
-	if (((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
-	    (job_ptr->priority < new_prio)) {
-		job_ptr->priority = new_prio;
-		last_job_update = time(NULL);
-	}
-
-	debug2("priority for job %u is now %u",
-	       job_ptr->job_id, job_ptr->priority);
+	if (_apply_weighted_factors(job_ptr, *start_time_ptr))
+		last_job_update = job_ptr->last_update;
 
 	return SLURM_SUCCESS;
 }
 
+extern void decay_apply_weighted_factors_list(list_t *jobs,
+					      time_t *start_time_ptr)
+{
+	decay_jobs_t djobs = { .start_time = *start_time_ptr };
+
+	list_for_each(jobs, _add_decay_job_foreach, &djobs);
+	_apply_weighted_factors_jobs(&djobs);
+	xfree(djobs.jobs);
+}
+
 extern uint32_t priority_p_recover(uint32_t prio_boost)
 {
 	time_t start_time;
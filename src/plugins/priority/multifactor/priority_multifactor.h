@@ -56,6 +56,13 @@ extern bool decay_apply_new_usage(job_record_t *job_ptr,
 				  time_t *start_time_ptr);
 extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 					time_t *start_time_ptr);
+/*
+ * Recalculate the priority of every job in jobs that needs it, spread over
+ * PriorityParameters=decay_threads threads.
+ * NOTE: Caller must hold the job write lock and part read lock.
+ */
+extern void decay_apply_weighted_factors_list(list_t *jobs,
+					      time_t *start_time_ptr);
 extern void set_assoc_usage_norm(slurmdb_assoc_rec_t *assoc);
 extern void set_priority_factors(time_t start_time, job_record_t *job_ptr);
 
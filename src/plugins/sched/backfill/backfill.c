@@ -123,6 +123,7 @@
 #define MAX_BF_MAX_TIME                3600
 #define MAX_BF_MIN_AGE_RESERVE         (30 * 24 * 60 * 60) /* 30 days */
 #define MAX_BF_MIN_PRIO_RESERVE        INFINITE
+#define MAX_BF_THREADS                 256
 #define MAX_BF_YIELD_INTERVAL          10000000 /* 10 seconds in usec */
 #define MAX_MAX_RPC_CNT                1000
 #define MAX_YIELD_SLEEP                10000000 /* 10 seconds in usec */
@@ -136,6 +137,7 @@ typedef struct {
 	time_t begin_time;
 	time_t end_time;
 	bitstr_t *avail_bitmap;
+	int avail_cnt;	/* bit_set_count(avail_bitmap) or -1 if not known */
 	bf_licenses_t *licenses;
 	int next;	/* next record, by time, zero termination */
 } node_space_map_t;
@@ -145,6 +147,24 @@ typedef struct {
 	int *node_space_recs;
 } node_space_handler_t;
 
+/*
+ * Speculative _try_sched() result for a queued job, see _try_sched_spec().
+ * The result is only used if the job is later tested with the same inputs.
+ */
+typedef struct {
+	job_record_t *job_ptr;
+	part_record_t *part_ptr;
+	uint32_t min_nodes;
+	uint32_t max_nodes;
+	uint32_t req_nodes;
+	bitstr_t *avail_bitmap;		/* nodes offered to _try_sched() */
+	bitstr_t *select_bitmap;	/* nodes returned by _try_sched() */
+	int rc;				/* _try_sched() return code */
+	time_t start_time;		/* job_ptr->start_time from test */
+	uint32_t total_cpus;		/* job_ptr->total_cpus from test */
+	bool used;
+} bf_spec_t;
+
 /*
  * HetJob scheduling structures
  * NOTE: An individial hetjob component can be submitted to multiple
@@ -224,6 +244,23 @@ static xhash_t *user_usage_map = NULL; /* look up user usage when no assoc */
 static bitstr_t *planned_bitmap = NULL;
 static bool soft_time_limit = false;
 
+/* Speculative job tests, see bf_threads */
+static int bf_threads = 1;
+static pthread_mutex_t spec_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t spec_work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t spec_done_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t *spec_tids = NULL;
+static int spec_tid_cnt = 0;
+static bool spec_shutdown = false;
+static bf_spec_t *spec_recs = NULL;
+static int spec_rec_cnt = 0;		/* records in current batch */
+static int spec_run_cnt = 0;		/* records handed out to workers */
+static int spec_next = 0;		/* next record to be tested */
+static int spec_done = 0;		/* records tested */
+static bitstr_t *spec_busy_bitmap = NULL; /* nodes used since batch built */
+static uint32_t spec_test_cnt = 0;
+static uint32_t spec_use_cnt = 0;
+
 /*********************** local functions *********************/
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     bitstr_t *res_bitmap, job_record_t *job_ptr,
@@ -303,6 +340,18 @@ static void _dump_job_test(job_record_t *job_ptr, bitstr_t *avail_bitmap,
 	xfree(node_list);
 }
 
+/*
+ * Return count of nodes available in a node_space record. The count is
+ * computed on first use and kept until the record's avail_bitmap changes,
+ * so records a job can not fit in are rejected without bitmap operations.
+ */
+static int _ns_avail_cnt(node_space_map_t *ns)
+{
+	if (ns->avail_cnt < 0)
+		ns->avail_cnt = bit_set_count(ns->avail_bitmap);
+	return ns->avail_cnt;
+}
+
 /* Log resource allocate table */
 static void _dump_node_space_table(node_space_map_t *node_space_ptr)
 {
@@ -649,6 +698,389 @@ static int  _try_sched(job_record_t *job_ptr, bitstr_t **avail_bitmap,
 	return rc;
 }
 
+/*
+ * Test if the select plugin can be called for this job from several threads
+ * at once. Jobs which use features, GRES, licenses or reservations touch
+ * shared state while being tested and are always tested serially.
+ */
+static bool _spec_job_ok(job_record_t *job_ptr, part_record_t *part_ptr)
+{
+	job_details_t *detail_ptr = job_ptr->details;
+
+	if (!detail_ptr || detail_ptr->feature_list ||
+	    detail_ptr->prefer_list || detail_ptr->feature_list_use)
+		return false;
+	if (job_ptr->het_job_id || job_ptr->array_recs ||
+	    job_ptr->part_ptr_list || (job_ptr->part_ptr != part_ptr) ||
+	    job_ptr->resv_name || job_ptr->resv_list || job_ptr->resv_ptr ||
+	    job_ptr->gres_list_req || job_ptr->license_list ||
+	    job_ptr->time_min || IS_JOB_WHOLE_TOPO(job_ptr) ||
+	    (job_ptr->deadline && (job_ptr->deadline != NO_VAL)))
+		return false;
+	/* The select plugin reorders rows of oversubscribed partitions */
+	if ((part_ptr->max_share & ~SHARED_FORCE) > 1)
+		return false;
+
+	return true;
+}
+
+static bool _spec_resv_exc_empty(resv_exc_t *resv_exc_ptr)
+{
+	return (!resv_exc_ptr->core_bitmap && !resv_exc_ptr->exc_cores &&
+		!resv_exc_ptr->gres_list_exc && !resv_exc_ptr->gres_list_inc);
+}
+
+static void _spec_clear(void)
+{
+	for (int i = 0; i < spec_rec_cnt; i++) {
+		FREE_NULL_BITMAP(spec_recs[i].avail_bitmap);
+		FREE_NULL_BITMAP(spec_recs[i].select_bitmap);
+	}
+	spec_rec_cnt = 0;
+}
+
+/* Run one speculative test, the job is left as it was found */
+static void _spec_test(bf_spec_t *spec)
+{
+	job_record_t *job_ptr = spec->job_ptr;
+	time_t save_start_time = job_ptr->start_time;
+	uint32_t save_total_cpus = job_ptr->total_cpus;
+	resv_exc_t resv_exc = { 0 };
+
+	spec->select_bitmap = bit_copy(spec->avail_bitmap);
+	job_ptr->bit_flags |= BACKFILL_TEST;
+	spec->rc = _try_sched(job_ptr, &spec->select_bitmap, spec->min_nodes,
+			      spec->max_nodes, spec->req_nodes, &resv_exc);
+	job_ptr->bit_flags &= ~BACKFILL_TEST;
+	spec->start_time = job_ptr->start_time;
+	spec->total_cpus = job_ptr->total_cpus;
+	job_ptr->start_time = save_start_time;
+	job_ptr->total_cpus = save_total_cpus;
+}
+
+/*
+ * Worker for speculative tests. Runs while the backfill thread holds the
+ * slurmctld locks and waits in _spec_run() for the batch to finish, so it
+ * must not take any locks itself.
+ */
+static void *_spec_agent(void *args)
+{
+	bf_spec_t *spec;
+
+#if HAVE_SYS_PRCTL_H
+	if (prctl(PR_SET_NAME, "bckfl_spec", NULL, NULL, NULL) < 0) {
+		error("cannot set my name to %s %m", "bckfl_spec");
+	}
+#endif
+	slurm_mutex_lock(&spec_lock);
+	while (!spec_shutdown) {
+		if (spec_next >= spec_run_cnt) {
+			slurm_cond_wait(&spec_work_cond, &spec_lock);
+			continue;
+		}
+		spec = &spec_recs[spec_next++];
+		slurm_mutex_unlock(&spec_lock);
+		_spec_test(spec);
+		slurm_mutex_lock(&spec_lock);
+		if (++spec_done == spec_run_cnt)
+			slurm_cond_signal(&spec_done_cond);
+	}
+	slurm_mutex_unlock(&spec_lock);
+
+	return NULL;
+}
+
+static void _spec_stop_threads(void)
+{
+	_spec_clear();
+
+	slurm_mutex_lock(&spec_lock);
+	spec_shutdown = true;
+	slurm_cond_broadcast(&spec_work_cond);
+	slurm_mutex_unlock(&spec_lock);
+
+	for (int i = 0; i < spec_tid_cnt; i++)
+		slurm_thread_join(spec_tids[i]);
+	xfree(spec_tids);
+	spec_tid_cnt = 0;
+	xfree(spec_recs);
+	FREE_NULL_BITMAP(spec_busy_bitmap);
+	spec_shutdown = false;
+}
+
+/* Start (bf_threads - 1) workers, the backfill thread is the last one */
+static void _spec_start_threads(void)
+{
+	if (spec_tid_cnt == (bf_threads - 1))
+		return;
+
+	_spec_stop_threads();
+	if (bf_threads <= 1)
+		return;
+
+	spec_recs = xcalloc(bf_threads, sizeof(*spec_recs));
+	spec_tids = xcalloc(bf_threads - 1, sizeof(*spec_tids));
+	for (spec_tid_cnt = 0; spec_tid_cnt < (bf_threads - 1);
+	     spec_tid_cnt++)
+		slurm_thread_create(&spec_tids[spec_tid_cnt], _spec_agent,
+				    NULL);
+}
+
+/*
+ * Record nodes whose state may have changed since the current batch was
+ * built. Results for jobs offered any of these nodes are not used.
+ */
+static void _spec_busy(job_record_t *job_ptr, bitstr_t *resv_bitmap,
+		       int rc)
+{
+	if (!spec_rec_cnt)
+		return;
+
+	if ((rc == SLURM_SUCCESS) && job_ptr->node_bitmap)
+		bit_or(spec_busy_bitmap, job_ptr->node_bitmap);
+	else
+		bit_or_not(spec_busy_bitmap, resv_bitmap);
+}
+
+/*
+ * Compute the nodes the job would be offered by _attempt_backfill() on its
+ * first test against the current node_space table. Returns false if the job
+ * would not reach _try_sched() or would not do so with these inputs.
+ */
+static bool _spec_prepare(bf_spec_t *spec, job_queue_rec_t *job_queue_rec,
+			  node_space_map_t *node_space, time_t now,
+			  time_t window_end)
+{
+	job_record_t *job_ptr = job_queue_rec->job_ptr;
+	part_record_t *part_ptr = job_queue_rec->part_ptr;
+	uint32_t min_nodes, max_nodes, req_nodes, qos_flags = 0;
+	uint32_t time_limit, end_time, save_reason;
+	char *save_desc;
+	time_t start_res = now;
+	bool resv_overlap = false;
+	bitstr_t *avail_bitmap = NULL;
+	resv_exc_t resv_exc = { 0 };
+	int rc;
+	assoc_mgr_lock_t qos_read_lock = {
+		.qos = READ_LOCK,
+	};
+
+	if (job_queue_rec->resv_ptr || job_queue_rec->use_prefer ||
+	    !part_ptr || !IS_JOB_PENDING(job_ptr) || !job_ptr->priority ||
+	    !_spec_job_ok(job_ptr, part_ptr))
+		return false;
+	if (((part_ptr->state_up & PARTITION_SCHED) == 0) ||
+	    !part_ptr->node_bitmap)
+		return false;
+
+	assoc_mgr_lock(&qos_read_lock);
+	if (job_ptr->qos_ptr)
+		qos_flags = job_ptr->qos_ptr->flags;
+	assoc_mgr_unlock(&qos_read_lock);
+
+	/* A failure here sets the job's reason, leave that to the real test */
+	save_reason = job_ptr->state_reason;
+	save_desc = job_ptr->state_desc;
+	job_ptr->state_desc = NULL;
+	rc = get_node_cnts(job_ptr, qos_flags, part_ptr, &min_nodes,
+			   &req_nodes, &max_nodes);
+	xfree(job_ptr->state_desc);
+	job_ptr->state_desc = save_desc;
+	job_ptr->state_reason = save_reason;
+	if (rc != SLURM_SUCCESS)
+		return false;
+
+	if ((job_ptr->time_limit == NO_VAL) ||
+	    (job_ptr->time_limit == INFINITE)) {
+		if (part_ptr->max_time == INFINITE)
+			time_limit = YEAR_MINUTES;
+		else
+			time_limit = part_ptr->max_time;
+	} else if (part_ptr->max_time == INFINITE) {
+		time_limit = job_ptr->time_limit;
+	} else {
+		time_limit = MIN(job_ptr->time_limit, part_ptr->max_time);
+	}
+
+	if (job_test_resv(job_ptr, &start_res, true, &avail_bitmap,
+			  &resv_exc, &resv_overlap, false) != SLURM_SUCCESS)
+		goto fail;
+	if (!_spec_resv_exc_empty(&resv_exc) || (window_end < start_res))
+		goto fail;
+
+	end_time = (time_limit * 60) + MAX(start_res, now);
+	if (end_time < now)	/* Overflow 32-bits */
+		end_time = INFINITE;
+
+	bit_and(avail_bitmap, part_ptr->node_bitmap);
+	bit_and(avail_bitmap, up_node_bitmap);
+	bit_and_not(avail_bitmap, bf_ignore_node_bitmap);
+	filter_by_node_owner(job_ptr, avail_bitmap);
+	filter_by_node_mcs(job_ptr, slurm_mcs_get_select(job_ptr),
+			   avail_bitmap);
+	for (int j = 0; ; ) {
+		if (node_space[j].end_time <= start_res)
+			;
+		else if (node_space[j].begin_time <= end_time) {
+			if (_ns_avail_cnt(&node_space[j]) < min_nodes)
+				goto fail;
+			bit_and(avail_bitmap, node_space[j].avail_bitmap);
+		} else
+			break;
+		if ((j = node_space[j].next) == 0)
+			break;
+	}
+	if (job_ptr->details->exc_node_bitmap)
+		bit_and_not(avail_bitmap, job_ptr->details->exc_node_bitmap);
+
+	if ((bit_set_count(avail_bitmap) < min_nodes) ||
+	    (job_ptr->details->req_node_bitmap &&
+	     !bit_super_set(job_ptr->details->req_node_bitmap,
+			    avail_bitmap)) ||
+	    job_req_node_filter(job_ptr, avail_bitmap, true))
+		goto fail;
+
+	*spec = (bf_spec_t) {
+		.job_ptr = job_ptr,
+		.part_ptr = part_ptr,
+		.min_nodes = min_nodes,
+		.max_nodes = max_nodes,
+		.req_nodes = req_nodes,
+		.avail_bitmap = avail_bitmap,
+	};
+	reservation_delete_resv_exc_parts(&resv_exc);
+	return true;
+
+fail:
+	FREE_NULL_BITMAP(avail_bitmap);
+	reservation_delete_resv_exc_parts(&resv_exc);
+	return false;
+}
+
+/* Test all records of the batch, using this thread as one of the workers */
+static void _spec_run(void)
+{
+	bf_spec_t *spec;
+
+	slurm_mutex_lock(&spec_lock);
+	spec_next = 0;
+	spec_done = 0;
+	spec_run_cnt = spec_rec_cnt;
+	slurm_cond_broadcast(&spec_work_cond);
+	while (spec_next < spec_run_cnt) {
+		spec = &spec_recs[spec_next++];
+		slurm_mutex_unlock(&spec_lock);
+		_spec_test(spec);
+		slurm_mutex_lock(&spec_lock);
+		spec_done++;
+	}
+	while (spec_done < spec_run_cnt)
+		slurm_cond_wait(&spec_done_cond, &spec_lock);
+	spec_next = spec_run_cnt = 0;
+	slurm_mutex_unlock(&spec_lock);
+}
+
+static bf_spec_t *_spec_find(job_record_t *job_ptr, part_record_t *part_ptr,
+			     bitstr_t *avail_bitmap, uint32_t min_nodes,
+			     uint32_t max_nodes, uint32_t req_nodes)
+{
+	for (int i = 1; i < spec_rec_cnt; i++) {
+		bf_spec_t *spec = &spec_recs[i];
+
+		if (spec->job_ptr != job_ptr)
+			continue;
+		if (spec->used || (spec->part_ptr != part_ptr) ||
+		    (spec->min_nodes != min_nodes) ||
+		    (spec->max_nodes != max_nodes) ||
+		    (spec->req_nodes != req_nodes) ||
+		    !bit_equal(spec->avail_bitmap, avail_bitmap) ||
+		    bit_overlap_any(spec->avail_bitmap, spec_busy_bitmap))
+			return NULL;
+		return spec;
+	}
+
+	return NULL;
+}
+
+static int _spec_use(bf_spec_t *spec, bitstr_t **avail_bitmap)
+{
+	spec->used = true;
+	spec->job_ptr->start_time = spec->start_time;
+	spec->job_ptr->total_cpus = spec->total_cpus;
+	FREE_NULL_BITMAP(*avail_bitmap);
+	*avail_bitmap = spec->select_bitmap;
+	spec->select_bitmap = NULL;
+
+	return spec->rc;
+}
+
+/*
+ * Same as _try_sched(), but with bf_threads also test the jobs following this
+ * one in job_queue, in parallel, against the current node_space table. When
+ * one of those jobs is reached and would be offered the same nodes, with
+ * none of them allocated in the meantime, its result is used as is. Anything
+ * else, including lock yields, discards the speculative results.
+ */
+static int _try_sched_spec(job_record_t *job_ptr, part_record_t *part_ptr,
+			   bitstr_t **avail_bitmap, uint32_t min_nodes,
+			   uint32_t max_nodes, uint32_t req_nodes,
+			   resv_exc_t *resv_exc_ptr, list_t *job_queue,
+			   node_space_map_t *node_space, time_t window_end)
+{
+	list_itr_t *iter;
+	job_queue_rec_t *job_queue_rec;
+	bf_spec_t *spec;
+	time_t now = time(NULL);
+	int scan_cnt = 0;
+
+	if ((job_ptr->bit_flags & TEST_NOW_ONLY) ||
+	    !_spec_job_ok(job_ptr, part_ptr) ||
+	    !_spec_resv_exc_empty(resv_exc_ptr))
+		return _try_sched(job_ptr, avail_bitmap, min_nodes, max_nodes,
+				  req_nodes, resv_exc_ptr);
+
+	if ((spec = _spec_find(job_ptr, part_ptr, *avail_bitmap, min_nodes,
+			       max_nodes, req_nodes))) {
+		spec_use_cnt++;
+		return _spec_use(spec, avail_bitmap);
+	}
+
+	_spec_clear();
+	if (!spec_busy_bitmap ||
+	    (bit_size(spec_busy_bitmap) != node_record_count)) {
+		FREE_NULL_BITMAP(spec_busy_bitmap);
+		spec_busy_bitmap = bit_alloc(node_record_count);
+	} else {
+		bit_clear_all(spec_busy_bitmap);
+	}
+
+	spec_recs[0] = (bf_spec_t) {
+		.job_ptr = job_ptr,
+		.part_ptr = part_ptr,
+		.min_nodes = min_nodes,
+		.max_nodes = max_nodes,
+		.req_nodes = req_nodes,
+		.avail_bitmap = bit_copy(*avail_bitmap),
+	};
+	spec_rec_cnt = 1;
+
+	/* Bound the search for eligible jobs in deep queues */
+	iter = list_iterator_create(job_queue);
+	while ((spec_rec_cnt < bf_threads) &&
+	       (scan_cnt++ < (bf_threads * 4)) &&
+	       (job_queue_rec = list_next(iter))) {
+		if (_spec_prepare(&spec_recs[spec_rec_cnt], job_queue_rec,
+				  node_space, now, window_end))
+			spec_rec_cnt++;
+	}
+	list_iterator_destroy(iter);
+	spec_test_cnt += spec_rec_cnt - 1;
+
+	_spec_run();
+
+	return _spec_use(&spec_recs[0], avail_bitmap);
+}
+
 /* Terminate backfill_agent */
 extern void stop_backfill_agent(void)
 {
@@ -991,6 +1423,37 @@ static void _load_config(void)
 
 	if (xstrcasestr(sched_params, "time_min_as_soft_limit"))
 		soft_time_limit = true;
+
+	if ((tmp_ptr = xstrcasestr(sched_params, "bf_threads="))) {
+		bf_threads = atoi(tmp_ptr + 11);
+		if ((bf_threads < 1) || (bf_threads > MAX_BF_THREADS)) {
+			error("Invalid SchedulerParameters bf_threads: %d",
+			      bf_threads);
+			bf_threads = 1;
+		}
+	} else {
+		bf_threads = 1;
+	}
+	if (bf_threads > 1) {
+		int exclusive_topo = 0;
+		char *reason = NULL;
+
+		(void) topology_g_get(TOPO_DATA_EXCLUSIVE_TOPO,
+				      &exclusive_topo);
+		if (xstrcmp(slurm_conf.select_type, "select/cons_tres"))
+			reason = slurm_conf.select_type;
+		else if (slurm_conf.preempt_mode != PREEMPT_MODE_OFF)
+			reason = "PreemptMode";
+		else if (exclusive_topo)
+			reason = "exclusive topology";
+		else if (assoc_limit_stop)
+			reason = "assoc_limit_stop";
+		if (reason) {
+			error("SchedulerParameters bf_threads not supported with %s, using 1",
+			      reason);
+			bf_threads = 1;
+		}
+	}
 }
 
 /* Note that slurm.conf has changed */
@@ -1129,10 +1592,36 @@ extern void *backfill_agent(void *args)
 	FREE_NULL_LIST(het_job_list);
 	xhash_free(user_usage_map); /* May have been init'ed if used */
 	FREE_NULL_BITMAP(planned_bitmap);
+	_spec_stop_threads();
 
 	return NULL;
 }
 
+/*
+ * Run a single backfill cycle in the calling thread. backfill_agent() must
+ * not be running, state normally kept between cycles is rebuilt each time.
+ */
+extern void backfill_run_cycle(void)
+{
+	/* Read config and partitions; Write jobs and nodes */
+	slurmctld_lock_t all_locks = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK };
+
+	_load_config();
+	_init_planned_bitmap();
+	het_job_list = list_create(_het_job_map_del);
+
+	lock_slurmctld(all_locks);
+	_het_job_start_clear();
+	_attempt_backfill();
+	unlock_slurmctld(all_locks);
+
+	FREE_NULL_LIST(het_job_list);
+	xhash_free(user_usage_map);
+	FREE_NULL_BITMAP(planned_bitmap);
+	_spec_stop_threads();
+}
+
 /*
  * Clear the start_time and sched_nodes for all pending jobs. This is used to
  * ensure that a job which can run in multiple partitions has its start_time and
@@ -1161,6 +1650,7 @@ static int _yield_locks(int64_t usec)
 	int yield_rpc_cnt;
 
 	yield_rpc_cnt = MAX((max_rpc_cnt / 10), 20);
+	_spec_clear();	/* Anything can change while unlocked */
 	job_update  = last_job_update;
 	node_update = last_node_update;
 	part_update = last_part_update;
@@ -1798,6 +2288,9 @@ static void _attempt_backfill(void)
 	bf_sleep_usec = 0;
 	job_start_cnt = 0;
 	job_test_cnt = 0;
+	spec_test_cnt = 0;
+	spec_use_cnt = 0;
+	_spec_start_threads();
 
 	if (!fed_mgr_sibs_synced()) {
 		info("returning, federation siblings not synced yet");
@@ -1855,6 +2348,7 @@ static void _attempt_backfill(void)
 	node_space[0].avail_bitmap = bit_copy(avail_node_bitmap);
 	/* Make "resuming" nodes available to be scheduled in backfill */
 	bit_or(node_space[0].avail_bitmap, rs_node_bitmap);
+	node_space[0].avail_cnt = -1;
 
 	if (bf_licenses)
 		node_space[0].licenses =
@@ -1894,7 +2388,7 @@ static void _attempt_backfill(void)
 	while (1) {
 		uint32_t bf_job_priority, prio_reserve;
 		bool get_boot_time = false;
-		bool licenses_unavail;
+		bool licenses_unavail, nodes_unavail;
 		bool use_prefer = false;
 
 		/* Run some final guaranteed logic after each job iteration */
@@ -2058,12 +2552,12 @@ static void _attempt_backfill(void)
 				      job_ptr);
 				assoc_mgr_unlock(&locks);
 				job_fail_qos(job_ptr, __func__, false);
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 				continue;
 			} else if (job_ptr->state_reason == FAIL_QOS) {
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = WAIT_NO_REASON;
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 			}
 			assoc_mgr_unlock(&locks);
 		}
@@ -2428,6 +2922,7 @@ next_task:
 		resv_end = 0;
 		later_start = 0;
 		licenses_unavail = false;
+		nodes_unavail = false;
 		/*
 		 * Restore the original time limit before checking against
 		 * reservations, and revert it after.
@@ -2500,8 +2995,18 @@ next_task:
 			if (node_space[j].end_time <= start_res)
 				;
 			else if (node_space[j].begin_time <= end_time) {
-				bit_and(avail_bitmap,
-					node_space[j].avail_bitmap);
+				/*
+				 * With fewer than min_nodes in any record the
+				 * test below fails. Keep walking the records
+				 * for licenses and later_start, but once
+				 * later_start is set avail_bitmap is unused.
+				 */
+				if (!nodes_unavail &&
+				    (_ns_avail_cnt(&node_space[j]) < min_nodes))
+					nodes_unavail = true;
+				if (!nodes_unavail || !later_start)
+					bit_and(avail_bitmap,
+						node_space[j].avail_bitmap);
 				if (!bf_licenses_avail(node_space[j].licenses,
 						       job_ptr)) {
 					licenses_unavail = true;
@@ -2531,7 +3036,7 @@ next_task:
 		 *	nodes lack features OR
 		 *	no change since previously tested nodes (only changes
 		 *	in other partition nodes) */
-		if (licenses_unavail ||
+		if (licenses_unavail || nodes_unavail ||
 		    (bit_set_count(avail_bitmap) < min_nodes) ||
 		    ((job_ptr->details->req_node_bitmap) &&
 		     (!bit_super_set(job_ptr->details->req_node_bitmap,
@@ -2657,8 +3162,16 @@ next_task:
 		if (test_fini != 1) {
 			/* Either active_bitmap was NULL or not usable by the
 			 * job. Test using avail_bitmap instead */
-			j = _try_sched(job_ptr, &avail_bitmap, min_nodes,
-				       max_nodes, req_nodes, &resv_exc);
+			if ((test_fini == -1) && (bf_threads > 1))
+				j = _try_sched_spec(job_ptr, part_ptr,
+						    &avail_bitmap, min_nodes,
+						    max_nodes, req_nodes,
+						    &resv_exc, job_queue,
+						    node_space, window_end);
+			else
+				j = _try_sched(job_ptr, &avail_bitmap,
+					       min_nodes, max_nodes,
+					       req_nodes, &resv_exc);
 			if (test_fini == 0) {
 				job_ptr->details->share_res = save_share_res;
 				job_ptr->details->whole_node = save_whole_node;
@@ -2681,7 +3194,7 @@ next_task:
 
 		if (start_res > job_ptr->start_time) {
 			job_ptr->start_time = start_res;
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 		}
 		/*
 		 * avail_bitmap at this point contains a bitmap of nodes
@@ -2725,7 +3238,7 @@ next_task:
 				     job_state_reason_string(
 					     job_ptr->state_reason),
 				     job_ptr->priority);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			_set_job_time_limit(job_ptr, orig_time_limit);
 			later_start = 0;
 			if (bb == -1) {
@@ -3210,6 +3723,7 @@ skip_start:
 	FREE_NULL_BITMAP(avail_bitmap);
 	reservation_delete_resv_exc_parts(&resv_exc);
 	FREE_NULL_BITMAP(resv_bitmap);
+	_spec_clear();
 
 	for (i = 0; ; ) {
 		FREE_NULL_BITMAP(node_space[i].avail_bitmap);
@@ -3227,6 +3741,9 @@ skip_start:
 		info("completed testing %u(%d) jobs, %s",
 		     slurmctld_diag_stats.bf_last_depth,
 		     job_test_count, TIME_STR);
+		if (bf_threads > 1)
+			info("used %u of %u speculative job tests",
+			     spec_use_cnt, spec_test_cnt);
 	}
 
 	slurm_mutex_lock(&slurmctld_config.thread_count_lock);
@@ -3257,6 +3774,7 @@ static int _start_job(job_record_t *job_ptr, bitstr_t *resv_bitmap)
 		is_job_array_head = true;
 	rc = select_nodes(job_ptr, false, NULL, NULL, false,
 			  SLURMDB_JOB_FLAG_BACKFILL);
+	_spec_busy(job_ptr, resv_bitmap, rc);
 	if (is_job_array_head && job_ptr->details) {
 		job_record_t *base_job_ptr;
 		base_job_ptr = find_job_record(job_ptr->array_job_id);
@@ -3276,7 +3794,7 @@ static int _start_job(job_record_t *job_ptr, bitstr_t *resv_bitmap)
 		FREE_NULL_BITMAP(orig_exc_nodes);
 	if (rc == SLURM_SUCCESS) {
 		/* job initiated */
-		last_job_update = time(NULL);
+		job_set_last_update(job_ptr, time(NULL));
 		info("Started %pJ in %s on %s",
 		     job_ptr, job_ptr->part_ptr->name, job_ptr->nodes);
 		if (job_ptr->batch_flag == 0)
@@ -3382,6 +3900,7 @@ static void _reset_job_time_limit(job_record_t *job_ptr, time_t now,
 	if (orig_time_limit != job_ptr->time_limit) {
 		info("%pJ time limit changed from %u to %u",
 		     job_ptr, orig_time_limit, job_ptr->time_limit);
+		job_set_last_update(job_ptr, now);
 	}
 }
 
@@ -3441,6 +3960,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			node_space[j].end_time = start_time;
 			node_space[i].avail_bitmap =
 				bit_copy(node_space[j].avail_bitmap);
+			node_space[i].avail_cnt = node_space[j].avail_cnt;
 			node_space[i].licenses =
 				bf_licenses_copy(node_space[j].licenses);
 			node_space[i].next = node_space[j].next;
@@ -3468,6 +3988,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			node_space[j].end_time = end_reserve;
 			node_space[i].avail_bitmap =
 				bit_copy(node_space[j].avail_bitmap);
+			node_space[i].avail_cnt = node_space[j].avail_cnt;
 			node_space[i].licenses =
 				bf_licenses_copy(node_space[j].licenses);
 			node_space[i].next = node_space[j].next;
@@ -3478,6 +3999,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 		/* merge in new usage with this record */
 		if (res_bitmap) {
 			bit_and(node_space[j].avail_bitmap, res_bitmap);
+			node_space[j].avail_cnt = -1;
 			bf_licenses_deduct(node_space[j].licenses, job_ptr);
 		} else {
 			/* setting up reservation licenses */
@@ -3501,7 +4023,10 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			i = j;
 			continue;
 		}
-		if (!bit_equal(node_space[i].avail_bitmap,
+		if (((node_space[i].avail_cnt >= 0) &&
+		     (node_space[j].avail_cnt >= 0) &&
+		     (node_space[i].avail_cnt != node_space[j].avail_cnt)) ||
+		    !bit_equal(node_space[i].avail_bitmap,
 			       node_space[j].avail_bitmap)) {
 			i = j;
 			continue;
@@ -3528,7 +4053,7 @@ static bool _test_resv_overlap(node_space_map_t *node_space,
 			       uint32_t start_time, uint32_t end_reserve)
 {
 	bool overlap = false;
-	int j = 0;
+	int j = 0, use_cnt;
 	bitstr_t *use_bitmap_efctv = NULL;
 
 	if (IS_JOB_WHOLE_TOPO(job_ptr)) {
@@ -3536,6 +4061,7 @@ static bool _test_resv_overlap(node_space_map_t *node_space,
 		topology_g_whole_topo(use_bitmap_efctv);
 		use_bitmap = use_bitmap_efctv;
 	}
+	use_cnt = bit_set_count(use_bitmap);
 
 	while (true) {
 		if ((node_space[j].end_time > start_time) &&
@@ -3544,7 +4070,8 @@ static bool _test_resv_overlap(node_space_map_t *node_space,
 			 * Jobs will run concurrently.
 			 * Do they conflict for resources?
 			 */
-			if (!bit_super_set(use_bitmap,
+			if ((_ns_avail_cnt(&node_space[j]) < use_cnt) ||
+			    !bit_super_set(use_bitmap,
 					   node_space[j].avail_bitmap)) {
 				overlap = true;
 				break;
@@ -3990,6 +4517,7 @@ static int _het_job_start_now(het_job_map_t *map, node_space_map_t *node_space)
 			if (reset_time)
 				_reset_job_time_limit(job_ptr, now, node_space);
 		}
+		job_set_last_update(job_ptr, now);
 		if (reset_time)
 			jobacct_storage_job_start_direct(acct_db_conn, job_ptr);
 	}
@@ -4022,7 +4550,7 @@ static void _het_job_kill_now(het_job_map_t *map)
 		job_ptr->details->begin_time = now + cred_lifetime + 1;
 		job_ptr->end_time   = now;
 		job_state_set(job_ptr, (JOB_PENDING | JOB_COMPLETING));
-		last_job_update     = now;
+		job_set_last_update(job_ptr, now);
 		build_cg_bitmap(job_ptr);
 		job_completion_logger(job_ptr, false);
 		deallocate_nodes(job_ptr, false, false, false);
@@ -44,6 +44,9 @@
 /* backfill_agent - detached thread periodically attempts to backfill jobs */
 extern void *backfill_agent(void *args);
 
+/* Run one backfill cycle in the calling thread, backfill_agent not running */
+extern void backfill_run_cycle(void);
+
 /* Terminate backfill_agent */
 extern void stop_backfill_agent(void);
 
@@ -95,3 +95,12 @@ extern int sched_p_reconfig(void)
 	backfill_reconfig();
 	return SLURM_SUCCESS;
 }
+
+extern int sched_p_run_cycle(void)
+{
+	if (backfill_thread)
+		return SLURM_ERROR;
+
+	backfill_run_cycle();
+	return SLURM_SUCCESS;
+}
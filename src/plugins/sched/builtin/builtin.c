@@ -205,7 +205,7 @@ static void _compute_start_times(void)
 				       NULL, NULL,
 				       &resv_exc);
 		if (rc == SLURM_SUCCESS) {
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			if (job_ptr->time_limit == INFINITE)
 				time_limit = 365 * 24 * 60 * 60;
 			else if (job_ptr->time_limit != NO_VAL)
@@ -274,3 +274,16 @@ extern void *builtin_agent(void *args)
 	}
 	return NULL;
 }
+
+/* Run one cycle of builtin_agent in the calling thread */
+extern void builtin_run_cycle(void)
+{
+	/* Read config, nodes and partitions; Write jobs */
+	slurmctld_lock_t all_locks = {
+		READ_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK, READ_LOCK };
+
+	_load_config();
+	lock_slurmctld(all_locks);
+	_compute_start_times();
+	unlock_slurmctld(all_locks);
+}
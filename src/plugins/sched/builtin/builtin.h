@@ -44,6 +44,9 @@
 /* builtin_agent - detached thread periodically when pending jobs can start */
 extern void *builtin_agent(void *args);
 
+/* Run one cycle of builtin_agent in the calling thread */
+extern void builtin_run_cycle(void);
+
 /* Terminate builtin_agent */
 extern void stop_builtin_agent(void);
 
@@ -92,3 +92,9 @@ extern int sched_p_reconfig(void)
 	builtin_reconfig();
 	return SLURM_SUCCESS;
 }
+
+extern int sched_p_run_cycle(void)
+{
+	builtin_run_cycle();
+	return SLURM_SUCCESS;
+}
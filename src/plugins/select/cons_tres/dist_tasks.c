@@ -58,7 +58,8 @@ static uint32_t comb_counts[MAX_BOARDS][MAX_BOARDS] =
  {7,21,35,35,21,7,1,0},
  {8,28,56,70,56,28,8,1}};
 
-static int *sockets_core_cnt = NULL;
+/* Per thread, sched/backfill may test several jobs at once (bf_threads) */
+static __thread int *sockets_core_cnt = NULL;
 
 /*
  * Generate all combinations of k integers from the
@@ -1031,6 +1032,7 @@ static int _cyclic_sync_core_bitmap(job_record_t *job_ptr,
 				if (!sock_str)
 					sock_str = xstrdup("NONE");
 				job_ptr->priority = 0;
+				job_set_last_update(job_ptr, time(NULL));
 				job_ptr->state_reason = WAIT_HELD;
 				error("sync loop not progressing, holding %pJ, "
 				      "tried to use %u CPUs on node %s core_map:%s avoided_sockets:%s vpus:%u",
@@ -2274,17 +2274,24 @@ static void _set_sched_weight(bitstr_t *node_bitmap)
 {
 	node_record_t *node_ptr;
 
+	/*
+	 * Build the weight before storing it, sched/backfill may run several
+	 * SELECT_MODE_WILL_RUN tests at once (bf_threads) and they must never
+	 * see a partially built value.
+	 */
 	for (int i = 0; (node_ptr = next_node_bitmap(node_bitmap, &i)); i++) {
-		node_ptr->sched_weight = node_ptr->weight;
-		node_ptr->sched_weight = node_ptr->sched_weight << 16;
+		uint64_t sched_weight = node_ptr->weight;
+
+		sched_weight = sched_weight << 16;
 		if (IS_NODE_COMPLETING(node_ptr))
-			node_ptr->sched_weight |= 0x100;
+			sched_weight |= 0x100;
 		if (IS_NODE_REBOOT_REQUESTED(node_ptr) ||
 		    IS_NODE_REBOOT_ISSUED(node_ptr))
-			node_ptr->sched_weight |= 0x200;
+			sched_weight |= 0x200;
 		if (IS_NODE_POWERED_DOWN(node_ptr) ||
 		    IS_NODE_POWERING_DOWN(node_ptr))
-			node_ptr->sched_weight |= 0x2000000000000;
+			sched_weight |= 0x2000000000000;
+		node_ptr->sched_weight = sched_weight;
 	}
 }
 
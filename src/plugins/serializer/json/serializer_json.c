@@ -35,11 +35,7 @@
 
 #include "config.h"
 
-#if HAVE_JSON_C_INC
-#include <json-c/json.h>
-#else
-#include <json/json.h>
-#endif
+#include <math.h>
 
 #include "slurm/slurm.h"
 #include "src/common/slurm_xlator.h"
@@ -48,6 +44,7 @@
 #include "src/common/log.h"
 #include "src/common/read_config.h"
 #include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/interfaces/serializer.h"
 
@@ -85,8 +82,6 @@ const char *mime_types[] = {
 	NULL
 };
 
-static json_object *_data_to_json(const data_t *d);
-
 extern int serializer_p_init(void)
 {
 	log_flag(DATA, "loaded");
@@ -102,131 +97,677 @@ extern int serializer_p_fini(void)
 }
 
 
-static json_object *_try_parse(const char *src, size_t stringlen,
-			       struct json_tokener *tok)
+/* Max nesting of lists and dictionaries to avoid overrunning the stack */
+#define MAX_DEPTH 64
+/* Numbers longer than this are never valid int64 or double values */
+#define MAX_NUMBER_LEN 512
+
+typedef struct {
+	const char *src; /* start of input */
+	const char *pos; /* current parsing position */
+	const char *end; /* end of input */
+	int depth; /* current nesting depth */
+	char *key; /* reused buffer for decoding dictionary keys */
+} parse_state_t;
+
+static int _parse_value(parse_state_t *state, data_t *d);
+
+/* Characters that end a run of plain string characters */
+static const bool _string_special[256] = {
+	['"'] = true,
+	['\\'] = true,
+	['\0'] = true,
+};
+
+static int _parse_fail(parse_state_t *state, const char *caller,
+		       const char *what)
 {
-	json_object *jobj = json_tokener_parse_ex(tok, src, stringlen);
+	error("%s: JSON parsing error at byte %zu of %zu: %s",
+	      caller, (size_t) (state->pos - state->src),
+	      (size_t) (state->end - state->src), what);
+	return ESLURM_REST_FAIL_PARSING;
+}
+#define _parse_error(state, what) _parse_fail(state, __func__, what)
 
-	if (jobj == NULL) {
-		enum json_tokener_error jerr = json_tokener_get_error(tok);
-		error("%s: JSON parsing error %zu bytes: %s",
-		      __func__, stringlen, json_tokener_error_desc(jerr));
-		return NULL;
+/* Skip whitespace and return next character or '\0' at end of input */
+static char _peek(parse_state_t *state)
+{
+	while (state->pos < state->end) {
+		switch (*state->pos) {
+		case ' ':
+		case '\t':
+		case '\n':
+		case '\r':
+			state->pos++;
+			break;
+		default:
+			return *state->pos;
+		}
+	}
+
+	return '\0';
+}
+
+static bool _match_literal(parse_state_t *state, const char *literal)
+{
+	const size_t len = strlen(literal);
+
+	if (((state->end - state->pos) < len) ||
+	    memcmp(state->pos, literal, len))
+		return false;
+
+	state->pos += len;
+	return true;
+}
+
+static int _hex_value(const char *str, uint32_t *value)
+{
+	*value = 0;
+
+	for (int i = 0; i < 4; i++) {
+		const char c = str[i];
+
+		*value <<= 4;
+		if ((c >= '0') && (c <= '9'))
+			*value |= c - '0';
+		else if ((c >= 'a') && (c <= 'f'))
+			*value |= c - 'a' + 10;
+		else if ((c >= 'A') && (c <= 'F'))
+			*value |= c - 'A' + 10;
+		else
+			return EINVAL;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+static char *_utf8_encode(char *dst, uint32_t cp)
+{
+	if (cp < 0x80) {
+		*dst++ = cp;
+	} else if (cp < 0x800) {
+		*dst++ = 0xc0 | (cp >> 6);
+		*dst++ = 0x80 | (cp & 0x3f);
+	} else if (cp < 0x10000) {
+		*dst++ = 0xe0 | (cp >> 12);
+		*dst++ = 0x80 | ((cp >> 6) & 0x3f);
+		*dst++ = 0x80 | (cp & 0x3f);
+	} else {
+		*dst++ = 0xf0 | (cp >> 18);
+		*dst++ = 0x80 | ((cp >> 12) & 0x3f);
+		*dst++ = 0x80 | ((cp >> 6) & 0x3f);
+		*dst++ = 0x80 | (cp & 0x3f);
+	}
+
+	return dst;
+}
+
+/*
+ * Decode escaped string contents from src into dst
+ * IN src - start of string contents (after opening quote)
+ * IN end - closing quote
+ * IN dst - buffer of at least (end - src + 1) bytes as decoding never grows
+ * RET SLURM_SUCCESS or error
+ */
+static int _decode_string(const char *src, const char *end, char *dst)
+{
+	while (src < end) {
+		const char *run = src;
+		uint32_t cp, low;
+
+		while ((src < end) && (*src != '\\'))
+			src++;
+
+		memcpy(dst, run, (src - run));
+		dst += src - run;
+
+		if (src >= end)
+			break;
+
+		/* closing quote is never escaped so src + 1 < end */
+		src++;
+		switch (*src++) {
+		case '"':
+			*dst++ = '"';
+			break;
+		case '\\':
+			*dst++ = '\\';
+			break;
+		case '/':
+			*dst++ = '/';
+			break;
+		case 'b':
+			*dst++ = '\b';
+			break;
+		case 'f':
+			*dst++ = '\f';
+			break;
+		case 'n':
+			*dst++ = '\n';
+			break;
+		case 'r':
+			*dst++ = '\r';
+			break;
+		case 't':
+			*dst++ = '\t';
+			break;
+		case 'u':
+			if (((end - src) < 4) || _hex_value(src, &cp))
+				return EINVAL;
+			src += 4;
+
+			if ((cp >= 0xd800) && (cp <= 0xdbff)) {
+				/* high surrogate must be followed by low */
+				if (((end - src) >= 6) && (src[0] == '\\') &&
+				    (src[1] == 'u') &&
+				    !_hex_value(src + 2, &low) &&
+				    (low >= 0xdc00) && (low <= 0xdfff)) {
+					cp = 0x10000 + ((cp - 0xd800) << 10) +
+					     (low - 0xdc00);
+					src += 6;
+				} else {
+					cp = 0xfffd;
+				}
+			} else if ((cp >= 0xdc00) && (cp <= 0xdfff)) {
+				/* unpaired low surrogate */
+				cp = 0xfffd;
+			}
+
+			dst = _utf8_encode(dst, cp);
+			break;
+		default:
+			return EINVAL;
+		}
+	}
+
+	*dst = '\0';
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Find end of string starting at state->pos (opening quote)
+ * IN/OUT state - pos is moved past the closing quote
+ * OUT start_ptr - set to start of string contents
+ * OUT end_ptr - set to closing quote
+ * RET SLURM_SUCCESS or error
+ */
+static int _scan_string(parse_state_t *state, const char **start_ptr,
+			const char **end_ptr)
+{
+	const char *p = state->pos + 1;
+
+	xassert(*state->pos == '"');
+
+	while (true) {
+		/* skip plain characters in one tight loop */
+		while ((p < state->end) &&
+		       !_string_special[(unsigned char) *p])
+			p++;
+
+		if ((p >= state->end) || (*p == '\0'))
+			return _parse_error(state, "unterminated string");
+
+		if (*p == '"')
+			break;
+
+		/* skip escaped character */
+		p += 2;
+	}
+
+	*start_ptr = state->pos + 1;
+	*end_ptr = p;
+	state->pos = p + 1;
+
+	return SLURM_SUCCESS;
+}
+
+static int _parse_string(parse_state_t *state, data_t *d)
+{
+	const char *start, *end;
+	char buf[16], *str;
+	int rc;
+
+	if ((rc = _scan_string(state, &start, &end)))
+		return rc;
+
+	if ((end - start) < sizeof(buf)) {
+		/* short strings are stored inline without an allocation */
+		if (_decode_string(start, end, buf))
+			return _parse_error(state, "invalid string escape");
+
+		data_set_string(d, buf);
+		return SLURM_SUCCESS;
+	}
+
+	/* decode directly into the string that data_t will own */
+	str = xmalloc((end - start) + 1);
+
+	if (_decode_string(start, end, str)) {
+		xfree(str);
+		return _parse_error(state, "invalid string escape");
+	}
+
+	data_set_string_own(d, str);
+	return SLURM_SUCCESS;
+}
+
+static int _parse_key(parse_state_t *state, data_t *dict, data_t **child_ptr)
+{
+	const char *start, *end;
+	int rc;
+
+	if (_peek(state) != '"')
+		return _parse_error(state, "expected dictionary key string");
+
+	if ((rc = _scan_string(state, &start, &end)))
+		return rc;
+
+	/* reuse key buffer to only allocate once per parse in most cases */
+	if (!state->key || (xsize(state->key) <= (end - start)))
+		xrealloc_nz(state->key, (end - start) + 1);
+
+	if (_decode_string(start, end, state->key))
+		return _parse_error(state, "invalid string escape");
+
+	if (_peek(state) != ':')
+		return _parse_error(state, "expected ':' after dictionary key");
+	state->pos++;
+
+	*child_ptr = data_key_set(dict, state->key);
+	return SLURM_SUCCESS;
+}
+
+static int _parse_number(parse_state_t *state, data_t *d)
+{
+	const char *start = state->pos;
+	char buf[MAX_NUMBER_LEN + 1], *digits, *end_ptr = NULL;
+	bool is_float = false;
+	size_t len;
+
+	while (state->pos < state->end) {
+		const char c = *state->pos;
+
+		if ((c == '.') || (c == 'e') || (c == 'E'))
+			is_float = true;
+		else if (((c < '0') || (c > '9')) && (c != '-') && (c != '+'))
+			break;
+
+		state->pos++;
+	}
+
+	if ((len = (state->pos - start)) > MAX_NUMBER_LEN)
+		return _parse_error(state, "number too long");
+
+	memcpy(buf, start, len);
+	buf[len] = '\0';
+
+	/* RFC 8259 Section 6: leading zeros are not allowed */
+	digits = buf + (buf[0] == '-');
+	if ((digits[0] == '0') && (digits[1] >= '0') && (digits[1] <= '9'))
+		return _parse_error(state, "leading zeros in number");
+
+	if (!is_float) {
+		int64_t value;
+
+		errno = 0;
+		value = strtoll(buf, &end_ptr, 10);
+
+		if (len && !errno && (end_ptr == (buf + len))) {
+			data_set_int(d, value);
+			return SLURM_SUCCESS;
+		}
+
+		/* fall back to double for integers out of int64 range */
+	}
+
+	{
+		double value = strtod(buf, &end_ptr);
+
+		if (!len || (end_ptr != (buf + len)))
+			return _parse_error(state, "invalid number");
+
+		data_set_float(d, value);
 	}
-	if (tok->char_offset < stringlen)
-		log_flag(DATA, "%s: Extra %zu characters after JSON string detected",
-		     __func__, (stringlen - tok->char_offset));
 
-	return jobj;
+	return SLURM_SUCCESS;
+}
+
+static int _parse_dict(parse_state_t *state, data_t *d)
+{
+	int rc;
+
+	xassert(*state->pos == '{');
+	state->pos++;
+
+	data_set_dict(d);
+
+	while (true) {
+		data_t *child = NULL;
+
+		if (_peek(state) == '}') {
+			state->pos++;
+			return SLURM_SUCCESS;
+		}
+
+		if ((rc = _parse_key(state, d, &child)))
+			return rc;
+
+		if ((rc = _parse_value(state, child)))
+			return rc;
+
+		switch (_peek(state)) {
+		case ',':
+			/* trailing comma before '}' is tolerated */
+			state->pos++;
+			break;
+		case '}':
+			state->pos++;
+			return SLURM_SUCCESS;
+		default:
+			return _parse_error(state,
+					    "expected ',' or '}' in dictionary");
+		}
+	}
+}
+
+static int _parse_list(parse_state_t *state, data_t *d)
+{
+	int rc;
+
+	xassert(*state->pos == '[');
+	state->pos++;
+
+	data_set_list(d);
+
+	while (true) {
+		if (_peek(state) == ']') {
+			state->pos++;
+			return SLURM_SUCCESS;
+		}
+
+		if ((rc = _parse_value(state, data_list_append(d))))
+			return rc;
+
+		switch (_peek(state)) {
+		case ',':
+			/* trailing comma before ']' is tolerated */
+			state->pos++;
+			break;
+		case ']':
+			state->pos++;
+			return SLURM_SUCCESS;
+		default:
+			return _parse_error(state, "expected ',' or ']' in list");
+		}
+	}
 }
 
-static data_t *_json_to_data(json_object *jobj, data_t *d)
+static int _parse_value(parse_state_t *state, data_t *d)
 {
-	size_t arraylen = 0;
+	int rc;
 
-	if (!d)
-		d = data_new();
+	switch (_peek(state)) {
+	case '{':
+	case '[':
+		if (state->depth >= MAX_DEPTH)
+			return _parse_error(state, "nesting too deep");
 
-	switch (json_object_get_type(jobj)) {
-	case json_type_null:
+		state->depth++;
+		if (*state->pos == '{')
+			rc = _parse_dict(state, d);
+		else
+			rc = _parse_list(state, d);
+		state->depth--;
+
+		return rc;
+	case '"':
+		return _parse_string(state, d);
+	case 't':
+		if (!_match_literal(state, "true"))
+			break;
+		data_set_bool(d, true);
+		return SLURM_SUCCESS;
+	case 'f':
+		if (!_match_literal(state, "false"))
+			break;
+		data_set_bool(d, false);
+		return SLURM_SUCCESS;
+	case 'n':
+		if (!_match_literal(state, "null"))
+			break;
 		data_set_null(d);
-		break;
-	case json_type_boolean:
-		data_set_bool(d, json_object_get_boolean(jobj));
-		break;
-	case json_type_double:
-		data_set_float(d, json_object_get_double(jobj));
-		break;
-	case json_type_int:
-		data_set_int(d, json_object_get_int64(jobj));
-		break;
-	case json_type_object:
-		data_set_dict(d);
-		/* warning: json_object_object_foreach is an evil macro */
-		json_object_object_foreach(jobj, key, val) {
-			_json_to_data(val, data_key_set(d, key));
+		return SLURM_SUCCESS;
+	/* accept non-finite values as written by _dump_float() */
+	case 'N':
+		if (!_match_literal(state, "NaN"))
+			break;
+		data_set_float(d, NAN);
+		return SLURM_SUCCESS;
+	case 'I':
+		if (!_match_literal(state, "Infinity"))
+			break;
+		data_set_float(d, INFINITY);
+		return SLURM_SUCCESS;
+	case '-':
+		if (_match_literal(state, "-Infinity")) {
+			data_set_float(d, -INFINITY);
+			return SLURM_SUCCESS;
 		}
-		break;
-	case json_type_array:
-		arraylen = json_object_array_length(jobj);
-		data_set_list(d);
-		for (size_t i = 0; i < arraylen; i++)
-			_json_to_data(json_object_array_get_idx(jobj, i),
-				      data_list_append(d));
-		break;
-	case json_type_string:
-		data_set_string(d, json_object_get_string(jobj));
-		break;
-	default:
-		fatal_abort("%s: unknown JSON type", __func__);
-	};
+		/* fall through */
+	case '0':
+	case '1':
+	case '2':
+	case '3':
+	case '4':
+	case '5':
+	case '6':
+	case '7':
+	case '8':
+	case '9':
+		return _parse_number(state, d);
+	case '\0':
+		return _parse_error(state, "unexpected end of input");
+	}
 
-	return d;
+	return _parse_error(state, "unexpected character");
 }
 
-static data_for_each_cmd_t _convert_dict_json(const char *key,
-					      const data_t *data,
-					      void *arg)
+typedef struct {
+	char *out; /* output string */
+	char *at; /* end of output string */
+	int depth; /* nesting depth for indentation */
+	bool pretty;
+} dump_state_t;
+
+static void _dump(const data_t *d, dump_state_t *state);
+
+static void _dump_str(dump_state_t *state, const char *str, ssize_t len)
+{
+	xstrncatat(state->out, &state->at, str, len);
+}
+
+static void _dump_newline(dump_state_t *state)
 {
-	json_object *jobj = arg;
-	json_object *jobject = _data_to_json(data);
+	static const char spaces[] = "                                ";
+	int len = state->depth * 2;
 
-	json_object_object_add(jobj, key, jobject);
-	return DATA_FOR_EACH_CONT;
+	if (!state->pretty)
+		return;
+
+	_dump_str(state, "\n", 1);
+
+	while (len > 0) {
+		int n = MIN(len, (sizeof(spaces) - 1));
+
+		_dump_str(state, spaces, n);
+		len -= n;
+	}
+}
+
+/* Write string as quoted and escaped JSON string (RFC 8259 Section 7) */
+static void _dump_quoted(dump_state_t *state, const char *str)
+{
+	const char *start = str;
+
+	_dump_str(state, "\"", 1);
+
+	for (const char *p = str; p && *p; p++) {
+		const unsigned char c = *p;
+		char esc[7];
+		const char *rep = NULL;
+
+		switch (c) {
+		case '"':
+			rep = "\\\"";
+			break;
+		case '\\':
+			rep = "\\\\";
+			break;
+		case '\b':
+			rep = "\\b";
+			break;
+		case '\f':
+			rep = "\\f";
+			break;
+		case '\n':
+			rep = "\\n";
+			break;
+		case '\r':
+			rep = "\\r";
+			break;
+		case '\t':
+			rep = "\\t";
+			break;
+		default:
+			if (c < 0x20) {
+				snprintf(esc, sizeof(esc), "\\u%04x", c);
+				rep = esc;
+			}
+		}
+
+		if (!rep)
+			continue;
+
+		/* flush unescaped run before replacement */
+		if (p > start)
+			_dump_str(state, start, (p - start));
+		_dump_str(state, rep, -1);
+		start = p + 1;
+	}
+
+	if (str && *start)
+		_dump_str(state, start, -1);
+
+	_dump_str(state, "\"", 1);
+}
+
+static void _dump_float(dump_state_t *state, double value)
+{
+	char buf[32];
+	int len;
+
+	/* match json-c handling of values not representable in JSON */
+	if (isnan(value)) {
+		_dump_str(state, "NaN", -1);
+		return;
+	} else if (isinf(value)) {
+		_dump_str(state, ((value > 0) ? "Infinity" : "-Infinity"), -1);
+		return;
+	}
+
+	len = snprintf(buf, sizeof(buf), "%.17g", value);
+	_dump_str(state, buf, len);
+
+	/* always keep a decimal point to stay a float when parsed */
+	if (!strpbrk(buf, ".eE"))
+		_dump_str(state, ".0", 2);
 }
 
-static data_for_each_cmd_t _convert_list_json(const data_t *data, void *arg)
+static data_for_each_cmd_t _dump_dict(const char *key, const data_t *data,
+				      void *arg)
 {
-	json_object *jobj = arg;
-	json_object *jarray = _data_to_json(data);
+	dump_state_t *state = arg;
+
+	if (state->at[-1] != '{')
+		_dump_str(state, ",", 1);
+	_dump_newline(state);
+
+	_dump_quoted(state, key);
+	if (state->pretty)
+		_dump_str(state, ": ", 2);
+	else
+		_dump_str(state, ":", 1);
+
+	_dump(data, state);
 
-	json_object_array_add(jobj, jarray);
 	return DATA_FOR_EACH_CONT;
 }
 
-static json_object *_data_to_json(const data_t *d)
+static data_for_each_cmd_t _dump_list(const data_t *data, void *arg)
 {
-	if (!d)
-		return NULL;
+	dump_state_t *state = arg;
+
+	if (state->at[-1] != '[')
+		_dump_str(state, ",", 1);
+	_dump_newline(state);
+
+	_dump(data, state);
 
+	return DATA_FOR_EACH_CONT;
+}
+
+static void _dump(const data_t *d, dump_state_t *state)
+{
 	switch (data_get_type(d)) {
+	case DATA_TYPE_NONE:
 	case DATA_TYPE_NULL:
-		return NULL;
+		_dump_str(state, "null", 4);
 		break;
 	case DATA_TYPE_BOOL:
-		return json_object_new_boolean(data_get_bool(d));
+		if (data_get_bool(d))
+			_dump_str(state, "true", 4);
+		else
+			_dump_str(state, "false", 5);
 		break;
 	case DATA_TYPE_FLOAT:
-		return json_object_new_double(data_get_float(d));
+		_dump_float(state, data_get_float(d));
 		break;
 	case DATA_TYPE_INT_64:
-		return json_object_new_int64(data_get_int(d));
-		break;
-	case DATA_TYPE_DICT:
 	{
-		json_object *jobj = json_object_new_object();
-		if (data_dict_for_each_const(d, _convert_dict_json, jobj) < 0)
-			error("%s: unexpected error calling _convert_dict_json()",
-			      __func__);
-		return jobj;
+		char buf[24];
+		int len = snprintf(buf, sizeof(buf), "%"PRId64,
+				   data_get_int(d));
+
+		_dump_str(state, buf, len);
+		break;
 	}
+	case DATA_TYPE_DICT:
+		_dump_str(state, "{", 1);
+		if (data_get_dict_length(d)) {
+			state->depth++;
+			if (data_dict_for_each_const(d, _dump_dict, state) < 0)
+				error("%s: unexpected error calling _dump_dict()",
+				      __func__);
+			state->depth--;
+			_dump_newline(state);
+		}
+		_dump_str(state, "}", 1);
+		break;
 	case DATA_TYPE_LIST:
-	{
-		json_object *jobj = json_object_new_array();
-		if (data_list_for_each_const(d, _convert_list_json, jobj) < 0)
-			error("%s: unexpected error calling _convert_list_json()",
-			      __func__);
-		return jobj;
-	}
+		_dump_str(state, "[", 1);
+		if (data_get_list_length(d)) {
+			state->depth++;
+			if (data_list_for_each_const(d, _dump_list, state) < 0)
+				error("%s: unexpected error calling _dump_list()",
+				      __func__);
+			state->depth--;
+			_dump_newline(state);
+		}
+		_dump_str(state, "]", 1);
+		break;
 	case DATA_TYPE_STRING:
-	{
-		const char *str = data_get_string(d);
-		if (str)
-			return json_object_new_string(str);
-		else
-			return json_object_new_string("");
+		_dump_quoted(state, data_get_string(d));
 		break;
-	}
 	default:
 		fatal_abort("%s: unknown type", __func__);
 	};
@@ -236,65 +777,62 @@ extern int serialize_p_data_to_string(char **dest, size_t *length,
 				      const data_t *src,
 				      serializer_flags_t flags)
 {
-	struct json_object *jobj = _data_to_json(src);
-	int jflags = 0;
+	dump_state_t state = {
+		.pretty = (flags == SER_FLAGS_PRETTY),
+	};
 
 	/* can't be pretty and compact at the same time! */
 	xassert((flags & (SER_FLAGS_PRETTY | SER_FLAGS_COMPACT)) !=
 		(SER_FLAGS_PRETTY | SER_FLAGS_COMPACT));
 
-	switch (flags) {
-	case SER_FLAGS_PRETTY:
-		jflags = JSON_C_TO_STRING_SPACED | JSON_C_TO_STRING_PRETTY;
-		break;
-	case SER_FLAGS_COMPACT: /* fallthrough */
-	default:
-		jflags = JSON_C_TO_STRING_PLAIN;
-	}
-
-	/* string will die with jobj */
-	*dest = xstrdup(json_object_to_json_string_ext(jobj, jflags));
+	/*
+	 * Write JSON directly from the data_t tree instead of converting to a
+	 * json-c object tree first to avoid holding another copy of the whole
+	 * (potentially very large) response in memory.
+	 */
+	if (src)
+		_dump(src, &state);
+	else
+		_dump_str(&state, "null", 4);
+
+	*dest = state.out;
 	if (length) {
 		/* add 1 for \0 */
-		*length = strlen(*dest) + 1;
+		*length = (state.at - state.out) + 1;
 	}
 
-	/* put is equiv to free() */
-	json_object_put(jobj);
-
 	return SLURM_SUCCESS;
 }
 
 extern int serialize_p_string_to_data(data_t **dest, const char *src,
 				      size_t length)
 {
-	json_object *jobj = NULL;
-	data_t *data = NULL;
-	struct json_tokener *tok = json_tokener_new();
+	parse_state_t state = {
+		.src = src,
+		.pos = src,
+		.end = (src + length),
+	};
+	data_t *data;
 	int rc;
 
-	if (!tok)
-		return ENOMEM;
-
 	if (!src)
 		return ESLURM_DATA_PTR_NULL;
 
-	/* json-c has hard limit of 32 bits */
-	if (length >= INT32_MAX) {
-		error("%s: unable to parse JSON: too large",
-		      __func__);
-		return ESLURM_DATA_TOO_LARGE;
-	}
+	/*
+	 * Parse directly from the source buffer into data_t without an
+	 * intermediate object tree. Strings are decoded directly into the
+	 * allocation that data_t takes ownership of.
+	 */
+	data = data_new();
 
-	jobj = _try_parse(src, length, tok);
-	if (jobj) {
-		data = _json_to_data(jobj, NULL);
-		json_object_put(jobj);
-		rc = SLURM_SUCCESS;
-	} else
-		rc = ESLURM_REST_FAIL_PARSING;
+	if ((rc = _parse_value(&state, data))) {
+		FREE_NULL_DATA(data);
+	} else if (_peek(&state) != '\0') {
+		log_flag(DATA, "%s: Extra %zu characters after JSON string detected",
+			 __func__, (size_t) (state.end - state.pos));
+	}
 
-	json_tokener_free(tok);
+	xfree(state.key);
 
 	*dest = data;
 	return rc;
@@ -39,6 +39,7 @@
 #include "slurm/slurm_errno.h"
 
 #include "src/common/assoc_mgr.h"
+#include "src/common/xhash.h"
 
 #include "src/interfaces/accounting_storage.h"
 #include "src/interfaces/priority.h"
@@ -563,26 +564,37 @@ static int _get_tres_state_reason(int tres_pos, int unk_reason)
 	return unk_reason;
 }
 
-static int _find_used_limits_for_acct(void *x, void *key)
+static void _used_limits_acct_id(void *item, const char **key,
+				 uint32_t *key_len)
 {
-	slurmdb_used_limits_t *used_limits = (slurmdb_used_limits_t *)x;
-	char *account = (char *)key;
+	slurmdb_used_limits_t *used_limits = item;
 
-	if (!xstrcmp(account, used_limits->acct))
-		return 1;
+	*key = used_limits->acct ? used_limits->acct : "";
+	*key_len = strlen(*key);
+}
 
-	return 0;
+static void _used_limits_user_id(void *item, const char **key,
+				 uint32_t *key_len)
+{
+	slurmdb_used_limits_t *used_limits = item;
+
+	*key = (const char *) &used_limits->uid;
+	*key_len = sizeof(used_limits->uid);
 }
 
-static int _find_used_limits_for_user(void *x, void *key)
+/* Index any records already in used_limit_list (e.g. added before reconfig) */
+static void _index_used_limits(list_t *used_limit_list, xhash_t *hash)
 {
-	slurmdb_used_limits_t *used_limits = (slurmdb_used_limits_t *)x;
-	uint32_t user_id = *(uint32_t *)key;
+	slurmdb_used_limits_t *used_limits;
+	list_itr_t *itr;
 
-	if (used_limits->uid == user_id)
-		return 1;
+	if (!used_limit_list)
+		return;
 
-	return 0;
+	itr = list_iterator_create(used_limit_list);
+	while ((used_limits = list_next(itr)))
+		xhash_add(hash, used_limits);
+	list_iterator_destroy(itr);
 }
 
 static bool _valid_job_assoc(job_record_t *job_ptr)
@@ -624,11 +636,11 @@ static void _qos_adjust_limit_usage(int type, job_record_t *job_ptr,
 		return;
 
 	used_limits_a =	acct_policy_get_acct_used_limits(
-		&qos_ptr->usage->acct_limit_list,
+		qos_ptr->usage,
 		job_ptr->assoc_ptr->acct);
 
 	used_limits = acct_policy_get_user_used_limits(
-		&qos_ptr->usage->user_limit_list,
+		qos_ptr->usage,
 		job_ptr->user_id);
 
 	switch (type) {
@@ -1119,11 +1131,11 @@ static void _qos_alter_job(job_record_t *job_ptr,
 		return;
 
 	used_limits_a =	acct_policy_get_acct_used_limits(
-		&qos_ptr->usage->acct_limit_list,
+		qos_ptr->usage,
 		job_ptr->assoc_ptr->acct);
 
 	used_limits_u = acct_policy_get_user_used_limits(
-		&qos_ptr->usage->user_limit_list,
+		qos_ptr->usage,
 		job_ptr->user_id);
 
 	for (i=0; i<slurmctld_tres_cnt; i++) {
@@ -1966,7 +1978,7 @@ static int _qos_policy_validate(job_desc_msg_t *job_desc,
 	    (qos_ptr->max_submit_jobs_pa != INFINITE)) {
 		slurmdb_used_limits_t *used_limits =
 			acct_policy_get_acct_used_limits(
-				&qos_ptr->usage->acct_limit_list,
+				qos_ptr->usage,
 				assoc_ptr->acct);
 
 		qos_out_ptr->max_submit_jobs_pa = qos_ptr->max_submit_jobs_pa;
@@ -1989,7 +2001,7 @@ static int _qos_policy_validate(job_desc_msg_t *job_desc,
 	    (qos_ptr->max_submit_jobs_pu != INFINITE)) {
 		slurmdb_used_limits_t *used_limits =
 			acct_policy_get_user_used_limits(
-				&qos_ptr->usage->user_limit_list,
+				qos_ptr->usage,
 				job_desc->user_id);
 
 		qos_out_ptr->max_submit_jobs_pu = qos_ptr->max_submit_jobs_pu;
@@ -2063,11 +2075,11 @@ static int _qos_job_runnable_pre_select(job_record_t *job_ptr,
 	wall_mins = qos_ptr->usage->grp_used_wall / 60;
 
 	used_limits_a =	acct_policy_get_acct_used_limits(
-		&qos_ptr->usage->acct_limit_list,
+		qos_ptr->usage,
 		assoc_ptr->acct);
 
 	used_limits = acct_policy_get_user_used_limits(
-		&qos_ptr->usage->user_limit_list,
+		qos_ptr->usage,
 		job_ptr->user_id);
 
 
@@ -2272,11 +2284,11 @@ static int _qos_job_runnable_post_select(job_record_t *job_ptr,
 		safe_limits = true;
 
 	used_limits_a =	acct_policy_get_acct_used_limits(
-		&qos_ptr->usage->acct_limit_list,
+		qos_ptr->usage,
 		assoc_ptr->acct);
 
 	used_limits = acct_policy_get_user_used_limits(
-		&qos_ptr->usage->user_limit_list,
+		qos_ptr->usage,
 		job_ptr->user_id);
 
 
@@ -2775,7 +2787,7 @@ static int _qos_job_time_out(job_record_t *job_ptr,
 		NULL, tres_usage_mins, NULL, false);
 	switch (tres_usage) {
 	case TRES_USAGE_CUR_EXCEEDS_LIMIT:
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 		info("%pJ timed out, the job is at or exceeds QOS %s's group max tres(%s) minutes of %"PRIu64" with %"PRIu64"",
 		     job_ptr, qos_ptr->name,
 		     assoc_mgr_tres_name_array[tres_pos],
@@ -2805,7 +2817,7 @@ static int _qos_job_time_out(job_record_t *job_ptr,
 		qos_out_ptr->grp_wall = qos_ptr->grp_wall;
 
 		if (wall_mins >= qos_ptr->grp_wall) {
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			info("%pJ timed out, the job is at or exceeds QOS %s's group wall limit of %u with %u",
 			     job_ptr, qos_ptr->name,
 			     qos_ptr->grp_wall, wall_mins);
@@ -2827,7 +2839,7 @@ static int _qos_job_time_out(job_record_t *job_ptr,
 		/* not possible curr_usage is NULL */
 		break;
 	case TRES_USAGE_REQ_EXCEEDS_LIMIT:
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 		info("%pJ timed out, the job is at or exceeds QOS %s's max tres(%s) minutes of %"PRIu64" with %"PRIu64,
 		     job_ptr, qos_ptr->name,
 		     assoc_mgr_tres_name_array[tres_pos],
@@ -3646,15 +3658,8 @@ extern bool acct_policy_validate_het_job(list_t *submit_job_list)
 	return rc;
 }
 
-/*
- * acct_policy_job_runnable_pre_select - Determine if the specified
- *	job can execute right now or not depending upon accounting
- *	policy (e.g. running job limit for this association). If the
- *	association limits prevent the job from ever running (lowered
- *	limits since job submission), then cancel the job.
- */
-extern bool acct_policy_job_runnable_pre_select(job_record_t *job_ptr,
-						bool assoc_mgr_locked)
+static bool _job_runnable_pre_select(job_record_t *job_ptr,
+				     bool assoc_mgr_locked)
 {
 	slurmdb_qos_rec_t *qos_ptr_1, *qos_ptr_2;
 	slurmdb_qos_rec_t qos_rec;
@@ -3879,13 +3884,9 @@ end_it:
 	return rc;
 }
 
-/*
- * acct_policy_job_runnable_post_select - After nodes have been
- *	selected for the job verify the counts don't exceed aggregated limits.
- */
-extern bool acct_policy_job_runnable_post_select(job_record_t *job_ptr,
-						 uint64_t *tres_req_cnt,
-						 bool assoc_mgr_locked)
+static bool _job_runnable_post_select(job_record_t *job_ptr,
+				      uint64_t *tres_req_cnt,
+				      bool assoc_mgr_locked)
 {
 	slurmdb_qos_rec_t *qos_ptr_1, *qos_ptr_2;
 	slurmdb_qos_rec_t qos_rec;
@@ -4265,6 +4266,55 @@ end_it:
 	return rc;
 }
 
+/*
+ * The limit checks below clear a QOS/association state_reason and then set
+ * it again on every pass. Only stamp the job when the reason it ends up with
+ * differs from the one it had, otherwise every pending job would look
+ * modified to SHOW_DELTA clients after each scheduling cycle.
+ */
+static void _stamp_reason_change(job_record_t *job_ptr,
+				 uint32_t old_reason, bool had_desc)
+{
+	if ((job_ptr->state_reason != old_reason) ||
+	    (had_desc && !job_ptr->state_desc))
+		job_set_last_update(job_ptr, time(NULL));
+}
+
+/*
+ * acct_policy_job_runnable_pre_select - Determine if the specified
+ *	job can execute right now or not depending upon accounting
+ *	policy (e.g. running job limit for this association). If the
+ *	association limits prevent the job from ever running (lowered
+ *	limits since job submission), then cancel the job.
+ */
+extern bool acct_policy_job_runnable_pre_select(job_record_t *job_ptr,
+						bool assoc_mgr_locked)
+{
+	uint32_t old_reason = job_ptr->state_reason;
+	bool had_desc = (job_ptr->state_desc != NULL);
+	bool rc = _job_runnable_pre_select(job_ptr, assoc_mgr_locked);
+
+	_stamp_reason_change(job_ptr, old_reason, had_desc);
+	return rc;
+}
+
+/*
+ * acct_policy_job_runnable_post_select - After nodes have been
+ *	selected for the job verify the counts don't exceed aggregated limits.
+ */
+extern bool acct_policy_job_runnable_post_select(job_record_t *job_ptr,
+						 uint64_t *tres_req_cnt,
+						 bool assoc_mgr_locked)
+{
+	uint32_t old_reason = job_ptr->state_reason;
+	bool had_desc = (job_ptr->state_desc != NULL);
+	bool rc = _job_runnable_post_select(job_ptr, tres_req_cnt,
+					    assoc_mgr_locked);
+
+	_stamp_reason_change(job_ptr, old_reason, had_desc);
+	return rc;
+}
+
 extern uint32_t acct_policy_get_max_nodes(job_record_t *job_ptr,
 					  uint32_t *wait_reason)
 {
@@ -4461,7 +4511,7 @@ extern int acct_policy_update_pending_job(job_record_t *job_ptr)
 	}
 
 	if (update_accounting) {
-		last_job_update = time(NULL);
+		job_set_last_update(job_ptr, time(NULL));
 		debug("limits changed for %pJ: updating accounting", job_ptr);
 		/* Update job record in accounting to reflect changes */
 		jobacct_storage_job_start_direct(acct_db_conn, job_ptr);
@@ -4557,7 +4607,7 @@ extern bool acct_policy_job_time_out(job_record_t *job_ptr)
 			NULL, tres_usage_mins, NULL, false);
 		switch (tres_usage) {
 		case TRES_USAGE_CUR_EXCEEDS_LIMIT:
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			info("%pJ timed out, the job is at or exceeds assoc %u(%s/%s/%s) group max tres(%s) minutes of %"PRIu64" with %"PRIu64,
 			     job_ptr, assoc->id, assoc->acct,
 			     assoc->user, assoc->partition,
@@ -4608,7 +4658,7 @@ extern bool acct_policy_job_time_out(job_record_t *job_ptr)
 			/* not possible curr_usage is NULL */
 			break;
 		case TRES_USAGE_REQ_EXCEEDS_LIMIT:
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			info("%pJ timed out, the job is at or exceeds assoc %u(%s/%s/%s) max tres(%s) minutes of %"PRIu64" with %"PRIu64,
 			     job_ptr, assoc->id, assoc->acct,
 			     assoc->user, assoc->partition,
@@ -4854,10 +4904,10 @@ extern int acct_policy_handle_accrue_time(job_record_t *job_ptr,
 	qos_ptr = job_ptr->qos_ptr;
 	if (qos_ptr) {
 		used_limits_acct = acct_policy_get_acct_used_limits(
-			&qos_ptr->usage->acct_limit_list,
+			qos_ptr->usage,
 			assoc_ptr->acct);
 		used_limits_user = acct_policy_get_user_used_limits(
-				&qos_ptr->usage->user_limit_list,
+				qos_ptr->usage,
 				job_ptr->user_id);
 	}
 
@@ -4968,10 +5018,10 @@ extern void acct_policy_add_accrue_time(job_record_t *job_ptr,
 	qos_ptr = job_ptr->qos_ptr;
 	if (qos_ptr) {
 		used_limits_acct = acct_policy_get_acct_used_limits(
-			&qos_ptr->usage->acct_limit_list,
+			qos_ptr->usage,
 			assoc_ptr->acct);
 		used_limits_user = acct_policy_get_user_used_limits(
-				&qos_ptr->usage->user_limit_list,
+				qos_ptr->usage,
 				job_ptr->user_id);
 	}
 
@@ -5026,10 +5076,10 @@ extern void acct_policy_remove_accrue_time(job_record_t *job_ptr,
 	qos_ptr = job_ptr->qos_ptr;
 	if (qos_ptr) {
 		used_limits_acct = acct_policy_get_acct_used_limits(
-			&qos_ptr->usage->acct_limit_list,
+			qos_ptr->usage,
 			assoc_ptr->acct);
 		used_limits_user = acct_policy_get_user_used_limits(
-				&qos_ptr->usage->user_limit_list,
+				qos_ptr->usage,
 				job_ptr->user_id);
 	}
 
@@ -5178,24 +5228,31 @@ extern void acct_policy_set_qos_order(job_record_t *job_ptr,
 }
 
 /*
- * Checks for record in *user_limit_list of user_id if
- * *user_limit_list doesn't exist it will create it, if the user_id
+ * Checks for record in usage->acct_limit_list of acct if
+ * usage->acct_limit_list doesn't exist it will create it, if the acct
  * record doesn't exist it will add it to the list.
- * In all cases the user record is returned.
+ * Lookups go through usage->acct_limit_hash instead of walking the list.
+ * In all cases the acct record is returned.
  */
 extern slurmdb_used_limits_t *acct_policy_get_acct_used_limits(
-	list_t **acct_limit_list, char *acct)
+	slurmdb_qos_usage_t *usage, char *acct)
 {
 	slurmdb_used_limits_t *used_limits;
 
-	xassert(acct_limit_list);
+	xassert(usage);
 
-	if (!*acct_limit_list)
-		*acct_limit_list = list_create(slurmdb_destroy_used_limits);
+	if (!usage->acct_limit_list)
+		usage->acct_limit_list =
+			list_create(slurmdb_destroy_used_limits);
 
-	if (!(used_limits = list_find_first(*acct_limit_list,
-					    _find_used_limits_for_acct,
-					    acct))) {
+	if (!usage->acct_limit_hash) {
+		usage->acct_limit_hash = xhash_init(_used_limits_acct_id, NULL);
+		_index_used_limits(usage->acct_limit_list,
+				   usage->acct_limit_hash);
+	}
+
+	if (!(used_limits = xhash_get_str(usage->acct_limit_hash,
+					  (acct ? acct : "")))) {
 		int i = sizeof(uint64_t) * slurmctld_tres_cnt;
 
 		used_limits = xmalloc(sizeof(slurmdb_used_limits_t));
@@ -5204,31 +5261,40 @@ extern slurmdb_used_limits_t *acct_policy_get_acct_used_limits(
 		used_limits->tres = xmalloc(i);
 		used_limits->tres_run_secs = xmalloc(i);
 
-		list_append(*acct_limit_list, used_limits);
+		list_append(usage->acct_limit_list, used_limits);
+		xhash_add(usage->acct_limit_hash, used_limits);
 	}
 
 	return used_limits;
 }
 
 /*
- * Checks for record in *user_limit_list of user_id if
- * *user_limit_list doesn't exist it will create it, if the user_id
+ * Checks for record in usage->user_limit_list of user_id if
+ * usage->user_limit_list doesn't exist it will create it, if the user_id
  * record doesn't exist it will add it to the list.
+ * Lookups go through usage->user_limit_hash instead of walking the list.
  * In all cases the user record is returned.
  */
 extern slurmdb_used_limits_t *acct_policy_get_user_used_limits(
-	list_t **user_limit_list, uint32_t user_id)
+	slurmdb_qos_usage_t *usage, uint32_t user_id)
 {
 	slurmdb_used_limits_t *used_limits;
 
-	xassert(user_limit_list);
+	xassert(usage);
+
+	if (!usage->user_limit_list)
+		usage->user_limit_list =
+			list_create(slurmdb_destroy_used_limits);
 
-	if (!*user_limit_list)
-		*user_limit_list = list_create(slurmdb_destroy_used_limits);
+	if (!usage->user_limit_hash) {
+		usage->user_limit_hash = xhash_init(_used_limits_user_id, NULL);
+		_index_used_limits(usage->user_limit_list,
+				   usage->user_limit_hash);
+	}
 
-	if (!(used_limits = list_find_first(*user_limit_list,
-					    _find_used_limits_for_user,
-					    &user_id))) {
+	if (!(used_limits = xhash_get(usage->user_limit_hash,
+				      (const char *) &user_id,
+				      sizeof(user_id)))) {
 		int i = sizeof(uint64_t) * slurmctld_tres_cnt;
 
 		used_limits = xmalloc(sizeof(slurmdb_used_limits_t));
@@ -5237,7 +5303,8 @@ extern slurmdb_used_limits_t *acct_policy_get_user_used_limits(
 		used_limits->tres = xmalloc(i);
 		used_limits->tres_run_secs = xmalloc(i);
 
-		list_append(*user_limit_list, used_limits);
+		list_append(usage->user_limit_list, used_limits);
+		xhash_add(usage->user_limit_hash, used_limits);
 	}
 
 	return used_limits;
@@ -60,6 +60,12 @@
  *
  *  All the state for each thread is maintained in thd_t struct, which is
  *  used by the watchdog thread as well as the communication threads.
+ *
+ *  When SlurmctldParameters=agent_use_conmgr is configured, RPCs which are
+ *  sent directly to each node without expecting a reply are instead issued
+ *  as non-blocking connections through conmgr. The agent thread opens up to
+ *  AGENT_CONMGR_MAX_CONNECTIONS connections at once (across all agents) and
+ *  conmgr's connect, read and write timeouts replace the watchdog thread.
 \*****************************************************************************/
 
 #include "config.h"
@@ -93,6 +99,8 @@
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
+#include "src/conmgr/conmgr.h"
+
 #include "src/interfaces/select.h"
 
 #include "src/slurmctld/agent.h"
@@ -176,6 +184,13 @@ typedef struct {
 	uint16_t protocol_version;	/* if set, use this version */
 } task_info_t;
 
+typedef struct {
+	agent_info_t *agent_ptr;	/* agent owning this connection */
+	thd_t *thread_ptr;		/* target of this connection */
+	bool sent;			/* RPC queued for writing */
+	bool timed_out;			/* connection timed out */
+} agent_con_t;
+
 typedef struct {
 	agent_arg_t* agent_arg_ptr;	/* The queued request */
 	time_t       first_attempt;	/* Time of first check for batch
@@ -189,12 +204,16 @@ typedef struct {
 	char **environment; /* MailProg environment variables */
 } mail_info_t;
 
+static void _agent_complete(agent_info_t *agent_ptr,
+			    thd_complete_t *thd_comp);
+static void _agent_conmgr(agent_info_t *agent_ptr);
 static void _agent_defer(void);
 static void _agent_retry(int min_wait, bool wait_too);
 static int  _batch_launch_defer(queued_request_t *queued_req_ptr);
 static void _reboot_from_ctld(agent_arg_t *agent_arg_ptr);
 static int  _signal_defer(queued_request_t *queued_req_ptr);
 static inline int _comm_err(char *node_name, slurm_msg_type_t msg_type);
+static bool _is_split_msg(slurm_msg_type_t msg_type);
 static void _list_delete_retry(void *retry_entry);
 static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr);
 static task_info_t *_make_task_data(agent_info_t *agent_info_ptr, int inx);
@@ -236,9 +255,14 @@ static pthread_mutex_t agent_cnt_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  agent_cnt_cond  = PTHREAD_COND_INITIALIZER;
 static int agent_cnt = 0;
 static int agent_thread_cnt = 0;
+static bool agent_use_conmgr = false;
 static int mail_thread_cnt = 0;
 static uint16_t message_timeout = NO_VAL16;
 
+static pthread_mutex_t agent_con_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t agent_con_cond = PTHREAD_COND_INITIALIZER;
+static int agent_con_cnt = 0;
+
 static pthread_mutex_t pending_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  pending_cond = PTHREAD_COND_INITIALIZER;
 static int pending_wait_time = NO_VAL16;
@@ -274,7 +298,7 @@ void *agent(void *args)
 	thd_t *thread_ptr;
 	task_info_t *task_specific_ptr;
 	time_t begin_time;
-	bool spawn_retry_agent = false;
+	bool spawn_retry_agent = false, use_conmgr;
 	int rpc_thread_cnt;
 	static time_t sched_update = 0;
 	static bool reboot_from_ctld = false;
@@ -297,10 +321,18 @@ void *agent(void *args)
 		if (xstrcasestr(slurm_conf.slurmctld_params,
 		                "reboot_from_controller"))
 			reboot_from_ctld = true;
+		agent_use_conmgr = (conmgr_enabled() && agent_uses_conmgr());
 		sched_update = slurm_conf.last_update;
 	}
 
-	rpc_thread_cnt = 2 + MIN(agent_arg_ptr->node_count, AGENT_THREAD_COUNT);
+	/* Connections are driven by conmgr's threads rather than our own */
+	use_conmgr = (agent_use_conmgr &&
+		      _is_split_msg(agent_arg_ptr->msg_type));
+	if (use_conmgr)
+		rpc_thread_cnt = 1;
+	else
+		rpc_thread_cnt = 2 + MIN(agent_arg_ptr->node_count,
+					 AGENT_THREAD_COUNT);
 	while (1) {
 		if (slurmctld_config.shutdown_time ||
 		    ((agent_thread_cnt+rpc_thread_cnt) <= MAX_SERVER_THREADS)) {
@@ -330,6 +362,16 @@ void *agent(void *args)
 	agent_info_ptr = _make_agent_info(agent_arg_ptr);
 	thread_ptr = agent_info_ptr->thread_struct;
 
+	if (use_conmgr) {
+		_agent_conmgr(agent_info_ptr);
+		delay = (int) difftime(time(NULL), begin_time);
+		if (delay > (slurm_conf.msg_timeout * 2)) {
+			info("agent msg_type=%s ran for %d seconds",
+			     rpc_num2string(agent_arg_ptr->msg_type), delay);
+		}
+		goto cleanup;
+	}
+
 	/* start the watchdog thread */
 	slurm_thread_create(&thread_wdog, _wdog, agent_info_ptr);
 
@@ -447,6 +489,29 @@ static int _valid_agent_arg(agent_arg_t *agent_arg_ptr)
 	return SLURM_SUCCESS;
 }
 
+/* Return true if msg_type is sent directly to each node without a reply */
+static bool _is_split_msg(slurm_msg_type_t msg_type)
+{
+	switch (msg_type) {
+	case REQUEST_JOB_NOTIFY:
+	case REQUEST_REBOOT_NODES:
+	case REQUEST_RECONFIGURE:
+	case REQUEST_RECONFIGURE_SACKD:
+	case REQUEST_RECONFIGURE_WITH_CONFIG:
+	case REQUEST_SHUTDOWN:
+	case SRUN_TIMEOUT:
+	case SRUN_NODE_FAIL:
+	case SRUN_REQUEST_SUSPEND:
+	case SRUN_USER_MSG:
+	case SRUN_STEP_MISSING:
+	case SRUN_STEP_SIGNAL:
+	case SRUN_JOB_COMPLETE:
+		return true;
+	default:
+		return false;
+	}
+}
+
 static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr)
 {
 	agent_info_t *agent_info_ptr = NULL;
@@ -475,19 +540,7 @@ static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr)
 	xassert(agent_arg_ptr->node_count ==
 		hostlist_count(agent_arg_ptr->hostlist));
 
-	if ((agent_arg_ptr->msg_type != REQUEST_JOB_NOTIFY)	&&
-	    (agent_arg_ptr->msg_type != REQUEST_REBOOT_NODES)	&&
-	    (agent_arg_ptr->msg_type != REQUEST_RECONFIGURE)	&&
-	    (agent_arg_ptr->msg_type != REQUEST_RECONFIGURE_SACKD) &&
-	    (agent_arg_ptr->msg_type != REQUEST_RECONFIGURE_WITH_CONFIG) &&
-	    (agent_arg_ptr->msg_type != REQUEST_SHUTDOWN)	&&
-	    (agent_arg_ptr->msg_type != SRUN_TIMEOUT)		&&
-	    (agent_arg_ptr->msg_type != SRUN_NODE_FAIL)		&&
-	    (agent_arg_ptr->msg_type != SRUN_REQUEST_SUSPEND)	&&
-	    (agent_arg_ptr->msg_type != SRUN_USER_MSG)		&&
-	    (agent_arg_ptr->msg_type != SRUN_STEP_MISSING)	&&
-	    (agent_arg_ptr->msg_type != SRUN_STEP_SIGNAL)	&&
-	    (agent_arg_ptr->msg_type != SRUN_JOB_COMPLETE)) {
+	if (!_is_split_msg(agent_arg_ptr->msg_type)) {
 #ifdef HAVE_FRONT_END
 		split = true;
 #else
@@ -614,7 +667,6 @@ static void _update_wdog_state(thd_t *thread_ptr,
  */
 static void *_wdog(void *args)
 {
-	bool srun_agent = false, sack_agent = false;
 	int i;
 	agent_info_t *agent_ptr = (agent_info_t *) args;
 	thd_t *thread_ptr = agent_ptr->thread_struct;
@@ -623,20 +675,6 @@ static void *_wdog(void *args)
 	thd_complete_t thd_comp;
 	ret_data_info_t *ret_data_info = NULL;
 
-	if ( (agent_ptr->msg_type == SRUN_JOB_COMPLETE)			||
-	     (agent_ptr->msg_type == SRUN_REQUEST_SUSPEND)		||
-	     (agent_ptr->msg_type == SRUN_STEP_MISSING)			||
-	     (agent_ptr->msg_type == SRUN_STEP_SIGNAL)			||
-	     (agent_ptr->msg_type == SRUN_NODE_FAIL)			||
-	     (agent_ptr->msg_type == SRUN_PING)				||
-	     (agent_ptr->msg_type == SRUN_TIMEOUT)			||
-	     (agent_ptr->msg_type == SRUN_USER_MSG)			||
-	     (agent_ptr->msg_type == RESPONSE_RESOURCE_ALLOCATION)	||
-	     (agent_ptr->msg_type == RESPONSE_HET_JOB_ALLOCATION) )
-		srun_agent = true;
-	if (agent_ptr->msg_type == REQUEST_RECONFIGURE_SACKD)
-		sack_agent = true;
-
 	thd_comp.max_delay = 0;
 
 	while (1) {
@@ -673,6 +711,36 @@ static void *_wdog(void *args)
 		slurm_mutex_unlock(&agent_ptr->thread_mutex);
 	}
 
+	_agent_complete(agent_ptr, &thd_comp);
+
+	slurm_mutex_unlock(&agent_ptr->thread_mutex);
+	return NULL;
+}
+
+/*
+ * Notify slurmctld of the results of all the agent's RPCs and release their
+ * per-node state.
+ * NOTE: agent_ptr->thread_mutex must be locked
+ */
+static void _agent_complete(agent_info_t *agent_ptr, thd_complete_t *thd_comp)
+{
+	bool srun_agent = false, sack_agent = false;
+	thd_t *thread_ptr = agent_ptr->thread_struct;
+
+	if ( (agent_ptr->msg_type == SRUN_JOB_COMPLETE)			||
+	     (agent_ptr->msg_type == SRUN_REQUEST_SUSPEND)		||
+	     (agent_ptr->msg_type == SRUN_STEP_MISSING)			||
+	     (agent_ptr->msg_type == SRUN_STEP_SIGNAL)			||
+	     (agent_ptr->msg_type == SRUN_NODE_FAIL)			||
+	     (agent_ptr->msg_type == SRUN_PING)				||
+	     (agent_ptr->msg_type == SRUN_TIMEOUT)			||
+	     (agent_ptr->msg_type == SRUN_USER_MSG)			||
+	     (agent_ptr->msg_type == RESPONSE_RESOURCE_ALLOCATION)	||
+	     (agent_ptr->msg_type == RESPONSE_HET_JOB_ALLOCATION) )
+		srun_agent = true;
+	if (agent_ptr->msg_type == REQUEST_RECONFIGURE_SACKD)
+		sack_agent = true;
+
 	if (sack_agent) {
 		if (thread_ptr[0].state != DSH_DONE)
 			sackd_mgr_remove_node(thread_ptr[0].nodename);
@@ -680,21 +748,18 @@ static void *_wdog(void *args)
 		_notify_slurmctld_jobs(agent_ptr);
 	} else if (agent_ptr->msg_type != REQUEST_SHUTDOWN) {
 		_notify_slurmctld_nodes(agent_ptr,
-					thd_comp.no_resp_cnt,
-					thd_comp.retry_cnt);
+					thd_comp->no_resp_cnt,
+					thd_comp->retry_cnt);
 	}
 
-	for (i = 0; i < agent_ptr->thread_count; i++) {
+	for (int i = 0; i < agent_ptr->thread_count; i++) {
 		FREE_NULL_LIST(thread_ptr[i].ret_list);
 		xfree(thread_ptr[i].nodename);
 	}
 
-	if (thd_comp.max_delay)
+	if (thd_comp->max_delay)
 		log_flag(AGENT, "%s: agent maximum delay %d seconds",
-			 __func__, thd_comp.max_delay);
-
-	slurm_mutex_unlock(&agent_ptr->thread_mutex);
-	return NULL;
+			 __func__, thd_comp->max_delay);
 }
 
 static void _notify_slurmctld_jobs(agent_info_t *agent_ptr)
@@ -1311,6 +1376,230 @@ cleanup:
 	return NULL;
 }
 
+static void *_agent_con_connect(conmgr_fd_t *con, void *arg)
+{
+	agent_con_t *acon = arg;
+	agent_info_t *agent_ptr = acon->agent_ptr;
+	slurm_msg_t msg;
+	int rc, err = SLURM_SUCCESS;
+
+	/*
+	 * Verify the non-blocking connect() actually succeeded. conmgr closes
+	 * the input of a connection that failed while polling, consuming the
+	 * socket error in the process.
+	 */
+	if (conmgr_fd_get_status(con).read_eof)
+		rc = SLURM_COMMUNICATIONS_CONNECTION_ERROR;
+	else if (!(rc = fd_get_socket_error(conmgr_fd_get_output_fd(con),
+					    &err)) &&
+		 (err != SLURM_COMMUNICATIONS_MISSING_SOCKET_ERROR))
+		rc = err;
+
+	if (rc) {
+		log_flag(AGENT, "%s: [%s] unable to connect to %s: %s",
+			 __func__, conmgr_fd_get_name(con),
+			 acon->thread_ptr->nodename, slurm_strerror(rc));
+		conmgr_queue_close_fd(con);
+		return acon;
+	}
+
+	slurm_msg_t_init(&msg);
+	if (agent_ptr->protocol_version)
+		msg.protocol_version = agent_ptr->protocol_version;
+	else
+		msg.protocol_version = SLURM_PROTOCOL_VERSION;
+	msg.msg_type = agent_ptr->msg_type;
+	msg.data = *agent_ptr->msg_args_pptr;
+	slurm_msg_set_r_uid(&msg, agent_ptr->r_uid);
+	msg.flags |= agent_ptr->msg_flags;
+
+	if ((rc = conmgr_queue_write_msg(con, &msg))) {
+		error("%s: [%s] unable to send %s to %s: %s",
+		      __func__, conmgr_fd_get_name(con),
+		      rpc_num2string(msg.msg_type), acon->thread_ptr->nodename,
+		      slurm_strerror(rc));
+		conmgr_queue_close_fd(con);
+	} else {
+		acon->sent = true;
+
+		/*
+		 * srun may exit as soon as it gets this message (see
+		 * _send_msg_maybe()), so do not wait for the remote to close.
+		 * Otherwise, wait for the remote to close the connection (or
+		 * reply) to know the message was received, similar to
+		 * slurm_send_only_node_msg().
+		 */
+		if (msg.msg_type == SRUN_JOB_COMPLETE)
+			conmgr_queue_close_fd(con);
+	}
+
+	destroy_forward(&msg.forward);
+	return acon;
+}
+
+static int _agent_con_msg(conmgr_fd_t *con, slurm_msg_t *msg, void *arg)
+{
+	agent_con_t *acon = arg;
+
+	/* Reply is not expected but is not an error either */
+	log_flag(AGENT, "%s: [%s] ignoring %s reply from %s",
+		 __func__, conmgr_fd_get_name(con),
+		 rpc_num2string(msg->msg_type), acon->thread_ptr->nodename);
+
+	slurm_free_msg(msg);
+	conmgr_queue_close_fd(con);
+	return SLURM_SUCCESS;
+}
+
+static int _agent_con_timeout(conmgr_fd_t *con, void *arg)
+{
+	agent_con_t *acon = arg;
+
+	log_flag(AGENT, "%s: [%s] %s to %s timed out",
+		 __func__, conmgr_fd_get_name(con),
+		 rpc_num2string(acon->agent_ptr->msg_type),
+		 acon->thread_ptr->nodename);
+
+	acon->timed_out = true;
+	return SLURM_PROTOCOL_SOCKET_IMPL_TIMEOUT;
+}
+
+static void _agent_con_finish(conmgr_fd_t *con, void *arg)
+{
+	agent_con_t *acon = arg;
+	agent_info_t *agent_ptr = acon->agent_ptr;
+	thd_t *thread_ptr = acon->thread_ptr;
+
+	slurm_mutex_lock(&agent_con_mutex);
+	agent_con_cnt--;
+	slurm_cond_signal(&agent_con_cond);
+	slurm_mutex_unlock(&agent_con_mutex);
+
+	slurm_mutex_lock(&agent_ptr->thread_mutex);
+	if ((acon->sent && !acon->timed_out) ||
+	    (agent_ptr->msg_type == SRUN_JOB_COMPLETE))
+		thread_ptr->state = DSH_DONE;
+	else
+		thread_ptr->state = DSH_NO_RESP;
+	thread_ptr->end_time = (time_t) difftime(time(NULL),
+						 thread_ptr->start_time);
+	agent_ptr->threads_active--;
+	slurm_cond_signal(&agent_ptr->thread_cond);
+	slurm_mutex_unlock(&agent_ptr->thread_mutex);
+
+	xfree(acon);
+}
+
+/*
+ * _agent_conmgr - issue an RPC to every node of the agent as non-blocking
+ *	conmgr connections instead of one thread per node, then notify
+ *	slurmctld of the results once all connections have finished.
+ * IN agent_ptr - agent to process, RPCs must not expect a reply
+ */
+static void _agent_conmgr(agent_info_t *agent_ptr)
+{
+	static const conmgr_events_t events = {
+		.on_connection = _agent_con_connect,
+		.on_msg = _agent_con_msg,
+		.on_finish = _agent_con_finish,
+		.on_connect_timeout = _agent_con_timeout,
+		.on_read_timeout = _agent_con_timeout,
+		.on_write_timeout = _agent_con_timeout,
+	};
+	static const conmgr_con_flags_t flags =
+		(CON_FLAG_WATCH_CONNECT_TIMEOUT | CON_FLAG_WATCH_READ_TIMEOUT |
+		 CON_FLAG_WATCH_WRITE_TIMEOUT);
+	/* Lock: Read node */
+	slurmctld_lock_t node_read_lock = { .node = READ_LOCK };
+	thd_t *thread_ptr = agent_ptr->thread_struct;
+	slurm_msg_type_t msg_type = agent_ptr->msg_type;
+	thd_complete_t thd_comp = {
+		.work_done = true,
+		.now = time(NULL),
+	};
+	bool comm_err;
+	int rc;
+
+	xassert(!agent_ptr->get_reply);
+
+	comm_err = ((msg_type != REQUEST_RECONFIGURE_SACKD) &&
+		    (msg_type != SRUN_JOB_COMPLETE) &&
+		    (msg_type != SRUN_STEP_MISSING) &&
+		    (msg_type != SRUN_STEP_SIGNAL) &&
+		    (msg_type != SRUN_TIMEOUT) &&
+		    (msg_type != SRUN_USER_MSG) &&
+		    (msg_type != SRUN_NODE_FAIL));
+
+	for (int i = 0; i < agent_ptr->thread_count; i++) {
+		agent_con_t *acon;
+		slurm_addr_t addr;
+
+		thread_ptr[i].start_time = time(NULL);
+
+		if (thread_ptr[i].addr) {
+			addr = *thread_ptr[i].addr;
+		} else if (slurm_conf_get_addr(thread_ptr[i].nodename, &addr,
+					       agent_ptr->msg_flags)) {
+			error("%s: can't find address for host %s, check slurm.conf",
+			      __func__, thread_ptr[i].nodename);
+			slurm_mutex_lock(&agent_ptr->thread_mutex);
+			thread_ptr[i].state = DSH_NO_RESP;
+			slurm_mutex_unlock(&agent_ptr->thread_mutex);
+			continue;
+		}
+
+		/* wait until "room" for another connection */
+		slurm_mutex_lock(&agent_con_mutex);
+		while (agent_con_cnt >= AGENT_CONMGR_MAX_CONNECTIONS)
+			slurm_cond_wait(&agent_con_cond, &agent_con_mutex);
+		agent_con_cnt++;
+		slurm_mutex_unlock(&agent_con_mutex);
+
+		acon = xmalloc(sizeof(*acon));
+		acon->agent_ptr = agent_ptr;
+		acon->thread_ptr = &thread_ptr[i];
+
+		slurm_mutex_lock(&agent_ptr->thread_mutex);
+		thread_ptr[i].state = DSH_ACTIVE;
+		agent_ptr->threads_active++;
+		slurm_mutex_unlock(&agent_ptr->thread_mutex);
+
+		log_flag(AGENT, "%s: sending %s to %s", __func__,
+			 rpc_num2string(msg_type), thread_ptr[i].nodename);
+
+		if ((rc = conmgr_create_connect_socket(CON_TYPE_RPC, &addr,
+						       sizeof(addr), &events,
+						       flags, acon))) {
+			log_flag(NET, "%s: connect to %s(%pA) failed: %s",
+				 __func__, thread_ptr[i].nodename, &addr,
+				 slurm_strerror(rc));
+			_agent_con_finish(NULL, acon);
+		}
+	}
+
+	slurm_mutex_lock(&agent_ptr->thread_mutex);
+	while (agent_ptr->threads_active)
+		slurm_cond_wait(&agent_ptr->thread_cond,
+				&agent_ptr->thread_mutex);
+
+	for (int i = 0; i < agent_ptr->thread_count; i++) {
+		if (comm_err && (thread_ptr[i].state == DSH_NO_RESP) &&
+		    thread_ptr[i].nodename) {
+			errno = SLURM_COMMUNICATIONS_SEND_ERROR;
+			lock_slurmctld(node_read_lock);
+			_comm_err(thread_ptr[i].nodename, msg_type);
+			unlock_slurmctld(node_read_lock);
+		}
+
+		_update_wdog_state(&thread_ptr[i], &thread_ptr[i].state,
+				   &thd_comp);
+	}
+	xassert(thd_comp.work_done);
+
+	_agent_complete(agent_ptr, &thd_comp);
+	slurm_mutex_unlock(&agent_ptr->thread_mutex);
+}
+
 static int _setup_requeue(agent_arg_t *agent_arg_ptr, thd_t *thread_ptr,
 			  int *count, int *spot)
 {
@@ -2011,6 +2300,11 @@ extern int get_agent_count(void)
 	return cnt;
 }
 
+extern bool agent_uses_conmgr(void)
+{
+	return xstrcasestr(slurm_conf.slurmctld_params, "agent_use_conmgr");
+}
+
 extern int get_agent_thread_count(void)
 {
 	int cnt;
@@ -45,6 +45,8 @@
 #include "src/slurmctld/slurmctld.h"
 
 #define AGENT_THREAD_COUNT	10	/* maximum active threads per agent */
+#define AGENT_CONMGR_MAX_CONNECTIONS 128 /* maximum conmgr connections for
+					  * all agents */
 
 #define LOTS_OF_AGENTS_CNT 50
 #define LOTS_OF_AGENTS ((get_agent_count() <= LOTS_OF_AGENTS_CNT) ? 0 : 1)
@@ -87,6 +89,12 @@ extern void agent_purge(void);
 /* get_agent_count - find out how many active agents we have */
 extern int get_agent_count(void);
 
+/*
+ * agent_uses_conmgr - true if SlurmctldParameters=agent_use_conmgr is set,
+ *	in which case split RPCs are sent through conmgr connections
+ */
+extern bool agent_uses_conmgr(void);
+
 /* get_agent_thread_count - get count of threads spawned by agents */
 extern int get_agent_thread_count(void);
 
@@ -127,8 +127,10 @@
 #include "src/slurmctld/reservation.h"
 #include "src/slurmctld/rpc_queue.h"
 #include "src/slurmctld/sackd_mgr.h"
+#include "src/slurmctld/sched_replay.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/slurmscriptd.h"
+#include "src/slurmctld/snapshot.h"
 #include "src/slurmctld/state_save.h"
 #include "src/slurmctld/trigger_mgr.h"
 
@@ -240,6 +242,7 @@ static pthread_cond_t reconfig_cond = PTHREAD_COND_INITIALIZER;
 static int reconfig_threads = 0;
 static int reconfig_rc = SLURM_SUCCESS;
 static bool reconfig = false;
+static int replay_cycles = 1;
 static pthread_mutex_t shutdown_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t shutdown_cond = PTHREAD_COND_INITIALIZER;
 static bool under_systemd = false;
@@ -281,6 +284,7 @@ static void         _remove_assoc(slurmdb_assoc_rec_t *rec);
 static void         _remove_qos(slurmdb_qos_rec_t *rec);
 static void         _restore_job_dependencies(void);
 static void         _run_primary_prog(bool primary_on);
+static void _run_replay(void);
 static void         _send_future_cloud_to_db();
 static void _service_connection(conmgr_callback_args_t conmgr_args,
 				int input_fd, int output_fd, void *arg);
@@ -547,6 +551,9 @@ int main(int argc, char **argv)
 		error("High latency for 1000 calls to gettimeofday(): %d microseconds",
 		      slurmctld_diag_stats.latency);
 
+	if (sched_replay_dir)
+		_run_replay();
+
 	/*
 	 * Verify clustername from conf matches value in spool dir
 	 * exit if inconsistent to protect state files from corruption.
@@ -571,9 +578,16 @@ int main(int argc, char **argv)
 	if (slurm_conf.slurmctld_params)
 		conmgr_set_params(slurm_conf.slurmctld_params);
 
-	conmgr_init(SLURMCTLD_CONMGR_DEFAULT_THREADS,
-		    SLURMCTLD_CONMGR_DEFAULT_MAX_CONNECTIONS,
-		    (conmgr_callbacks_t) {0});
+	/* Leave room for agent connections in addition to incoming RPCs */
+	if (agent_uses_conmgr())
+		conmgr_init(SLURMCTLD_CONMGR_DEFAULT_THREADS,
+			    (SLURMCTLD_CONMGR_DEFAULT_MAX_CONNECTIONS +
+			     AGENT_CONMGR_MAX_CONNECTIONS),
+			    (conmgr_callbacks_t) {0});
+	else
+		conmgr_init(SLURMCTLD_CONMGR_DEFAULT_THREADS,
+			    SLURMCTLD_CONMGR_DEFAULT_MAX_CONNECTIONS,
+			    (conmgr_callbacks_t) {0});
 
 	conmgr_add_work_fifo(_register_signal_handlers, NULL);
 
@@ -599,6 +613,7 @@ int main(int argc, char **argv)
 
 	rate_limit_init();
 	rpc_queue_init();
+	snapshot_init();
 
 	/* open ports must happen after become_slurm_user() */
 	 _open_ports();
@@ -1055,6 +1070,7 @@ int main(int argc, char **argv)
 
 	rate_limit_shutdown();
 	rpc_queue_shutdown();
+	snapshot_shutdown();
 	log_fini();
 	sched_log_fini();
 
@@ -2604,7 +2620,9 @@ extern void ctld_assoc_mgr_init(void)
 	clusteracct_storage_g_register_ctld(acct_db_conn,
 					    slurm_conf.slurmctld_port);
 
-	if (assoc_mgr_init(acct_db_conn, &assoc_init_arg, errno)) {
+	/* A replay never talks to slurmdbd, always use the state files */
+	if (assoc_mgr_init(acct_db_conn, &assoc_init_arg,
+			   sched_replay_dir ? ESLURM_DB_CONNECTION : errno)) {
 		if (accounting_enforce & ACCOUNTING_ENFORCE_ASSOCS)
 			error("Association database appears down, "
 			      "reading from state file.");
@@ -2876,10 +2894,14 @@ static void _parse_commandline(int argc, char **argv)
 
 	enum {
 		LONG_OPT_ENUM_START = 0x100,
+		LONG_OPT_REPLAY,
+		LONG_OPT_REPLAY_CYCLES,
 		LONG_OPT_SYSTEMD,
 	};
 
 	static struct option long_options[] = {
+		{"replay", required_argument, 0, LONG_OPT_REPLAY},
+		{"replay-cycles", required_argument, 0, LONG_OPT_REPLAY_CYCLES},
 		{"systemd", no_argument, 0, LONG_OPT_SYSTEMD},
 		{"version", no_argument, 0, 'V'},
 		{NULL, 0, 0, 0}
@@ -2946,6 +2968,16 @@ static void _parse_commandline(int argc, char **argv)
 			print_slurm_version();
 			exit(0);
 			break;
+		case LONG_OPT_REPLAY:
+			xfree(sched_replay_dir);
+			sched_replay_dir = xstrdup(optarg);
+			break;
+		case LONG_OPT_REPLAY_CYCLES:
+			replay_cycles = strtol(optarg, &tmp_char, 10);
+			if ((tmp_char[0] != '\0') || (replay_cycles < 1))
+				fatal("Invalid --replay-cycles value: %s",
+				      optarg);
+			break;
 		case LONG_OPT_SYSTEMD:
 			under_systemd = true;
 			break;
@@ -2958,6 +2990,12 @@ static void _parse_commandline(int argc, char **argv)
 	if (under_systemd && !daemonize)
 		fatal("--systemd and -D options are mutually exclusive");
 
+	if (sched_replay_dir) {
+		if (under_systemd)
+			fatal("--systemd and --replay options are mutually exclusive");
+		daemonize = false;
+	}
+
 	/*
 	 * Reconfiguration has historically been equivalent to recover = 1.
 	 * Force defaults in case the original process used '-c', '-i' or '-R'.
@@ -2989,6 +3027,95 @@ static void _parse_commandline(int argc, char **argv)
 	}
 }
 
+/*
+ * Load the state saved in sched_replay_dir and run scheduling cycles on it.
+ * No ports are opened and nothing is sent to slurmdbd or the slurmd, scripts
+ * are not run and state is not saved. Does not return.
+ */
+static void _run_replay(void)
+{
+	int error_code;
+	struct stat stat_buf;
+	struct timeval start, now;
+	uint64_t load_usec;
+	/* Locks: Write configuration, job, node, and partition */
+	slurmctld_lock_t config_write_lock = {
+		WRITE_LOCK, WRITE_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK };
+
+	if ((stat(sched_replay_dir, &stat_buf) < 0) ||
+	    !S_ISDIR(stat_buf.st_mode))
+		fatal("Invalid replay state directory %s", sched_replay_dir);
+
+	sched_replay_conf();
+	accounting_enforce = slurm_conf.accounting_storage_enforce;
+
+	/* Plugins must not start threads of their own to schedule jobs */
+	slurmctld_config.scheduling_disabled = true;
+
+	info("%s version %s replaying state of cluster %s from %s",
+	     slurm_prog_name, SLURM_VERSION_STRING, slurm_conf.cluster_name,
+	     sched_replay_dir);
+
+	if (auth_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize auth plugin");
+	if (hash_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize hash plugin");
+	if (license_init(slurm_conf.licenses) != SLURM_SUCCESS)
+		fatal("Invalid Licenses value: %s", slurm_conf.licenses);
+	if (cred_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize cred plugin");
+	if (select_g_init(0) != SLURM_SUCCESS)
+		fatal("failed to initialize node selection plugin");
+	if (gres_init() != SLURM_SUCCESS)
+		fatal("failed to initialize gres plugin");
+	if (preempt_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize preempt plugin");
+	if (acct_gather_conf_init() != SLURM_SUCCESS)
+		fatal("failed to initialize acct_gather plugins");
+	if (jobacct_gather_init() != SLURM_SUCCESS)
+		fatal("failed to initialize jobacct_gather plugin");
+	if (node_features_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize node_features plugin");
+	if (extra_constraints_enabled() &&
+	    serializer_g_init(MIME_TYPE_JSON_PLUGIN, NULL))
+		fatal("Extra constraints feature requires a json serializer.");
+	if (switch_g_init(true) != SLURM_SUCCESS)
+		fatal("Failed to initialize switch plugin");
+	if (acct_storage_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize accounting_storage plugin");
+	if (bb_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize burst_buffer plugin");
+
+	gettimeofday(&start, NULL);
+	ctld_assoc_mgr_init();
+	lock_slurmctld(config_write_lock);
+	if (switch_g_restore(2))
+		fatal("failed to initialize switch plugin");
+	if (priority_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize priority plugin");
+	if ((error_code = read_slurm_conf(2)))
+		fatal("read_slurm_conf reading %s: %s",
+		      slurm_conf.slurm_conf, slurm_strerror(error_code));
+	select_g_select_nodeinfo_set_all();
+	unlock_slurmctld(config_write_lock);
+	_restore_job_dependencies();
+	sync_job_priorities();
+	gettimeofday(&now, NULL);
+	load_usec = ((now.tv_sec - start.tv_sec) * USEC_IN_SEC) +
+		    now.tv_usec - start.tv_usec;
+
+	if (mcs_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize mcs plugin");
+	if (sched_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize sched plugin");
+
+	sched_replay_run(replay_cycles, load_usec);
+
+	sched_g_fini();
+	ctld_assoc_mgr_fini();
+	exit(0);
+}
+
 static void _usage(void)
 {
         char *txt;
@@ -3161,6 +3288,11 @@ void update_log_levels(int req_slurmctld_debug, int req_syslog_debug)
 	else
 		log_opts.syslog_level = LOG_LEVEL_FATAL;
 
+	if (xstrcasestr(slurm_conf.slurmctld_params, "log_async=block"))
+		log_opts.async = LOG_ASYNC_BLOCK;
+	else if (xstrcasestr(slurm_conf.slurmctld_params, "log_async"))
+		log_opts.async = LOG_ASYNC_DROP;
+
 	log_alter(log_opts, LOG_DAEMON, slurm_conf.slurmctld_logfile);
 
 	debug("slurmctld log levels: stderr=%s logfile=%s syslog=%s",
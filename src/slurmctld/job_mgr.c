@@ -75,6 +75,7 @@
 #include "src/common/tres_bind.h"
 #include "src/common/tres_frequency.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
 #include "src/interfaces/accounting_storage.h"
@@ -120,6 +121,8 @@
 #define SLURM_CREATE_JOB_FLAG_NO_ALLOCATE_0 0
 #define TOP_PRIORITY 0xffff0000	/* large, but leave headroom for higher */
 #define PURGE_OLD_JOB_IN_SEC 2592000 /* 30 days in seconds */
+#define JOB_DELTA_PURGE_AGE 600	/* seconds purged job IDs are kept for
+				 * SHOW_DELTA requests */
 
 #define JOB_HASH_INX(_job_id)	(_job_id % hash_table_size)
 #define JOB_ARRAY_HASH_INX(_job_id, _task_id)		\
@@ -127,6 +130,35 @@
 
 /* No need to change we always pack SLURM_PROTOCOL_VERSION */
 #define JOB_STATE_VERSION     "PROTOCOL_VERSION"
+#define JOB_JOURNAL_VERSION   "JOURNAL_VERSION"
+
+/*
+ * Seconds before the last job state save that a job may have been stamped
+ * and still be changed afterwards, see _pack_journal_job()
+ */
+#define JOURNAL_STAMP_SLACK 60
+
+/* Job state journal record types, see _pack_job_journal() */
+enum {
+	JOURNAL_REC_JOB = 1,	/* job_id, job_record_pack() output */
+	JOURNAL_REC_PURGE,	/* job_id */
+	JOURNAL_REC_COMMIT,	/* job_id_sequence, bf_when_last_cycle, time */
+};
+
+typedef struct {
+	uint32_t job_id;
+	uint32_t offset;	/* offset of job record in journal buffer,
+				 * 0 if the job was purged */
+} journal_job_t;
+
+typedef struct {
+	buf_t *buffer;			/* journal file contents */
+	time_t bf_when_last_cycle;
+	uint32_t job_id_sequence;
+	xhash_t *jobs;			/* journal_job_t by job_id */
+	uint16_t protocol_version;
+	list_t *records;		/* journal_job_t in journal order */
+} job_journal_t;
 
 typedef enum {
 	JOB_HASH_JOB,
@@ -147,14 +179,24 @@ typedef struct {
 	uint32_t  filter_uid;
 	bool has_qos_lock;
 	uint32_t  jobs_packed;
+	uint32_t  purged_packed;
 	uint16_t  protocol_version;
 	uint16_t  show_flags;
 	uid_t     uid;
+	time_t    update_time;	/* pack only jobs changed since, 0 for all */
+	time_t    now;
+	uint32_t  cache_ttl;	/* max seconds to reuse pack_job() output */
 	slurmdb_user_rec_t user_rec;
 	bool privileged;
 	part_record_t **visible_parts;
 } _foreach_pack_job_info_t;
 
+typedef struct {
+	uint32_t job_id;
+	time_t purge_time;
+	uint32_t user_id;
+} purged_job_t;
+
 typedef struct {
 	bitstr_t *node_map;
 	list_t *license_list;
@@ -212,14 +254,24 @@ static uint32_t lowest_prio  = TOP_PRIORITY;
 static int      hash_table_size = 0;
 static int      job_count = 0;		/* job's in the system */
 static uint32_t job_id_sequence = 0;	/* first job_id to assign new job */
+static time_t   job_delta_horizon = 0;	/* SHOW_DELTA needs newer cursor */
 static struct   job_record **job_hash = NULL;
 static struct   job_record **job_array_hash_j = NULL;
 static struct   job_record **job_array_hash_t = NULL;
 static bool     kill_invalid_dep;
 static time_t   last_file_write_time = (time_t) 0;
+static bool     journal_need_compact = true; /* next save writes job_state */
+static uint32_t *journal_purged = NULL;	/* IDs of journaled jobs purged
+					 * since the last job state save */
+static int      journal_purged_cnt = 0;
+static uint64_t journal_size = 0;	/* bytes in job_state.journal */
+static uint64_t journal_snapshot_size = 0; /* bytes in job_state */
+static time_t   journal_last_save = 0;	/* time of last job state save */
 static uint32_t max_array_size = NO_VAL;
 static bitstr_t *requeue_exit = NULL;
 static bitstr_t *requeue_exit_hold = NULL;
+static list_t  *purged_job_list = NULL;	/* purged_job_t, oldest first */
+static pthread_mutex_t pack_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
 static bool     validate_cfgd_licenses = true;
 
 /* Local functions */
@@ -261,6 +313,7 @@ static void _notify_srun_missing_step(job_record_t *job_ptr, int node_inx,
 				      time_t now, time_t node_boot_time);
 static buf_t *_open_job_state_file(char **state_file);
 static time_t _get_last_job_state_write_time(void);
+static int _load_job_record(job_record_t *job_ptr);
 static void _pack_default_job_details(job_record_t *job_ptr, buf_t *buffer,
 				      uint16_t protocol_version);
 static void _pack_pending_job_details(job_details_t *detail_ptr, buf_t *buffer,
@@ -341,6 +394,7 @@ static int _job_fail_account(job_record_t *job_ptr, const char *func_name,
 
 		xfree(job_ptr->state_desc);
 		job_ptr->state_reason = FAIL_ACCOUNT;
+		job_set_last_update(job_ptr, time(NULL));
 
 		if (job_ptr->details) {
 			/* reset the job */
@@ -420,6 +474,7 @@ extern int job_fail_qos(job_record_t *job_ptr, const char *func_name,
 
 		xfree(job_ptr->state_desc);
 		job_ptr->state_reason = FAIL_QOS;
+		job_set_last_update(job_ptr, time(NULL));
 
 		if (job_ptr->details) {
 			/* reset the job */
@@ -658,7 +713,7 @@ static int _add_job_record(job_record_t *job_ptr, int num_jobs)
 		return SLURM_ERROR;
 	}
 	job_count += num_jobs;
-	last_job_update = time(NULL);
+	job_set_last_update(job_ptr, time(NULL));
 	list_append(job_list, job_ptr);
 
 	return SLURM_SUCCESS;
@@ -808,10 +863,307 @@ static slurmdb_qos_rec_t *_determine_and_validate_qos(
 	return qos_ptr;
 }
 
+/* Write nwrite bytes of data to fd, RET 0 or errno */
+static int _write_state_data(int fd, char *data, uint32_t nwrite,
+			     const char *file)
+{
+	int pos = 0, amount;
+
+	while (nwrite > 0) {
+		amount = write(fd, &data[pos], nwrite);
+		if (amount < 0) {
+			if (errno == EINTR)
+				continue;
+			error("Error writing file %s, %m", file);
+			return errno;
+		}
+		nwrite -= amount;
+		pos    += amount;
+	}
+
+	return 0;
+}
+
+/* Checksum of a job state journal record, RET SLURM_SUCCESS or error */
+static int _journal_crc(char *data, uint32_t len, uint32_t *crc)
+{
+	slurm_hash_t hash = { .type = HASH_PLUGIN_K12 };
+
+	if (hash_g_compute(data, len, NULL, 0, &hash) < (int) sizeof(*crc)) {
+		error("%s: unable to checksum job state journal record",
+		      __func__);
+		return SLURM_ERROR;
+	}
+
+	memcpy(crc, hash.hash, sizeof(*crc));
+	return SLURM_SUCCESS;
+}
+
+/* Start a journal record, RET offset to pass to _journal_rec_end() */
+static uint32_t _journal_rec_start(uint16_t type, buf_t *buffer)
+{
+	uint32_t rec_start = get_buf_offset(buffer);
+
+	pack32(0, buffer);	/* length, set by _journal_rec_end() */
+	pack32(0, buffer);	/* checksum, set by _journal_rec_end() */
+	pack16(type, buffer);
+
+	return rec_start;
+}
+
+/* Finish a journal record, RET SLURM_SUCCESS or error */
+static int _journal_rec_end(uint32_t rec_start, buf_t *buffer)
+{
+	uint32_t rec_end = get_buf_offset(buffer);
+	uint32_t data_start = rec_start + (2 * sizeof(uint32_t));
+	uint32_t len = rec_end - data_start;
+	uint32_t crc;
+
+	if (_journal_crc(get_buf_data(buffer) + data_start, len, &crc))
+		return SLURM_ERROR;
+
+	set_buf_offset(buffer, rec_start);
+	pack32(len, buffer);
+	pack32(crc, buffer);
+	set_buf_offset(buffer, rec_end);
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Pack a job record into buffer and note its hash as the version last
+ * written to disk. Used for job_state when journaling.
+ */
+static int _dump_job_state_hash(void *object, void *arg)
+{
+	job_record_t *job_ptr = object;
+	buf_t *buffer = arg;
+	uint32_t job_start = get_buf_offset(buffer);
+
+	job_mgr_dump_job_state(job_ptr, buffer);
+
+	job_ptr->state_hash.type = HASH_PLUGIN_K12;
+	if (hash_g_compute(get_buf_data(buffer) + job_start,
+			   get_buf_offset(buffer) - job_start, NULL, 0,
+			   &job_ptr->state_hash) < 0)
+		job_ptr->state_hash.type = 0;
+	job_ptr->state_db_index = job_ptr->db_index;
+	job_ptr->state_update = job_ptr->last_update;
+
+	return 0;
+}
+
+/*
+ * Append a journal record for a job whose packed state differs from what
+ * was last written to disk.
+ * RET 0 or -1 to abort the save on error
+ */
+static int _pack_journal_job(void *object, void *arg)
+{
+	job_record_t *job_ptr = object;
+	buf_t *buffer = arg;
+	slurm_hash_t hash = { .type = HASH_PLUGIN_K12 };
+	uint32_t rec_start, job_start;
+
+	if (job_ptr->job_id == NO_VAL)
+		return 0;
+
+	/*
+	 * Changes to a job stamp last_update, so jobs not stamped since they
+	 * were last written are skipped without packing them. db_index is set
+	 * by accounting_storage without a stamp, so it is compared directly.
+	 * Writers may stamp a job with a time taken before they got the job
+	 * write lock, so jobs stamped shortly before the last save are packed
+	 * again and compared by hash.
+	 */
+	if (job_ptr->state_hash.type &&
+	    (job_ptr->last_update == job_ptr->state_update) &&
+	    (job_ptr->db_index == job_ptr->state_db_index) &&
+	    (job_ptr->last_update < (journal_last_save - JOURNAL_STAMP_SLACK)))
+		return 0;
+
+	rec_start = _journal_rec_start(JOURNAL_REC_JOB, buffer);
+	pack32(job_ptr->job_id, buffer);
+	job_start = get_buf_offset(buffer);
+	job_mgr_dump_job_state(job_ptr, buffer);
+
+	if (hash_g_compute(get_buf_data(buffer) + job_start,
+			   get_buf_offset(buffer) - job_start, NULL, 0,
+			   &hash) < 0) {
+		error("%s: unable to hash %pJ", __func__, job_ptr);
+		return -1;
+	}
+
+	job_ptr->state_db_index = job_ptr->db_index;
+	job_ptr->state_update = job_ptr->last_update;
+
+	if ((job_ptr->state_hash.type == hash.type) &&
+	    !memcmp(job_ptr->state_hash.hash, hash.hash, sizeof(hash.hash))) {
+		/* Unchanged since last written */
+		set_buf_offset(buffer, rec_start);
+		return 0;
+	}
+
+	if (_journal_rec_end(rec_start, buffer))
+		return -1;
+
+	job_ptr->state_hash = hash;
+	return 0;
+}
+
+/*
+ * Pack journal records for all jobs changed or purged since the last job
+ * state save.
+ * OUT buffer_ptr - buffer to append to job_state.journal or NULL if nothing
+ *	changed
+ * RET SLURM_SUCCESS or error if the journal can not be used and job_state
+ *	must be rewritten instead
+ * NOTE: Job read lock must be held.
+ */
+static int _pack_job_journal(time_t now, buf_t **buffer_ptr)
+{
+	static int high_buffer_size = (64 * 1024);
+	buf_t *buffer = init_buf(high_buffer_size);
+	uint32_t rec_start;
+	int rc = SLURM_SUCCESS;
+
+	*buffer_ptr = NULL;
+
+	for (int i = 0; !rc && (i < journal_purged_cnt); i++) {
+		rec_start = _journal_rec_start(JOURNAL_REC_PURGE, buffer);
+		pack32(journal_purged[i], buffer);
+		rc = _journal_rec_end(rec_start, buffer);
+	}
+
+	if (!rc && (list_for_each_ro(job_list, _pack_journal_job, buffer) < 0))
+		rc = SLURM_ERROR;
+
+	if (rc) {
+		/* Purged jobs are left out of the rewritten job_state */
+		FREE_NULL_BUFFER(buffer);
+		return rc;
+	}
+
+	journal_purged_cnt = 0;
+	xfree(journal_purged);
+	journal_last_save = now;
+
+	if (!get_buf_offset(buffer)) {
+		FREE_NULL_BUFFER(buffer);
+		return SLURM_SUCCESS;
+	}
+
+	/* Records are only applied on recovery once committed */
+	rec_start = _journal_rec_start(JOURNAL_REC_COMMIT, buffer);
+	pack32(job_id_sequence, buffer);
+	pack_time(slurmctld_diag_stats.bf_when_last_cycle, buffer);
+	pack_time(now, buffer);
+	if ((rc = _journal_rec_end(rec_start, buffer))) {
+		FREE_NULL_BUFFER(buffer);
+		return rc;
+	}
+
+	high_buffer_size = MAX(high_buffer_size, get_buf_offset(buffer));
+	*buffer_ptr = buffer;
+	return SLURM_SUCCESS;
+}
+
+/* Append journal records to job_state.journal, RET 0 or error code */
+static int _write_job_journal(buf_t *buffer)
+{
+	char *journal_file = xstrdup_printf("%s/job_state.journal",
+					    slurm_conf.state_save_location);
+	int error_code = SLURM_SUCCESS, fd, rc;
+
+	lock_state_files();
+	fd = open(journal_file, O_WRONLY|O_APPEND|O_CLOEXEC);
+	if (fd < 0) {
+		error("Can't save state, open file %s error %m",
+		      journal_file);
+		error_code = errno;
+	} else {
+		error_code = _write_state_data(fd, get_buf_data(buffer),
+					       get_buf_offset(buffer),
+					       journal_file);
+		rc = fsync_and_close(fd, "job journal");
+		if (rc && !error_code)
+			error_code = rc;
+	}
+	unlock_state_files();
+
+	if (error_code) {
+		/* The journal may end with a partial record, start over */
+		journal_need_compact = true;
+	} else {
+		journal_size += get_buf_offset(buffer);
+	}
+
+	xfree(journal_file);
+	return error_code;
+}
+
+/*
+ * Start a new job_state.journal for the job_state file just written at
+ * snapshot_time, or remove it when not journaling.
+ * NOTE: State files must be locked.
+ */
+static void _reset_job_journal(bool journal, time_t snapshot_time,
+			       uint32_t snapshot_size)
+{
+	char *journal_file = xstrdup_printf("%s/job_state.journal",
+					    slurm_conf.state_save_location);
+	char *new_file = xstrdup_printf("%s.new", journal_file);
+	buf_t *buffer;
+	int fd, rc;
+
+	journal_need_compact = true;
+	if (!journal) {
+		(void) unlink(journal_file);
+		goto fini;
+	}
+
+	buffer = init_buf(BUF_SIZE);
+	packstr(JOB_JOURNAL_VERSION, buffer);
+	pack16(SLURM_PROTOCOL_VERSION, buffer);
+	pack_time(snapshot_time, buffer);
+
+	fd = open(new_file, O_CREAT|O_WRONLY|O_TRUNC|O_CLOEXEC, 0600);
+	if (fd < 0) {
+		error("Can't save state, create file %s error %m", new_file);
+		rc = errno;
+	} else {
+		rc = _write_state_data(fd, get_buf_data(buffer),
+				       get_buf_offset(buffer), new_file);
+		if (fsync_and_close(fd, "job journal") && !rc)
+			rc = SLURM_ERROR;
+	}
+
+	if (!rc && rename(new_file, journal_file)) {
+		error("Can't rename %s to %s: %m", new_file, journal_file);
+		rc = errno;
+	}
+
+	if (rc) {
+		(void) unlink(new_file);
+	} else {
+		journal_size = get_buf_offset(buffer);
+		journal_snapshot_size = snapshot_size;
+		journal_need_compact = false;
+	}
+	FREE_NULL_BUFFER(buffer);
+
+fini:
+	xfree(journal_file);
+	xfree(new_file);
+}
+
 /*
  * dump_all_job_state - save the state of all jobs to file for checkpoint
  *	Changes here should be reflected in load_last_job_id() and
  *	load_all_job_state().
+ *
+ *	With SlurmctldParameters=job_state_journal only jobs changed since
+ *	the last save are appended to job_state.journal. The full job_state
+ *	file is only rewritten once the journal grows larger than it.
  * RET 0 or error code
  */
 int dump_all_job_state(void)
@@ -824,11 +1176,12 @@ int dump_all_job_state(void)
 	/* Locks: Read config and job */
 	slurmctld_lock_t job_read_lock =
 		{ READ_LOCK, READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
-	buf_t *buffer = init_buf(high_buffer_size);
+	buf_t *buffer;
 	time_t now = time(NULL);
 	time_t last_state_file_time;
 	static time_t last_job_state_size_check = 0;
-	uint32_t jobs_start, jobs_end, jobs_count;
+	uint32_t jobs_start, jobs_end, jobs_count, nwrite = 0;
+	bool journal;
 	DEF_TIMERS;
 
 	START_TIMER;
@@ -851,6 +1204,36 @@ int dump_all_job_state(void)
 		}
 	}
 
+	lock_slurmctld(job_read_lock);
+
+	journal = (xstrcasestr(slurm_conf.slurmctld_params,
+			       "job_state_journal") != NULL);
+	if (journal && !journal_need_compact &&
+	    (journal_size < journal_snapshot_size)) {
+		if (!_pack_job_journal(now, &buffer)) {
+			unlock_slurmctld(job_read_lock);
+			if (buffer)
+				error_code = _write_job_journal(buffer);
+			FREE_NULL_BUFFER(buffer);
+			END_TIMER2(__func__);
+			return error_code;
+		}
+
+		/* Fall back to rewriting job_state */
+		error("%s: unable to journal job state, writing all jobs",
+		      __func__);
+		journal_need_compact = true;
+	}
+
+	/*
+	 * A journal is only applied to the job_state file with the same time
+	 * stamp, so never reuse the time stamp of the previous file.
+	 */
+	if (journal && (now <= last_state_file_time))
+		now = last_state_file_time + 1;
+
+	buffer = init_buf(high_buffer_size);
+
 	/* write header: version, time */
 	packstr(JOB_STATE_VERSION, buffer);
 	pack16(SLURM_PROTOCOL_VERSION, buffer);
@@ -867,14 +1250,18 @@ int dump_all_job_state(void)
 	       job_id_sequence);
 
 	/* write individual job records */
-	lock_slurmctld(job_read_lock);
-
 	verify_job_state_cache_synced();
 
 	pack_time(slurmctld_diag_stats.bf_when_last_cycle, buffer);
 
+	/* Everything purged so far is absent from the new job_state file */
+	journal_purged_cnt = 0;
+	xfree(journal_purged);
+	journal_last_save = now;
+
 	jobs_start = get_buf_offset(buffer);
-	list_for_each_ro(job_list, job_mgr_dump_job_state, buffer);
+	list_for_each_ro(job_list, journal ? _dump_job_state_hash :
+			 job_mgr_dump_job_state, buffer);
 	jobs_end = get_buf_offset(buffer);
 	if ((difftime(now, last_job_state_size_check) > 60) &&
 	    (jobs_count = list_count(job_list))) {
@@ -928,30 +1315,21 @@ int dump_all_job_state(void)
 		      new_file);
 		error_code = errno;
 	} else {
-		int pos = 0, amount, rc;
-		char *data;
-		uint32_t nwrite = get_buf_offset(buffer);
+		int rc;
 
-		data = (char *)get_buf_data(buffer);
+		nwrite = get_buf_offset(buffer);
 		high_buffer_size = MAX(nwrite, high_buffer_size);
-		while (nwrite > 0) {
-			amount = write(log_fd, &data[pos], nwrite);
-			if ((amount < 0) && (errno != EINTR)) {
-				error("Error writing file %s, %m", new_file);
-				error_code = errno;
-				break;
-			}
-			nwrite -= amount;
-			pos    += amount;
-		}
+		error_code = _write_state_data(log_fd, get_buf_data(buffer),
+					       nwrite, new_file);
 
 		rc = fsync_and_close(log_fd, "job");
 		if (rc && !error_code)
 			error_code = rc;
 	}
-	if (error_code)
+	if (error_code) {
 		(void) unlink(new_file);
-	else {			/* file shuffle */
+		journal_need_compact = true;
+	} else {			/* file shuffle */
 		(void) unlink(old_file);
 		if (link(reg_file, old_file))
 			debug4("unable to create link for %s -> %s: %m",
@@ -962,6 +1340,7 @@ int dump_all_job_state(void)
 			       new_file, reg_file);
 		(void) unlink(new_file);
 		last_file_write_time = now;
+		_reset_job_journal(journal, now, nwrite);
 	}
 	xfree(old_file);
 	xfree(reg_file);
@@ -1069,7 +1448,7 @@ extern void set_job_failed_assoc_qos_ptr(job_record_t *job_ptr)
 
 			job_ptr->state_reason = WAIT_NO_REASON;
 			xfree(job_ptr->state_desc);
-			last_job_update = time(NULL);
+			job_set_last_update(job_ptr, time(NULL));
 		}
 	}
 
@@ -1094,7 +1473,7 @@ extern void set_job_failed_assoc_qos_ptr(job_record_t *job_ptr)
 			      __func__, job_ptr, qos_rec.name, job_ptr->qos_id);
 			job_ptr->state_reason = WAIT_NO_REASON;
 			xfree(job_ptr->state_desc);
-			last_job_update = time(NULL);
+			job_set_last_update(job_ptr, time(NULL));
 		}
 	}
 }
@@ -1124,6 +1503,7 @@ extern void set_job_tres_req_str(job_record_t *job_ptr, bool assoc_mgr_locked)
 extern void backup_slurmctld_restart(void)
 {
 	last_file_write_time = (time_t) 0;
+	journal_need_compact = true;
 }
 
 /* Return the time stamp in the current job state save file, 0 is returned on
@@ -1157,6 +1537,138 @@ unpack_error:
 	return buf_time;
 }
 
+static void _journal_job_id(void *item, const char **key, uint32_t *key_len)
+{
+	journal_job_t *rec = item;
+
+	*key = (const char *) &rec->job_id;
+	*key_len = sizeof(rec->job_id);
+}
+
+static void _free_job_journal(job_journal_t *journal)
+{
+	xhash_free(journal->jobs);
+	FREE_NULL_LIST(journal->records);
+	FREE_NULL_BUFFER(journal->buffer);
+}
+
+/* Note the latest committed version of each job in the journal */
+static void _commit_journal_jobs(job_journal_t *journal, journal_job_t *batch,
+				 int batch_cnt)
+{
+	for (int i = 0; i < batch_cnt; i++) {
+		journal_job_t *rec = xhash_get(journal->jobs,
+					       (char *) &batch[i].job_id,
+					       sizeof(batch[i].job_id));
+		if (!rec) {
+			rec = xmalloc(sizeof(*rec));
+			rec->job_id = batch[i].job_id;
+			list_append(journal->records, rec);
+			xhash_add(journal->jobs, rec);
+		}
+		rec->offset = batch[i].offset;
+	}
+}
+
+/*
+ * Read job_state.journal written after the job_state file with time stamp
+ * snapshot_time. Records following the last complete, valid commit record
+ * are discarded.
+ * OUT journal - Use _free_job_journal() to release. journal->records is NULL
+ *	if there is no applicable journal.
+ */
+static void _load_job_journal(time_t snapshot_time, job_journal_t *journal)
+{
+	char *journal_file = xstrdup_printf("%s/job_state.journal",
+					    slurm_conf.state_save_location);
+	char *ver_str = NULL;
+	buf_t *buffer;
+	journal_job_t *batch = NULL;
+	int batch_cnt = 0, commit_cnt = 0;
+	uint32_t good_end = 0;
+	time_t journal_time = 0;
+
+	memset(journal, 0, sizeof(*journal));
+
+	if (!(buffer = create_mmap_buf(journal_file))) {
+		debug("No job state journal (%s) to recover", journal_file);
+		xfree(journal_file);
+		return;
+	}
+
+	safe_unpackstr(&ver_str, buffer);
+	if (xstrcmp(ver_str, JOB_JOURNAL_VERSION))
+		goto unpack_error;
+	safe_unpack16(&journal->protocol_version, buffer);
+	safe_unpack_time(&journal_time, buffer);
+	if (journal_time != snapshot_time) {
+		info("Ignoring job state journal %s, it was not written for this job_state file",
+		     journal_file);
+		goto fini;
+	}
+
+	journal->buffer = buffer;
+	journal->jobs = xhash_init(_journal_job_id, NULL);
+	journal->records = list_create(xfree_ptr);
+
+	good_end = get_buf_offset(buffer);
+	while (remaining_buf(buffer) > 0) {
+		uint32_t len, crc, rec_crc, rec_start;
+		uint16_t type;
+
+		safe_unpack32(&len, buffer);
+		safe_unpack32(&crc, buffer);
+		rec_start = get_buf_offset(buffer);
+		if ((len > remaining_buf(buffer)) ||
+		    _journal_crc(get_buf_data(buffer) + rec_start, len,
+				 &rec_crc) ||
+		    (rec_crc != crc))
+			break;
+
+		safe_unpack16(&type, buffer);
+		if ((type == JOURNAL_REC_JOB) || (type == JOURNAL_REC_PURGE)) {
+			if (!(batch_cnt % 1024))
+				xrecalloc(batch, batch_cnt + 1024,
+					  sizeof(*batch));
+			safe_unpack32(&batch[batch_cnt].job_id, buffer);
+			if (type == JOURNAL_REC_JOB)
+				batch[batch_cnt].offset =
+					get_buf_offset(buffer);
+			batch_cnt++;
+		} else if (type == JOURNAL_REC_COMMIT) {
+			safe_unpack32(&journal->job_id_sequence, buffer);
+			safe_unpack_time(&journal->bf_when_last_cycle, buffer);
+			safe_unpack_time(&journal_time, buffer);
+			_commit_journal_jobs(journal, batch, batch_cnt);
+			batch_cnt = 0;
+			commit_cnt++;
+			good_end = rec_start + len;
+		} else {
+			break;
+		}
+		set_buf_offset(buffer, rec_start + len);
+	}
+
+unpack_error:
+	if (!journal->buffer) {
+		error("Invalid job state journal %s, ignoring it",
+		      journal_file);
+		goto fini;
+	}
+	if (good_end < size_buf(buffer))
+		error("Discarding %u bytes of incomplete job state journal %s",
+		      size_buf(buffer) - good_end, journal_file);
+	info("Recovered %d job state journal updates from %s",
+	     commit_cnt, journal_file);
+	buffer = NULL;
+
+fini:
+	FREE_NULL_BUFFER(buffer);
+	xfree(batch);
+	xfree(ver_str);
+	xfree(journal_file);
+}
+
 /*
  * load_all_job_state - load the job state from file, recover from last
  *	checkpoint. Execute this after loading the configuration file data.
@@ -1173,6 +1685,7 @@ extern int load_all_job_state(void)
 	uint32_t saved_job_id;
 	char *ver_str = NULL;
 	uint16_t protocol_version = NO_VAL16;
+	job_journal_t journal = { 0 };
 
 	/* read the file */
 	lock_state_files();
@@ -1204,12 +1717,19 @@ extern int load_all_job_state(void)
 	}
 
 	safe_unpack_time(&buf_time, buffer);
+	_load_job_journal(buf_time, &journal);
 	safe_unpack32(&saved_job_id, buffer);
 	if (saved_job_id <= slurm_conf.max_job_id)
 		job_id_sequence = MAX(saved_job_id, job_id_sequence);
 	debug3("Job id in job_state header is %u", saved_job_id);
+	if (journal.records &&
+	    (journal.job_id_sequence <= slurm_conf.max_job_id))
+		job_id_sequence = MAX(journal.job_id_sequence,
+				      job_id_sequence);
 
 	safe_unpack_time(&buf_time, buffer); /* bf_when_last_cycle */
+	if (journal.records && journal.bf_when_last_cycle)
+		buf_time = journal.bf_when_last_cycle;
 	if (!slurmctld_diag_stats.bf_when_last_cycle)
 		slurmctld_diag_stats.bf_when_last_cycle = buf_time;
 
@@ -1221,13 +1741,60 @@ extern int load_all_job_state(void)
 	 * into the job_mgr_load_job_state function than any other option.
 	 */
 	while (remaining_buf(buffer) > 0) {
-		error_code = job_mgr_load_job_state(buffer, protocol_version);
+		job_record_t *job_ptr = NULL;
+
+		if (!journal.records) {
+			error_code = job_mgr_load_job_state(buffer,
+							    protocol_version);
+			if (error_code != SLURM_SUCCESS)
+				goto unpack_error;
+			job_cnt++;
+			continue;
+		}
+
+		if (job_record_unpack(&job_ptr, slurmctld_tres_cnt, buffer,
+				      protocol_version)) {
+			error("failed to load job from state");
+			goto unpack_error;
+		}
+		if (xhash_get(journal.jobs, (char *) &job_ptr->job_id,
+			      sizeof(job_ptr->job_id))) {
+			/*
+			 * Superseded by the journal. Clear the state so the
+			 * batch script of a finished job is not queued for
+			 * removal when freeing this copy.
+			 */
+			job_ptr->job_state = JOB_PENDING;
+			job_record_delete(job_ptr);
+			continue;
+		}
+		error_code = _load_job_record(job_ptr);
 		if (error_code != SLURM_SUCCESS)
 			goto unpack_error;
 		job_cnt++;
 	}
+
+	if (journal.records) {
+		list_itr_t *iter = list_iterator_create(journal.records);
+		journal_job_t *rec;
+
+		while ((rec = list_next(iter))) {
+			if (!rec->offset)
+				continue;	/* purged */
+			set_buf_offset(journal.buffer, rec->offset);
+			error_code = job_mgr_load_job_state(
+				journal.buffer, journal.protocol_version);
+			if (error_code != SLURM_SUCCESS)
+				break;
+			job_cnt++;
+		}
+		list_iterator_destroy(iter);
+		if (error_code != SLURM_SUCCESS)
+			goto unpack_error;
+	}
 	debug3("Set job_id_sequence to %u", job_id_sequence);
 
+	_free_job_journal(&journal);
 	FREE_NULL_BUFFER(buffer);
 	info("Recovered information about %d jobs", job_cnt);
 	return error_code;
@@ -1237,6 +1804,7 @@ unpack_error:
 		fatal("Incomplete job state save file, start with '-i' to ignore this. Warning: using -i will lose the data that can't be recovered.");
 	error("Incomplete job state save file");
 	info("Recovered information about %d jobs", job_cnt);
+	_free_job_journal(&journal);
 	FREE_NULL_BUFFER(buffer);
 	return SLURM_ERROR;
 }
@@ -1253,6 +1821,7 @@ extern int load_last_job_id( void )
 	time_t buf_time;
 	char *ver_str = NULL;
 	uint16_t protocol_version = NO_VAL16;
+	job_journal_t journal;
 
 	/* read the file */
 	lock_state_files();
@@ -1285,6 +1854,12 @@ extern int load_last_job_id( void )
 	safe_unpack32( &job_id_sequence, buffer);
 	debug3("Job ID in job_state header is %u", job_id_sequence);
 
+	_load_job_journal(buf_time, &journal);
+	if (journal.records)
+		job_id_sequence = MAX(journal.job_id_sequence,
+				      job_id_sequence);
+	_free_job_journal(&journal);
+
 	/* Ignore the state for individual jobs stored here */
 
 	xfree(ver_str);
@@ -1322,10 +1897,24 @@ extern int job_mgr_dump_job_state(void *object, void *arg)
 
 extern int job_mgr_load_job_state(buf_t *buffer,
 				  uint16_t protocol_version)
+{
+	job_record_t *job_ptr = NULL;
+
+	if (job_record_unpack(&job_ptr, slurmctld_tres_cnt, buffer,
+			      protocol_version)) {
+		error("failed to load job from state");
+		error("Incomplete job record");
+		return SLURM_ERROR;
+	}
+
+	return _load_job_record(job_ptr);
+}
+
+/* Add a job record unpacked from state save to the job list */
+static int _load_job_record(job_record_t *job_ptr)
 {
 	time_t now = time(NULL);
 	list_t *part_ptr_list = NULL;
-	job_record_t *job_ptr = NULL;
 	part_record_t *part_ptr;
 	int qos_error, rc;
 	slurmdb_assoc_rec_t assoc_rec;
@@ -1338,12 +1927,6 @@ extern int job_mgr_load_job_state(buf_t *buffer,
 		.user = READ_LOCK
 	};
 
-	if (job_record_unpack(&job_ptr, slurmctld_tres_cnt, buffer,
-			      protocol_version)) {
-		error("failed to load job from state");
-		goto unpack_error;
-	}
-
 	if (find_job_record(job_ptr->job_id)) {
 		error("duplicate job state record found for %pJ", job_ptr);
 		goto unpack_error;
@@ -1540,7 +2123,7 @@ extern int job_mgr_load_job_state(buf_t *buffer,
 		&job_ptr->gres_used);
 
 	on_job_state_change(job_ptr, job_ptr->job_state);
-	last_job_update = now;
+	job_set_last_update(job_ptr, now);
 	return SLURM_SUCCESS;
 
 unpack_error:
@@ -3273,6 +3856,10 @@ void init_job_conf(void)
 	}
 
 	last_job_update = time(NULL);
+	job_delta_horizon = last_job_update;
+
+	if (!purged_job_list)
+		purged_job_list = list_create(xfree_ptr);
 
 	if (!purge_files_list) {
 		purge_files_list = list_create(xfree_ptr);
@@ -3351,6 +3938,8 @@ extern job_record_t *job_array_split(job_record_t *job_ptr, bool list_add)
 	job_ptr_pend->db_flags = 0;
 	job_ptr_pend->step_list = save_step_list;
 	job_ptr_pend->db_index = save_db_index;
+	job_ptr_pend->last_update = job_ptr->last_update = time(NULL);
+	job_ptr_pend->pack_cache = NULL;
 
 	job_ptr_pend->prio_factors = save_prio_factors;
 	slurm_copy_priority_factors(job_ptr_pend->prio_factors,
@@ -3852,6 +4441,7 @@ static int _select_nodes_parts(job_record_t *job_ptr, bool test_only,
 	list_itr_t *iter;
 	int rc = ESLURM_REQUESTED_PART_CONFIG_UNAVAILABLE;
 	int best_rc = -1, part_limits_rc = WAIT_NO_REASON;
+	uint32_t old_reason = job_ptr->state_reason;
 	bitstr_t *save_avail_node_bitmap = NULL;
 
 	save_avail_node_bitmap = bit_copy(avail_node_bitmap);
@@ -3936,6 +4526,9 @@ static int _select_nodes_parts(job_record_t *job_ptr, bool test_only,
 	else if (rc == ESLURM_INVALID_ACCOUNT)
 		job_ptr->state_reason = FAIL_ACCOUNT;
 
+	if (job_ptr->state_reason != old_reason)
+		job_set_last_update(job_ptr, time(NULL));
+
 	FREE_NULL_BITMAP(avail_node_bitmap);
 	avail_node_bitmap = save_avail_node_bitmap;
 
@@ -4188,7 +4781,7 @@ extern int job_allocate(job_desc_msg_t *job_desc, int immediate,
 	}
 
 	if (!test_only) {
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 	}
 
 	if (held_user)
@@ -5039,7 +5632,7 @@ extern int job_signal(job_record_t *job_ptr, uint16_t signal,
 		}
 	}
 
-	last_job_update = now;
+	job_set_last_update(job_ptr, now);
 
 	/*
 	 * Handle jobs submitted through scrontab.
@@ -5876,7 +6469,7 @@ extern int prolog_complete(uint32_t job_id, uint32_t prolog_return_code,
 		job_ptr->state_reason = WAIT_NO_REASON;
 		agent_trigger(999, false, true);
 	}
-	last_job_update = time(NULL);
+	job_set_last_update(job_ptr, time(NULL));
 
 	return SLURM_SUCCESS;
 }
@@ -6094,7 +6687,7 @@ static int _job_complete(job_record_t *job_ptr, uid_t uid, bool requeue,
 		job_completion_logger(job_ptr, false);
 	}
 
-	last_job_update = now;
+	job_set_last_update(job_ptr, now);
 	job_ptr->time_last_active = now;   /* Timer for resending kill RPC */
 	if (job_comp_flag) {	/* job was running */
 		build_cg_bitmap(job_ptr);
@@ -8787,7 +9380,7 @@ extern void job_config_fini(job_record_t *job_ptr)
 {
 	time_t now = time(NULL);
 
-	last_job_update = now;
+	job_set_last_update(job_ptr, now);
 	job_state_unset_flag(job_ptr, JOB_CONFIGURING);
 	if (IS_JOB_POWER_UP_NODE(job_ptr)) {
 		info("Resetting %pJ start time for node power up", job_ptr);
@@ -8954,7 +9547,7 @@ void job_time_limit(void)
 		    IS_JOB_PENDING(job_ptr) && (job_ptr->priority == 0)) {
 			job_ptr->state_reason = WAIT_NO_REASON;
 			set_job_prio(job_ptr);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 		}
 
 		/* Don't enforce time limits for configuring hetjobs */
@@ -9032,7 +9625,7 @@ void job_time_limit(void)
 			else
 				over_run = now - (over_time_limit  * 60);
 			if (job_ptr->end_time <= over_run) {
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 				info("Time limit exhausted for %pJ", job_ptr);
 				_job_timed_out(job_ptr, false);
 				job_ptr->state_reason = FAIL_TIMEOUT;
@@ -9044,7 +9637,7 @@ void job_time_limit(void)
 		if (job_ptr->resv_ptr &&
 		    !(job_ptr->resv_ptr->flags & RESERVE_FLAG_FLEX) &&
 		    (job_ptr->resv_ptr->end_time + resv_over_run) < time(NULL)){
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			info("Reservation ended for %pJ", job_ptr);
 			xfree(job_ptr->state_desc);
 			xstrfmtcat(job_ptr->state_desc, "Reservation %s, which this job was running under, has ended",
@@ -9065,7 +9658,7 @@ void job_time_limit(void)
 		acct_policy_job_time_out(job_ptr);
 
 		if (job_ptr->state_reason == FAIL_TIMEOUT) {
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			_job_timed_out(job_ptr, false);
 			xfree(job_ptr->state_desc);
 			goto time_check;
@@ -9532,6 +10125,23 @@ static void _delete_job_common(job_record_t *job_ptr)
 	if (!job_ptr->job_id)
 		return;
 
+	/* Remember the job ID for SHOW_DELTA requests */
+	if (purged_job_list && (job_ptr->job_id != NO_VAL)) {
+		purged_job_t *purged = xmalloc(sizeof(*purged));
+		purged->job_id = job_ptr->job_id;
+		purged->purge_time = time(NULL);
+		purged->user_id = job_ptr->user_id;
+		list_append(purged_job_list, purged);
+	}
+
+	/* Remember the job ID for the next job state journal record */
+	if (job_ptr->state_hash.type && (job_ptr->job_id != NO_VAL)) {
+		if (!(journal_purged_cnt % 64))
+			xrecalloc(journal_purged, journal_purged_cnt + 64,
+				  sizeof(*journal_purged));
+		journal_purged[journal_purged_cnt++] = job_ptr->job_id;
+	}
+
 	/* Remove record from fed_job_list */
 	fed_mgr_remove_fed_job_info(job_ptr->job_id);
 
@@ -9738,6 +10348,155 @@ static bool _hide_job_user_rec(job_record_t *job_ptr, slurmdb_user_rec_t *user,
 	return false;
 }
 
+/* Get SlurmctldParameters=job_pack_cache_ttl, 0 if pack caching is disabled */
+static uint32_t _get_pack_cache_ttl(void)
+{
+	static time_t conf_update = 0;
+	static uint32_t cache_ttl = 0;
+	char *tmp_ptr;
+
+	slurm_mutex_lock(&pack_cache_mutex);
+	if (conf_update != slurm_conf.last_update) {
+		conf_update = slurm_conf.last_update;
+		cache_ttl = 0;
+		if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params,
+					   "job_pack_cache_ttl="))) {
+			cache_ttl = strtol(tmp_ptr +
+					   strlen("job_pack_cache_ttl="),
+					   NULL, 10);
+		}
+	}
+	slurm_mutex_unlock(&pack_cache_mutex);
+
+	return cache_ttl;
+}
+
+/*
+ * Find the cached pack_job() output for this request, if still current.
+ * NOTE: pack_cache_mutex must be locked before calling this.
+ */
+static job_pack_cache_t *_find_pack_cache(job_record_t *job_ptr,
+					  _foreach_pack_job_info_t *pack_info)
+{
+	job_pack_cache_t *cache;
+	job_record_t *array_head;
+	time_t min_pack_time;
+
+	if (!job_ptr->pack_cache)
+		return NULL;
+
+	/*
+	 * The packed record also depends on the configuration, the partition's
+	 * MaxTime and, for array tasks, on the meta job's max_run_tasks.
+	 */
+	min_pack_time = MAX(job_ptr->last_update, last_part_update);
+	min_pack_time = MAX(min_pack_time, job_delta_horizon);
+	if (job_ptr->array_job_id && !job_ptr->array_recs &&
+	    (array_head = find_job_record(job_ptr->array_job_id)))
+		min_pack_time = MAX(min_pack_time, array_head->last_update);
+
+	for (int i = 0; i < JOB_PACK_CACHE_SLOTS; i++) {
+		cache = &job_ptr->pack_cache[i];
+		if (!cache->buffer ||
+		    (cache->protocol_version != pack_info->protocol_version) ||
+		    (cache->show_flags != pack_info->show_flags))
+			continue;
+		/*
+		 * last_update has a resolution of one second, so only trust
+		 * output packed after the second the job last changed.
+		 */
+		if ((cache->pack_time <= min_pack_time) ||
+		    (cache->expire <= pack_info->now))
+			return NULL;
+		return cache;
+	}
+
+	return NULL;
+}
+
+/*
+ * Save pack_job() output of size bytes starting at offset of the response
+ * buffer, replacing the oldest (or stale) entry of the job's cache.
+ * NOTE: pack_cache_mutex must be locked before calling this.
+ */
+static void _save_pack_cache(job_record_t *job_ptr,
+			     _foreach_pack_job_info_t *pack_info,
+			     uint32_t offset, uint32_t size)
+{
+	job_pack_cache_t *cache = NULL, *oldest = NULL;
+	time_t expire = pack_info->now + pack_info->cache_ttl;
+
+	/* Pending jobs report an expected start time that moves with now */
+	if (!IS_JOB_STARTED(job_ptr)) {
+		if (job_ptr->start_time)
+			expire = MIN(expire, job_ptr->start_time);
+		else if (job_ptr->details &&
+			 (job_ptr->details->begin_time > pack_info->now))
+			expire = MIN(expire, job_ptr->details->begin_time);
+	}
+	if (expire <= pack_info->now)
+		return;
+
+	if (!job_ptr->pack_cache)
+		job_ptr->pack_cache = xcalloc(JOB_PACK_CACHE_SLOTS,
+					      sizeof(*job_ptr->pack_cache));
+
+	for (int i = 0; i < JOB_PACK_CACHE_SLOTS; i++) {
+		job_pack_cache_t *slot = &job_ptr->pack_cache[i];
+
+		if (!slot->buffer ||
+		    ((slot->protocol_version == pack_info->protocol_version) &&
+		     (slot->show_flags == pack_info->show_flags))) {
+			cache = slot;
+			break;
+		}
+		if (!oldest || (slot->pack_time < oldest->pack_time))
+			oldest = slot;
+	}
+	if (!cache)
+		cache = oldest;
+
+	FREE_NULL_BUFFER(cache->buffer);
+	cache->buffer = init_buf(size);
+	packmem_array(&get_buf_data(pack_info->buffer)[offset], size,
+		      cache->buffer);
+	cache->expire = expire;
+	cache->pack_time = pack_info->now;
+	cache->protocol_version = pack_info->protocol_version;
+	cache->show_flags = pack_info->show_flags;
+}
+
+/*
+ * Pack a job record, reusing the output of an earlier pack_job() call for
+ * the same protocol_version and show_flags if the job has not changed since.
+ * The job read lock allows concurrent callers, so the cache itself is
+ * protected by pack_cache_mutex.
+ */
+static void _pack_job_cached(job_record_t *job_ptr,
+			     _foreach_pack_job_info_t *pack_info)
+{
+	job_pack_cache_t *cache;
+	uint32_t offset;
+
+	slurm_mutex_lock(&pack_cache_mutex);
+	if ((cache = _find_pack_cache(job_ptr, pack_info))) {
+		packbuf(cache->buffer, pack_info->buffer);
+		slurm_mutex_unlock(&pack_cache_mutex);
+		return;
+	}
+	slurm_mutex_unlock(&pack_cache_mutex);
+
+	offset = get_buf_offset(pack_info->buffer);
+	pack_job(job_ptr, pack_info->show_flags, pack_info->buffer,
+		 pack_info->protocol_version, pack_info->uid,
+		 pack_info->has_qos_lock);
+
+	slurm_mutex_lock(&pack_cache_mutex);
+	_save_pack_cache(job_ptr, pack_info, offset,
+			 (get_buf_offset(pack_info->buffer) - offset));
+	slurm_mutex_unlock(&pack_cache_mutex);
+}
+
 static int _pack_job(void *object, void *arg)
 {
 	job_record_t *job_ptr = (job_record_t *)object;
@@ -9752,6 +10511,9 @@ static int _pack_job(void *object, void *arg)
 	if (!(pack_info->show_flags & SHOW_ALL) && IS_JOB_REVOKED(job_ptr))
 		return SLURM_SUCCESS;
 
+	if (job_ptr->last_update < pack_info->update_time)
+		return SLURM_SUCCESS;
+
 	if (!pack_info->privileged) {
 		if (((pack_info->show_flags & SHOW_ALL) == 0) &&
 		    _all_parts_hidden(job_ptr, pack_info->visible_parts))
@@ -9762,9 +10524,12 @@ static int _pack_job(void *object, void *arg)
 			return SLURM_SUCCESS;
 	}
 
-	pack_job(job_ptr, pack_info->show_flags, pack_info->buffer,
-		 pack_info->protocol_version, pack_info->uid,
-		 pack_info->has_qos_lock);
+	if (pack_info->cache_ttl)
+		_pack_job_cached(job_ptr, pack_info);
+	else
+		pack_job(job_ptr, pack_info->show_flags, pack_info->buffer,
+			 pack_info->protocol_version, pack_info->uid,
+			 pack_info->has_qos_lock);
 
 	pack_info->jobs_packed++;
 
@@ -9804,20 +10569,77 @@ static buf_t *_pack_init_job_info(uint16_t protocol_version)
 	return buffer;
 }
 
+static int _foreach_pack_purged_job(void *x, void *arg)
+{
+	purged_job_t *purged = x;
+	_foreach_pack_job_info_t *pack_info = arg;
+
+	if (purged->purge_time < pack_info->update_time)
+		return SLURM_SUCCESS;
+
+	if ((pack_info->filter_uid != NO_VAL) &&
+	    (pack_info->filter_uid != purged->user_id))
+		return SLURM_SUCCESS;
+
+	if (!pack_info->privileged &&
+	    (slurm_conf.private_data & PRIVATE_DATA_JOBS) &&
+	    (purged->user_id != pack_info->uid))
+		return SLURM_SUCCESS;
+
+	pack32(purged->job_id, pack_info->buffer);
+	pack_info->purged_packed++;
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * _pack_fini_job_info - append the trailer to a job_info_msg_t buffer and put
+ *	the real record count in its header
+ *
+ * NOTE: change _unpack_job_info_msg() in common/slurm_protocol_pack.c
+ *	whenever the data format changes
+ */
+static void _pack_fini_job_info(_foreach_pack_job_info_t *pack_info)
+{
+	uint32_t count_offset, tmp_offset;
+	bool delta = (pack_info->update_time != 0);
+
+	if (pack_info->protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		packbool(delta, pack_info->buffer);
+
+		/* Purged job IDs, packed as with pack32_array() */
+		count_offset = get_buf_offset(pack_info->buffer);
+		pack32(0, pack_info->buffer);
+		if (delta)
+			list_for_each_ro(purged_job_list,
+					 _foreach_pack_purged_job, pack_info);
+		tmp_offset = get_buf_offset(pack_info->buffer);
+		set_buf_offset(pack_info->buffer, count_offset);
+		pack32(pack_info->purged_packed, pack_info->buffer);
+		set_buf_offset(pack_info->buffer, tmp_offset);
+	}
+
+	/* put the real record count in the message body header */
+	tmp_offset = get_buf_offset(pack_info->buffer);
+	set_buf_offset(pack_info->buffer, 0);
+	pack32(pack_info->jobs_packed, pack_info->buffer);
+	set_buf_offset(pack_info->buffer, tmp_offset);
+}
+
 /*
  * pack_all_jobs - dump all job information for all jobs in
  *	machine independent form (for network transmission)
  * IN show_flags - job filtering options
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN update_time - with SHOW_DELTA, pack only jobs changed since this time
  * OUT buffer
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
  */
 extern buf_t *pack_all_jobs(uint16_t show_flags, uid_t uid, uint32_t filter_uid,
-			    uint16_t protocol_version)
+			    time_t update_time, uint16_t protocol_version)
 {
-	uint32_t tmp_offset;
 	_foreach_pack_job_info_t pack_info = {
 		.buffer = _pack_init_job_info(protocol_version),
 		.filter_uid = filter_uid,
@@ -9825,6 +10647,8 @@ extern buf_t *pack_all_jobs(uint16_t show_flags, uid_t uid, uint32_t filter_uid,
 		.protocol_version = protocol_version,
 		.show_flags = show_flags,
 		.uid = uid,
+		.now = time(NULL),
+		.cache_ttl = _get_pack_cache_ttl(),
 		.has_qos_lock = true,
 		.user_rec.uid = uid,
 	};
@@ -9837,14 +10661,21 @@ extern buf_t *pack_all_jobs(uint16_t show_flags, uid_t uid, uint32_t filter_uid,
 	pack_info.privileged = validate_operator_user_rec(&pack_info.user_rec);
 	pack_info.visible_parts = build_visible_parts(
 		uid, (pack_info.privileged || (show_flags & SHOW_ALL)));
+
+	/*
+	 * Only honor SHOW_DELTA if every change since update_time is known
+	 * and the client can unpack the delta trailer, otherwise fall back to
+	 * packing all jobs.
+	 */
+	if ((show_flags & SHOW_DELTA) &&
+	    (protocol_version >= SLURM_24_11_PROTOCOL_VERSION) &&
+	    (update_time > job_delta_horizon))
+		pack_info.update_time = update_time;
+
 	list_for_each_ro(job_list, _pack_job, &pack_info);
 	assoc_mgr_unlock(&locks);
 
-	/* put the real record count in the message body header */
-	tmp_offset = get_buf_offset(pack_info.buffer);
-	set_buf_offset(pack_info.buffer, 0);
-	pack32(pack_info.jobs_packed, pack_info.buffer);
-	set_buf_offset(pack_info.buffer, tmp_offset);
+	_pack_fini_job_info(&pack_info);
 
 	xfree(pack_info.visible_parts);
 
@@ -9865,7 +10696,6 @@ extern buf_t *pack_all_jobs(uint16_t show_flags, uid_t uid, uint32_t filter_uid,
 extern buf_t *pack_spec_jobs(list_t *job_ids, uint16_t show_flags, uid_t uid,
 			     uint32_t filter_uid, uint16_t protocol_version)
 {
-	uint32_t tmp_offset;
 	_foreach_pack_job_info_t pack_info = {
 		.buffer = _pack_init_job_info(protocol_version),
 		.filter_uid = filter_uid,
@@ -9873,6 +10703,8 @@ extern buf_t *pack_spec_jobs(list_t *job_ids, uint16_t show_flags, uid_t uid,
 		.protocol_version = protocol_version,
 		.show_flags = show_flags,
 		.uid = uid,
+		.now = time(NULL),
+		.cache_ttl = _get_pack_cache_ttl(),
 		.has_qos_lock = true,
 		.user_rec.uid = uid,
 	};
@@ -9890,11 +10722,7 @@ extern buf_t *pack_spec_jobs(list_t *job_ids, uint16_t show_flags, uid_t uid,
 	list_for_each_ro(job_ids, _foreach_pack_jobid, &pack_info);
 	assoc_mgr_unlock(&locks);
 
-	/* put the real record count in the message body header */
-	tmp_offset = get_buf_offset(pack_info.buffer);
-	set_buf_offset(pack_info.buffer, 0);
-	pack32(pack_info.jobs_packed, pack_info.buffer);
-	set_buf_offset(pack_info.buffer, tmp_offset);
+	_pack_fini_job_info(&pack_info);
 
 	xfree(pack_info.visible_parts);
 
@@ -9938,8 +10766,9 @@ extern buf_t *pack_one_job(uint32_t job_id, uint16_t show_flags, uid_t uid,
 			   uint16_t protocol_version)
 {
 	job_record_t *job_ptr;
-	uint32_t jobs_packed = 0, tmp_offset;
+	uint32_t jobs_packed = 0;
 	buf_t *buffer;
+	_foreach_pack_job_info_t pack_info = { 0 };
 	assoc_mgr_lock_t locks = { .qos = READ_LOCK, .user = READ_LOCK };
 	slurmdb_user_rec_t user_rec = { 0 };
 	bool hide_job = false;
@@ -10019,11 +10848,10 @@ extern buf_t *pack_one_job(uint32_t job_id, uint16_t show_flags, uid_t uid,
 		return NULL;
 	}
 
-	/* put the real record count in the message body header */
-	tmp_offset = get_buf_offset(buffer);
-	set_buf_offset(buffer, 0);
-	pack32(jobs_packed, buffer);
-	set_buf_offset(buffer, tmp_offset);
+	pack_info.buffer = buffer;
+	pack_info.jobs_packed = jobs_packed;
+	pack_info.protocol_version = protocol_version;
+	_pack_fini_job_info(&pack_info);
 
 	return buffer;
 }
@@ -11144,6 +11972,8 @@ static inline bool _purge_complete_het_job(job_record_t *het_job_leader)
  */
 void handle_invalid_dependency(job_record_t *job_ptr)
 {
+	if (job_ptr->state_reason != WAIT_DEP_INVALID)
+		job_set_last_update(job_ptr, time(NULL));
 	job_ptr->state_reason = WAIT_DEP_INVALID;
 	xfree(job_ptr->state_desc);
 
@@ -11165,6 +11995,35 @@ void handle_invalid_dependency(job_record_t *job_ptr)
 	fed_mgr_remove_remote_dependencies(job_ptr);
 }
 
+/*
+ * Forget purged job IDs older than JOB_DELTA_PURGE_AGE. SHOW_DELTA requests
+ * with a cursor from before the newest forgotten entry get a full job list.
+ */
+static void _trim_purged_job_list(time_t now)
+{
+	purged_job_t *purged;
+	time_t min_time = now - JOB_DELTA_PURGE_AGE;
+
+	while ((purged = list_peek(purged_job_list)) &&
+	       (purged->purge_time < min_time)) {
+		job_delta_horizon = MAX(job_delta_horizon, purged->purge_time);
+		purged = list_pop(purged_job_list);
+		xfree(purged);
+	}
+}
+
+extern void job_set_last_update(job_record_t *job_ptr, time_t now)
+{
+	job_ptr->last_update = now;
+	last_job_update = now;
+}
+
+extern void job_delta_reset(void)
+{
+	last_job_update = time(NULL);
+	job_delta_horizon = last_job_update;
+}
+
 /*
  * purge_old_job - purge old job records.
  *	The jobs must have completed at least MIN_JOB_AGE minutes ago.
@@ -11221,6 +12080,8 @@ void purge_old_job(void)
 		slurm_cond_signal(&purge_thread_cond);
 		slurm_mutex_unlock(&purge_thread_lock);
 	}
+
+	_trim_purged_job_list(time(NULL));
 }
 
 extern void free_old_jobs(void)
@@ -11360,14 +12221,17 @@ static int _set_job_id(job_record_t *job_ptr)
  */
 extern void set_job_prio(job_record_t *job_ptr)
 {
-	uint32_t relative_prio;
+	uint32_t relative_prio, old_prio;
 
 	xassert(job_ptr);
 	xassert (job_ptr->magic == JOB_MAGIC);
 
 	if (IS_JOB_FINISHED(job_ptr))
 		return;
+	old_prio = job_ptr->priority;
 	job_ptr->priority = priority_g_set(lowest_prio, job_ptr);
+	if (job_ptr->priority != old_prio)
+		job_set_last_update(job_ptr, time(NULL));
 	if ((job_ptr->priority == 0) || (job_ptr->direct_set_prio))
 		return;
 
@@ -11529,11 +12393,13 @@ static bool _top_priority(job_record_t *job_ptr, uint32_t het_job_offset)
 			    && job_ptr->state_reason != WAIT_MAX_REQUEUE) {
 				job_ptr->state_reason = WAIT_HELD;
 				xfree(job_ptr->state_desc);
+				job_set_last_update(job_ptr, now);
 			}
 		} else if (job_ptr->state_reason == WAIT_NO_REASON &&
 			   het_job_offset == NO_VAL) {
 			job_ptr->state_reason = WAIT_PRIORITY;
 			xfree(job_ptr->state_desc);
+			job_set_last_update(job_ptr, now);
 		}
 	}
 	return top;
@@ -11576,6 +12442,7 @@ static void _hold_job_rec(job_record_t *job_ptr, uid_t uid)
 
 	job_ptr->direct_set_prio = 1;
 	job_ptr->priority = 0;
+	job_set_last_update(job_ptr, now);
 
 	if (job_ptr->details && (job_ptr->details->begin_time < now))
 		job_ptr->details->begin_time = 0;
@@ -11851,7 +12718,7 @@ static int _update_job(job_record_t *job_ptr, job_desc_msg_t *job_desc,
 		if (IS_JOB_COMPLETED(job_ptr) && operator &&
 		    (job_desc->burst_buffer[0] == '\0')) {
 			xfree(job_ptr->burst_buffer);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 		} else {
 			error_code = ESLURM_NOT_SUPPORTED;
 		}
@@ -11928,7 +12795,7 @@ static int _update_job(job_record_t *job_ptr, job_desc_msg_t *job_desc,
 	detail_ptr = job_ptr->details;
 	if (detail_ptr)
 		mc_ptr = detail_ptr->mc_ptr;
-	last_job_update = now;
+	job_set_last_update(job_ptr, now);
 
 	/*
 	 * Check to see if the new requested job_desc exceeds any
@@ -15458,7 +16325,7 @@ extern int job_alloc_info_ptr(uint32_t uid, job_record_t *job_ptr)
 	    (prolog == 0) && job_ptr->node_bitmap &&
 	    (bit_overlap_any(power_down_node_bitmap,
 	                     job_ptr->node_bitmap) == 0)) {
-		last_job_update = time(NULL);
+		job_set_last_update(job_ptr, time(NULL));
 		set_job_alias_list(job_ptr);
 	}
 
@@ -16028,6 +16895,7 @@ void job_fini (void)
 	xfree(job_array_hash_t);
 	FREE_NULL_LIST(purge_jobs_list);
 	FREE_NULL_LIST(purge_files_list);
+	FREE_NULL_LIST(purged_job_list);
 	FREE_NULL_BITMAP(requeue_exit);
 	FREE_NULL_BITMAP(requeue_exit_hold);
 }
@@ -16057,6 +16925,8 @@ extern bool job_array_start_test(job_record_t *job_ptr)
 		    (base_job_ptr->array_recs->max_run_tasks != 0) &&
 		    (base_job_ptr->array_recs->tot_run_tasks >=
 		     base_job_ptr->array_recs->max_run_tasks)) {
+			if (job_ptr->state_reason != WAIT_ARRAY_TASK_LIMIT)
+				job_set_last_update(job_ptr, now);
 			if (job_ptr->details &&
 			    (job_ptr->details->begin_time <= now))
 				job_ptr->details->begin_time = (time_t) 0;
@@ -16227,16 +17097,9 @@ extern void job_completion_logger(job_record_t *job_ptr, bool requeue)
 	jobacct_storage_g_job_complete(acct_db_conn, job_ptr);
 }
 
-/*
- * job_independent - determine if this job has a dependent job pending
- *	or if the job's scheduled begin time is in the future
- * IN job_ptr - pointer to job being tested
- * RET - true if job no longer must be deferred for another job
- */
-extern bool job_independent(job_record_t *job_ptr)
+static bool _job_independent(job_record_t *job_ptr, time_t now)
 {
 	job_details_t *detail_ptr = job_ptr->details;
-	time_t now = time(NULL);
 	int depend_rc;
 
 	if ((job_ptr->state_reason == FAIL_BURST_BUFFER_OP) ||
@@ -16306,6 +17169,28 @@ extern bool job_independent(job_record_t *job_ptr)
 	return true;
 }
 
+/*
+ * job_independent - determine if this job has a dependent job pending
+ *	or if the job's scheduled begin time is in the future
+ * IN job_ptr - pointer to job being tested
+ * RET - true if job no longer must be deferred for another job
+ */
+extern bool job_independent(job_record_t *job_ptr)
+{
+	time_t now = time(NULL);
+	uint32_t old_reason = job_ptr->state_reason;
+	time_t old_begin = job_ptr->details ? job_ptr->details->begin_time : 0;
+	bool rc = _job_independent(job_ptr, now);
+
+	/* Only stamp real changes, this runs for every pending job */
+	if ((job_ptr->state_reason != old_reason) ||
+	    (job_ptr->details &&
+	     (job_ptr->details->begin_time != old_begin)))
+		job_set_last_update(job_ptr, now);
+
+	return rc;
+}
+
 /*
  * determine if job is ready to execute per the node select plugin
  * IN job_id - job to test
@@ -16350,7 +17235,7 @@ extern int job_node_ready(uint32_t job_id, int *ready)
 	    job_ptr->node_bitmap &&
 	    (bit_overlap_any(power_down_node_bitmap,
 	                     job_ptr->node_bitmap) == 0)) {
-		last_job_update = time(NULL);
+		job_set_last_update(job_ptr, time(NULL));
 		set_job_alias_list(job_ptr);
 	}
 
@@ -16536,7 +17421,8 @@ static int _suspend_job_nodes(job_record_t *job_ptr, bool indf_susp)
 			node_ptr->last_busy  = now;
 		}
 	}
-	last_job_update = last_node_update = now;
+	last_node_update = now;
+	job_set_last_update(job_ptr, now);
 	return rc;
 }
 
@@ -16586,7 +17472,8 @@ static int _resume_job_nodes(job_record_t *job_ptr, bool indf_susp)
 		node_flags = node_ptr->node_state & NODE_STATE_FLAGS;
 		node_ptr->node_state = NODE_STATE_ALLOCATED | node_flags;
 	}
-	last_job_update = last_node_update = time(NULL);
+	last_node_update = time(NULL);
+	job_set_last_update(job_ptr, last_node_update);
 	return rc;
 }
 
@@ -17023,7 +17910,7 @@ static int _job_requeue_op(uid_t uid, job_record_t *job_ptr, bool preempt,
 			return SLURM_SUCCESS;
 	}
 
-	last_job_update = now;
+	job_set_last_update(job_ptr, now);
 
 	/*
 	 * In the job is in the process of completing
@@ -17417,6 +18304,7 @@ static int _set_top(list_t *top_job_list, uid_t uid)
 	int64_t delta_prio, delta_nice, total_delta = 0;
 	int other_job_cnt = 0;
 	uint32_t *prio_elem;
+	time_t now = time(NULL);
 
 	xassert(job_list);
 	xassert(top_job_list);
@@ -17521,6 +18409,7 @@ static int _set_top(list_t *top_job_list, uid_t uid)
 		job_ptr->priority = next_prio;
 		job_ptr->details->nice -= delta_nice;
 		job_ptr->bit_flags &= (~TOP_PRIO_TMP);
+		job_set_last_update(job_ptr, now);
 	}
 	list_iterator_destroy(iter);
 	FREE_NULL_LIST(prio_list);
@@ -17539,6 +18428,7 @@ static int _set_top(list_t *top_job_list, uid_t uid)
 			job_ptr->priority = next_prio;
 			job_ptr->details->nice += delta_nice;
 			job_ptr->bit_flags &= (~TOP_PRIO_TMP);
+			job_set_last_update(job_ptr, now);
 			total_delta -= delta_nice;
 			if (--other_job_cnt == 0)
 				break;	/* Count will match list size anyway */
@@ -17547,7 +18437,7 @@ static int _set_top(list_t *top_job_list, uid_t uid)
 	}
 	FREE_NULL_LIST(other_job_list);
 
-	last_job_update = time(NULL);
+	last_job_update = now;
 
 	return rc;
 }
@@ -17815,7 +18705,7 @@ extern int update_job_wckey(char *module, job_record_t *job_ptr,
 		info("%s: cleared wckey for %pJ", module, job_ptr);
 	}
 
-	last_job_update = time(NULL);
+	job_set_last_update(job_ptr, time(NULL));
 
 	return SLURM_SUCCESS;
 }
@@ -18392,7 +19282,7 @@ static void _kill_dependent(job_record_t *job_ptr)
 	job_ptr->start_time = now;
 	job_ptr->end_time = now;
 	job_completion_logger(job_ptr, false);
-	last_job_update = now;
+	job_set_last_update(job_ptr, now);
 	srun_allocate_abort(job_ptr);
 }
 
@@ -324,7 +324,7 @@ static bool _job_runnable_test1(job_record_t *job_ptr, bool sched_plugin)
 		 * previous run hasn't finished yet */
 		job_ptr->state_reason = WAIT_CLEANING;
 		xfree(job_ptr->state_desc);
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 		sched_debug3("%pJ. State=PENDING. Reason=Cleaning.", job_ptr);
 		return false;
 	}
@@ -334,7 +334,7 @@ static bool _job_runnable_test1(job_record_t *job_ptr, bool sched_plugin)
 	if (job_ptr->state_reason == WAIT_FRONT_END) {
 		job_ptr->state_reason = WAIT_NO_REASON;
 		xfree(job_ptr->state_desc);
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 	}
 #endif
 
@@ -351,7 +351,7 @@ static bool _job_runnable_test1(job_record_t *job_ptr, bool sched_plugin)
 		    (job_ptr->state_reason != WAIT_RESV_DELETED)) {
 			job_ptr->state_reason = WAIT_HELD;
 			xfree(job_ptr->state_desc);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 		}
 		sched_debug3("%pJ. State=%s. Reason=%s. Priority=%u.",
 			     job_ptr,
@@ -367,7 +367,7 @@ static bool _job_runnable_test1(job_record_t *job_ptr, bool sched_plugin)
 		/* released behind active dependency? */
 		job_ptr->state_reason = WAIT_DEPENDENCY;
 		xfree(job_ptr->state_desc);
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 	}
 
 	if (!job_indepen)	/* can not run now */
@@ -394,7 +394,7 @@ static bool _job_runnable_test2(job_record_t *job_ptr, time_t now,
 	     (job_state_reason_check(job_ptr->state_reason, JSR_PART)))) {
 		job_ptr->state_reason = reason;
 		xfree(job_ptr->state_desc);
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 	}
 	if (reason != WAIT_NO_REASON)
 		return false;
@@ -622,7 +622,7 @@ static int _foreach_wait_front_end(void *x, void *arg)
 
 	job_ptr->state_reason = WAIT_FRONT_END;
 	xfree(job_ptr->state_desc);
-	last_job_update = now;
+	job_set_last_update(job_ptr, now);
 
 	return 0;
 }
@@ -758,7 +758,7 @@ extern list_t *build_job_queue(bool clear_start, bool backfill)
 			     job_ptr->state_reason_prev_db)) {
 				job_ptr->state_reason_prev_db =
 					job_ptr->state_reason;
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 			}
 		}
 
@@ -937,6 +937,15 @@ extern void schedule(bool full_queue)
 	slurm_mutex_unlock(&sched_mutex);
 }
 
+/*
+ * Run the main scheduling loop once in the calling thread, bypassing the
+ * sched_agent request queue
+ */
+extern int schedule_cycle(bool full_queue)
+{
+	return _schedule(full_queue);
+}
+
 /* detached thread periodically attempts to schedule jobs */
 static void *_sched_agent(void *args)
 {
@@ -1040,7 +1049,7 @@ extern bool deadline_ok(job_record_t *job_ptr, const char *func)
 		}
 	}
 	if (fail_job) {
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 		job_state_set(job_ptr, JOB_DEADLINE);
 		job_ptr->exit_code = 1;
 		job_ptr->state_reason = FAIL_DEADLINE;
@@ -1085,7 +1094,7 @@ extern void fill_array_reasons(job_record_t *job_ptr,
 		/* Set the reason for the subsequent array task */
 		xfree(job_ptr->state_desc);
 		job_ptr->state_reason = reject_array_job->state_reason;
-		last_job_update = time(NULL);
+		job_set_last_update(job_ptr, time(NULL));
 		debug3("%s: Setting reason of array task %pJ to %s",
 		       __func__, job_ptr,
 		       job_state_reason_string(job_ptr->state_reason));
@@ -1523,7 +1532,7 @@ static int _schedule(bool full_queue)
 			if (!avail_front_end(job_ptr)) {
 				job_ptr->state_reason = WAIT_FRONT_END;
 				xfree(job_ptr->state_desc);
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 				continue;
 			}
 			if (!_job_runnable_test1(job_ptr, false))
@@ -1566,7 +1575,7 @@ next_part:
 			if (!avail_front_end(job_ptr)) {
 				job_ptr->state_reason = WAIT_FRONT_END;
 				xfree(job_ptr->state_desc);
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 				xfree(job_queue_rec);
 				continue;
 			}
@@ -1652,7 +1661,7 @@ next_task:
 			if (job_ptr->state_reason == WAIT_NO_REASON) {
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = WAIT_PRIORITY;
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 			}
 			if (job_ptr->part_ptr == skip_part_ptr)
 				continue;
@@ -1705,7 +1714,7 @@ next_task:
 			if (found_resv) {
 				job_ptr->state_reason = WAIT_PRIORITY;
 				xfree(job_ptr->state_desc);
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 				sched_debug3("%pJ. State=PENDING. Reason=Priority. Priority=%u. Resv=%s.",
 					     job_ptr,
 					     job_ptr->priority,
@@ -1732,7 +1741,7 @@ next_task:
 					    job_ptr->priority);
 				job_ptr->state_reason = WAIT_PRIORITY;
 				xfree(job_ptr->state_desc);
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 			} else {
 				/*
 				 * Log job can not run even though we are not
@@ -1745,7 +1754,7 @@ next_task:
 					     job_ptr->state_desc,
 					     job_ptr->priority);
 			}
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 
 			continue;
 		} else if (wait_on_resv &&
@@ -1773,12 +1782,12 @@ next_task:
 				assoc_mgr_unlock(&locks);
 				sched_debug("%pJ has invalid QOS", job_ptr);
 				job_fail_qos(job_ptr, __func__, false);
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 				continue;
 			} else if (job_ptr->state_reason == FAIL_QOS) {
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = WAIT_NO_REASON;
-				last_job_update = now;
+				job_set_last_update(job_ptr, now);
 			}
 			assoc_mgr_unlock(&locks);
 		}
@@ -1836,7 +1845,7 @@ next_task:
 			job_ptr->state_reason = WAIT_RESOURCES;
 			xfree(job_ptr->state_desc);
 			job_ptr->state_desc = xstrdup("Nodes required for job are DOWN, DRAINED or reserved for jobs in higher priority partitions");
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			sched_debug3("%pJ. State=%s. Reason=%s. Priority=%u. Partition=%s.",
 				     job_ptr,
 				     job_state_string(job_ptr->job_state),
@@ -1855,7 +1864,7 @@ next_task:
 			 * the time we consider running it. It should be
 			 * very rare. */
 			sched_info("%pJ has invalid account", job_ptr);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			job_ptr->state_reason = FAIL_ACCOUNT;
 			xfree(job_ptr->state_desc);
 			continue;
@@ -1966,7 +1975,7 @@ skip_start:
 		} else if (error_code == ESLURM_FED_JOB_LOCK) {
 			job_ptr->state_reason = WAIT_FED_JOB_LOCK;
 			xfree(job_ptr->state_desc);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			sched_debug3("%pJ. State=%s. Reason=%s. Priority=%u. Partition=%s. Couldn't get federation job lock.",
 				     job_ptr,
 				     job_state_string(job_ptr->job_state),
@@ -1977,7 +1986,7 @@ skip_start:
 		} else if (error_code == SLURM_SUCCESS) {
 			/* job initiated */
 			sched_debug3("%pJ initiated", job_ptr);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 
 			/* Clear assumed rejected array status */
 			reject_array_job = NULL;
@@ -2034,6 +2043,7 @@ skip_start:
 				   job_ptr, slurm_strerror(error_code));
 			job_ptr->state_reason = WAIT_MAX_POWERED_NODES;
 			xfree(job_ptr->state_desc);
+			job_set_last_update(job_ptr, now);
 		} else if (error_code == ESLURM_PORTS_BUSY) {
 			/*
 			 * This can only happen if using stepd step manager.
@@ -2042,6 +2052,7 @@ skip_start:
 			fail_by_part = true;
 			job_ptr->state_reason = WAIT_MPI_PORTS_BUSY;
 			xfree(job_ptr->state_desc);
+			job_set_last_update(job_ptr, now);
 			sched_debug3("%pJ. State=%s. Reason=%s. Priority=%u. Partition=%s.",
 				     job_ptr,
 				     job_state_string(job_ptr->job_state),
@@ -2054,7 +2065,7 @@ skip_start:
 			   (error_code != ESLURM_INVALID_BURST_BUFFER_REQUEST)){
 			sched_info("schedule: %pJ non-runnable: %s",
 				   job_ptr, slurm_strerror(error_code));
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			job_state_set(job_ptr, JOB_PENDING);
 			job_ptr->state_reason = FAIL_BAD_CONSTRAINTS;
 			xfree(job_ptr->state_desc);
@@ -2477,7 +2488,7 @@ job_failed:
 	xfree(job_ptr->state_desc);
 	job_ptr->state_desc = xstrdup(fail_why);
 	job_ptr->state_reason = FAIL_SYSTEM;
-	last_job_update = time(NULL);
+	job_set_last_update(job_ptr, time(NULL));
 	slurm_free_job_launch_msg(launch_msg_ptr);
 	/* ignore the return as job is in an unknown state anyway */
 	job_complete(job_ptr->job_id, slurm_conf.slurm_user_id, false, false,
@@ -3135,6 +3146,7 @@ static int _test_job_dependency_common(
 			job_ptr->time_limit = djob_ptr->end_time - now;
 			job_ptr->time_limit /= 60;  /* sec to min */
 			*clear_dep = true;
+			job_set_last_update(job_ptr, now);
 		}
 		if (!*failure && job_ptr->details && djob_ptr->details) {
 			job_ptr->details->share_res =
@@ -3301,7 +3313,7 @@ extern int test_job_dependency(job_record_t *job_ptr, bool *was_changed)
 	if (or_satisfied && (job_ptr->state_reason == WAIT_DEP_INVALID)) {
 		job_ptr->state_reason = WAIT_NO_REASON;
 		xfree(job_ptr->state_desc);
-		last_job_update = time(NULL);
+		job_set_last_update(job_ptr, time(NULL));
 	}
 
 	if (or_satisfied || (!or_flag && !and_failed && !has_unfulfilled)) {
@@ -3899,7 +3911,7 @@ extern int handle_job_dependency_updates(void *object, void *arg)
 		    (job_ptr->state_reason == WAIT_DEPENDENCY)) {
 			job_ptr->state_reason = WAIT_NO_REASON;
 			xfree(job_ptr->state_desc);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 		}
 		_depend_list2str(job_ptr, false);
 		fed_mgr_job_requeue(job_ptr);
@@ -3914,7 +3926,7 @@ extern int handle_job_dependency_updates(void *object, void *arg)
 			/* Still dependent */
 			job_ptr->state_reason = WAIT_DEPENDENCY;
 			xfree(job_ptr->state_desc);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 		}
 	}
 	if (slurm_conf.debug_flags & DEBUG_FLAG_DEPENDENCY)
@@ -5414,7 +5426,7 @@ extern void rebuild_job_part_list(job_record_t *job_ptr)
 
 	if (!job_ptr->part_ptr_list) {
 		job_ptr->partition = xstrdup(job_ptr->part_ptr->name);
-		last_job_update = time(NULL);
+		job_set_last_update(job_ptr, time(NULL));
 		return;
 	}
 
@@ -5424,7 +5436,7 @@ extern void rebuild_job_part_list(job_record_t *job_ptr)
 	} else if (IS_JOB_PENDING(job_ptr))
 		arg.flags |= REBUILD_PENDING;
 	list_for_each(job_ptr->part_ptr_list, _build_partition_string, &arg);
-	last_job_update = time(NULL);
+	job_set_last_update(job_ptr, time(NULL));
 }
 
 /* cleanup_completing()
@@ -221,6 +221,14 @@ extern void rebuild_job_part_list(job_record_t *job_ptr);
  */
 extern void schedule(bool full_queue);
 
+/*
+ * Run the main scheduling loop once in the calling thread. Only used when
+ * main_sched_init() has not been called, e.g. by "slurmctld --replay".
+ * IN full_queue - ignore default_queue_depth and test all pending jobs
+ * RET count of jobs started
+ */
+extern int schedule_cycle(bool full_queue);
+
 /*
  * set_job_elig_time - set the eligible time for pending jobs once their
  *	dependencies are lifted (in job->details->begin_time)
@@ -301,6 +301,7 @@ extern void job_state_set(job_record_t *job_ptr, uint32_t state)
 	on_job_state_change(job_ptr, state);
 
 	job_ptr->job_state = state;
+	job_ptr->last_update = time(NULL);
 }
 
 extern void job_state_set_flag(job_record_t *job_ptr, uint32_t flag)
@@ -326,6 +327,10 @@ extern void job_state_set_flag(job_record_t *job_ptr, uint32_t flag)
 	on_job_state_change(job_ptr, job_state);
 
 	job_ptr->job_state = job_state;
+
+	/* JOB_UPDATE_DB is internal and only holds a job read lock */
+	if (flag != JOB_UPDATE_DB)
+		job_ptr->last_update = time(NULL);
 }
 
 extern void job_state_unset_flag(job_record_t *job_ptr, uint32_t flag)
@@ -343,6 +348,7 @@ extern void job_state_unset_flag(job_record_t *job_ptr, uint32_t flag)
 	on_job_state_change(job_ptr, job_state);
 
 	job_ptr->job_state = job_state;
+	job_ptr->last_update = time(NULL);
 }
 
 static job_state_response_job_t *_append_job_state(job_state_args_t *args)
@@ -4718,7 +4718,7 @@ void make_node_idle(node_record_t *node_ptr, job_record_t *job_ptr)
 	xassert(node_ptr);
 	if (node_bitmap && (bit_test(node_bitmap, node_ptr->index))) {
 		/* Not a replay */
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 		bit_clear(node_bitmap, node_ptr->index);
 
 		if (!IS_JOB_FINISHED(job_ptr))
@@ -976,7 +976,7 @@ static void _find_qos_grp_node_bitmap(job_record_t *job_ptr,
 	    (qos_ptr->max_tres_pu_ctld[TRES_ARRAY_NODE] != INFINITE64)) {
 		*per_user_limit = true;
 		used_limits = acct_policy_get_user_used_limits(
-			&qos_ptr->usage->user_limit_list,
+			qos_ptr->usage,
 			job_ptr->user_id);
 		if (used_limits && used_limits->node_bitmap) {
 			if (*grp_node_bitmap)
@@ -993,7 +993,7 @@ static void _find_qos_grp_node_bitmap(job_record_t *job_ptr,
 	    (qos_ptr->max_tres_pa_ctld[TRES_ARRAY_NODE] != INFINITE64)) {
 		*per_acct_limit = true;
 		used_limits = acct_policy_get_acct_used_limits(
-			&qos_ptr->usage->acct_limit_list,
+			qos_ptr->usage,
 			job_ptr->assoc_ptr->acct);
 		if (used_limits && used_limits->node_bitmap) {
 			if (*grp_node_bitmap)
@@ -2419,7 +2419,7 @@ static int _get_resv_mpi_ports(job_record_t *job_ptr,
 			job_ptr->time_last_active = 0;
 			job_ptr->end_time = 0;
 			job_ptr->state_reason = WAIT_RESOURCES;
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			xfree(job_ptr->state_desc);
 			return error_code;
 		}
@@ -2488,7 +2488,7 @@ static int _get_resv_mpi_ports(job_record_t *job_ptr,
 			job_ptr->time_last_active = 0;
 			job_ptr->end_time = 0;
 			job_ptr->state_reason = WAIT_MPI_PORTS_BUSY;
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			xfree(job_ptr->state_desc);
 		}
 	}
@@ -2496,33 +2496,9 @@ static int _get_resv_mpi_ports(job_record_t *job_ptr,
 	return error_code;
 }
 
-/*
- * select_nodes - select and allocate nodes to a specific job
- * IN job_ptr - pointer to the job record
- * IN test_only - if set do not allocate nodes, just confirm they
- *	could be allocated now
- * IN select_node_bitmap - bitmap of nodes to be used for the
- *	job's resource allocation (not returned if NULL), caller
- *	must free
- * IN submission - if set ignore reservations
- * IN scheduler_type - which scheduler is calling this
- *      (i.e. SLURMDB_JOB_FLAG_BACKFILL, SLURMDB_JOB_FLAG_SCHED, etc)
- * OUT err_msg - if not NULL set to error message for job, caller must xfree
- * RET 0 on success, ESLURM code from slurm_errno.h otherwise
- * globals: list_part - global list of partition info
- *	default_part_loc - pointer to default partition
- *	config_list - global list of node configuration info
- * Notes: The algorithm is
- *	1) Build a table (node_set_ptr) of nodes with the requisite
- *	   configuration. Each table entry includes their weight,
- *	   node_list, features, etc.
- *	2) Call _pick_best_nodes() to select those nodes best satisfying
- *	   the request, (e.g. best-fit or other criterion)
- *	3) Call allocate_nodes() to perform the actual allocation
- */
-extern int select_nodes(job_record_t *job_ptr, bool test_only,
-			bitstr_t **select_node_bitmap, char **err_msg,
-			bool submission, uint32_t scheduler_type)
+static int _select_nodes(job_record_t *job_ptr, bool test_only,
+			 bitstr_t **select_node_bitmap, char **err_msg,
+			 bool submission, uint32_t scheduler_type)
 {
 	int bb, error_code = SLURM_SUCCESS, i, node_set_size = 0;
 	bitstr_t *select_bitmap = NULL;
@@ -2605,7 +2581,7 @@ extern int select_nodes(job_record_t *job_ptr, bool test_only,
 			   part_ptr->allow_groups);
 		debug2("%s: %s", __func__, job_ptr->state_desc);
 		job_ptr->state_reason = WAIT_ACCOUNT;
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 		return ESLURM_REQUESTED_PART_CONFIG_UNAVAILABLE;
 	}
 
@@ -2626,7 +2602,7 @@ extern int select_nodes(job_record_t *job_ptr, bool test_only,
 		    (job_ptr->state_reason == FAIL_BURST_BUFFER_OP))
 			return ESLURM_BURST_BUFFER_WAIT; /* Fatal BB event */
 		xfree(job_ptr->state_desc);
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 		if (bb == 0)
 			job_ptr->state_reason = WAIT_BURST_BUFFER_STAGING;
 		else
@@ -2827,7 +2803,7 @@ extern int select_nodes(job_record_t *job_ptr, bool test_only,
 			       __func__, job_ptr);
 			job_ptr->state_reason = WAIT_PART_NODE_LIMIT;
 			xfree(job_ptr->state_desc);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 
 		/* Non-fatal errors for job below */
 		} else if (error_code == ESLURM_NODE_NOT_AVAIL) {
@@ -2863,7 +2839,7 @@ extern int select_nodes(job_record_t *job_ptr, bool test_only,
 					   "for other job");
 			}
 			xfree(unavail_node);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 		} else if (error_code == ESLURM_RESERVATION_MAINT) {
 			error_code = ESLURM_RESERVATION_BUSY;	/* All reserved */
 			job_ptr->state_reason = WAIT_NODE_NOT_AVAIL;
@@ -2959,7 +2935,7 @@ extern int select_nodes(job_record_t *job_ptr, bool test_only,
 		job_ptr->end_time = 0;
 		job_ptr->priority = 0;
 		job_ptr->state_reason = WAIT_HELD;
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 		goto cleanup;
 	}
 	if (select_g_job_begin(job_ptr) != SLURM_SUCCESS) {
@@ -2974,7 +2950,7 @@ extern int select_nodes(job_record_t *job_ptr, bool test_only,
 		job_ptr->time_last_active = 0;
 		job_ptr->end_time = 0;
 		job_ptr->state_reason = WAIT_RESOURCES;
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 		goto cleanup;
 	}
 
@@ -2997,7 +2973,7 @@ extern int select_nodes(job_record_t *job_ptr, bool test_only,
 		job_ptr->time_last_active = 0;
 		job_ptr->end_time = 0;
 		job_ptr->state_reason = WAIT_RESOURCES;
-		last_job_update = now;
+		job_set_last_update(job_ptr, now);
 		goto cleanup;
 	}
 
@@ -3025,7 +3001,7 @@ extern int select_nodes(job_record_t *job_ptr, bool test_only,
 			job_ptr->end_time = 0;
 			job_ptr->state_reason = WAIT_RESOURCES;
 			job_state_set(job_ptr, JOB_PENDING);
-			last_job_update = now;
+			job_set_last_update(job_ptr, now);
 			goto cleanup;
 		}
 	}
@@ -3151,6 +3127,47 @@ cleanup:
 	return error_code;
 }
 
+/*
+ * select_nodes - select and allocate nodes to a specific job
+ * IN job_ptr - pointer to the job record
+ * IN test_only - if set do not allocate nodes, just confirm they
+ *	could be allocated now
+ * IN select_node_bitmap - bitmap of nodes to be used for the
+ *	job's resource allocation (not returned if NULL), caller
+ *	must free
+ * IN submission - if set ignore reservations
+ * IN scheduler_type - which scheduler is calling this
+ *      (i.e. SLURMDB_JOB_FLAG_BACKFILL, SLURMDB_JOB_FLAG_SCHED, etc)
+ * OUT err_msg - if not NULL set to error message for job, caller must xfree
+ * RET 0 on success, ESLURM code from slurm_errno.h otherwise
+ * globals: list_part - global list of partition info
+ *	default_part_loc - pointer to default partition
+ *	config_list - global list of node configuration info
+ * Notes: The algorithm is
+ *	1) Build a table (node_set_ptr) of nodes with the requisite
+ *	   configuration. Each table entry includes their weight,
+ *	   node_list, features, etc.
+ *	2) Call _pick_best_nodes() to select those nodes best satisfying
+ *	   the request, (e.g. best-fit or other criterion)
+ *	3) Call allocate_nodes() to perform the actual allocation
+ */
+extern int select_nodes(job_record_t *job_ptr, bool test_only,
+			bitstr_t **select_node_bitmap, char **err_msg,
+			bool submission, uint32_t scheduler_type)
+{
+	uint32_t old_reason = job_ptr->state_reason;
+	uint32_t old_prio = job_ptr->priority;
+	int rc = _select_nodes(job_ptr, test_only, select_node_bitmap, err_msg,
+			       submission, scheduler_type);
+
+	/* Reasons set while evaluating the job are not stamped one by one */
+	if ((job_ptr->state_reason != old_reason) ||
+	    (job_ptr->priority != old_prio))
+		job_set_last_update(job_ptr, time(NULL));
+
+	return rc;
+}
+
 /*
  * get_node_cnts - determine the number of nodes for the requested job.
  * IN job_ptr - pointer to the job record.
@@ -3213,6 +3230,8 @@ extern int get_node_cnts(job_record_t *job_ptr, uint32_t qos_flags,
 
 	if (acct_max_nodes < *min_nodes) {
 		error_code = ESLURM_ACCOUNTING_POLICY;
+		if (job_ptr->state_reason != wait_reason)
+			job_set_last_update(job_ptr, time(NULL));
 		xfree(job_ptr->state_desc);
 		job_ptr->state_reason = wait_reason;
 		goto end_it;
@@ -3269,6 +3288,7 @@ extern void launch_prolog(job_record_t *job_ptr)
 	if ((slurm_conf.prolog_flags & PROLOG_FLAG_ALLOC) &&
 	    !(slurm_conf.prolog_flags & PROLOG_FLAG_NOHOLD)) {
 		job_ptr->state_reason = WAIT_PROLOG;
+		job_set_last_update(job_ptr, time(NULL));
 #ifndef HAVE_FRONT_END
 		FREE_NULL_BITMAP(job_ptr->node_bitmap_pr);
 		job_ptr->node_bitmap_pr = bit_copy(job_ptr->node_bitmap);
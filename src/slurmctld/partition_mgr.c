@@ -2159,7 +2159,7 @@ extern int part_policy_valid_qos(part_record_t *part_ptr,
 				xfree(job_ptr->state_desc);
 				job_ptr->state_desc = tmp_err;
 				job_ptr->state_reason = WAIT_QOS;
-				last_job_update = time(NULL);
+				job_set_last_update(job_ptr, time(NULL));
 			} else {
 				xfree(tmp_err);
 			}
@@ -2179,7 +2179,7 @@ extern int part_policy_valid_qos(part_record_t *part_ptr,
 				xfree(job_ptr->state_desc);
 				job_ptr->state_desc = tmp_err;
 				job_ptr->state_reason = WAIT_QOS;
-				last_job_update = time(NULL);
+				job_set_last_update(job_ptr, time(NULL));
 			} else {
 				xfree(tmp_err);
 			}
@@ -2206,7 +2206,7 @@ extern int part_policy_valid_qos(part_record_t *part_ptr,
 				xfree(job_ptr->state_desc);
 				job_ptr->state_desc = tmp_err;
 				job_ptr->state_reason = WAIT_QOS;
-				last_job_update = time(NULL);
+				job_set_last_update(job_ptr, time(NULL));
 			} else {
 				xfree(tmp_err);
 			}
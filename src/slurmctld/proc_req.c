@@ -106,6 +106,7 @@
 #include "src/slurmctld/sackd_mgr.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/slurmscriptd.h"
+#include "src/slurmctld/snapshot.h"
 #include "src/slurmctld/state_save.h"
 #include "src/slurmctld/trigger_mgr.h"
 
@@ -1421,6 +1422,7 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t *msg)
 		} else {
 			buffer = pack_all_jobs(job_info_request_msg->show_flags,
 					       msg->auth_uid, NO_VAL,
+					       job_info_request_msg->last_update,
 					       msg->protocol_version);
 		}
 		if (!(msg->flags & CTLD_QUEUE_PROCESSING))
@@ -1450,7 +1452,7 @@ static void _slurm_rpc_dump_jobs_user(slurm_msg_t *msg)
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 		lock_slurmctld(job_read_lock);
 	buffer = pack_all_jobs(job_info_request_msg->show_flags, msg->auth_uid,
-			       job_info_request_msg->user_id,
+			       job_info_request_msg->user_id, 0,
 			       msg->protocol_version);
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 		unlock_slurmctld(job_read_lock);
@@ -1638,12 +1640,38 @@ static void _slurm_rpc_dump_front_end(slurm_msg_t *msg)
 	}
 }
 
+/*
+ * Send a published snapshot of the response to msg without taking any
+ * slurmctld locks.
+ * RET true if a snapshot newer than update_time was sent
+ */
+static bool _send_snapshot(slurm_msg_t *msg, snapshot_key_t *key,
+			   time_t update_time, slurm_msg_type_t msg_type)
+{
+	snapshot_t *snap;
+
+	if (!(snap = snapshot_acquire(key, update_time)))
+		return false;
+
+	(void) send_msg_response(msg, msg_type, snapshot_buffer(snap));
+	snapshot_release(snap);
+
+	return true;
+}
+
 /* _slurm_rpc_dump_nodes - dump RPC for node state information */
 static void _slurm_rpc_dump_nodes(slurm_msg_t *msg)
 {
 	DEF_TIMERS;
 	buf_t *buffer;
 	node_info_request_msg_t *node_req_msg = msg->data;
+	time_t pack_time, update_time;
+	snapshot_key_t key = {
+		.protocol_version = msg->protocol_version,
+		.show_flags = node_req_msg->show_flags,
+		.type = SNAPSHOT_NODES,
+		.uid = msg->auth_uid,
+	};
 	/* Locks: Read config, write node (reset allocated CPU count in some
 	 * select plugins), read part (for part_is_visible) */
 	slurmctld_lock_t node_write_lock = {
@@ -1658,6 +1686,23 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t *msg)
 		return;
 	}
 
+	if (snapshot_enabled()) {
+		if ((node_req_msg->last_update - 1) >= last_node_update) {
+			debug3("%s, no change", __func__);
+			slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
+			return;
+		}
+
+		key.shared = ((node_req_msg->show_flags & SHOW_ALL) ||
+			      validate_operator(msg->auth_uid));
+		update_time = MAX(last_node_update, last_part_update);
+		update_time = MAX(update_time, slurm_conf.last_update);
+		if (_send_snapshot(msg, &key, update_time, RESPONSE_NODE_INFO)) {
+			END_TIMER2(__func__);
+			return;
+		}
+	}
+
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 		lock_slurmctld(node_write_lock);
 
@@ -1669,6 +1714,7 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t *msg)
 		debug3("%s, no change", __func__);
 		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
 	} else {
+		pack_time = time(NULL);
 		buffer = pack_all_nodes(node_req_msg->show_flags,
 					msg->auth_uid, msg->protocol_version);
 		if (!(msg->flags & CTLD_QUEUE_PROCESSING))
@@ -1677,7 +1723,7 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t *msg)
 
 		/* send message */
 		(void) send_msg_response(msg, RESPONSE_NODE_INFO, buffer);
-		FREE_NULL_BUFFER(buffer);
+		snapshot_publish(&key, buffer, pack_time);
 	}
 }
 
@@ -1723,6 +1769,13 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t *msg)
 	DEF_TIMERS;
 	buf_t *buffer = NULL;
 	part_info_request_msg_t *part_req_msg = msg->data;
+	time_t pack_time, update_time;
+	snapshot_key_t key = {
+		.protocol_version = msg->protocol_version,
+		.show_flags = part_req_msg->show_flags,
+		.type = SNAPSHOT_PARTITIONS,
+		.uid = msg->auth_uid,
+	};
 
 	/* Locks: Read configuration and partition */
 	slurmctld_lock_t part_read_lock = {
@@ -1737,6 +1790,23 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t *msg)
 		return;
 	}
 
+	if (snapshot_enabled()) {
+		if ((part_req_msg->last_update - 1) >= last_part_update) {
+			debug2("%s, no change", __func__);
+			slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
+			return;
+		}
+
+		key.shared = ((part_req_msg->show_flags & SHOW_ALL) ||
+			      validate_operator(msg->auth_uid));
+		update_time = MAX(last_part_update, slurm_conf.last_update);
+		if (_send_snapshot(msg, &key, update_time,
+				   RESPONSE_PARTITION_INFO)) {
+			END_TIMER2(__func__);
+			return;
+		}
+	}
+
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 		lock_slurmctld(part_read_lock);
 
@@ -1746,6 +1816,7 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t *msg)
 		debug2("%s, no change", __func__);
 		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
 	} else {
+		pack_time = time(NULL);
 		buffer = pack_all_part(part_req_msg->show_flags, msg->auth_uid,
 				       msg->protocol_version);
 		if (!(msg->flags & CTLD_QUEUE_PROCESSING))
@@ -1754,7 +1825,7 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t *msg)
 
 		/* send message */
 		(void) send_msg_response(msg, RESPONSE_PARTITION_INFO, buffer);
-		FREE_NULL_BUFFER(buffer);
+		snapshot_publish(&key, buffer, pack_time);
 	}
 }
 
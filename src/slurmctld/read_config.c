@@ -88,6 +88,7 @@
 #include "src/slurmctld/proc_req.h"
 #include "src/slurmctld/read_config.h"
 #include "src/slurmctld/reservation.h"
+#include "src/slurmctld/sched_replay.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/trigger_mgr.h"
 
@@ -241,6 +242,7 @@ static void _sort_node_record_table_ptr(void)
 		if (node_record_table_ptr[i])
 			node_record_table_ptr[i]->index = i;
 	}
+	node_conf_name_cache_clear();
 
 #if _DEBUG
 	/* Log the results */
@@ -613,6 +615,8 @@ static void _init_all_slurm_conf(void)
 
 	slurm_conf_reinit(conf_name);
 	xfree(conf_name);
+	if (sched_replay_dir)
+		sched_replay_conf();
 
 	init_node_conf();
 	init_part_conf();
@@ -1474,7 +1478,7 @@ void _sync_jobs_to_conf(void)
 	}
 	list_iterator_destroy(job_iterator);
 
-	last_job_update = now;
+	job_delta_reset();
 }
 
 /*
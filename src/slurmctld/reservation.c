@@ -781,6 +781,7 @@ static int _foreach_clear_job_resv(void *x, void *key)
 		 */
 		job_ptr->state_reason = WAIT_NO_REASON;
 		xfree(job_ptr->state_desc);
+		job_set_last_update(job_ptr, time(NULL));
 	}
 
 	if (!_find_job_with_resv_ptr(job_ptr, resv_ptr))
@@ -6374,6 +6375,7 @@ extern void job_time_adj_resv(job_record_t *job_ptr)
 	slurmctld_resv_t * resv_ptr;
 	time_t now = time(NULL);
 	int32_t resv_begin_time;
+	uint32_t old_time_limit = job_ptr->time_limit;
 
 	iter = list_iterator_create(resv_list);
 	while ((resv_ptr = list_next(iter))) {
@@ -6396,6 +6398,8 @@ extern void job_time_adj_resv(job_record_t *job_ptr)
 	}
 	list_iterator_destroy(iter);
 	job_ptr->time_limit = MAX(job_ptr->time_limit, job_ptr->time_min);
+	if (job_ptr->time_limit != old_time_limit)
+		job_set_last_update(job_ptr, now);
 	job_end_time_reset(job_ptr);
 }
 
@@ -6749,6 +6753,7 @@ extern int job_test_resv(job_record_t *job_ptr, time_t *when,
 					debug("%s: Holding %pJ, expired reservation %s",
 					      __func__, job_ptr, resv_ptr->name);
 					job_ptr->priority = 0;	/* admin hold */
+					job_set_last_update(job_ptr, now);
 				}
 				return ESLURM_RESERVATION_INVALID;
 			}
@@ -0,0 +1,246 @@
+/*****************************************************************************\
+ *  sched_replay.c - run scheduling cycles against saved state
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/slurm_protocol_defs.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/interfaces/sched_plugin.h"
+
+#include "src/slurmctld/job_scheduler.h"
+#include "src/slurmctld/locks.h"
+#include "src/slurmctld/sched_replay.h"
+#include "src/slurmctld/slurmctld.h"
+
+typedef struct {
+	uint32_t pending;
+	uint32_t running;
+} job_counts_t;
+
+char *sched_replay_dir = NULL;
+
+extern void sched_replay_conf(void)
+{
+	xassert(sched_replay_dir);
+
+	xfree(slurm_conf.state_save_location);
+	slurm_conf.state_save_location = xstrdup(sched_replay_dir);
+
+	/* Nothing may leave this process: no slurmdbd, scripts or munge */
+	xfree(slurm_conf.accounting_storage_type);
+	xfree(slurm_conf.bb_type);
+	xfree(slurm_conf.job_comp_type);
+	xfree(slurm_conf.prep_plugins);
+	xfree(slurm_conf.cred_type);
+	slurm_conf.cred_type = xstrdup("cred/none");
+}
+
+static uint64_t _usec_since(struct timeval *start)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	return ((now.tv_sec - start->tv_sec) * USEC_IN_SEC) +
+		now.tv_usec - start->tv_usec;
+}
+
+static double _per_sec(uint32_t count, uint64_t usec)
+{
+	if (!usec)
+		return 0.0;
+	return ((double) count * USEC_IN_SEC) / usec;
+}
+
+static int _count_job(void *x, void *arg)
+{
+	job_record_t *job_ptr = x;
+	job_counts_t *counts = arg;
+
+	if (IS_JOB_PENDING(job_ptr))
+		counts->pending++;
+	else if (IS_JOB_RUNNING(job_ptr) || IS_JOB_SUSPENDED(job_ptr))
+		counts->running++;
+
+	return 0;
+}
+
+static void _print_jobs(const char *when)
+{
+	job_counts_t counts = { 0 };
+	slurmctld_lock_t job_read_lock = { .job = READ_LOCK };
+
+	lock_slurmctld(job_read_lock);
+	list_for_each(job_list, _count_job, &counts);
+	printf("Jobs %s: %d (%u pending, %u running)\n",
+	       when, list_count(job_list), counts.pending, counts.running);
+	unlock_slurmctld(job_read_lock);
+}
+
+/* Return the exit reason counter incremented since "prev" was captured */
+static int _exit_code(uint32_t *prev, uint32_t *curr, int cnt)
+{
+	for (int i = 0; i < cnt; i++) {
+		if (curr[i] != prev[i])
+			return i;
+	}
+	return -1;
+}
+
+static void _run_main_sched(int cycle)
+{
+	diag_stats_t prev = slurmctld_diag_stats;
+	struct timeval start;
+	uint64_t usec;
+	uint32_t depth;
+	int code;
+
+	gettimeofday(&start, NULL);
+	(void) schedule_cycle(true);
+	usec = _usec_since(&start);
+
+	depth = slurmctld_diag_stats.schedule_cycle_depth -
+		prev.schedule_cycle_depth;
+	code = _exit_code(prev.schedule_exit, slurmctld_diag_stats.schedule_exit,
+			  SCHEDULE_EXIT_COUNT);
+
+	printf("Cycle %d main scheduler: %"PRIu64" usec, cycle %u usec\n",
+	       cycle, usec, slurmctld_diag_stats.schedule_cycle_last);
+	printf("\tQueue length: %u\n", slurmctld_diag_stats.schedule_queue_len);
+	printf("\tDepth: %u\n", depth);
+	printf("\tJobs started: %u\n",
+	       slurmctld_diag_stats.jobs_started - prev.jobs_started);
+	printf("\tJobs tested per second: %.0f\n",
+	       _per_sec(depth, slurmctld_diag_stats.schedule_cycle_last));
+	if (code >= 0)
+		printf("\tExit: %s\n", schedule_exit2string(code));
+}
+
+static void _run_sched_plugin(int cycle)
+{
+	diag_stats_t prev = slurmctld_diag_stats;
+	struct timeval start;
+	uint64_t usec;
+	int code;
+
+	gettimeofday(&start, NULL);
+	if (sched_g_run_cycle() != SLURM_SUCCESS) {
+		error("%s: %s can not run a cycle with its thread active",
+		      __func__, slurm_conf.schedtype);
+		return;
+	}
+	usec = _usec_since(&start);
+
+	printf("Cycle %d %s: %"PRIu64" usec\n",
+	       cycle, slurm_conf.schedtype, usec);
+	if (slurmctld_diag_stats.bf_cycle_counter == prev.bf_cycle_counter)
+		return;
+
+	code = _exit_code(prev.bf_exit, slurmctld_diag_stats.bf_exit,
+			  BF_EXIT_COUNT);
+
+	printf("\tCycle: %u usec\n", slurmctld_diag_stats.bf_cycle_last);
+	printf("\tQueue length: %u\n", slurmctld_diag_stats.bf_queue_len);
+	printf("\tDepth: %u\n", slurmctld_diag_stats.bf_last_depth);
+	printf("\tDepth (try sched): %u\n",
+	       slurmctld_diag_stats.bf_last_depth_try);
+	printf("\tJobs started: %u\n",
+	       slurmctld_diag_stats.backfilled_jobs - prev.backfilled_jobs);
+	printf("\tJobs tested per second: %.0f\n",
+	       _per_sec(slurmctld_diag_stats.bf_last_depth,
+			slurmctld_diag_stats.bf_cycle_last));
+	printf("\tTable size: %u\n", slurmctld_diag_stats.bf_table_size);
+	if (code >= 0)
+		printf("\tExit: %s\n", bf_exit2string(code));
+}
+
+static void _print_summary(void)
+{
+	diag_stats_t *stats = &slurmctld_diag_stats;
+
+	printf("\nMain schedule statistics (microseconds):\n");
+	printf("\tTotal cycles: %u\n", stats->schedule_cycle_counter);
+	printf("\tMax cycle:    %u\n", stats->schedule_cycle_max);
+	if (stats->schedule_cycle_counter) {
+		printf("\tMean cycle:   %u\n",
+		       stats->schedule_cycle_sum /
+		       stats->schedule_cycle_counter);
+		printf("\tMean depth cycle:  %u\n",
+		       stats->schedule_cycle_depth /
+		       stats->schedule_cycle_counter);
+	}
+
+	if (!stats->bf_cycle_counter)
+		return;
+
+	printf("\nBackfilling stats (microseconds):\n");
+	printf("\tTotal cycles: %u\n", stats->bf_cycle_counter);
+	printf("\tMax cycle:  %u\n", stats->bf_cycle_max);
+	printf("\tMean cycle: %"PRIu64"\n",
+	       stats->bf_cycle_sum / stats->bf_cycle_counter);
+	printf("\tDepth Mean: %u\n",
+	       stats->bf_depth_sum / stats->bf_cycle_counter);
+	printf("\tDepth Mean (try depth): %u\n",
+	       stats->bf_depth_try_sum / stats->bf_cycle_counter);
+	printf("\tQueue length mean: %u\n",
+	       stats->bf_queue_len_sum / stats->bf_cycle_counter);
+	printf("\tMean table size: %u\n",
+	       stats->bf_table_size_sum / stats->bf_cycle_counter);
+}
+
+extern void sched_replay_run(int cycles, uint64_t load_usec)
+{
+	printf("State loaded from %s in %"PRIu64" usec\n",
+	       slurm_conf.state_save_location, load_usec);
+	printf("Nodes: %d\n", node_record_count);
+	printf("Partitions: %d\n", list_count(part_list));
+	_print_jobs("loaded");
+
+	for (int i = 1; i <= cycles; i++) {
+		printf("\n");
+		_run_main_sched(i);
+		_run_sched_plugin(i);
+	}
+
+	printf("\n");
+	_print_jobs("after replay");
+	_print_summary();
+	fflush(stdout);
+}
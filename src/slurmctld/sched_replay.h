@@ -0,0 +1,59 @@
+/*****************************************************************************\
+ *  sched_replay.h - run scheduling cycles against saved state
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCTLD_SCHED_REPLAY_H
+#define _SLURMCTLD_SCHED_REPLAY_H
+
+#include <inttypes.h>
+
+/* Directory holding the state to replay, set by "slurmctld --replay" */
+extern char *sched_replay_dir;
+
+/*
+ * Point slurm_conf at the replay state and disable plugins that act outside
+ * of slurmctld. Must be called again each time slurm.conf is read.
+ */
+extern void sched_replay_conf(void);
+
+/*
+ * Run main scheduler and sched plugin cycles against the state loaded by
+ * "slurmctld --replay" and print per-phase timings and scheduling statistics
+ * to stdout. Caller must not have started any scheduling threads.
+ * IN cycles - number of scheduling cycles to run
+ * IN load_usec - microseconds spent loading state, for the report
+ */
+extern void sched_replay_run(int cycles, uint64_t load_usec);
+
+#endif
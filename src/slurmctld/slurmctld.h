@@ -1192,6 +1192,21 @@ extern int job_requeue2(uid_t uid, requeue_msg_t *req_ptr, slurm_msg_t *msg,
 extern int job_set_top(slurm_msg_t *msg, top_job_msg_t *top_ptr, uid_t uid,
 		       uint16_t protocol_version);
 
+/*
+ * job_set_last_update - record that a job was modified so it is included in
+ *	SHOW_DELTA job info responses, and advance last_job_update
+ * IN job_ptr - job that was modified
+ * IN now - time of the modification
+ */
+extern void job_set_last_update(job_record_t *job_ptr, time_t now);
+
+/*
+ * job_delta_reset - invalidate all job info cursors older than now, forcing
+ *	SHOW_DELTA requests to receive a full job list. Used when job records
+ *	may have changed without job_set_last_update() (e.g. reconfiguration).
+ */
+extern void job_delta_reset(void);
+
 /*
  * job_time_limit - terminate jobs which have exceeded their time limit
  * global: job_list - pointer global job list
@@ -1390,6 +1405,7 @@ extern int dump_job_state(const uint32_t filter_jobs_count,
  * IN show_flags - job filtering options
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN update_time - with SHOW_DELTA, pack only jobs changed since this time
  * IN protocol_version - slurm protocol version of client
  * OUT buffer
  * global: job_list - global list of job records
@@ -1397,7 +1413,7 @@ extern int dump_job_state(const uint32_t filter_jobs_count,
  *	whenever the data format changes
  */
 extern buf_t *pack_all_jobs(uint16_t show_flags, uid_t uid, uint32_t filter_uid,
-			    uint16_t protocol_version);
+			    time_t update_time, uint16_t protocol_version);
 
 /*
  * pack_spec_jobs - dump job information for specified jobs in
@@ -0,0 +1,217 @@
+/*****************************************************************************\
+ *  snapshot.c - published snapshots of query RPC responses
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * Read-only query RPCs (e.g. sinfo) normally take the slurmctld read locks to
+ * pack their response, so a burst of them delays writers such as the
+ * scheduler. Once a response has been packed, it is published here as an
+ * immutable, reference counted snapshot. Until the state it was packed from
+ * changes, later requests send the snapshot without taking any slurmctld
+ * locks. Replaced snapshots are freed once the last reader releases them.
+ */
+
+#include <stdbool.h>
+
+#include "src/common/macros.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmctld/slurmctld.h"
+#include "src/slurmctld/snapshot.h"
+
+#define SNAPSHOT_SLOTS 8
+
+struct snapshot {
+	buf_t *buffer;
+	time_t expire;
+	snapshot_key_t key;
+	time_t pack_time;
+	int ref_cnt;
+};
+
+static snapshot_t *snapshots[SNAPSHOT_TYPE_CNT][SNAPSHOT_SLOTS];
+static pthread_mutex_t snapshot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t snapshot_ttl = 0;
+
+static bool _key_match(snapshot_key_t *key1, snapshot_key_t *key2)
+{
+	if ((key1->protocol_version != key2->protocol_version) ||
+	    (key1->show_flags != key2->show_flags) ||
+	    (key1->shared != key2->shared))
+		return false;
+
+	return (key1->shared || (key1->uid == key2->uid));
+}
+
+/* NOTE: snapshot_mutex must be locked before calling this */
+static void _unref_snapshot(snapshot_t *snap)
+{
+	xassert(snap->ref_cnt > 0);
+
+	if (--snap->ref_cnt)
+		return;
+
+	FREE_NULL_BUFFER(snap->buffer);
+	xfree(snap);
+}
+
+extern void snapshot_init(void)
+{
+	char *tmp_ptr;
+
+	if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params,
+				   "query_snapshot_ttl=")))
+		snapshot_ttl = strtol(tmp_ptr + strlen("query_snapshot_ttl="),
+				      NULL, 10);
+
+	if (snapshot_ttl)
+		info("Query RPC snapshots enabled, query_snapshot_ttl=%u",
+		     snapshot_ttl);
+}
+
+extern void snapshot_shutdown(void)
+{
+	slurm_mutex_lock(&snapshot_mutex);
+	snapshot_ttl = 0;
+	for (int i = 0; i < SNAPSHOT_TYPE_CNT; i++) {
+		for (int j = 0; j < SNAPSHOT_SLOTS; j++) {
+			if (!snapshots[i][j])
+				continue;
+			_unref_snapshot(snapshots[i][j]);
+			snapshots[i][j] = NULL;
+		}
+	}
+	slurm_mutex_unlock(&snapshot_mutex);
+}
+
+extern bool snapshot_enabled(void)
+{
+	return (snapshot_ttl != 0);
+}
+
+extern snapshot_t *snapshot_acquire(snapshot_key_t *key, time_t update_time)
+{
+	snapshot_t *snap = NULL;
+	time_t now = time(NULL);
+
+	xassert(key->type < SNAPSHOT_TYPE_CNT);
+
+	slurm_mutex_lock(&snapshot_mutex);
+	for (int i = 0; snapshot_ttl && (i < SNAPSHOT_SLOTS); i++) {
+		snapshot_t *tmp = snapshots[key->type][i];
+
+		if (!tmp || !_key_match(&tmp->key, key))
+			continue;
+		/*
+		 * The snapshot must have been packed after the last update,
+		 * changes made within the same second are not covered.
+		 */
+		if ((tmp->pack_time > update_time) && (tmp->expire > now)) {
+			snap = tmp;
+			snap->ref_cnt++;
+		}
+		break;
+	}
+	slurm_mutex_unlock(&snapshot_mutex);
+
+	return snap;
+}
+
+extern buf_t *snapshot_buffer(snapshot_t *snap)
+{
+	return snap->buffer;
+}
+
+extern void snapshot_release(snapshot_t *snap)
+{
+	if (!snap)
+		return;
+
+	slurm_mutex_lock(&snapshot_mutex);
+	_unref_snapshot(snap);
+	slurm_mutex_unlock(&snapshot_mutex);
+}
+
+extern void snapshot_publish(snapshot_key_t *key, buf_t *buffer,
+			     time_t pack_time)
+{
+	snapshot_t *snap, **slot = NULL;
+
+	xassert(key->type < SNAPSHOT_TYPE_CNT);
+
+	slurm_mutex_lock(&snapshot_mutex);
+	if (!snapshot_ttl) {
+		slurm_mutex_unlock(&snapshot_mutex);
+		FREE_NULL_BUFFER(buffer);
+		return;
+	}
+
+	/* Replace the snapshot for this key, an empty slot or the oldest */
+	for (int i = 0; i < SNAPSHOT_SLOTS; i++) {
+		snapshot_t **tmp = &snapshots[key->type][i];
+
+		if (*tmp && _key_match(&(*tmp)->key, key)) {
+			slot = tmp;
+			break;
+		}
+		if (!*tmp) {
+			if (!slot || *slot)
+				slot = tmp;
+		} else if (!slot ||
+			   (*slot && ((*slot)->pack_time > (*tmp)->pack_time))) {
+			slot = tmp;
+		}
+	}
+
+	if (*slot && ((*slot)->pack_time > pack_time) &&
+	    _key_match(&(*slot)->key, key)) {
+		/* A newer snapshot was published meanwhile */
+		slurm_mutex_unlock(&snapshot_mutex);
+		FREE_NULL_BUFFER(buffer);
+		return;
+	}
+
+	snap = xmalloc(sizeof(*snap));
+	snap->buffer = buffer;
+	snap->expire = time(NULL) + snapshot_ttl;
+	snap->key = *key;
+	snap->pack_time = pack_time;
+	snap->ref_cnt = 1;
+
+	if (*slot)
+		_unref_snapshot(*slot);
+	*slot = snap;
+	slurm_mutex_unlock(&snapshot_mutex);
+}
@@ -0,0 +1,90 @@
+/*****************************************************************************\
+ * snapshot.h - published snapshots of query RPC responses
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#include "src/common/pack.h"
+
+typedef enum {
+	SNAPSHOT_NODES,
+	SNAPSHOT_PARTITIONS,
+	SNAPSHOT_TYPE_CNT
+} snapshot_type_t;
+
+typedef struct {
+	bool shared; /* response does not depend on uid */
+	uint16_t protocol_version;
+	uint16_t show_flags;
+	snapshot_type_t type;
+	uid_t uid;
+} snapshot_key_t;
+
+typedef struct snapshot snapshot_t;
+
+extern void snapshot_init(void);
+
+extern void snapshot_shutdown(void);
+
+/* Return true if SlurmctldParameters=query_snapshot_ttl is set */
+extern bool snapshot_enabled(void);
+
+/*
+ * Get a reference to the published snapshot matching key.
+ * IN key - response to look for
+ * IN update_time - time of the last change to the state in the response
+ * RET snapshot packed after update_time, or NULL if none is available.
+ *     Must be released with snapshot_release().
+ *
+ * NOTE: No slurmctld locks are required.
+ */
+extern snapshot_t *snapshot_acquire(snapshot_key_t *key, time_t update_time);
+
+/* Return the packed response held by a snapshot. Must not be modified. */
+extern buf_t *snapshot_buffer(snapshot_t *snap);
+
+extern void snapshot_release(snapshot_t *snap);
+
+/*
+ * Publish a packed response for later snapshot_acquire() calls.
+ * IN key - response that was packed
+ * IN buffer - packed response, ownership is taken and it must not be
+ *	modified afterwards
+ * IN pack_time - time when the state was read, while still locked
+ */
+extern void snapshot_publish(snapshot_key_t *key, buf_t *buffer,
+			     time_t pack_time);
+
+#endif
@@ -3157,6 +3157,7 @@ static int _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 	list_itr_t *itr = NULL;
 	buf_t *req_buf = NULL, *ret_buf = NULL;
 	int rc = SLURM_SUCCESS;
+	int trans_lost_start = 0, trans_lost_end = 0;
 	/* DEF_TIMERS; */
 
 	if (!_validate_slurm_user(slurmdbd_conn)) {
@@ -3171,6 +3172,14 @@ static int _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 
 	list_msg.my_list = list_create(slurmdbd_free_buffer);
 	/* START_TIMER; */
+	/*
+	 * Process the whole batch as one transaction instead of committing
+	 * after every message. The batch is committed below before replying.
+	 */
+	acct_storage_g_get_data(slurmdbd_conn->db_conn,
+				ACCT_STORAGE_INFO_TRANS_LOST,
+				&trans_lost_start);
+	slurmdbd_conn->in_mult_msg = true;
 	itr = list_iterator_create(get_msg->my_list);
 	while ((req_buf = list_next(itr))) {
 		persist_msg_t sub_msg;
@@ -3193,9 +3202,43 @@ static int _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 			break;
 	}
 	list_iterator_destroy(itr);
+	slurmdbd_conn->in_mult_msg = false;
 	/* END_TIMER; */
 	/* info("%d multi took %s", list_count(get_msg->my_list), TIME_STR); */
 
+	/*
+	 * A deadlock or a reconnect to the database loses the open
+	 * transaction, but only the failed statement is retried. Everything
+	 * this batch did before it is gone, so throw away the rest and have
+	 * slurmctld resend the whole batch instead of acknowledging messages
+	 * that were lost. Do the same if the batch can not be committed.
+	 */
+	acct_storage_g_get_data(slurmdbd_conn->db_conn,
+				ACCT_STORAGE_INFO_TRANS_LOST, &trans_lost_end);
+	if (trans_lost_end != trans_lost_start) {
+		comment = "Transaction lost while processing DBD_SEND_MULT_MSG, batch must be resent";
+	} else if (slurmdbd_conn->conn->rem_port &&
+		   !slurmdbd_conf->commit_delay) {
+		int commit_rc = acct_storage_g_commit(slurmdbd_conn->db_conn,
+						      1);
+
+		acct_storage_g_get_data(slurmdbd_conn->db_conn,
+					ACCT_STORAGE_INFO_TRANS_LOST,
+					&trans_lost_end);
+		if (commit_rc || (trans_lost_end != trans_lost_start))
+			comment = "Commit of DBD_SEND_MULT_MSG failed, batch must be resent";
+	}
+
+	if (comment) {
+		error("%s", comment);
+		acct_storage_g_commit(slurmdbd_conn->db_conn, 0);
+		FREE_NULL_LIST(list_msg.my_list);
+		*out_buffer = slurm_persist_make_rc_msg(slurmdbd_conn->conn,
+							SLURM_ERROR, comment,
+							DBD_SEND_MULT_MSG);
+		return SLURM_ERROR;
+	}
+
 	*out_buffer = init_buf(1024);
 	pack16((uint16_t) DBD_GOT_MULT_MSG, *out_buffer);
 	slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->conn->version,
@@ -3728,12 +3771,17 @@ extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
 		      slurmdbd_conn->conn->fd,
 		      slurmdbd_msg_type_2_str(msg->msg_type, 1));
 	else if (slurmdbd_conn->conn->rem_port &&
+		 !slurmdbd_conn->in_mult_msg &&
+		 (msg->msg_type != DBD_SEND_MULT_MSG) &&
 		 (!slurmdbd_conf->commit_delay ||
 		  (msg->msg_type == DBD_REGISTER_CTLD))) {
 		/* If we are dealing with the slurmctld do the
 		   commit (SUCCESS or NOT) afterwards since we
 		   do transactions for performance reasons.
 		   (don't ever use autocommit with innodb)
+		   Messages inside a DBD_SEND_MULT_MSG are committed
+		   together by _send_mult_msg() once the whole batch
+		   is processed.
 		*/
 		acct_storage_g_commit(slurmdbd_conn->db_conn, 1);
 	}
@@ -109,6 +109,7 @@ static void _clear_slurmdbd_conf(void)
 		slurmdbd_conf->purge_suspend = 0;
 		slurmdbd_conf->purge_txn = 0;
 		slurmdbd_conf->purge_usage = 0;
+		slurmdbd_conf->rollup_threads = 0;
 		xfree(slurmdbd_conf->storage_loc);
 		slurmdbd_conf->track_wckey = 0;
 		slurmdbd_conf->track_ctld = 0;
@@ -398,12 +399,26 @@ extern int read_slurmdbd_conf(void)
 		else if (slurm_conf.msg_timeout > 100)
 			warning("MessageTimeout is too high for effective fault-tolerance");
 
+		slurmdbd_conf->rollup_threads = 1;
 		s_p_get_string(&slurmdbd_conf->parameters, "Parameters", tbl);
 		if (slurmdbd_conf->parameters) {
 			if (xstrcasestr(slurmdbd_conf->parameters,
 					"PreserveCaseUser"))
 				slurmdbd_conf->persist_conn_rc_flags |=
 					PERSIST_FLAG_P_USER_CASE;
+
+			if ((temp_str = xstrcasestr(slurmdbd_conf->parameters,
+						    "rollup_threads="))) {
+				long tmp_val = strtol(temp_str +
+						      strlen("rollup_threads="),
+						      NULL, 10);
+				if ((tmp_val > 0) &&
+				    (tmp_val <= MAX_SLURMDBD_ROLLUP_THREADS))
+					slurmdbd_conf->rollup_threads = tmp_val;
+				else
+					error("Parameters option rollup_threads=%ld is invalid, ignored",
+					      tmp_val);
+			}
 		}
 
 		s_p_get_string(&slurmdbd_conf->pid_file, "PidFile", tbl);
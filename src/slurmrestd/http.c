@@ -430,69 +430,66 @@ no_mem:
 }
 
 /*
- * Create rfc2616 formatted header
+ * Append rfc2616 formatted header
  * TODO: add more sanity checks
+ * IN/OUT buffer ptr to string to append header
  * IN name header name
  * IN value header value
- * RET formatted string (must xfree)
  * */
-static char *_fmt_header(const char *name, const char *value)
+static void _fmt_header(char **buffer, const char *name, const char *value)
 {
-	return xstrdup_printf("%s: %s"CRLF, name, value);
+	xstrfmtcat(*buffer, "%s: %s"CRLF, name, value);
 }
 
 /*
- * Create and write formatted header
- * IN request HTTP request
+ * Append rfc2616 formatted numerical header
+ * TODO: add sanity checks
+ * IN/OUT buffer ptr to string to append header
  * IN name header name
  * IN value header value
- * RET formatted string (must xfree)
  * */
-static int _write_fmt_header(conmgr_fd_t *con, const char *name,
-			     const char *value)
+static void _fmt_header_num(char **buffer, const char *name, size_t value)
 {
-	const char *buffer = _fmt_header(name, value);
-	int rc = conmgr_queue_write_data(con, buffer, strlen(buffer));
-	xfree(buffer);
-	return rc;
+	xstrfmtcat(*buffer, "%s: %zu"CRLF, name, value);
 }
 
 /*
- * Create rfc2616 formatted numerical header
- * TODO: add sanity checks
- * IN name header name
- * IN value header value
- * RET formatted string (must xfree)
- * */
-static char *_fmt_header_num(const char *name, size_t value)
+ * Hand over xmalloc()ed data to conmgr to avoid copying it
+ * IN con connection to write
+ * IN/OUT data_ptr ptr to data to send (always released)
+ * IN bytes number of bytes to send
+ * RET SLURM_SUCCESS or error
+ */
+static int _write_xfer(conmgr_fd_t *con, char **data_ptr, size_t bytes)
 {
-	return xstrdup_printf("%s: %zu" CRLF, name, value);
+	buf_t *buf;
+	int rc;
+
+	if (!(buf = create_buf(*data_ptr, bytes))) {
+		rc = conmgr_queue_write_data(con, *data_ptr, bytes);
+		xfree(*data_ptr);
+		return rc;
+	}
+
+	*data_ptr = NULL;
+	set_buf_offset(buf, bytes);
+
+	return conmgr_queue_write_buffer(con, &buf);
 }
 
 extern int send_http_connection_close(http_context_t *ctxt)
 {
-	return _write_fmt_header(ctxt->con, "Connection", "Close");
-}
+	char *buffer = NULL;
 
-/*
- * Create and write formatted numerical header
- * IN request HTTP request
- * IN name header name
- * IN value header value
- * RET formatted string (must xfree)
- * */
-static int _write_fmt_num_header(conmgr_fd_t *con, const char *name,
-				 size_t value)
-{
-	const char *buffer = _fmt_header_num(name, value);
-	int rc = conmgr_queue_write_data(con, buffer, strlen(buffer));
-	xfree(buffer);
-	return rc;
+	_fmt_header(&buffer, "Connection", "Close");
+
+	return _write_xfer(ctxt->con, &buffer, strlen(buffer));
 }
 
 extern int send_http_response(const send_http_response_args_t *args)
 {
 	char *buffer = NULL;
+	char *body = (args->body_xfer ? (char *) args->body : NULL);
 	int rc = SLURM_SUCCESS;
 	xassert(args->status_code != HTTP_STATUS_NONE);
 	xassert(args->body_length == 0 || (args->body_length && args->body));
@@ -502,60 +499,33 @@ extern int send_http_response(const send_http_response_args_t *args)
 	       args->status_code,
 	       get_http_status_code_string(args->status_code));
 
-	/* send rfc2616 response */
+	/* send rfc2616 response with all headers in a single write */
 	xstrfmtcat(buffer, "HTTP/%d.%d %d %s"CRLF,
 		   args->http_major, args->http_minor, args->status_code,
 		   get_http_status_code_string(args->status_code));
 
-	rc = conmgr_queue_write_data(args->con, buffer, strlen(buffer));
-	xfree(buffer);
-
-	if (rc)
-		return rc;
-
 	/* send along any requested headers */
 	if (args->headers) {
 		list_itr_t *itr = list_iterator_create(args->headers);
 		http_header_entry_t *header = NULL;
-		while ((header = list_next(itr))) {
-			if ((rc = _write_fmt_header(args->con, header->name,
-						    header->value)))
-				break;
-		}
+		while ((header = list_next(itr)))
+			_fmt_header(&buffer, header->name, header->value);
 		list_iterator_destroy(itr);
-
-		if (rc)
-			return rc;
 	}
 
 	if (args->body && args->body_length) {
 		/* RFC7230-3.3.2 limits response of Content-Length */
 		if ((args->status_code < 100) ||
 		    ((args->status_code >= 200) &&
-		     (args->status_code != 204))) {
-			if ((rc = _write_fmt_num_header(args->con,
-				"Content-Length", args->body_length))) {
-				return rc;
-			}
-		}
-
-		if (args->body_encoding &&
-		    (rc = _write_fmt_header(
-			     args->con, "Content-Type", args->body_encoding)))
-			return rc;
-
-		if ((rc = conmgr_queue_write_data(args->con, CRLF,
-						  strlen(CRLF))))
-			return rc;
+		     (args->status_code != 204)))
+			_fmt_header_num(&buffer, "Content-Length",
+					args->body_length);
 
-		log_flag(NET, "%s: [%s] rc=%s(%u) sending body:\n%s",
-			 __func__, conmgr_fd_get_name(args->con),
-			 get_http_status_code_string(args->status_code),
-			 args->status_code, args->body);
+		if (args->body_encoding)
+			_fmt_header(&buffer, "Content-Type",
+				    args->body_encoding);
 
-		if ((rc = conmgr_queue_write_data(args->con, args->body,
-						  args->body_length)))
-			return rc;
+		xstrcat(buffer, CRLF);
 	} else if (((args->status_code >= 100) && (args->status_code < 200)) ||
 		   (args->status_code == 204) ||
 		   (args->status_code == 304)) {
@@ -563,11 +533,28 @@ extern int send_http_response(const send_http_response_args_t *args)
 		 * RFC2616 requires empty line after headers for return code
 		 * that "MUST NOT" include a message body
 		 */
-		if ((rc = conmgr_queue_write_data(args->con, CRLF,
-						  strlen(CRLF))))
-			return rc;
+		xstrcat(buffer, CRLF);
+	}
+
+	if ((rc = _write_xfer(args->con, &buffer, strlen(buffer))))
+		goto cleanup;
+
+	if (args->body && args->body_length) {
+		log_flag(NET, "%s: [%s] rc=%s(%u) sending body:\n%s",
+			 __func__, conmgr_fd_get_name(args->con),
+			 get_http_status_code_string(args->status_code),
+			 args->status_code, args->body);
+
+		if (body)
+			rc = _write_xfer(args->con, &body, args->body_length);
+		else
+			rc = conmgr_queue_write_data(args->con, args->body,
+						     args->body_length);
 	}
 
+cleanup:
+	xfree(buffer);
+	xfree(body);
 	return rc;
 }
 
@@ -125,6 +125,7 @@ typedef struct {
 	const char *body; /* body to send or NULL */
 	size_t body_length; /* bytes in body to send or 0 */
 	const char *body_encoding; /* body encoding type or NULL */
+	bool body_xfer; /* body is xmalloc()ed and will be released */
 } send_http_response_args_t;
 
 /*
@@ -1613,7 +1613,8 @@ extern int wrap_openapi_ctxt_callback(const char *context_id,
 				      int tag, data_t *resp, void *auth,
 				      data_parser_t *parser,
 				      const openapi_path_binding_t *op_path,
-				      const openapi_resp_meta_t *plugin_meta)
+				      const openapi_resp_meta_t *plugin_meta,
+				      openapi_resp_cache_t *cache)
 {
 	int rc = SLURM_SUCCESS;
 	openapi_ctxt_t ctxt = {
@@ -1623,6 +1624,7 @@ extern int wrap_openapi_ctxt_callback(const char *context_id,
 		.query = query,
 		.resp = resp,
 		.tag = tag,
+		.cache = cache,
 	};
 	openapi_resp_meta_t query_meta = {{0}};
 	openapi_ctxt_handler_t callback = op_path->callback;
@@ -49,6 +49,18 @@
 
 #include "src/interfaces/data_parser.h"
 
+/*
+ * Response cache state handed to handlers of paths bound with
+ * OP_BIND_RESP_CACHE. Handlers that support caching check if the cached
+ * response is still current (usually by passing last_update to slurmctld)
+ * instead of querying and dumping the full response again.
+ */
+typedef struct {
+	time_t last_update; /* IN: last_update of cached response or 0 */
+	bool current; /* IN/OUT: cached response is current (do not dump) */
+	time_t update; /* OUT: last_update of dumped response or 0 */
+} openapi_resp_cache_t;
+
 typedef struct {
 	int rc;
 	list_t *errors;
@@ -62,6 +74,7 @@ typedef struct {
 	data_t *resp;
 	data_t *parent_path;
 	int tag;
+	openapi_resp_cache_t *cache; /* NULL if response is not cacheable */
 } openapi_ctxt_t;
 
 /*
@@ -78,6 +91,7 @@ typedef enum {
 	OP_BIND_HIDDEN_OAS = SLURM_BIT(4), /* Hide from OpenAPI specification */
 	OP_BIND_NO_SLURMDBD = SLURM_BIT(5), /* Do not prepare slurmdbd connection */
 	OP_BIND_REQUIRE_SLURMDBD = SLURM_BIT(6), /* Require slurmdbd connection or don't call path */
+	OP_BIND_RESP_CACHE = SLURM_BIT(7), /* GET responses may be cached */
 	OP_BIND_INVALID_MAX = INFINITE16
 } op_bind_flags_t;
 
@@ -170,14 +184,18 @@ extern void destroy_openapi(void);
  */
 extern void *openapi_get_db_conn(void *ctxt);
 
-/* Wraps ctxt callback to apply standardised response schema */
+/*
+ * Wraps ctxt callback to apply standardised response schema
+ * IN cache - response cache state for handler or NULL
+ */
 extern int wrap_openapi_ctxt_callback(const char *context_id,
 				      http_request_method_t method,
 				      data_t *parameters, data_t *query,
 				      int tag, data_t *resp, void *auth,
 				      data_parser_t *parser,
 				      const openapi_path_binding_t *op_path,
-				      const openapi_resp_meta_t *plugin_meta);
+				      const openapi_resp_meta_t *plugin_meta,
+				      openapi_resp_cache_t *cache);
 
 /*
  * Macro to make a single response dumping easy
@@ -44,9 +44,11 @@
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
+#include "src/interfaces/hash.h"
 #include "src/interfaces/serializer.h"
 
 #include "src/slurmrestd/operations.h"
+#include "src/slurmrestd/response_cache.h"
 #include "src/slurmrestd/rest_auth.h"
 
 static pthread_rwlock_t paths_lock = PTHREAD_RWLOCK_INITIALIZER;
@@ -492,6 +494,43 @@ static int _resolve_mime(on_http_request_args_t *args, const char **read_mime,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Generate cache key unique to the request and the requesting user.
+ * Credentials are only included as a hash.
+ */
+static char *_get_cache_key(on_http_request_args_t *args,
+			    const char *write_mime, data_parser_t *parser)
+{
+	static const char *cred_headers[] = {
+		HTTP_HEADER_USER_NAME,
+		HTTP_HEADER_USER_TOKEN,
+		HTTP_HEADER_AUTH,
+	};
+	rest_auth_context_t *auth = args->context->auth;
+	slurm_hash_t hash = { .type = HASH_PLUGIN_K12 };
+	char *creds = NULL, *key = NULL;
+	int len;
+
+	for (int i = 0; i < ARRAY_SIZE(cred_headers); i++)
+		xstrfmtcat(creds, "%s\n",
+			   find_http_header(args->headers, cred_headers[i]));
+
+	len = hash_g_compute(creds, strlen(creds), NULL, 0, &hash);
+	xfree(creds);
+
+	if (len <= 0)
+		return NULL;
+
+	xstrfmtcat(key, "%s?%s %s %s %u %s ", args->path, args->query,
+		   write_mime, data_parser_get_plugin(parser),
+		   auth->plugin_id, auth->user_name);
+
+	for (int i = 0; i < len; i++)
+		xstrfmtcat(key, "%02x", hash.hash[i]);
+
+	return key;
+}
+
 static int _call_handler(on_http_request_args_t *args, data_t *params,
 			 data_t *query, const openapi_path_binding_t *op_path,
 			 int callback_tag, const char *write_mime,
@@ -500,18 +539,32 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 {
 	int rc;
 	data_t *resp = data_new();
-	char *body = NULL;
+	char *body = NULL, *etag = NULL;
 	http_status_code_t e;
+	openapi_resp_cache_t cache = {0};
+	resp_cache_entry_t *entry = NULL;
+	bool not_modified = false;
+	http_header_entry_t etag_header = { .name = "ETag" };
+	list_t *headers = NULL;
 
 	xassert(op_path);
 	debug3("%s: [%s] BEGIN: calling ctxt handler: 0x%"PRIXPTR"[%d] for path: %s",
 	       __func__, _name(args), (uintptr_t) op_path->callback,
 	       callback_tag, args->path);
 
+	if ((op_path->flags & OP_BIND_RESP_CACHE) &&
+	    (args->method == HTTP_REQUEST_GET) && !args->body_length) {
+		char *key = _get_cache_key(args, write_mime, parser);
+
+		if (key)
+			entry = response_cache_acquire(key, &cache);
+		xfree(key);
+	}
+
 	rc = wrap_openapi_ctxt_callback(_name(args), args->method, params,
 					query, callback_tag, resp,
 					args->context->auth, parser, op_path,
-					meta);
+					meta, (entry ? &cache : NULL));
 
 	/*
 	 * Clear auth context after callback is complete. Client has to provide
@@ -519,7 +572,12 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 	 */
 	FREE_NULL_REST_AUTH(args->context->auth);
 
-	if (data_get_type(resp) != DATA_TYPE_NULL) {
+	if (entry && !rc && cache.current)
+		not_modified = response_cache_get(
+			entry, resp, find_http_header(args->headers,
+						      "If-None-Match"));
+
+	if (!not_modified && (data_get_type(resp) != DATA_TYPE_NULL)) {
 		int rc2;
 		serializer_flags_t sflags = SER_FLAGS_PRETTY;
 
@@ -535,7 +593,17 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 			rc = rc2;
 	}
 
-	if (rc == SLURM_NO_CHANGE_IN_DATA) {
+	if (entry) {
+		etag = response_cache_release(entry, &cache, rc, resp);
+
+		if (etag) {
+			etag_header.value = etag;
+			headers = list_create(NULL);
+			list_append(headers, &etag_header);
+		}
+	}
+
+	if ((rc == SLURM_NO_CHANGE_IN_DATA) || not_modified) {
 		/*
 		 * RFC#7232 Section:4.1
 		 *
@@ -547,6 +615,7 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 			.http_major = args->http_major,
 			.http_minor = args->http_minor,
 			.status_code = HTTP_STATUS_CODE_REDIRECT_NOT_MODIFIED,
+			.headers = headers,
 		};
 		e = send_args.status_code;
 		rc = send_http_response(&send_args);
@@ -571,6 +640,7 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 			.http_major = args->http_major,
 			.http_minor = args->http_minor,
 			.status_code = HTTP_STATUS_CODE_SUCCESS_OK,
+			.headers = headers,
 			.body = NULL,
 			.body_length = 0,
 		};
@@ -579,6 +649,9 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 			send_args.body = body;
 			send_args.body_length = strlen(body);
 			send_args.body_encoding = write_mime;
+			/* hand over body to avoid copying it */
+			send_args.body_xfer = true;
+			body = NULL;
 		}
 
 		rc = send_http_response(&send_args);
@@ -590,6 +663,8 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 	       callback_tag, args->path, rc, slurm_strerror(rc), e,
 	       get_http_status_code_string(e));
 
+	FREE_NULL_LIST(headers);
+	xfree(etag);
 	xfree(body);
 	FREE_NULL_DATA(resp);
 
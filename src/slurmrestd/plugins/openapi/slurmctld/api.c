@@ -355,7 +355,7 @@ const openapi_path_binding_t openapi_paths[] = {
 			},
 			{0}
 		},
-		.flags = OP_FLAGS,
+		.flags = (OP_FLAGS | OP_BIND_RESP_CACHE),
 	},
 	{
 		.path = "/slurm/{data_parser}/node/{node_name}",
@@ -416,7 +416,7 @@ const openapi_path_binding_t openapi_paths[] = {
 			},
 			{0}
 		},
-		.flags = OP_FLAGS,
+		.flags = (OP_FLAGS | OP_BIND_RESP_CACHE),
 	},
 	{
 		.path = "/slurm/{data_parser}/partition/{partition_name}",
@@ -97,11 +97,47 @@ cleanup:
 }
 
 
+/*
+ * Check with slurmctld if the cached response is still current.
+ * Any node or partition info sent by slurmctld is kept to avoid querying it
+ * again when the response needs to be dumped.
+ * RET true if cached response is current
+ */
+static bool _cache_current(openapi_resp_cache_t *cache, uint16_t show_flags,
+			   node_info_msg_t **node_info_ptr,
+			   partition_info_msg_t **part_info_ptr)
+{
+	if (cache->current)
+		return true;
+
+	if (!cache->last_update)
+		return false;
+
+	errno = 0;
+	if (slurm_load_node(cache->last_update, node_info_ptr, show_flags) &&
+	    (errno != SLURM_NO_CHANGE_IN_DATA))
+		return false;
+
+	errno = 0;
+	if (slurm_load_partitions(cache->last_update, part_info_ptr,
+				  show_flags) &&
+	    (errno != SLURM_NO_CHANGE_IN_DATA))
+		return false;
+
+	if (*node_info_ptr || *part_info_ptr)
+		return false;
+
+	cache->current = true;
+	return true;
+}
+
 static void _dump_nodes(ctxt_t *ctxt, char *name)
 {
 	openapi_nodes_query_t query = {0};
 	node_info_msg_t *node_info_ptr = NULL;
+	partition_info_msg_t *part_info_ptr = NULL;
 	openapi_resp_node_info_msg_t resp = {0};
+	openapi_resp_cache_t *cache = NULL;
 
 	if (DATA_PARSE(ctxt->parser, OPENAPI_NODES_QUERY, query, ctxt->query,
 		       ctxt->parent_path)) {
@@ -113,8 +149,18 @@ static void _dump_nodes(ctxt_t *ctxt, char *name)
 	if (!query.show_flags)
 		query.show_flags = SHOW_ALL | SHOW_DETAIL | SHOW_MIXED;
 
+	/* Only cache full dumps that client didn't ask to be conditional */
+	if (!name && !query.update_time &&
+	    !(query.show_flags & SHOW_FEDERATION))
+		cache = ctxt->cache;
+
+	if (cache && _cache_current(cache, query.show_flags, &node_info_ptr,
+				    &part_info_ptr))
+		goto done;
+
 	if (!name) {
-		if ((slurm_load_node(query.update_time, &node_info_ptr,
+		if (!node_info_ptr &&
+		    (slurm_load_node(query.update_time, &node_info_ptr,
 				     query.show_flags))) {
 			resp_error(ctxt, errno, __func__,
 				   "Failure to query nodes");
@@ -132,9 +178,9 @@ static void _dump_nodes(ctxt_t *ctxt, char *name)
 
 	if (node_info_ptr && node_info_ptr->record_count) {
 		int rc;
-		partition_info_msg_t *part_info_ptr = NULL;
 
-		if ((rc = slurm_load_partitions(query.update_time,
+		if (!part_info_ptr &&
+		    (rc = slurm_load_partitions(query.update_time,
 						&part_info_ptr,
 						query.show_flags))) {
 			resp_error(ctxt, rc, __func__,
@@ -143,7 +189,6 @@ static void _dump_nodes(ctxt_t *ctxt, char *name)
 		}
 
 		slurm_populate_node_partitions(node_info_ptr, part_info_ptr);
-		slurm_free_partition_info_msg(part_info_ptr);
 
 		resp.last_update = node_info_ptr->last_update;
 		resp.nodes = node_info_ptr;
@@ -151,7 +196,17 @@ static void _dump_nodes(ctxt_t *ctxt, char *name)
 
 	DATA_DUMP(ctxt->parser, OPENAPI_NODES_RESP, resp, ctxt->resp);
 
+	if (cache && node_info_ptr) {
+		cache->update = node_info_ptr->last_update;
+
+		/* Partitions may have been dumped before the nodes */
+		if (part_info_ptr &&
+		    (part_info_ptr->last_update < cache->update))
+			cache->update = part_info_ptr->last_update;
+	}
+
 done:
+	slurm_free_partition_info_msg(part_info_ptr);
 	slurm_free_node_info_msg(node_info_ptr);
 }
 
@@ -47,6 +47,7 @@ extern int op_handler_partitions(openapi_ctxt_t *ctxt)
 	partition_info_msg_t *part_info_ptr = NULL;
 	openapi_partitions_query_t query = {0};
 	openapi_resp_partitions_info_msg_t resp = {0};
+	openapi_resp_cache_t *cache = NULL;
 
 	if (ctxt->method != HTTP_REQUEST_GET) {
 		resp_error(ctxt, ESLURM_REST_INVALID_QUERY, __func__,
@@ -62,12 +63,26 @@ extern int op_handler_partitions(openapi_ctxt_t *ctxt)
 		goto done;
 	}
 
+	/* Only cache full dumps that client didn't ask to be conditional */
+	if (!query.update_time && !(query.show_flags & SHOW_FEDERATION))
+		cache = ctxt->cache;
+
+	if (cache && cache->current)
+		goto done;
+
 	errno = 0;
-	if ((rc = slurm_load_partitions(query.update_time, &part_info_ptr,
+	if ((rc = slurm_load_partitions((cache ? cache->last_update :
+					 query.update_time), &part_info_ptr,
 					query.show_flags))) {
 		if ((rc == SLURM_ERROR) && errno)
 			rc = errno;
 
+		if (cache && cache->last_update &&
+		    (rc == SLURM_NO_CHANGE_IN_DATA)) {
+			cache->current = true;
+			rc = SLURM_SUCCESS;
+		}
+
 		goto done;
 	}
 
@@ -78,6 +93,9 @@ extern int op_handler_partitions(openapi_ctxt_t *ctxt)
 
 	DATA_DUMP(ctxt->parser, OPENAPI_PARTITION_RESP, resp, ctxt->resp);
 
+	if (cache)
+		cache->update = resp.last_update;
+
 done:
 	slurm_free_partition_info_msg(part_info_ptr);
 	return rc;
@@ -0,0 +1,349 @@
+/*****************************************************************************\
+ *  response_cache.c - Slurm REST API response cache
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include "config.h"
+
+#include <inttypes.h>
+
+#include "src/common/data.h"
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmrestd/response_cache.h"
+
+#define MAGIC_ENTRY 0xA1B3C1DE
+
+struct resp_cache_entry_s {
+	int magic; /* MAGIC_ENTRY */
+	char *key;
+	int refs; /* requests using or waiting on entry */
+	bool busy; /* entry is in use by a request */
+	bool moved; /* cached response moved into request response */
+	uint64_t generation; /* incremented on every new cached response */
+	uint64_t last_used; /* use sequence for eviction */
+	time_t last_update; /* last_update of cached response */
+	data_t *resp; /* cached response without meta, errors and warnings */
+	char *etag;
+};
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static list_t *entries = NULL;
+static int max_entries = 0;
+static uint64_t use_seq = 0;
+static uint64_t etag_seq = 0;
+static time_t start_time = 0;
+
+static void _free_entry(void *x)
+{
+	resp_cache_entry_t *entry = x;
+
+	if (!entry)
+		return;
+
+	xassert(entry->magic == MAGIC_ENTRY);
+	xassert(!entry->refs);
+	entry->magic = ~MAGIC_ENTRY;
+
+	xfree(entry->key);
+	FREE_NULL_DATA(entry->resp);
+	xfree(entry->etag);
+	xfree(entry);
+}
+
+static int _find_key(void *x, void *key)
+{
+	resp_cache_entry_t *entry = x;
+
+	xassert(entry->magic == MAGIC_ENTRY);
+
+	return !xstrcmp(entry->key, key);
+}
+
+static int _find_lru(void *x, void *arg)
+{
+	resp_cache_entry_t *entry = x;
+	resp_cache_entry_t **lru_ptr = arg;
+
+	xassert(entry->magic == MAGIC_ENTRY);
+
+	if (!entry->refs &&
+	    (!*lru_ptr || (entry->last_used < (*lru_ptr)->last_used)))
+		*lru_ptr = entry;
+
+	return SLURM_SUCCESS;
+}
+
+static void _evict(void)
+{
+	while (list_count(entries) > max_entries) {
+		resp_cache_entry_t *lru = NULL;
+
+		(void) list_for_each(entries, _find_lru, &lru);
+
+		/* every entry is in use */
+		if (!lru)
+			break;
+
+		debug3("%s: evicting cached response for %s",
+		       __func__, lru->key);
+
+		list_delete_ptr(entries, lru);
+	}
+}
+
+extern void init_response_cache(int max)
+{
+	slurm_mutex_lock(&mutex);
+
+	xassert(!entries);
+
+	if ((max_entries = max) > 0) {
+		entries = list_create(_free_entry);
+		start_time = time(NULL);
+	}
+
+	slurm_mutex_unlock(&mutex);
+}
+
+extern void destroy_response_cache(void)
+{
+	slurm_mutex_lock(&mutex);
+	FREE_NULL_LIST(entries);
+	max_entries = 0;
+	slurm_mutex_unlock(&mutex);
+}
+
+extern resp_cache_entry_t *response_cache_acquire(const char *key,
+						  openapi_resp_cache_t *cache)
+{
+	resp_cache_entry_t *entry;
+	uint64_t generation;
+	bool waited = false;
+
+	slurm_mutex_lock(&mutex);
+
+	if (!entries) {
+		slurm_mutex_unlock(&mutex);
+		return NULL;
+	}
+
+	if (!(entry = list_find_first(entries, _find_key, (void *) key))) {
+		entry = xmalloc(sizeof(*entry));
+		entry->magic = MAGIC_ENTRY;
+		entry->key = xstrdup(key);
+		list_append(entries, entry);
+	}
+
+	entry->refs++;
+	entry->last_used = ++use_seq;
+	generation = entry->generation;
+
+	_evict();
+
+	while (entry->busy) {
+		waited = true;
+		slurm_cond_wait(&cond, &mutex);
+	}
+
+	entry->busy = true;
+
+	if (entry->resp) {
+		cache->last_update = entry->last_update;
+
+		/*
+		 * Response was refreshed by the request we waited on which
+		 * makes it as current as asking slurmctld again
+		 */
+		if (waited && (generation != entry->generation))
+			cache->current = true;
+	}
+
+	slurm_mutex_unlock(&mutex);
+
+	return entry;
+}
+
+/* Check If-None-Match header per RFC#7232 Section:3.2 (weak comparison) */
+static bool _match_etag(const char *if_none_match, const char *etag)
+{
+	char *token, *save_ptr = NULL, *buffer;
+	bool match = false;
+
+	if (!if_none_match || !etag)
+		return false;
+
+	if (!xstrncmp(etag, "W/", 2))
+		etag += 2;
+
+	buffer = xstrdup(if_none_match);
+	token = strtok_r(buffer, ",", &save_ptr);
+	while (token && !match) {
+		xstrtrim(token);
+
+		if (!xstrncmp(token, "W/", 2))
+			token += 2;
+
+		match = (!xstrcmp(token, "*") || !xstrcmp(token, etag));
+		token = strtok_r(NULL, ",", &save_ptr);
+	}
+	xfree(buffer);
+
+	return match;
+}
+
+static data_for_each_cmd_t _move_in(const char *key, data_t *data, void *arg)
+{
+	data_t *resp = arg;
+
+	data_move(data_key_set(resp, key), data);
+
+	return DATA_FOR_EACH_CONT;
+}
+
+static data_for_each_cmd_t _move_out(const char *key, data_t *data, void *arg)
+{
+	data_t *resp = arg;
+	data_t *src = data_key_get(resp, key);
+
+	xassert(src);
+	data_move(data, src);
+
+	return DATA_FOR_EACH_CONT;
+}
+
+extern bool response_cache_get(resp_cache_entry_t *entry, data_t *resp,
+			       const char *if_none_match)
+{
+	xassert(entry->magic == MAGIC_ENTRY);
+	xassert(entry->busy);
+	xassert(entry->resp);
+	xassert(!entry->moved);
+
+	if (_match_etag(if_none_match, entry->etag))
+		return true;
+
+	/* Entry is busy which gives exclusive access to entry->resp */
+	(void) data_dict_for_each(entry->resp, _move_in, resp);
+	entry->moved = true;
+
+	return false;
+}
+
+static bool _is_empty(const data_t *resp, const char *key)
+{
+	const data_t *d = data_key_get_const(resp, key);
+
+	if (!d || (data_get_type(d) == DATA_TYPE_NULL))
+		return true;
+
+	return ((data_get_type(d) == DATA_TYPE_LIST) &&
+		!data_get_list_length(d));
+}
+
+static void _store(resp_cache_entry_t *entry, openapi_resp_cache_t *cache,
+		   data_t *resp)
+{
+	FREE_NULL_DATA(entry->resp);
+	entry->resp = data_move(NULL, resp);
+
+	/* always populated per request */
+	data_key_unset(entry->resp,
+		       XSTRINGIFY(OPENAPI_RESP_STRUCT_META_FIELD_NAME));
+	data_key_unset(entry->resp,
+		       XSTRINGIFY(OPENAPI_RESP_STRUCT_ERRORS_FIELD_NAME));
+	data_key_unset(entry->resp,
+		       XSTRINGIFY(OPENAPI_RESP_STRUCT_WARNINGS_FIELD_NAME));
+
+	entry->last_update = cache->update;
+
+	/*
+	 * ETag is weak as meta changes per request. The sequence and start
+	 * time make it unique across entries and restarts.
+	 */
+	xfree(entry->etag);
+	entry->etag = xstrdup_printf("W/\"%"PRIx64"-%"PRIx64"\"",
+				     (uint64_t) start_time, ++etag_seq);
+}
+
+extern char *response_cache_release(resp_cache_entry_t *entry,
+				    openapi_resp_cache_t *cache, int rc,
+				    data_t *resp)
+{
+	char *etag = NULL;
+
+	xassert(entry->magic == MAGIC_ENTRY);
+	xassert(entry->busy);
+
+	slurm_mutex_lock(&mutex);
+
+	if (entry->moved) {
+		(void) data_dict_for_each(entry->resp, _move_out, resp);
+		entry->moved = false;
+		etag = xstrdup(entry->etag);
+	} else if (!rc && cache->current && entry->resp) {
+		/* client already had current response */
+		etag = xstrdup(entry->etag);
+	} else if (!rc && cache->update &&
+		   (data_get_type(resp) == DATA_TYPE_DICT) &&
+		   _is_empty(resp, XSTRINGIFY(
+				OPENAPI_RESP_STRUCT_ERRORS_FIELD_NAME)) &&
+		   _is_empty(resp, XSTRINGIFY(
+				OPENAPI_RESP_STRUCT_WARNINGS_FIELD_NAME))) {
+		_store(entry, cache, resp);
+		entry->generation++;
+		etag = xstrdup(entry->etag);
+	} else if (!cache->current) {
+		/* cached response is stale or unverified */
+		FREE_NULL_DATA(entry->resp);
+		xfree(entry->etag);
+		entry->last_update = 0;
+	}
+
+	entry->busy = false;
+	entry->refs--;
+	slurm_cond_broadcast(&cond);
+
+	_evict();
+
+	slurm_mutex_unlock(&mutex);
+
+	return etag;
+}
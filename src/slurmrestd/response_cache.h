@@ -0,0 +1,89 @@
+/*****************************************************************************\
+ *  response_cache.h - Slurm REST API response cache
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#ifndef SLURMRESTD_RESPONSE_CACHE_H
+#define SLURMRESTD_RESPONSE_CACHE_H
+
+#include "src/common/data.h"
+#include "src/slurmrestd/openapi.h"
+
+typedef struct resp_cache_entry_s resp_cache_entry_t;
+
+/*
+ * Setup response cache
+ * IN max_entries - max number of cached responses or 0 to disable caching
+ */
+extern void init_response_cache(int max_entries);
+extern void destroy_response_cache(void);
+
+/*
+ * Get exclusive use of the cache entry for a request.
+ * Identical requests arriving while the entry is in use will wait and then
+ * reuse the refreshed response instead of querying slurmctld again.
+ *
+ * IN key - string uniquely identifying request and requesting user
+ * IN/OUT cache - populated with state of cached response for handler
+ * RET entry (must call response_cache_release()) or NULL if caching disabled
+ */
+extern resp_cache_entry_t *response_cache_acquire(const char *key,
+						  openapi_resp_cache_t *cache);
+
+/*
+ * Populate response from the cache after handler found cache to be current
+ * IN entry - entry from response_cache_acquire()
+ * IN/OUT resp - response to populate (cached data is moved not copied)
+ * IN if_none_match - If-None-Match header from client or NULL
+ * RET true if client already has the current response and resp was not
+ *	populated
+ */
+extern bool response_cache_get(resp_cache_entry_t *entry, data_t *resp,
+			       const char *if_none_match);
+
+/*
+ * Release cache entry after response has been serialized.
+ * Cacheable responses dumped by the handler are moved into the cache.
+ *
+ * IN entry - entry from response_cache_acquire()
+ * IN cache - cache state from handler
+ * IN rc - return code of handler
+ * IN/OUT resp - response (contents may be moved into the cache)
+ * RET ETag of response sent to client (caller must xfree) or NULL
+ */
+extern char *response_cache_release(resp_cache_entry_t *entry,
+				    openapi_resp_cache_t *cache, int rc,
+				    data_t *resp);
+
+#endif /* SLURMRESTD_RESPONSE_CACHE_H */
@@ -80,6 +80,7 @@
 #include "src/slurmrestd/http.h"
 #include "src/slurmrestd/openapi.h"
 #include "src/slurmrestd/operations.h"
+#include "src/slurmrestd/response_cache.h"
 #include "src/slurmrestd/rest_auth.h"
 
 #define OPT_LONG_MAX_CON 0x100
@@ -115,6 +116,8 @@ static char *slurm_conf_filename = NULL;
 static int thread_count = 20;
 /* Max number of connections */
 static int max_connections = 124;
+/* Max number of cached responses */
+static int response_cache_size = 0;
 /* User to become once loaded */
 static uid_t uid = 0;
 static gid_t gid = 0;
@@ -186,6 +189,14 @@ static void _parse_env(void)
 	if ((buffer = getenv("SLURMRESTD_MAX_CONNECTIONS")))
 		_set_max_connections(buffer);
 
+	if ((buffer = getenv("SLURMRESTD_RESPONSE_CACHE"))) {
+		response_cache_size = slurm_atoul(buffer);
+
+		if (response_cache_size < 0)
+			fatal("Invalid env SLURMRESTD_RESPONSE_CACHE: %s",
+			      buffer);
+	}
+
 	if ((buffer = getenv("SLURMRESTD_OPENAPI_PLUGINS")) != NULL) {
 		xfree(oas_specs);
 		oas_specs = xstrdup(buffer);
@@ -764,6 +775,8 @@ int main(int argc, char **argv)
 	if (init_operations(parsers))
 		fatal("Unable to initialize operations structures");
 
+	init_response_cache(response_cache_size);
+
 	if (oas_specs && !xstrcasecmp(oas_specs, "list")) {
 		fprintf(stderr, "Possible OpenAPI plugins:\n");
 		init_openapi(oas_specs, _plugrack_foreach_list, NULL, NULL);
@@ -826,6 +839,7 @@ int main(int argc, char **argv)
 	/* cleanup everything */
 	destroy_rest_auth();
 	destroy_operations();
+	destroy_response_cache();
 	destroy_openapi();
 	conmgr_fini();
 	FREE_NULL_DATA_PARSER_ARRAY(parsers, false);
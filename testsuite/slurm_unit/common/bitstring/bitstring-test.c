@@ -331,6 +331,70 @@ START_TEST(test_bit_ffs_from_bit)
 }
 END_TEST
 
+START_TEST(test_bit_large_ops)
+{
+	/* Sizes long enough for the vectorized word kernels, with tails */
+	int sizes[] = { 512, 1001, 12031 };
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		int n = sizes[i], cnt1 = 0, cnt_and = 0;
+		bitstr_t *bs = bit_alloc(n);
+		bitstr_t *bs2 = bit_alloc(n);
+		bitstr_t *tmp;
+
+		for (int j = 0; j < n; j++) {
+			if (!(j % 3)) {
+				bit_set(bs, j);
+				cnt1++;
+			}
+			if (!(j % 5)) {
+				bit_set(bs2, j);
+				if (!(j % 3))
+					cnt_and++;
+			}
+		}
+
+		ck_assert_int_eq(bit_set_count(bs), cnt1);
+		ck_assert_int_eq(bit_overlap(bs, bs2), cnt_and);
+		ck_assert_int_eq(bit_overlap_any(bs, bs2), 1);
+		ck_assert_int_eq(bit_super_set(bs, bs2), 0);
+
+		tmp = bit_copy(bs);
+		bit_and(tmp, bs2);
+		ck_assert_int_eq(bit_set_count(tmp), cnt_and);
+		ck_assert_int_eq(bit_super_set(tmp, bs), 1);
+		ck_assert_int_eq(bit_super_set(tmp, bs2), 1);
+		bit_free(tmp);
+
+		tmp = bit_copy(bs);
+		bit_or(tmp, bs2);
+		ck_assert_int_eq(bit_set_count(tmp),
+				 cnt1 + bit_set_count(bs2) - cnt_and);
+		bit_free(tmp);
+
+		tmp = bit_copy(bs);
+		bit_and_not(tmp, bs2);
+		ck_assert_int_eq(bit_set_count(tmp), cnt1 - cnt_and);
+		ck_assert_int_eq(bit_overlap_any(tmp, bs2), 0);
+		ck_assert_int_eq(bit_overlap(tmp, bs2), 0);
+		bit_free(tmp);
+
+		/* Only the last bit overlaps */
+		bit_clear_all(bs);
+		bit_clear_all(bs2);
+		bit_set(bs, n - 1);
+		bit_set(bs2, n - 1);
+		ck_assert_int_eq(bit_overlap_any(bs, bs2), 1);
+		bit_clear(bs2, n - 1);
+		ck_assert_int_eq(bit_overlap_any(bs, bs2), 0);
+		ck_assert_int_eq(bit_super_set(bs, bs2), 0);
+
+		bit_free(bs);
+		bit_free(bs2);
+	}
+}
+END_TEST
+
 int main(void)
 {
 	int number_failed;
@@ -353,6 +417,7 @@ int main(void)
 	tcase_add_test(tc_core, test_bit_overlap);
 	tcase_add_test(tc_core, test_bit_set_count_range);
 	tcase_add_test(tc_core, test_bit_ffs_from_bit);
+	tcase_add_test(tc_core, test_bit_large_ops);
 
 	suite_add_tcase(s, tc_core);
 
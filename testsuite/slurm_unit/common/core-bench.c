@@ -0,0 +1,994 @@
+/*****************************************************************************\
+ *  core-bench.c - microbenchmarks for core data structures
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * Reproducible timings of the primitives the daemons spend most of their time
+ * in, at cluster scale sizes. Not run by "make check", build and run with
+ * "make bench" in this directory. See _usage() for the options.
+ *
+ * Each benchmark is run several times with fresh setup and the fastest run is
+ * reported, along with the number of malloc() calls per operation (glibc
+ * only) and the throughput. Inputs are generated from a fixed seed so numbers
+ * are comparable between releases on the same hardware.
+ */
+
+#define _GNU_SOURCE
+
+#include "config.h"
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "slurm/slurm_errno.h"
+#include "src/common/bitstring.h"
+#include "src/common/data.h"
+#include "src/common/hostlist.h"
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/pack.h"
+#include "src/common/read_config.h"
+#include "src/common/xahash.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/interfaces/serializer.h"
+
+#define BYTES_IN_MiB (1024 * 1024)
+#define NSEC_IN_SEC 1000000000
+
+/*
+ * Count every allocation made by the process, including those from within
+ * libslurm, by interposing the glibc allocator entry points.
+ */
+#if defined(__GLIBC__)
+#define HAVE_ALLOC_COUNT 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static uint64_t alloc_count = 0;
+
+extern void *malloc(size_t size)
+{
+	__atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+	return __libc_malloc(size);
+}
+
+extern void *calloc(size_t nmemb, size_t size)
+{
+	__atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+	return __libc_calloc(nmemb, size);
+}
+
+extern void *realloc(void *ptr, size_t size)
+{
+	__atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+	return __libc_realloc(ptr, size);
+}
+
+#define _get_alloc_count() __atomic_load_n(&alloc_count, __ATOMIC_RELAXED)
+#else
+#define HAVE_ALLOC_COUNT 0
+#define _get_alloc_count() 0
+#endif
+
+typedef struct {
+	int size; /* elements in the data structure (nodes, jobs, hosts) */
+	void *state; /* from setup() */
+	uint64_t ops; /* operations done by run(), set by run() */
+	uint64_t bytes; /* bytes processed by run(), set by run() */
+} bench_args_t;
+
+typedef struct {
+	const char *name;
+	void (*setup)(bench_args_t *args);
+	void (*run)(bench_args_t *args);
+	void (*cleanup)(bench_args_t *args);
+	enum {
+		SIZE_NODES,
+		SIZE_JOBS,
+		SIZE_HOSTS,
+		SIZE_DATA,
+	} size_type;
+} bench_t;
+
+static int repeat = 5;
+static bool parsable = false;
+static char *filter = NULL;
+static int node_sizes[] = { 10000, 100000 };
+static int job_sizes[] = { 1000000 };
+static int host_sizes[] = { 10000, 100000 };
+static int data_sizes[] = { 10000 };
+static bool have_serializer = false;
+
+/* Keep the compiler from discarding results of the benchmarked calls */
+static volatile uint64_t sink;
+
+static uint64_t rand_state = 0x2545f4914f6cdd1dULL;
+
+/* xorshift64, fixed seed so every run sees the same inputs */
+static uint64_t _rand(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+	return rand_state;
+}
+
+static uint64_t _now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * NSEC_IN_SEC) + ts.tv_nsec;
+}
+
+/* Number of iterations so that a run touches roughly 2^30 bits */
+static int _bit_iterations(int size)
+{
+	return MAX(1, (1 << 30) / size);
+}
+
+/*
+ * Bitstring benchmarks
+ */
+typedef struct {
+	bitstr_t *b1;
+	bitstr_t *b2;
+} bit_state_t;
+
+static void _bit_setup(bench_args_t *args)
+{
+	bit_state_t *st = xmalloc(sizeof(*st));
+
+	st->b1 = bit_alloc(args->size);
+	st->b2 = bit_alloc(args->size);
+
+	/* ~50% busy nodes, and a disjoint ~25% for the second bitmap */
+	for (int i = 0; i < args->size; i++) {
+		uint64_t r = _rand() % 4;
+
+		if (r < 2)
+			bit_set(st->b1, i);
+		else if (r == 2)
+			bit_set(st->b2, i);
+	}
+
+	args->state = st;
+}
+
+static void _bit_cleanup(bench_args_t *args)
+{
+	bit_state_t *st = args->state;
+
+	FREE_NULL_BITMAP(st->b1);
+	FREE_NULL_BITMAP(st->b2);
+	xfree(st);
+}
+
+#define BIT_BENCH(_name, _expr)						\
+static void _bench_##_name(bench_args_t *args)				\
+{									\
+	bit_state_t *st = args->state;					\
+	int iterations = _bit_iterations(args->size);			\
+	uint64_t sum = 0;						\
+									\
+	for (int i = 0; i < iterations; i++)				\
+		sum += (uint64_t) (_expr);				\
+									\
+	sink = sum;							\
+	args->ops = iterations;						\
+	args->bytes = (uint64_t) iterations * (args->size / 8);	\
+}
+
+BIT_BENCH(bit_set_count, bit_set_count(st->b1))
+BIT_BENCH(bit_overlap, bit_overlap(st->b1, st->b2))
+BIT_BENCH(bit_overlap_any, bit_overlap_any(st->b1, st->b2))
+BIT_BENCH(bit_super_set, bit_super_set(st->b1, st->b2))
+BIT_BENCH(bit_equal, bit_equal(st->b1, st->b2))
+BIT_BENCH(bit_ffs, bit_ffs(st->b2))
+BIT_BENCH(bit_fls, bit_fls(st->b2))
+BIT_BENCH(bit_and, (bit_and(st->b2, st->b1), 0))
+BIT_BENCH(bit_or, (bit_or(st->b2, st->b1), 0))
+BIT_BENCH(bit_and_not, (bit_and_not(st->b2, st->b1), 0))
+BIT_BENCH(bit_copybits, (bit_copybits(st->b2, st->b1), 0))
+
+static void _bench_bit_copy(bench_args_t *args)
+{
+	bit_state_t *st = args->state;
+	int iterations = _bit_iterations(args->size) / 16;
+
+	for (int i = 0; i < iterations; i++) {
+		bitstr_t *tmp = bit_copy(st->b1);
+		FREE_NULL_BITMAP(tmp);
+	}
+
+	args->ops = iterations;
+	args->bytes = (uint64_t) iterations * (args->size / 8);
+}
+
+static void _bench_bit_fmt_full(bench_args_t *args)
+{
+	bit_state_t *st = args->state;
+	int iterations = MAX(1, 10000000 / args->size);
+
+	for (int i = 0; i < iterations; i++) {
+		char *str = bit_fmt_full(st->b1);
+		sink = strlen(str);
+		xfree(str);
+	}
+
+	args->ops = iterations;
+}
+
+/*
+ * Hostlist benchmarks
+ */
+typedef struct {
+	char *ranged; /* ranged expression of the host names */
+	hostlist_t *hl;
+	char **names;
+} host_state_t;
+
+static void _host_setup(bench_args_t *args)
+{
+	host_state_t *st = xmalloc(sizeof(*st));
+
+	st->hl = hostlist_create(NULL);
+	st->names = xcalloc(args->size, sizeof(*st->names));
+
+	/* Leave holes so the ranges look like a real partition */
+	for (int i = 0, n = 0; i < args->size; n++) {
+		if (!(_rand() % 16))
+			continue;
+		st->names[i] = xstrdup_printf("node%06d", n);
+		hostlist_push_host(st->hl, st->names[i]);
+		i++;
+	}
+
+	st->ranged = hostlist_ranged_string_xmalloc(st->hl);
+	args->state = st;
+}
+
+static void _host_cleanup(bench_args_t *args)
+{
+	host_state_t *st = args->state;
+
+	FREE_NULL_HOSTLIST(st->hl);
+	for (int i = 0; i < args->size; i++)
+		xfree(st->names[i]);
+	xfree(st->names);
+	xfree(st->ranged);
+	xfree(st);
+}
+
+static void _bench_hostlist_create(bench_args_t *args)
+{
+	host_state_t *st = args->state;
+	int iterations = MAX(1, 10000000 / args->size);
+
+	for (int i = 0; i < iterations; i++) {
+		hostlist_t *hl = hostlist_create(st->ranged);
+		sink = hostlist_count(hl);
+		FREE_NULL_HOSTLIST(hl);
+	}
+
+	args->ops = iterations;
+	args->bytes = (uint64_t) iterations * strlen(st->ranged);
+}
+
+static void _bench_hostlist_ranged_string(bench_args_t *args)
+{
+	host_state_t *st = args->state;
+	int iterations = MAX(1, 10000000 / args->size);
+
+	for (int i = 0; i < iterations; i++) {
+		char *str = hostlist_ranged_string_xmalloc(st->hl);
+		sink = strlen(str);
+		xfree(str);
+	}
+
+	args->ops = iterations;
+	args->bytes = (uint64_t) iterations * strlen(st->ranged);
+}
+
+static void _bench_hostlist_push_host(bench_args_t *args)
+{
+	host_state_t *st = args->state;
+	hostlist_t *hl = hostlist_create(NULL);
+
+	for (int i = 0; i < args->size; i++)
+		hostlist_push_host(hl, st->names[i]);
+	hostlist_uniq(hl);
+
+	sink = hostlist_count(hl);
+	FREE_NULL_HOSTLIST(hl);
+	args->ops = args->size;
+}
+
+static void _bench_hostlist_find(bench_args_t *args)
+{
+	host_state_t *st = args->state;
+	int iterations = 10000;
+
+	for (int i = 0; i < iterations; i++)
+		sink = hostlist_find(st->hl, st->names[_rand() % args->size]);
+
+	args->ops = iterations;
+}
+
+/*
+ * Pack benchmarks
+ */
+typedef struct {
+	buf_t *buffer;
+	char **strings;
+} pack_state_t;
+
+static void _pack_setup(bench_args_t *args)
+{
+	pack_state_t *st = xmalloc(sizeof(*st));
+
+	st->strings = xcalloc(args->size, sizeof(*st->strings));
+	for (int i = 0; i < args->size; i++)
+		st->strings[i] = xstrdup_printf("job_name_%"PRIu64,
+						_rand() % 100000000);
+
+	/* Packed copy of the data for the unpack benchmarks */
+	st->buffer = init_buf(BUF_SIZE);
+	for (int i = 0; i < args->size; i++) {
+		pack32(i, st->buffer);
+		packstr(st->strings[i], st->buffer);
+	}
+
+	args->state = st;
+}
+
+static void _pack_cleanup(bench_args_t *args)
+{
+	pack_state_t *st = args->state;
+
+	for (int i = 0; i < args->size; i++)
+		xfree(st->strings[i]);
+	xfree(st->strings);
+	FREE_NULL_BUFFER(st->buffer);
+	xfree(st);
+}
+
+static void _bench_pack32(bench_args_t *args)
+{
+	buf_t *buffer = init_buf(BUF_SIZE);
+
+	for (int i = 0; i < args->size; i++)
+		pack32(i, buffer);
+
+	args->ops = args->size;
+	args->bytes = get_buf_offset(buffer);
+	FREE_NULL_BUFFER(buffer);
+}
+
+static void _bench_packstr(bench_args_t *args)
+{
+	pack_state_t *st = args->state;
+	buf_t *buffer = init_buf(BUF_SIZE);
+
+	for (int i = 0; i < args->size; i++)
+		packstr(st->strings[i], buffer);
+
+	args->ops = args->size;
+	args->bytes = get_buf_offset(buffer);
+	FREE_NULL_BUFFER(buffer);
+}
+
+static void _bench_unpack(bench_args_t *args)
+{
+	pack_state_t *st = args->state;
+	uint32_t val, len;
+	char *str;
+
+	set_buf_offset(st->buffer, 0);
+	for (int i = 0; i < args->size; i++) {
+		if (unpack32(&val, st->buffer) ||
+		    unpackstr_xmalloc(&str, &len, st->buffer))
+			fatal("%s: unpack failed", __func__);
+		sink = val + len;
+		xfree(str);
+	}
+
+	args->ops = args->size;
+	args->bytes = get_buf_offset(st->buffer);
+}
+
+/*
+ * List benchmarks
+ */
+static int _cmp_u64(void *x, void *y)
+{
+	uint64_t a = **(uint64_t **) x, b = **(uint64_t **) y;
+
+	return (a > b) - (a < b);
+}
+
+static int _find_u64(void *x, void *key)
+{
+	return (*(uint64_t *) x == *(uint64_t *) key);
+}
+
+static int _sum_u64(void *x, void *arg)
+{
+	*(uint64_t *) arg += *(uint64_t *) x;
+	return SLURM_SUCCESS;
+}
+
+static void _list_setup(bench_args_t *args)
+{
+	list_t *l = list_create(xfree_ptr);
+
+	for (int i = 0; i < args->size; i++) {
+		uint64_t *val = xmalloc(sizeof(*val));
+		*val = _rand();
+		list_append(l, val);
+	}
+
+	args->state = l;
+}
+
+static void _list_cleanup(bench_args_t *args)
+{
+	list_t *l = args->state;
+
+	FREE_NULL_LIST(l);
+}
+
+static void _bench_list_append(bench_args_t *args)
+{
+	list_t *l = list_create(NULL);
+	uint64_t val = 0;
+
+	for (int i = 0; i < args->size; i++)
+		list_append(l, &val);
+
+	FREE_NULL_LIST(l);
+	args->ops = args->size;
+}
+
+static void _bench_list_for_each(bench_args_t *args)
+{
+	uint64_t sum = 0;
+
+	list_for_each(args->state, _sum_u64, &sum);
+
+	sink = sum;
+	args->ops = args->size;
+}
+
+static void _bench_list_find_first(bench_args_t *args)
+{
+	uint64_t key = 0; /* not found, so walks the whole list */
+
+	sink = (uintptr_t) list_find_first(args->state, _find_u64, &key);
+	args->ops = args->size;
+}
+
+static void _bench_list_sort(bench_args_t *args)
+{
+	list_sort(args->state, _cmp_u64);
+	args->ops = args->size;
+}
+
+/*
+ * xahash benchmarks, keyed on job id like the job hash tables
+ */
+typedef struct {
+	uint32_t job_id;
+} job_entry_t;
+
+typedef struct {
+	xahash_table_t *ht;
+	uint32_t *job_ids;
+} xahash_state_t;
+
+static xahash_hash_t _hash_job_id(const void *key, const size_t key_bytes,
+				  void *state)
+{
+	return *(uint32_t *) key;
+}
+
+static bool _match_job_id(void *entry, const void *key, const size_t key_bytes,
+			  void *state)
+{
+	job_entry_t *job = entry;
+
+	return (job->job_id == *(uint32_t *) key);
+}
+
+static void _on_insert_job_id(void *entry, const void *key,
+			      const size_t key_bytes, void *state)
+{
+	job_entry_t *job = entry;
+
+	job->job_id = *(uint32_t *) key;
+}
+
+static void _xahash_setup(bench_args_t *args)
+{
+	xahash_state_t *st = xmalloc(sizeof(*st));
+
+	st->job_ids = xcalloc(args->size, sizeof(*st->job_ids));
+	for (int i = 0; i < args->size; i++)
+		st->job_ids[i] = (_rand() % 0x3ffffff) + 1;
+
+	/* Same sizing as the job_id hash table in slurmctld */
+	st->ht = xahash_new_table(_hash_job_id, _match_job_id,
+				  _on_insert_job_id, NULL, 0,
+				  sizeof(job_entry_t), args->size);
+	for (int i = 0; i < args->size; i++)
+		xahash_insert_entry(st->ht, &st->job_ids[i],
+				    sizeof(st->job_ids[i]));
+
+	args->state = st;
+}
+
+static void _xahash_cleanup(bench_args_t *args)
+{
+	xahash_state_t *st = args->state;
+
+	FREE_NULL_XAHASH_TABLE(st->ht);
+	xfree(st->job_ids);
+	xfree(st);
+}
+
+static void _bench_xahash_insert(bench_args_t *args)
+{
+	xahash_state_t *st = args->state;
+	xahash_table_t *ht = xahash_new_table(_hash_job_id, _match_job_id,
+					      _on_insert_job_id, NULL, 0,
+					      sizeof(job_entry_t), args->size);
+
+	for (int i = 0; i < args->size; i++)
+		xahash_insert_entry(ht, &st->job_ids[i],
+				    sizeof(st->job_ids[i]));
+
+	FREE_NULL_XAHASH_TABLE(ht);
+	args->ops = args->size;
+}
+
+static void _bench_xahash_find(bench_args_t *args)
+{
+	xahash_state_t *st = args->state;
+	uint64_t found = 0;
+
+	for (int i = 0; i < args->size; i++)
+		if (xahash_find_entry(st->ht, &st->job_ids[i],
+				      sizeof(st->job_ids[i])))
+			found++;
+
+	sink = found;
+	args->ops = args->size;
+}
+
+/*
+ * data_t benchmarks, shaped like a slurmrestd job listing
+ */
+typedef struct {
+	data_t *data;
+	char *json;
+	size_t json_len;
+} data_state_t;
+
+static void _fill_jobs(data_t *data, int count)
+{
+	data_t *jobs = data_set_list(data_key_set(data_set_dict(data),
+						  "jobs"));
+
+	for (int i = 0; i < count; i++) {
+		data_t *job = data_set_dict(data_list_append(jobs));
+
+		data_set_int(data_key_set(job, "job_id"), i + 1);
+		data_set_string(data_key_set(job, "name"), "bench_job");
+		data_set_string(data_key_set(job, "partition"), "debug");
+		data_set_string(data_key_set(job, "job_state"), "PENDING");
+		data_set_int(data_key_set(job, "user_id"), _rand() % 1000);
+		data_set_int(data_key_set(job, "priority"), _rand() % 100000);
+	}
+}
+
+static void _data_setup(bench_args_t *args)
+{
+	data_state_t *st = xmalloc(sizeof(*st));
+
+	st->data = data_new();
+	_fill_jobs(st->data, args->size);
+
+	if (have_serializer &&
+	    serialize_g_data_to_string(&st->json, &st->json_len, st->data,
+				       MIME_TYPE_JSON, SER_FLAGS_COMPACT))
+		fatal("%s: unable to serialize", __func__);
+
+	args->state = st;
+}
+
+static void _data_cleanup(bench_args_t *args)
+{
+	data_state_t *st = args->state;
+
+	FREE_NULL_DATA(st->data);
+	xfree(st->json);
+	xfree(st);
+}
+
+static void _bench_data_build(bench_args_t *args)
+{
+	data_t *data = data_new();
+
+	_fill_jobs(data, args->size);
+	FREE_NULL_DATA(data);
+
+	args->ops = args->size;
+}
+
+static void _bench_data_copy(bench_args_t *args)
+{
+	data_state_t *st = args->state;
+	data_t *copy = data_copy(NULL, st->data);
+
+	FREE_NULL_DATA(copy);
+	args->ops = args->size;
+}
+
+static void _bench_data_serialize(bench_args_t *args)
+{
+	data_state_t *st = args->state;
+	char *output = NULL;
+	size_t output_len = 0;
+
+	if (serialize_g_data_to_string(&output, &output_len, st->data,
+				       MIME_TYPE_JSON, SER_FLAGS_COMPACT))
+		fatal("%s: unable to serialize", __func__);
+
+	xfree(output);
+	args->ops = args->size;
+	args->bytes = output_len;
+}
+
+static void _bench_data_parse(bench_args_t *args)
+{
+	data_state_t *st = args->state;
+	data_t *data = NULL;
+
+	if (serialize_g_string_to_data(&data, st->json, st->json_len,
+				       MIME_TYPE_JSON))
+		fatal("%s: unable to parse", __func__);
+
+	FREE_NULL_DATA(data);
+	args->ops = args->size;
+	args->bytes = st->json_len;
+}
+
+static void _dict_setup(bench_args_t *args)
+{
+	data_t *data = data_set_dict(data_new());
+
+	for (int i = 0; i < args->size; i++)
+		data_set_int(data_key_set_int(data, i), i);
+
+	args->state = data;
+}
+
+static void _dict_cleanup(bench_args_t *args)
+{
+	data_t *data = args->state;
+
+	FREE_NULL_DATA(data);
+}
+
+static void _bench_data_key_get(bench_args_t *args)
+{
+	data_t *data = args->state;
+	int found = 0;
+
+	for (int i = 0; i < args->size; i++)
+		if (data_key_get_int(data, i))
+			found++;
+
+	sink = found;
+	args->ops = args->size;
+}
+
+static const bench_t benchmarks[] = {
+	{ "bit_set_count", _bit_setup, _bench_bit_set_count, _bit_cleanup,
+	  SIZE_NODES },
+	{ "bit_overlap", _bit_setup, _bench_bit_overlap, _bit_cleanup,
+	  SIZE_NODES },
+	{ "bit_overlap_any", _bit_setup, _bench_bit_overlap_any, _bit_cleanup,
+	  SIZE_NODES },
+	{ "bit_super_set", _bit_setup, _bench_bit_super_set, _bit_cleanup,
+	  SIZE_NODES },
+	{ "bit_equal", _bit_setup, _bench_bit_equal, _bit_cleanup,
+	  SIZE_NODES },
+	{ "bit_ffs", _bit_setup, _bench_bit_ffs, _bit_cleanup, SIZE_NODES },
+	{ "bit_fls", _bit_setup, _bench_bit_fls, _bit_cleanup, SIZE_NODES },
+	{ "bit_and", _bit_setup, _bench_bit_and, _bit_cleanup, SIZE_NODES },
+	{ "bit_or", _bit_setup, _bench_bit_or, _bit_cleanup, SIZE_NODES },
+	{ "bit_and_not", _bit_setup, _bench_bit_and_not, _bit_cleanup,
+	  SIZE_NODES },
+	{ "bit_copybits", _bit_setup, _bench_bit_copybits, _bit_cleanup,
+	  SIZE_NODES },
+	{ "bit_copy", _bit_setup, _bench_bit_copy, _bit_cleanup, SIZE_NODES },
+	{ "bit_fmt_full", _bit_setup, _bench_bit_fmt_full, _bit_cleanup,
+	  SIZE_NODES },
+	{ "hostlist_create", _host_setup, _bench_hostlist_create,
+	  _host_cleanup, SIZE_HOSTS },
+	{ "hostlist_ranged_string", _host_setup,
+	  _bench_hostlist_ranged_string, _host_cleanup, SIZE_HOSTS },
+	{ "hostlist_push_host", _host_setup, _bench_hostlist_push_host,
+	  _host_cleanup, SIZE_HOSTS },
+	{ "hostlist_find", _host_setup, _bench_hostlist_find, _host_cleanup,
+	  SIZE_HOSTS },
+	{ "pack32", _pack_setup, _bench_pack32, _pack_cleanup, SIZE_JOBS },
+	{ "packstr", _pack_setup, _bench_packstr, _pack_cleanup, SIZE_JOBS },
+	{ "unpack32+unpackstr_xmalloc", _pack_setup, _bench_unpack,
+	  _pack_cleanup, SIZE_JOBS },
+	{ "list_append", NULL, _bench_list_append, NULL, SIZE_JOBS },
+	{ "list_for_each", _list_setup, _bench_list_for_each, _list_cleanup,
+	  SIZE_JOBS },
+	{ "list_find_first", _list_setup, _bench_list_find_first,
+	  _list_cleanup, SIZE_JOBS },
+	{ "list_sort", _list_setup, _bench_list_sort, _list_cleanup,
+	  SIZE_JOBS },
+	{ "xahash_insert", _xahash_setup, _bench_xahash_insert,
+	  _xahash_cleanup, SIZE_JOBS },
+	{ "xahash_find", _xahash_setup, _bench_xahash_find, _xahash_cleanup,
+	  SIZE_JOBS },
+	{ "data_build", NULL, _bench_data_build, NULL, SIZE_DATA },
+	{ "data_key_get", _dict_setup, _bench_data_key_get, _dict_cleanup,
+	  SIZE_DATA },
+	{ "data_copy", _data_setup, _bench_data_copy, _data_cleanup,
+	  SIZE_DATA },
+	{ "data_serialize_json", _data_setup, _bench_data_serialize,
+	  _data_cleanup, SIZE_DATA },
+	{ "data_parse_json", _data_setup, _bench_data_parse, _data_cleanup,
+	  SIZE_DATA },
+};
+
+static void _print_header(void)
+{
+	if (parsable)
+		printf("name|size|ns_per_op|allocs_per_op|ops_per_sec|MiB_per_sec\n");
+	else
+		printf("%-28s %8s %14s %12s %14s %12s\n", "benchmark", "size",
+		       "ns/op", "allocs/op", "ops/sec", "MiB/sec");
+}
+
+static void _print_result(const char *name, int size, uint64_t nsec,
+			  uint64_t allocs, bench_args_t *args)
+{
+	double ns_per_op = (double) nsec / args->ops;
+	double ops_per_sec = (double) args->ops * NSEC_IN_SEC / nsec;
+	double mib_per_sec = 0;
+
+	if (args->bytes)
+		mib_per_sec = ((double) args->bytes * NSEC_IN_SEC / nsec) /
+			      BYTES_IN_MiB;
+
+	if (parsable) {
+		printf("%s|%d|%.2f|", name, size, ns_per_op);
+		if (HAVE_ALLOC_COUNT)
+			printf("%.3f", (double) allocs / args->ops);
+		printf("|%.0f|", ops_per_sec);
+		if (args->bytes)
+			printf("%.2f", mib_per_sec);
+		printf("\n");
+		return;
+	}
+
+	printf("%-28s %8d %14.2f ", name, size, ns_per_op);
+	if (HAVE_ALLOC_COUNT)
+		printf("%12.3f ", (double) allocs / args->ops);
+	else
+		printf("%12s ", "-");
+	printf("%14.0f ", ops_per_sec);
+	if (args->bytes)
+		printf("%12.2f\n", mib_per_sec);
+	else
+		printf("%12s\n", "-");
+}
+
+static void _run_bench(const bench_t *bench, int size)
+{
+	uint64_t best_nsec = UINT64_MAX, best_allocs = 0;
+	bench_args_t args = { 0 };
+
+	for (int r = 0; r < repeat; r++) {
+		uint64_t start, nsec, allocs;
+
+		/* Every repetition sees identical inputs */
+		rand_state = 0x2545f4914f6cdd1dULL;
+		args = (bench_args_t) { .size = size };
+
+		if (bench->setup)
+			bench->setup(&args);
+
+		allocs = _get_alloc_count();
+		start = _now_nsec();
+		bench->run(&args);
+		nsec = _now_nsec() - start;
+		allocs = _get_alloc_count() - allocs;
+
+		if (bench->cleanup)
+			bench->cleanup(&args);
+
+		if (nsec < best_nsec) {
+			best_nsec = nsec;
+			best_allocs = allocs;
+		}
+	}
+
+	_print_result(bench->name, size, MAX(best_nsec, 1), best_allocs, &args);
+}
+
+static void _usage(void)
+{
+	printf("Usage: core-bench [-b name] [-d jobs] [-H hosts] [-j jobs] [-n nodes] [-p] [-r repeat]\n"
+	       "  -b name    only run benchmarks whose name contains this string\n"
+	       "  -d jobs    job count for data_* (default: 10000)\n"
+	       "  -j jobs    element count for pack/list/xahash (default: 1000000)\n"
+	       "  -n nodes   bitmap size in nodes (default: 10000 and 100000)\n"
+	       "  -H hosts   hostlist size (default: 10000 and 100000)\n"
+	       "  -p         parsable output\n"
+	       "  -r repeat  runs per benchmark, the fastest is reported (default: 5)\n");
+}
+
+static void _init_serializer(void)
+{
+	const char *conf = getenv("SLURM_CONF");
+
+	/*
+	 * Serializer plugins are optional, only needed for data_*_json. They
+	 * are found through PluginDir, so a slurm.conf must be available.
+	 */
+	if (!conf)
+		conf = default_slurm_config_file;
+	if (access(conf, R_OK) || slurm_conf_init(conf) ||
+	    serializer_g_init(MIME_TYPE_JSON_PLUGIN, NULL)) {
+		fprintf(stderr, "JSON serializer not available, skipping data_*_json benchmarks\n");
+		return;
+	}
+
+	have_serializer = true;
+}
+
+static void _run_size_set(const bench_t *bench, int *sizes, int count)
+{
+	for (int i = 0; i < count; i++)
+		_run_bench(bench, sizes[i]);
+}
+
+extern int main(int argc, char **argv)
+{
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	int opt, node_cnt = ARRAY_SIZE(node_sizes);
+	int job_cnt = ARRAY_SIZE(job_sizes), host_cnt = ARRAY_SIZE(host_sizes);
+	int data_cnt = ARRAY_SIZE(data_sizes);
+
+	log_opts.stderr_level = LOG_LEVEL_ERROR;
+	log_init("core-bench", log_opts, 0, NULL);
+
+	while ((opt = getopt(argc, argv, "b:d:hH:j:n:pr:")) != -1) {
+		switch (opt) {
+		case 'b':
+			filter = optarg;
+			break;
+		case 'd':
+			data_sizes[0] = atoi(optarg);
+			data_cnt = 1;
+			break;
+		case 'H':
+			host_sizes[0] = atoi(optarg);
+			host_cnt = 1;
+			break;
+		case 'j':
+			job_sizes[0] = atoi(optarg);
+			job_cnt = 1;
+			break;
+		case 'n':
+			node_sizes[0] = atoi(optarg);
+			node_cnt = 1;
+			break;
+		case 'p':
+			parsable = true;
+			break;
+		case 'r':
+			repeat = atoi(optarg);
+			break;
+		case 'h':
+		default:
+			_usage();
+			return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	if ((repeat < 1) || (node_sizes[0] < 1) || (job_sizes[0] < 1) ||
+	    (host_sizes[0] < 1) || (data_sizes[0] < 1)) {
+		_usage();
+		return EXIT_FAILURE;
+	}
+
+	if (!filter || xstrcasestr("data_serialize_json data_parse_json",
+				   filter))
+		_init_serializer();
+
+#ifndef NDEBUG
+	fprintf(stderr, "WARNING: built with assertions enabled (see --disable-debug), timings are not representative\n");
+#endif
+
+	_print_header();
+
+	for (int i = 0; i < ARRAY_SIZE(benchmarks); i++) {
+		const bench_t *bench = &benchmarks[i];
+
+		if (filter && !xstrcasestr(bench->name, filter))
+			continue;
+		if (!have_serializer && xstrcasestr(bench->name, "_json"))
+			continue;
+
+		switch (bench->size_type) {
+		case SIZE_NODES:
+			_run_size_set(bench, node_sizes, node_cnt);
+			break;
+		case SIZE_JOBS:
+			_run_size_set(bench, job_sizes, job_cnt);
+			break;
+		case SIZE_HOSTS:
+			_run_size_set(bench, host_sizes, host_cnt);
+			break;
+		case SIZE_DATA:
+			_run_size_set(bench, data_sizes, data_cnt);
+			break;
+		}
+	}
+
+	if (have_serializer)
+		serializer_g_fini();
+	log_fini();
+
+	return EXIT_SUCCESS;
+}
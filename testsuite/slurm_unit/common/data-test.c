@@ -121,6 +121,17 @@ static data_for_each_cmd_t _del_list_odd(data_t *data, void *arg)
 	return DATA_FOR_EACH_CONT;
 }
 
+static data_for_each_cmd_t
+	_check_dict_order(const char *key, const data_t *data, void *arg)
+{
+	int64_t *last = arg;
+
+	ck_assert_msg(data_get_int(data) > *last, "check order");
+
+	*last = data_get_int(data);
+	return DATA_FOR_EACH_CONT;
+}
+
 data_for_each_cmd_t _check_list_order(const data_t *data, void *arg)
 {
 	int *found = arg;
@@ -237,6 +248,53 @@ START_TEST(test_dict_iteration)
 }
 END_TEST
 
+START_TEST(test_dict_index)
+{
+	const int count = 1000;
+	int64_t last = -1;
+	data_t *d = data_set_dict(data_new());
+
+	/* large enough to use key index */
+	for (int i = 0; i < count; i++)
+		data_set_int(data_key_set_int(d, i), i);
+	ck_assert_msg(data_get_dict_length(d) == count, "dict cardinality");
+
+	for (int i = 0; i < count; i++) {
+		data_t *v = data_key_get_int(d, i);
+
+		ck_assert_msg(v && (data_get_int(v) == i), "find key %d", i);
+		ck_assert_msg(data_key_set_int(d, i) == v, "reuse key %d", i);
+	}
+	ck_assert_msg(!data_key_get(d, "missing"), "missing key");
+
+	for (int i = 0; i < count; i += 2) {
+		char key[16];
+
+		snprintf(key, sizeof(key), "%d", i);
+		ck_assert_msg(data_key_unset(d, key), "unset key %d", i);
+	}
+	ck_assert_msg(data_get_dict_length(d) == (count / 2),
+		      "dict cardinality after unset");
+
+	for (int i = 0; i < count; i++) {
+		data_t *v = data_key_get_int(d, i);
+
+		if (i % 2)
+			ck_assert_msg(v && (data_get_int(v) == i),
+				      "find key %d", i);
+		else
+			ck_assert_msg(!v, "removed key %d", i);
+	}
+
+	/* insertion order is preserved */
+	ck_assert_msg(data_dict_for_each_const(d, _check_dict_order, &last) ==
+		      (count / 2), "dict order");
+	ck_assert_msg(last == (count - 1), "last key");
+
+	FREE_NULL_DATA(d);
+}
+END_TEST
+
 START_TEST(test_dict_typeset)
 {
 	data_t *d = data_new();
@@ -355,6 +413,7 @@ Suite *suite_data(void)
 	tcase_add_test(tc_core, test_detection);
 	tcase_add_test(tc_core, test_dict_typeset);
 	tcase_add_test(tc_core, test_dict_iteration);
+	tcase_add_test(tc_core, test_dict_index);
 	tcase_add_test(tc_core, test_list_iteration);
 
 	suite_add_tcase(s, tc_core);
@@ -0,0 +1,175 @@
+/*****************************************************************************\
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "slurm/slurm.h"
+#include "src/common/hostlist.h"
+#include "src/common/xmalloc.h"
+
+/* these are not in slurm.h */
+int slurm_hostlist_delete_host(hostlist_t *, const char *);
+hostset_t *slurm_hostset_create(const char*);
+void slurm_hostset_destroy(hostset_t *);
+int slurm_hostset_count(hostset_t *);
+int slurm_hostset_within(hostset_t *, const char *);
+int slurm_hostset_insert(hostset_t *, const char *);
+
+/* enough ranges for hostlist_find() to use the lookup index */
+#define HOSTS "login1,n[2,4,6,8,10,12,14,16-20,0030],rack[1-4],gpu[01-02]"
+
+START_TEST(hostlist_find_check)
+{
+	hostlist_t *hl = slurm_hostlist_create(HOSTS);
+	ck_assert(hl != NULL);
+
+	/* repeat to search with and without the lookup index */
+	for (int i = 0; i < 3; i++) {
+		ck_assert_int_eq(slurm_hostlist_find(hl, "login1"), 0);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "n2"), 1);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "n18"), 10);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "n0030"), 13);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "rack4"), 17);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "gpu02"), 19);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "n3"), -1);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "n30"), -1);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "n21"), -1);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "gpu2"), -1);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "rack"), -1);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "login2"), -1);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "node2"), -1);
+	}
+
+	/* positions must follow modifications */
+	ck_assert_int_eq(slurm_hostlist_delete_host(hl, "n2"), 1);
+	ck_assert_int_eq(slurm_hostlist_find(hl, "n2"), -1);
+	ck_assert_int_eq(slurm_hostlist_find(hl, "n18"), 9);
+	ck_assert_int_eq(slurm_hostlist_push_host(hl, "n2"), 1);
+	ck_assert_int_eq(slurm_hostlist_find(hl, "n2"), 19);
+	ck_assert_int_eq(slurm_hostlist_find(hl, "n2"), 19);
+
+	slurm_hostlist_destroy(hl);
+}
+END_TEST
+
+START_TEST(hostlist_find_prefix_digit_check)
+{
+	hostlist_t *hl =
+		slurm_hostlist_create("nid0000[2-7],a[1-3],b1,c1,d1,e1,f1,g1");
+	ck_assert(hl != NULL);
+
+	for (int i = 0; i < 3; i++) {
+		ck_assert_int_eq(slurm_hostlist_find(hl, "nid00002"), 0);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "nid00007"), 5);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "nid00008"), -1);
+		ck_assert_int_eq(slurm_hostlist_find(hl, "g1"), 14);
+	}
+
+	slurm_hostlist_destroy(hl);
+}
+END_TEST
+
+START_TEST(hostlist_ranged_string_check)
+{
+	char *p;
+	hostlist_t *hl = slurm_hostlist_create("n[1-3]");
+	ck_assert(hl != NULL);
+
+	p = slurm_hostlist_ranged_string_xmalloc(hl);
+	ck_assert_str_eq(p, "n[1-3]");
+	xfree(p);
+
+	/* cached string must not outlive modifications */
+	ck_assert_int_eq(slurm_hostlist_push_host(hl, "n5"), 1);
+	p = slurm_hostlist_ranged_string_xmalloc(hl);
+	ck_assert_str_eq(p, "n[1-3,5]");
+	xfree(p);
+
+	free(slurm_hostlist_shift(hl));
+	p = slurm_hostlist_ranged_string_xmalloc(hl);
+	ck_assert_str_eq(p, "n[2-3,5]");
+	xfree(p);
+
+	slurm_hostlist_destroy(hl);
+}
+END_TEST
+
+START_TEST(hostset_insert_check)
+{
+	hostset_t *hs = slurm_hostset_create("n[1-3,7]");
+	ck_assert(hs != NULL);
+
+	ck_assert_int_eq(slurm_hostset_insert(hs, "n[5,9],m1"), 3);
+	ck_assert_int_eq(slurm_hostset_insert(hs, "n[2-6]"), 2);
+	ck_assert_int_eq(slurm_hostset_count(hs), 9);
+	ck_assert(slurm_hostset_within(hs, "m1,n[1-7,9]"));
+	ck_assert(!slurm_hostset_within(hs, "n8"));
+
+	slurm_hostset_destroy(hs);
+}
+END_TEST
+
+/*****************************************************************************
+ * TEST SUITE                                                                *
+ ****************************************************************************/
+
+Suite *make_find_suite(void)
+{
+	Suite *s = suite_create("hostlist_find");
+	TCase *tc_core = tcase_create("hostlist_find");
+	tcase_add_test(tc_core, hostlist_find_check);
+	tcase_add_test(tc_core, hostlist_find_prefix_digit_check);
+	tcase_add_test(tc_core, hostlist_ranged_string_check);
+	tcase_add_test(tc_core, hostset_insert_check);
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+/*****************************************************************************
+ * TEST RUNNER                                                               *
+ ****************************************************************************/
+
+int main(void)
+{
+	int number_failed;
+	SRunner *sr = srunner_create(make_find_suite());
+
+	srunner_run_all(sr, CK_VERBOSE);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
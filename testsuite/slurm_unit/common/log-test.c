@@ -1,14 +1,231 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <slurm/slurm_errno.h>
 #include "src/common/log.h"
 
+/* Enough to overflow the 4 MB async log buffer plus a pipe */
+#define ASYNC_LINES	8192
+#define ASYNC_PAD	1000
+
+typedef struct {
+	int fd;
+	const char *end;	/* stop reading once this has been read */
+	char *data;
+	size_t len;
+} reader_t;
+
+static char pad[ASYNC_PAD + 1];
+static volatile bool block_done = false;
+
 int bad_func()
 {
 	slurm_seterrno_ret(EINVAL);
 }
+
+/* Create a fifo and open its read end so the logger can open it to write */
+static int _open_fifo(char *path)
+{
+	int fd;
+
+	if (mkfifo(path, 0600) < 0)
+		return -1;
+	if ((fd = open(path, O_RDONLY | O_NONBLOCK)) < 0)
+		return -1;
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+	return fd;
+}
+
+static void *_reader(void *arg)
+{
+	reader_t *r = arg;
+	size_t size = 0, end_len = strlen(r->end);
+
+	while (true) {
+		ssize_t got;
+		size_t from;
+
+		if ((size - r->len) < 65536) {
+			size = (size + 65536) * 2;
+			r->data = realloc(r->data, size);
+		}
+		got = read(r->fd, r->data + r->len, size - r->len - 1);
+		if ((got < 0) && (errno == EINTR))
+			continue;
+		if (got <= 0)
+			break;
+
+		from = (r->len > end_len) ? (r->len - end_len) : 0;
+		r->len += got;
+		r->data[r->len] = '\0';
+		if (strstr(r->data + from, r->end))
+			break;
+	}
+
+	return NULL;
+}
+
+static void *_block_logger(void *arg)
+{
+	for (int i = 0; i < ASYNC_LINES; i++)
+		info("async block %d %s", i, pad);
+	info("async block done");
+	block_done = true;
+	return NULL;
+}
+
+/*
+ * Check the lines named by tag arrived in order and count them and the
+ * dropped messages reported by the logger. RET number of errors
+ */
+static int _check_lines(char *data, const char *tag, int *lines,
+			uint64_t *dropped)
+{
+	char *save_ptr = NULL, *line, *p;
+	size_t tag_len = strlen(tag);
+	int last = -1, errors = 0;
+
+	*lines = 0;
+	*dropped = 0;
+	for (line = strtok_r(data, "\n", &save_ptr); line;
+	     line = strtok_r(NULL, "\n", &save_ptr)) {
+		if (strstr(line, "log messages dropped")) {
+			p = strstr(line, "error: ");
+			if (!p) {
+				fprintf(stderr, "bad drop notice: %s\n", line);
+				errors++;
+				continue;
+			}
+			*dropped += strtoull(p + 7, NULL, 10);
+		} else if ((p = strstr(line, tag)) &&
+			   (p[tag_len] >= '0') && (p[tag_len] <= '9')) {
+			int i = atoi(p + tag_len);
+
+			if ((i <= last) || (strlen(p) < ASYNC_PAD)) {
+				fprintf(stderr, "%sline %d out of order or truncated\n",
+					tag, i);
+				errors++;
+			}
+			last = i;
+			(*lines)++;
+		}
+	}
+
+	return errors;
+}
+
+/*
+ * Log to a fifo nobody reads until the async buffer is full, then drain it
+ * with log_flush(). Every message must either be written or be counted in
+ * the dropped notice.
+ */
+static int _test_async_drop(char *path)
+{
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	reader_t r = { .end = "async drop done\n" };
+	pthread_t tid;
+	uint64_t dropped;
+	int lines, errors = 0;
+
+	if ((r.fd = _open_fifo(path)) < 0) {
+		fprintf(stderr, "unable to create fifo %s: %m\n", path);
+		return 1;
+	}
+
+	log_opts.stderr_level = LOG_LEVEL_QUIET;
+	log_opts.syslog_level = LOG_LEVEL_QUIET;
+	log_opts.async = LOG_ASYNC_DROP;
+	log_alter(log_opts, 0, path);
+
+	for (int i = 0; i < ASYNC_LINES; i++)
+		info("async drop %d %s", i, pad);
+
+	/* Drain the full buffer so the final message and notice are queued */
+	pthread_create(&tid, NULL, _reader, &r);
+	log_flush();
+	info("async drop done");
+	log_flush();
+	pthread_join(tid, NULL);
+	close(r.fd);
+
+	if (!r.data || !strstr(r.data, r.end)) {
+		fprintf(stderr, "async drop: log_flush() did not drain\n");
+		free(r.data);
+		return 1;
+	}
+
+	errors += _check_lines(r.data, "async drop ", &lines, &dropped);
+	if (!dropped || (lines + dropped != ASYNC_LINES)) {
+		fprintf(stderr, "async drop: %d lines and %"PRIu64" dropped, expected %d total with some dropped\n",
+			lines, dropped, ASYNC_LINES);
+		errors++;
+	}
+
+	free(r.data);
+	return errors;
+}
+
+/*
+ * Log to a fifo nobody reads from another thread, which must block once the
+ * async buffer is full and finish with nothing lost once the fifo is read.
+ */
+static int _test_async_block(char *path)
+{
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	reader_t r = { .end = "async block done\n" };
+	pthread_t log_tid, read_tid;
+	uint64_t dropped;
+	int lines, errors = 0;
+
+	if ((r.fd = _open_fifo(path)) < 0) {
+		fprintf(stderr, "unable to create fifo %s: %m\n", path);
+		return 1;
+	}
+
+	log_opts.stderr_level = LOG_LEVEL_QUIET;
+	log_opts.syslog_level = LOG_LEVEL_QUIET;
+	log_opts.async = LOG_ASYNC_BLOCK;
+	log_alter(log_opts, 0, path);
+
+	pthread_create(&log_tid, NULL, _block_logger, NULL);
+	usleep(200000);
+	if (block_done) {
+		fprintf(stderr, "async block: logging did not block with a full buffer\n");
+		errors++;
+	}
+
+	pthread_create(&read_tid, NULL, _reader, &r);
+	pthread_join(log_tid, NULL);
+	log_flush();
+	pthread_join(read_tid, NULL);
+	close(r.fd);
+
+	if (!r.data || !strstr(r.data, r.end)) {
+		fprintf(stderr, "async block: log_flush() did not drain\n");
+		free(r.data);
+		return errors + 1;
+	}
+
+	errors += _check_lines(r.data, "async block ", &lines, &dropped);
+	if (dropped || (lines != ASYNC_LINES)) {
+		fprintf(stderr, "async block: %d lines and %"PRIu64" dropped, expected %d lines\n",
+			lines, dropped, ASYNC_LINES);
+		errors++;
+	}
+
+	free(r.data);
+	return errors;
+}
+
 int main(int ac, char **av)
 {
 	/* test elements */
@@ -62,6 +279,34 @@ int main(int ac, char **av)
 
 	if (bad_func() < 0)
 		error("bad_func: %m");
+
+	/* async logfile writer, with the rest of the logging off */
+	{
+		char dir[] = "/tmp/log-test.XXXXXX";
+		char drop_path[64], block_path[64];
+		int errors = 0;
+
+		memset(pad, 'x', ASYNC_PAD);
+		if (!mkdtemp(dir)) {
+			fprintf(stderr, "mkdtemp: %m\n");
+			return 1;
+		}
+		snprintf(drop_path, sizeof(drop_path), "%s/drop", dir);
+		snprintf(block_path, sizeof(block_path), "%s/block", dir);
+
+		errors += _test_async_drop(drop_path);
+		errors += _test_async_block(block_path);
+
+		log_opts.logfile_level = LOG_LEVEL_QUIET;
+		log_alter(log_opts, 0, NULL);
+		unlink(drop_path);
+		unlink(block_path);
+		rmdir(dir);
+
+		if (errors)
+			return 1;
+	}
+
 	return 0;
 }
 	
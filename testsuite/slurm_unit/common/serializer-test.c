@@ -45,6 +45,8 @@
 #endif
 
 #include <check.h>
+#include <float.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -468,6 +470,518 @@ START_TEST(test_parse)
 }
 END_TEST
 
+/* Parse JSON and check data is only returned on success */
+static data_t *_parse(const char *src, size_t len)
+{
+	data_t *d = NULL;
+	int rc;
+
+	rc = serialize_g_string_to_data(&d, src, len, MIME_TYPE_JSON);
+	debug("parsed %zu bytes rc=%d -> %pD", len, rc, d);
+
+	if (rc)
+		assert_ptr_null(d, ==);
+	else
+		assert_ptr_null(d, !=);
+
+	return d;
+}
+
+START_TEST(test_parse_limits)
+{
+	/* Must match MAX_DEPTH and MAX_NUMBER_LEN in serializer/json */
+	static const int max_depth = 64, max_number_len = 512;
+	char *str = NULL;
+	data_t *d;
+
+	/* deepest allowed nesting */
+	for (int i = 0; i < max_depth; i++)
+		xstrcatchar(str, '[');
+	for (int i = 0; i < max_depth; i++)
+		xstrcatchar(str, ']');
+	d = _parse(str, strlen(str));
+	assert_ptr_null(d, !=);
+	FREE_NULL_DATA(d);
+	xfree(str);
+
+	/* one level too deep */
+	for (int i = 0; i <= max_depth; i++)
+		xstrcat(str, "{\"a\":");
+	xstrcatchar(str, '1');
+	for (int i = 0; i <= max_depth; i++)
+		xstrcatchar(str, '}');
+	d = _parse(str, strlen(str));
+	assert_ptr_null(d, ==);
+	xfree(str);
+
+	/* far too deep must fail without running out of stack */
+	for (int i = 0; i < 100000; i++)
+		xstrcatchar(str, '[');
+	d = _parse(str, strlen(str));
+	assert_ptr_null(d, ==);
+	xfree(str);
+
+	/* longest allowed number */
+	xstrcat(str, "1.");
+	for (int i = 2; i < max_number_len; i++)
+		xstrcatchar(str, '0');
+	d = _parse(str, strlen(str));
+	assert_ptr_null(d, !=);
+	assert(data_get_type(d) == DATA_TYPE_FLOAT);
+	assert(data_get_float(d) == 1.0);
+	FREE_NULL_DATA(d);
+
+	/* one digit too long */
+	xstrcatchar(str, '0');
+	d = _parse(str, strlen(str));
+	assert_ptr_null(d, ==);
+	xfree(str);
+}
+END_TEST
+
+START_TEST(test_parse_strings)
+{
+	static const struct {
+		const char *src;
+		const char *expected;
+	} s[] = {
+		/* surrogate pair */
+		{ "\"\\ud83d\\ude00\"", "\xF0\x9F\x98\x80" },
+		{ "\"\\uD83D\\uDE00\"", "\xF0\x9F\x98\x80" },
+		/* lone or reversed surrogates become U+FFFD */
+		{ "\"\\ud800\"", "\xEF\xBF\xBD" },
+		{ "\"\\udbff\"", "\xEF\xBF\xBD" },
+		{ "\"\\udc00\"", "\xEF\xBF\xBD" },
+		{ "\"\\udfff\"", "\xEF\xBF\xBD" },
+		{ "\"\\ude00\\ud83d\"", "\xEF\xBF\xBD\xEF\xBF\xBD" },
+		{ "\"\\ud800\\ud800\"", "\xEF\xBF\xBD\xEF\xBF\xBD" },
+		{ "\"\\ud800\\u0041\"", "\xEF\xBF\xBD" "A" },
+		{ "\"\\ud800x\"", "\xEF\xBF\xBD" "x" },
+		{ "\"\\ud800\\n\"", "\xEF\xBF\xBD" "\n" },
+		/* invalid UTF-8 inside strings is passed through as is */
+		{ "\"\xC3\x28\"", "\xC3\x28" },
+		{ "\"\xFF\xFE\"", "\xFF\xFE" },
+		{ "\"\xED\xA0\x80\"", "\xED\xA0\x80" },
+		{ "\"\xF0\x9F\x98\"", "\xF0\x9F\x98" },
+		/* escapes */
+		{ "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"", "\"\\/\b\f\n\r\t" },
+		{ "\"\\u0001\\u001F\\u007f\"", "\x01\x1F\x7F" },
+		{ "\"\\u00e9\\u20AC\"", "\xC3\xA9\xE2\x82\xAC" },
+	};
+	/* should fail */
+	static const char *sf[] = {
+		"\"\\u\"",
+		"\"\\ud8\"",
+		"\"\\ud83d\\ude0\"",
+		"\"\\uZZZZ\"",
+		"\"\\x41\"",
+		"\"\\'\"",
+		"\"\\",
+		"\"\\\"",
+		"\"\\u0041",
+		"\xC3\x28",
+		"[\"taco\", \xC3\xA9]",
+		"\xEF\xBB\xBF\"taco\"",
+	};
+	/* embedded NUL can only be tested with an explicit length */
+	static const char nul[] = "\"ta\0co\"";
+	const char *str;
+	data_t *d;
+
+	for (int i = 0; i < ARRAY_SIZE(s); i++) {
+		d = _parse(s[i].src, strlen(s[i].src));
+		assert_msg(d && (data_get_type(d) == DATA_TYPE_STRING) &&
+			   !xstrcmp(data_get_string(d), s[i].expected),
+			   "string %d failed: %s", i, s[i].src);
+		FREE_NULL_DATA(d);
+	}
+
+	/* dictionary keys are decoded the same way */
+	str = "{\"\\ud800\\u0041\": 1}";
+	d = _parse(str, strlen(str));
+	assert_ptr_null(d, !=);
+	assert(data_key_get_const(d, "\xEF\xBF\xBD" "A") != NULL);
+	FREE_NULL_DATA(d);
+
+	for (int i = 0; i < ARRAY_SIZE(sf); i++) {
+		d = _parse(sf[i], strlen(sf[i]));
+		assert_msg(!d, "expected failure %d parsed: %s", i, sf[i]);
+		FREE_NULL_DATA(d);
+	}
+
+	d = _parse(nul, (sizeof(nul) - 1));
+	assert_ptr_null(d, ==);
+}
+END_TEST
+
+START_TEST(test_parse_numbers)
+{
+	static const struct {
+		const char *src;
+		int64_t value;
+	} si[] = {
+		{ "0", 0 },
+		{ "-0", 0 },
+		{ "10", 10 },
+		{ "-10", -10 },
+		{ "9223372036854775807", INT64_MAX },
+		{ "-9223372036854775808", INT64_MIN },
+	};
+	static const struct {
+		const char *src;
+		double value;
+	} sd[] = {
+		{ "-0.0", -0.0 },
+		{ "0.5", 0.5 },
+		{ "-0.5", -0.5 },
+		{ "0e10", 0.0 },
+		{ "0E-10", 0.0 },
+		{ "1.5e+3", 1500.0 },
+		/* out of int64 range */
+		{ "9223372036854775808", 9223372036854775808.0 },
+		{ "-9223372036854775809", -9223372036854775809.0 },
+		/* out of double range */
+		{ "1e400", INFINITY },
+		{ "-1e400", -INFINITY },
+		{ "1e-400", 0.0 },
+		/* non-finite values as written by the JSON serializer */
+		{ "Infinity", INFINITY },
+		{ "-Infinity", -INFINITY },
+	};
+	/* should fail */
+	static const char *sf[] = {
+		"00",
+		"01",
+		"-01",
+		"0123",
+		"-0123.5",
+		"00.5",
+		"-",
+		"--1",
+		"+1",
+		".5",
+		"1e",
+		"1e+",
+		"1.5.5",
+		"1-2",
+		"[0x10]",
+		"[01]",
+		"{\"a\": 007}",
+		"inf",
+		"nan",
+		"-NaN",
+	};
+	data_t *d;
+
+	for (int i = 0; i < ARRAY_SIZE(si); i++) {
+		d = _parse(si[i].src, strlen(si[i].src));
+		assert_msg(d && (data_get_type(d) == DATA_TYPE_INT_64) &&
+			   (data_get_int(d) == si[i].value),
+			   "int %d failed: %s", i, si[i].src);
+		FREE_NULL_DATA(d);
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(sd); i++) {
+		d = _parse(sd[i].src, strlen(sd[i].src));
+		assert_msg(d && (data_get_type(d) == DATA_TYPE_FLOAT) &&
+			   (data_get_float(d) == sd[i].value) &&
+			   (signbit(data_get_float(d)) ==
+			    signbit(sd[i].value)),
+			   "float %d failed: %s", i, sd[i].src);
+		FREE_NULL_DATA(d);
+	}
+
+	d = _parse("NaN", 3);
+	assert(d && (data_get_type(d) == DATA_TYPE_FLOAT) &&
+	       isnan(data_get_float(d)));
+	FREE_NULL_DATA(d);
+
+	for (int i = 0; i < ARRAY_SIZE(sf); i++) {
+		d = _parse(sf[i], strlen(sf[i]));
+		assert_msg(!d, "expected failure %d parsed: %s", i, sf[i]);
+		FREE_NULL_DATA(d);
+	}
+}
+END_TEST
+
+START_TEST(test_parse_commas)
+{
+	/* trailing comma before closing bracket is tolerated */
+	static const struct {
+		const char *src;
+		int count;
+	} s[] = {
+		{ "[1,]", 1 },
+		{ "[1, 2 ,\n]", 2 },
+		{ "[[],]", 1 },
+		{ "{\"a\":1,}", 1 },
+		{ "{\"a\":1, \"b\":[2,],\t}", 2 },
+	};
+	/* should fail */
+	static const char *sf[] = {
+		",",
+		"[,]",
+		"[,1]",
+		"[1,,]",
+		"[1,,2]",
+		"[1 2]",
+		"{,}",
+		"{,\"a\":1}",
+		"{\"a\":1,,}",
+		"{\"a\",}",
+		"{\"a\":,}",
+		"{\"a\":1 \"b\":2}",
+		"1,",
+	};
+	data_t *d;
+
+	for (int i = 0; i < ARRAY_SIZE(s); i++) {
+		d = _parse(s[i].src, strlen(s[i].src));
+		assert_ptr_null(d, !=);
+		if (data_get_type(d) == DATA_TYPE_LIST)
+			assert_int_eq(data_get_list_length(d), s[i].count);
+		else
+			assert_int_eq(data_get_dict_length(d), s[i].count);
+		FREE_NULL_DATA(d);
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(sf); i++) {
+		d = _parse(sf[i], strlen(sf[i]));
+		/* trailing characters after a complete value are ignored */
+		if (!xstrcmp(sf[i], "1,")) {
+			assert(d && (data_get_int(d) == 1));
+			FREE_NULL_DATA(d);
+			continue;
+		}
+		assert_msg(!d, "expected failure %d parsed: %s", i, sf[i]);
+		FREE_NULL_DATA(d);
+	}
+}
+END_TEST
+
+START_TEST(test_parse_truncated)
+{
+	static const char *s[] = {
+		"{\"a\":[1,-2.5e3,\"x\\u0041\\ud83d\\ude00\",true,false,null],"
+		"\"b\":{\"c\":\"\\\"\\\\\\/\",\"d\":[]},\"e\":NaN,"
+		"\"f\":-Infinity}",
+		"[ { \"taco\" : \"tacos\" } , [ 100 , 1.1238e10 ] ]",
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(s); i++) {
+		const size_t len = strlen(s[i]);
+		data_t *d;
+
+		/*
+		 * The full string follows every truncation point so any read
+		 * past the given length would parse successfully.
+		 */
+		for (size_t l = 0; l < len; l++) {
+			d = _parse(s[i], l);
+			assert_msg(!d, "truncated %d at %zu parsed", i, l);
+			FREE_NULL_DATA(d);
+		}
+
+		d = _parse(s[i], len);
+		assert_ptr_null(d, !=);
+		FREE_NULL_DATA(d);
+	}
+}
+END_TEST
+
+START_TEST(test_parse_roundtrip)
+{
+	data_t *src = data_set_dict(data_new()), *list;
+	char *str = NULL;
+
+	/* strings needing every kind of escape or none at all */
+	data_set_string(data_key_set(src, "empty"), "");
+	data_set_string(data_key_set(src, "escapes"),
+			"\"\\/\b\f\n\r\t\x01\x1F\x7F");
+	data_set_string(data_key_set(src, "utf8"),
+			"\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+	data_set_string(data_key_set(src, "key \"with\"\n\\escapes\\"), "v");
+	for (int c = 1; c < 128; c++)
+		xstrcatchar(str, c);
+	data_set_string(data_key_set(src, "ascii"), str);
+	xfree(str);
+
+	data_set_int(data_key_set(src, "int_min"), INT64_MIN);
+	data_set_int(data_key_set(src, "int_max"), INT64_MAX);
+	data_set_int(data_key_set(src, "zero"), 0);
+	data_set_float(data_key_set(src, "float"), -1.1238e-10);
+	data_set_float(data_key_set(src, "whole_float"), 100.0);
+	data_set_bool(data_key_set(src, "true"), true);
+	data_set_bool(data_key_set(src, "false"), false);
+	data_set_null(data_key_set(src, "null"));
+	data_set_dict(data_key_set(src, "empty_dict"));
+	data_set_list(data_key_set(src, "empty_list"));
+
+	list = data_set_list(data_key_set(src, "nested"));
+	for (int i = 0; i < 10; i++)
+		list = data_set_list(data_list_append(list));
+	data_set_string(data_key_set(data_set_dict(data_list_append(list)),
+				     "deep"), "value");
+
+	for (int f = 0; f < ARRAY_SIZE(flag_combinations); f++) {
+		char *output = NULL, *output2 = NULL;
+		size_t output_len = 0, output2_len = 0;
+		data_t *d = NULL;
+		int rc;
+
+		rc = serialize_g_data_to_string(&output, &output_len, src,
+						MIME_TYPE_JSON,
+						flag_combinations[f]);
+		assert_int_eq(rc, 0);
+
+		d = _parse(output, output_len);
+		assert_msg(data_check_match(src, d, false),
+			   "round trip failed: %s", output);
+		assert(data_get_type(data_key_get(d, "whole_float")) ==
+		       DATA_TYPE_FLOAT);
+
+		/* dumping the parsed data gives the same output */
+		rc = serialize_g_data_to_string(&output2, &output2_len, d,
+						MIME_TYPE_JSON,
+						flag_combinations[f]);
+		assert_int_eq(rc, 0);
+		assert_msg(!xstrcmp(output, output2),
+			   "second dump differs: %s != %s", output, output2);
+
+		FREE_NULL_DATA(d);
+		xfree(output);
+		xfree(output2);
+	}
+
+	FREE_NULL_DATA(src);
+}
+END_TEST
+
+/* Dump data as compact JSON and check the output text */
+static void _check_dump(const data_t *d, const char *expected)
+{
+	char *output = NULL;
+	int rc;
+
+	rc = serialize_g_data_to_string(&output, NULL, d, MIME_TYPE_JSON,
+					SER_FLAGS_COMPACT);
+	assert_int_eq(rc, 0);
+	assert_msg(!xstrcmp(output, expected), "dumped %s expected %s",
+		   output, expected);
+	xfree(output);
+}
+
+START_TEST(test_dump_float)
+{
+	static const struct {
+		double value;
+		const char *expected;
+	} s[] = {
+		{ 0.1, "0.10000000000000001" },
+		{ 1.5, "1.5" },
+		{ 100.0, "100.0" },
+		{ -0.0, "-0.0" },
+		{ 1e21, "1e+21" },
+		{ 5e-324, "4.9406564584124654e-324" },
+		{ 1.7976931348623157e308, "1.7976931348623157e+308" },
+	};
+	static const double rt[] = {
+		0.1, 1.0 / 3.0, 2.0 / 3.0, -1.1238e10, 123456789012345678.0,
+		DBL_MAX, -DBL_MAX, DBL_MIN, DBL_EPSILON, 5e-324, 0.0, -0.0,
+		1.0, 100.0, M_PI, 9007199254740993.0,
+	};
+	data_t *list = data_set_list(data_new()), *d;
+	char *output = NULL;
+	size_t output_len = 0;
+	double value = 0;
+	int rc;
+
+	for (int i = 0; i < ARRAY_SIZE(s); i++) {
+		d = data_set_float(data_new(), s[i].value);
+		_check_dump(d, s[i].expected);
+		FREE_NULL_DATA(d);
+	}
+
+	/* values JSON can't represent are written as json-c did */
+	data_set_float(data_list_append(list), NAN);
+	data_set_float(data_list_append(list), INFINITY);
+	data_set_float(data_list_append(list), -INFINITY);
+	_check_dump(list, "[NaN,Infinity,-Infinity]");
+
+	rc = serialize_g_data_to_string(&output, &output_len, list,
+					MIME_TYPE_JSON, SER_FLAGS_PRETTY);
+	assert_int_eq(rc, 0);
+	FREE_NULL_DATA(list);
+
+	/* and parse back to the same values */
+	list = _parse(output, output_len);
+	assert_ptr_null(list, !=);
+	_check_dump(list, "[NaN,Infinity,-Infinity]");
+	xfree(output);
+	FREE_NULL_DATA(list);
+
+	/* "%.17g" gives back exactly the same double */
+	for (int i = 0; i < ARRAY_SIZE(rt); i++) {
+		d = data_set_float(data_new(), rt[i]);
+		rc = serialize_g_data_to_string(&output, &output_len, d,
+						MIME_TYPE_JSON,
+						SER_FLAGS_COMPACT);
+		assert_int_eq(rc, 0);
+		FREE_NULL_DATA(d);
+
+		d = _parse(output, output_len);
+		if (d)
+			value = data_get_float(d);
+		assert_msg(d && (data_get_type(d) == DATA_TYPE_FLOAT) &&
+			   !memcmp(&rt[i], &value, sizeof(value)),
+			   "float %d did not round trip: %s", i, output);
+		xfree(output);
+		FREE_NULL_DATA(d);
+	}
+}
+END_TEST
+
+START_TEST(test_dump_string)
+{
+	static const struct {
+		const char *value;
+		const char *expected;
+	} s[] = {
+		{ "", "\"\"" },
+		/* '/' is not escaped as json-c did */
+		{ "a/b", "\"a/b\"" },
+		{ "</script>", "\"</script>\"" },
+		{ "/", "\"/\"" },
+		{ "\"\\", "\"\\\"\\\\\"" },
+		{ "\b\f\n\r\t", "\"\\b\\f\\n\\r\\t\"" },
+		{ "\x01\x1F", "\"\\u0001\\u001f\"" },
+		/* DEL and UTF-8 are written as is */
+		{ "\x7F", "\"\x7F\"" },
+		{ "\xC3\xA9\xF0\x9F\x98\x80", "\"\xC3\xA9\xF0\x9F\x98\x80\"" },
+		{ "taco \"tacos\" \\taco/", "\"taco \\\"tacos\\\" \\\\taco/\"" },
+	};
+	data_t *d;
+
+	for (int i = 0; i < ARRAY_SIZE(s); i++) {
+		d = data_set_string(data_new(), s[i].value);
+		_check_dump(d, s[i].expected);
+		FREE_NULL_DATA(d);
+	}
+
+	/* escaped '/' is still accepted when parsing */
+	d = _parse("\"a\\/b\"", 6);
+	assert(d && !xstrcmp(data_get_string(d), "a/b"));
+	_check_dump(d, "\"a/b\"");
+	FREE_NULL_DATA(d);
+
+	/* keys are escaped the same way */
+	d = data_set_dict(data_new());
+	data_set_null(data_key_set(d, "a/b\n"));
+	_check_dump(d, "{\"a/b\\n\":null}");
+	FREE_NULL_DATA(d);
+}
+END_TEST
+
 START_TEST(test_mimetype)
 {
 	const char *ptr = NULL;
@@ -704,6 +1218,14 @@ extern Suite *suite_data(void)
 
 	tcase_add_test(tc_core, test_mimetype);
 	tcase_add_test(tc_core, test_parse);
+	tcase_add_test(tc_core, test_parse_limits);
+	tcase_add_test(tc_core, test_parse_strings);
+	tcase_add_test(tc_core, test_parse_numbers);
+	tcase_add_test(tc_core, test_parse_commas);
+	tcase_add_test(tc_core, test_parse_truncated);
+	tcase_add_test(tc_core, test_parse_roundtrip);
+	tcase_add_test(tc_core, test_dump_float);
+	tcase_add_test(tc_core, test_dump_string);
 	tcase_add_test(tc_core, test_compliance);
 	tcase_add_test(tc_core, test_bandwidth);
 